@@ -0,0 +1,132 @@
+/**
+ * @file accept_bench.c
+ * @brief Connection accept rate of zn_server as the number of SO_REUSEPORT
+ *        listeners grows
+ *
+ * Usage: accept_bench [seconds] [max_workers] [client_threads] [port]
+ *
+ * For 1, 2, 4, ... up to max_workers workers (one per core by default), a
+ * server is started and client_threads threads connect to it in a loop for
+ * the given time. Clients close with SO_LINGER 0 so the connections end in
+ * a reset instead of piling up in TIME_WAIT; the server closes each
+ * connection as soon as it is accepted.
+ *
+ * Reports accepted connections per second and how the kernel spread them
+ * over the listeners. Accept throughput only scales when there are as many
+ * free cores as workers, and the clients compete for the same cores on a
+ * single machine.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "server.h"
+#include "threads.h"
+
+#define MAX_CLIENTS 64
+
+static volatile bool clients_running = false;
+static int server_port = 0;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void on_connection(zn_reactor_t *reactor, socket_t *client, void *data) {
+    (void)reactor;
+    (void)data;
+    close(client->fd);
+}
+
+static void *client_main(void *arg) {
+    uint64_t *failures = (uint64_t *)arg;
+    struct linger reset = { 1, 0 };
+    while (__atomic_load_n(&clients_running, __ATOMIC_RELAXED)) {
+        socket_t client;
+        if (!socket_create(&client, SOCKET_TCP).success) {
+            (*failures)++;
+            continue;
+        }
+        if (!socket_connect(&client, "127.0.0.1", server_port).success) {
+            (*failures)++;
+        }
+        setsockopt(client.fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        socket_close(&client);
+    }
+    return NULL;
+}
+
+static void run(size_t workers, size_t clients, double seconds, int port) {
+    zn_server_config_t config;
+    zn_server_config_init(&config, port);
+    config.workers = workers;
+
+    zn_server_t *server = zn_server_create(&config, on_connection, NULL);
+    if (!server || zn_server_start(server) != 0) {
+        fprintf(stderr, "failed to start a server with %zu workers on port %d\n", workers, port);
+        exit(1);
+    }
+    server_port = zn_server_port(server);
+
+    zn_thread_t threads[MAX_CLIENTS];
+    uint64_t failures[MAX_CLIENTS] = { 0 };
+    clients_running = true;
+    double start = now_ms();
+    for (size_t i = 0; i < clients; i++) {
+        zn_thread_init(&threads[i]);
+        zn_thread_create(&threads[i], client_main, &failures[i]);
+    }
+    usleep((useconds_t)(seconds * 1e6));
+    __atomic_store_n(&clients_running, false, __ATOMIC_RELAXED);
+    for (size_t i = 0; i < clients; i++) {
+        zn_thread_join(&threads[i], NULL);
+    }
+    double elapsed = now_ms() - start;
+    zn_server_stop(server);
+
+    uint64_t total = 0, failed = 0;
+    for (size_t i = 0; i < workers; i++) {
+        total += zn_server_accepted(server, i);
+    }
+    for (size_t i = 0; i < clients; i++) {
+        failed += failures[i];
+    }
+
+    printf("  %2zu workers  %10.0f accepts/s  %8lu failed  spread:", workers, (double)total / (elapsed / 1e3),
+           (unsigned long)failed);
+    for (size_t i = 0; i < workers; i++) {
+        printf(" %4.1f%%", total ? 100.0 * (double)zn_server_accepted(server, i) / (double)total : 0.0);
+    }
+    printf("\n");
+    zn_server_destroy(server);
+}
+
+int main(int argc, char **argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_workers = argc > 2 ? (size_t)atol(argv[2]) : (size_t)(cores > 0 ? cores : 1);
+    size_t clients = argc > 3 ? (size_t)atol(argv[3]) : 4;
+    int port = argc > 4 ? atoi(argv[4]) : 7860;
+    if (max_workers == 0) {
+        max_workers = 1;
+    }
+    if (clients == 0 || clients > MAX_CLIENTS) {
+        clients = clients == 0 ? 1 : MAX_CLIENTS;
+    }
+
+    printf("accept_bench: %.1f s per run, %zu client threads, %ld cores\n", seconds, clients, cores);
+    for (size_t workers = 1;; workers *= 2) {
+        if (workers > max_workers) {
+            workers = max_workers;
+        }
+        run(workers, clients, seconds, port);
+        if (workers == max_workers) {
+            break;
+        }
+    }
+    return 0;
+}
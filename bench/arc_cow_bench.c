@@ -0,0 +1,110 @@
+/**
+ * @file arc_cow_bench.c
+ * @brief Passes a 10MB ZenoRC array through a pipeline of value-semantics stages
+ *
+ * Every stage takes its input by value (a ZenoRC copy), reads it and hands a
+ * copy to the next stage. Only the last stage writes. With copy-on-write the
+ * whole pipeline performs a single clone; with eager copies every stage
+ * copies the full buffer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "zeno_arc.h"
+
+#define ARRAY_BYTES (10u * 1024u * 1024u)
+#define ARRAY_COUNT (ARRAY_BYTES / sizeof(int))
+#define STAGES 8
+#define ITERATIONS 50
+
+typedef void* (*copy_fn)(void*);
+
+static size_t bytes_copied = 0;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Eager copy that keeps track of how much was copied
+static void* eager_copy(void* ptr) {
+    bytes_copied += ARRAY_BYTES;
+    return ZenoRC_clone(ptr);
+}
+
+static void* cow_copy(void* ptr) {
+    return ZenoRC_copy(ptr);
+}
+
+// Read-only stage: checks the array and passes a copy along
+static int* stage_read(int* input, copy_fn copy, long* checksum) {
+    int* array = (int*)copy(input);
+    *checksum += array[0] + array[ARRAY_COUNT / 2] + array[ARRAY_COUNT - 1];
+    return array;
+}
+
+// Final stage: the only one that writes
+static int* stage_write(int* input, copy_fn copy) {
+    int* array = (int*)copy(input);
+    if (copy == cow_copy) {
+        if (!ZenoRC_isUnique(array)) {
+            bytes_copied += ARRAY_BYTES;
+        }
+        array = ZENO_MUTATE(array);
+    }
+    array[0] = -1;
+    return array;
+}
+
+static double run_pipeline(int* source, copy_fn copy, long* checksum) {
+    double start = now_ms();
+    
+    for (int iter = 0; iter < ITERATIONS; iter++) {
+        int* current = source;
+        ZenoRC_retain(current);
+        
+        for (int stage = 0; stage < STAGES; stage++) {
+            int* next = stage_read(current, copy, checksum);
+            ZenoRC_release(current);
+            current = next;
+        }
+        
+        int* result = stage_write(current, copy);
+        *checksum += result[0];
+        ZenoRC_release(current);
+        ZenoRC_release(result);
+    }
+    
+    return (now_ms() - start) / ITERATIONS;
+}
+
+int main(void) {
+    int* source = (int*)ZenoRC_createArray(sizeof(int), ARRAY_COUNT, "int");
+    for (size_t i = 0; i < ARRAY_COUNT; i++) {
+        source[i] = (int)i;
+    }
+    
+    long checksum = 0;
+    
+    bytes_copied = 0;
+    double eager_ms = run_pipeline(source, eager_copy, &checksum);
+    size_t eager_bytes = bytes_copied / ITERATIONS;
+    
+    bytes_copied = 0;
+    double cow_ms = run_pipeline(source, cow_copy, &checksum);
+    size_t cow_bytes = bytes_copied / ITERATIONS;
+    
+    printf("ZenoRC copy-on-write pipeline (%u MB array, %d read stages + 1 write)\n",
+           ARRAY_BYTES / (1024u * 1024u), STAGES);
+    printf("  eager copy:     %8.3f ms/pipeline, %6zu MB copied\n",
+           eager_ms, eager_bytes / (1024 * 1024));
+    printf("  copy-on-write:  %8.3f ms/pipeline, %6zu MB copied\n",
+           cow_ms, cow_bytes / (1024 * 1024));
+    printf("  speedup:        %8.1fx\n", eager_ms / cow_ms);
+    printf("  (checksum %ld)\n", checksum);
+    
+    ZenoRC_releaseObject(source);
+    return 0;
+}
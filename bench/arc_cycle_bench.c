@@ -0,0 +1,227 @@
+/**
+ * @file arc_cycle_bench.c
+ * @brief Cycle collector pause lengths against the slice budget
+ *
+ * Usage: arc_cycle_bench [budget_us] [ring_nodes]
+ *
+ * Builds garbage rings of ZenoRC nodes, drops every outside reference so
+ * each ring is left to the cycle collector, then collects in slices of
+ * `budget_us` (1000 by default) until the roots buffer is drained:
+ *
+ * - small: 100000 rings of 4 nodes, many roots per batch
+ * - large: 64 rings of `ring_nodes` nodes (200000 by default), one root
+ *   each, which reaches far more objects than a slice can trace
+ * - trigger: 32 large rings left to the automatic trigger (one root, one
+ *   slice of `budget_us`) while the mutator keeps retaining and releasing
+ *   a live ring. A trial that reaches the live ring is abandoned when the
+ *   mutator touches it; the garbage rings must still be freed.
+ *
+ * Reports the slices run and the median, 95th and 99th percentile and
+ * longest pause per scenario, and checks that every garbage node was freed
+ * by the slices alone. Exits non-zero if a pause percentile is over twice
+ * the budget: the 95th for small, which only runs a few dozen slices, and
+ * the 99th for the others. The maximum is reported but not checked: pauses
+ * are wall-clock time, and a slice that is preempted can take any time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "zeno_arc.h"
+
+#ifndef ZENO_ARC_CYCLES
+#error "arc_cycle_bench needs the cycle collector (-DZENO_ARC_CYCLES)"
+#endif
+
+typedef struct Node {
+    struct Node* next;
+    long value;
+} Node;
+
+static size_t nodes_alive = 0;
+
+static void node_trace(void* ptr, ZenoRC_Visitor visit) {
+    Node* node = (Node*)ptr;
+    if (node->next) {
+        visit(node->next);
+    }
+}
+
+static void node_deinit(void* ptr) {
+    Node* node = (Node*)ptr;
+    ZenoRC_release(node->next);
+    nodes_alive--;
+}
+
+static Node* node_new(long value) {
+    Node* node = (Node*)ZenoRC_alloc(sizeof(Node), "Node");
+    node->next = NULL;
+    node->value = value;
+    ZenoRC_setDeinit(node, node_deinit);
+    ZenoRC_setTrace(node, node_trace);
+    nodes_alive++;
+    return node;
+}
+
+// Build a ring of `length` nodes, returning a retained reference to it
+static Node* make_ring(size_t length) {
+    Node* head = node_new(0);
+    Node* tail = head;
+    for (size_t i = 1; i < length; i++) {
+        Node* node = node_new((long)i);
+        tail->next = node;
+        tail = node;
+    }
+    ZenoRC_retain(head);
+    tail->next = head;
+    return head;
+}
+
+// Build a ring of `length` nodes and drop the outside reference to it
+static void make_garbage_ring(size_t length) {
+    // Only the tail holds the head now, so it is buffered as a possible root
+    ZenoRC_release(make_ring(length));
+}
+
+#define MAX_SLICES 100000
+
+typedef struct {
+    size_t slices;
+    uint64_t p50_ns;
+    uint64_t p95_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+} slice_result_t;
+
+static uint64_t pauses[MAX_SLICES];
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static slice_result_t percentiles(size_t slices) {
+    slice_result_t result = {0};
+    result.slices = slices;
+    if (slices > MAX_SLICES) {
+        slices = MAX_SLICES;
+    }
+    qsort(pauses, slices, sizeof(uint64_t), compare_u64);
+    result.p50_ns = pauses[slices / 2];
+    result.p95_ns = pauses[slices * 95 / 100];
+    result.p99_ns = pauses[slices * 99 / 100];
+    result.max_ns = pauses[slices - 1];
+    return result;
+}
+
+// Collect in slices of budget_us until nothing is buffered
+static slice_result_t drain(uint64_t budget_us) {
+    size_t slices = 0;
+    size_t remaining;
+    do {
+        remaining = ZenoRC_collectCyclesSlice(budget_us);
+        if (slices < MAX_SLICES) {
+            pauses[slices] = ZenoRC_getCycleStats().last_pause_ns;
+        }
+        slices++;
+    } while (remaining > 0);
+    return percentiles(slices);
+}
+
+// Record the pause of the slice the trigger ran since the last call, if any
+static void record_trigger_slice(size_t* slices, size_t* seen) {
+    ZenoRC_CycleStats stats = ZenoRC_getCycleStats();
+    if (stats.slices != *seen) {
+        if (*slices < MAX_SLICES) {
+            pauses[*slices] = stats.last_pause_ns;
+        }
+        (*slices)++;
+        *seen = stats.slices;
+    }
+}
+
+// Leave garbage rings to the automatic trigger while the mutator uses a
+// live ring, until the garbage is gone or `max_steps` mutator steps ran
+static slice_result_t mutate(uint64_t budget_us, size_t ring_nodes, size_t max_steps, size_t* steps) {
+    size_t live_nodes = 2;
+    Node* live = make_ring(live_nodes);
+    ZenoRC_setCycleTrigger(1, budget_us);
+
+    // Every release below buffers a root and runs at most one slice
+    size_t slices = 0;
+    size_t seen = ZenoRC_getCycleStats().slices;
+    for (size_t i = 0; i < 32; i++) {
+        make_garbage_ring(ring_nodes);
+        record_trigger_slice(&slices, &seen);
+    }
+
+    for (*steps = 0; nodes_alive > live_nodes && *steps < max_steps; (*steps)++) {
+        ZenoRC_retain(live);
+        live->value++;
+        ZenoRC_release(live);
+        record_trigger_slice(&slices, &seen);
+    }
+
+    ZenoRC_setCycleTrigger(0, 0);
+    ZenoRC_release(live);
+    return percentiles(slices ? slices : 1);
+}
+
+static void report(const char* label, slice_result_t result) {
+    printf("  %-7s %6zu slices  pause p50 %6.3f ms  p95 %6.3f ms  p99 %6.3f ms  max %6.3f ms\n", label,
+           result.slices, result.p50_ns / 1e6, result.p95_ns / 1e6, result.p99_ns / 1e6,
+           result.max_ns / 1e6);
+}
+
+int main(int argc, char** argv) {
+    uint64_t budget_us = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000;
+    size_t ring_nodes = argc > 2 ? strtoull(argv[2], NULL, 10) : 200000;
+    if (budget_us == 0 || ring_nodes < 2) {
+        fprintf(stderr, "usage: arc_cycle_bench [budget_us] [ring_nodes]\n");
+        return 1;
+    }
+
+    // Slices are run by hand
+    ZenoRC_setCycleTrigger(0, 0);
+    printf("arc_cycle_bench: slice budget %.3f ms\n", budget_us / 1e3);
+
+    for (size_t i = 0; i < 100000; i++) {
+        make_garbage_ring(4);
+    }
+    slice_result_t small = drain(budget_us);
+    report("small", small);
+
+    for (size_t i = 0; i < 64; i++) {
+        make_garbage_ring(ring_nodes);
+    }
+    slice_result_t large = drain(budget_us);
+    report("large", large);
+    if (nodes_alive != 0) {
+        fprintf(stderr, "%zu nodes were not freed by the slices\n", nodes_alive);
+        return 1;
+    }
+
+    size_t cancelled = ZenoRC_getCycleStats().trials_cancelled;
+    size_t steps;
+    slice_result_t trigger = mutate(budget_us, ring_nodes, MAX_SLICES, &steps);
+    report("trigger", trigger);
+    cancelled = ZenoRC_getCycleStats().trials_cancelled - cancelled;
+    printf("  %zu mutator steps, %zu trials cancelled by the mutator\n", steps, cancelled);
+    if (steps == MAX_SLICES) {
+        fprintf(stderr, "the automatic trigger did not free the garbage in %zu steps\n", steps);
+        return 1;
+    }
+
+    // Only the live ring, released above, may be left
+    ZenoRC_collectCycles();
+    if (nodes_alive != 0) {
+        fprintf(stderr, "%zu nodes were not freed\n", nodes_alive);
+        return 1;
+    }
+    uint64_t limit_ns = budget_us * 2000ull;
+    if (small.p95_ns > limit_ns || large.p99_ns > limit_ns || trigger.p99_ns > limit_ns) {
+        fprintf(stderr, "pause percentile over twice the budget\n");
+        return 1;
+    }
+    printf("  all nodes freed, pause percentiles within twice the budget\n");
+    return 0;
+}
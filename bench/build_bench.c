@@ -0,0 +1,219 @@
+/**
+ * @file build_bench.c
+ * @brief `zeno build` of a many-module project, serial vs parallel
+ *
+ * Usage: build_bench [modules] [jobs] [runs] [zeno]
+ *
+ * Writes a project of `modules` modules (200 by default) to a temporary
+ * directory, split between its src and lib include directories, and a
+ * manifest for it. main imports every module; most modules also import
+ * the one before them, so headers include headers and the import graph is
+ * discovered over several waves. Each module has a handful of functions
+ * with loops and branches so that compiling a unit takes real time.
+ *
+ * The project is then built from scratch with `zeno build -j1` and with
+ * `zeno build -j<jobs>` (jobs defaults to the number of cores), best of
+ * `runs`, using the zeno binary at `zeno` (bin/zeno by default). Both
+ * binaries must print the same result, which is also checked against the
+ * value computed here.
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FUNCTIONS_PER_MODULE 6
+
+// Modules that start a new import chain instead of importing the one before
+#define CHAIN_LENGTH 8
+
+static const char function_template[] =
+    "fn step%d_%d(a: int, b: int): int {\n"
+    "    let total: int = a * %d + b;\n"
+    "    let k: int = 8;\n"
+    "    while (k) {\n"
+    "        if (k %% 2) {\n"
+    "            total = total %% 100003 + k * b;\n"
+    "        } else {\n"
+    "            total = total + %d;\n"
+    "        }\n"
+    "        k = k - 1;\n"
+    "    }\n"
+    "    return total;\n"
+    "}\n"
+    "\n";
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static FILE* create(const char* dir, const char* name) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "failed to create %s\n", path);
+        exit(1);
+    }
+    return file;
+}
+
+/* What the generated step functions compute, for checking the binaries */
+static long step(int module, int function, long a, long b) {
+    long total = a * (module * FUNCTIONS_PER_MODULE + function) + b;
+    for (long k = 8; k; k--) {
+        if (k % 2) {
+            total = total % 100003 + k * b;
+        } else {
+            total = total + function;
+        }
+    }
+    return total;
+}
+
+/* Write the project and return the sum main prints */
+static long generate(const char* root, int modules) {
+    char src[PATH_MAX], lib[PATH_MAX];
+    snprintf(src, sizeof(src), "%s/src", root);
+    snprintf(lib, sizeof(lib), "%s/lib", root);
+    if (mkdir(src, 0755) != 0 || mkdir(lib, 0755) != 0) {
+        fprintf(stderr, "failed to create the project directories\n");
+        exit(1);
+    }
+
+    FILE* manifest = create(root, "manifest.yaml");
+    fprintf(manifest, "name: \"build_bench\"\n");
+    fprintf(manifest, "output:\n  dir: \"./build\"\n  binary: \"build_bench\"\n");
+    fprintf(manifest, "source:\n  main: \"src/main.zn\"\n  include:\n    - \"src\"\n    - \"lib\"\n");
+    fprintf(manifest, "compiler:\n  cc: \"cc\"\n  flags: \"-O2 -w\"\n");
+    fclose(manifest);
+
+    long expected = 0;
+    for (int m = 1; m <= modules; m++) {
+        char name[64];
+        snprintf(name, sizeof(name), "mod%d.zn", m);
+        FILE* file = create(m % 2 ? src : lib, name);
+        if (m % CHAIN_LENGTH != 1) {
+            fprintf(file, "import \"mod%d.zn\";\n\n", m - 1);
+        }
+        for (int f = 0; f < FUNCTIONS_PER_MODULE; f++) {
+            int factor = m * FUNCTIONS_PER_MODULE + f;
+            fprintf(file, function_template, m, f, factor, f);
+        }
+
+        // entry<m> chains the module's functions together
+        fprintf(file, "fn entry%d(x: int): int {\n    let value: int = x;\n", m);
+        long value = m;
+        for (int f = 0; f < FUNCTIONS_PER_MODULE; f++) {
+            fprintf(file, "    value = step%d_%d(value, %d);\n", m, f, f + 1);
+            value = step(m, f, value, f + 1);
+        }
+        fprintf(file, "    return value;\n}\n");
+        fclose(file);
+        expected += value;
+    }
+
+    FILE* main_file = create(src, "main.zn");
+    fprintf(main_file, "import \"stdio.h\";\n");
+    for (int m = 1; m <= modules; m++) {
+        fprintf(main_file, "import \"mod%d.zn\";\n", m);
+    }
+    fprintf(main_file, "\nfn main(): int {\n    let total: int = 0;\n");
+    for (int m = 1; m <= modules; m++) {
+        fprintf(main_file, "    total = total + entry%d(%d);\n", m, m);
+    }
+    fprintf(main_file, "    printf(\"%%d\\n\", total);\n    return 0;\n}\n");
+    fclose(main_file);
+
+    return expected;
+}
+
+/* Build from scratch with `jobs` jobs, best of runs; returns the best time */
+static double build(const char* zeno, int jobs, int runs) {
+    char command[PATH_MAX + 64];
+    double best = 0;
+    for (int run = 0; run < runs; run++) {
+        if (system("rm -rf build") != 0) {
+            fprintf(stderr, "failed to remove the previous build\n");
+            exit(1);
+        }
+        snprintf(command, sizeof(command), "%s build -j%d > /dev/null", zeno, jobs);
+        double start = now_ms();
+        int status = system(command);
+        double elapsed = now_ms() - start;
+        if (status != 0) {
+            fprintf(stderr, "%s failed\n", command);
+            exit(1);
+        }
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+/* Run the built binary and return what it printed */
+static long run_binary(void) {
+    FILE* output = popen("./build/build_bench", "r");
+    long value = 0;
+    if (!output || fscanf(output, "%ld", &value) != 1) {
+        fprintf(stderr, "failed to run the built binary\n");
+        exit(1);
+    }
+    pclose(output);
+    return value;
+}
+
+int main(int argc, char** argv) {
+    int modules = argc > 1 ? atoi(argv[1]) : 200;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int jobs = argc > 2 ? atoi(argv[2]) : (int)(cores > 0 ? cores : 1);
+    int runs = argc > 3 ? atoi(argv[3]) : 3;
+    const char* zeno_path = argc > 4 ? argv[4] : "bin/zeno";
+    char zeno[PATH_MAX];
+    if (modules <= 0 || jobs <= 0 || runs <= 0 || !realpath(zeno_path, zeno)) {
+        fprintf(stderr, "usage: build_bench [modules] [jobs] [runs] [zeno]\n");
+        return 1;
+    }
+
+    char root[] = "/tmp/build_bench_XXXXXX";
+    if (!mkdtemp(root)) {
+        fprintf(stderr, "failed to create a temporary directory\n");
+        return 1;
+    }
+    long expected = generate(root, modules);
+    if (chdir(root) != 0) {
+        fprintf(stderr, "failed to enter %s\n", root);
+        return 1;
+    }
+
+    printf("build_bench: %d modules, %d functions each, best of %d runs\n", modules,
+           FUNCTIONS_PER_MODULE + 1, runs);
+    double serial = build(zeno, 1, runs);
+    long serial_value = run_binary();
+    double parallel = build(zeno, jobs, runs);
+    long parallel_value = run_binary();
+
+    printf("  -j1  %8.1f ms\n", serial);
+    printf("  -j%-2d %8.1f ms  (%.2fx, %ld cores)\n", jobs, parallel, serial / parallel, cores);
+
+    char cleanup[PATH_MAX + 16];
+    snprintf(cleanup, sizeof(cleanup), "rm -rf %s", root);
+    if (chdir("/") != 0 || system(cleanup) != 0) {
+        fprintf(stderr, "failed to remove %s\n", root);
+    }
+
+    if (serial_value != expected || parallel_value != expected) {
+        fprintf(stderr, "built binaries printed %ld and %ld, expected %ld\n", serial_value, parallel_value,
+                expected);
+        return 1;
+    }
+    printf("  both binaries print %ld\n", expected);
+    return 0;
+}
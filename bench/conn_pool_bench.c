@@ -0,0 +1,188 @@
+/**
+ * @file conn_pool_bench.c
+ * @brief Checkout cost of zn_conn_pool for new and reused connections, and
+ *        cancellation of connects in flight when the pool is destroyed
+ *
+ * Usage: conn_pool_bench [iterations] [pending]
+ *
+ * Against a zn_server on loopback:
+ *
+ * - new: `iterations` (5000 by default) blocking checkouts, each checked
+ *   back in as not reusable, so every one opens a connection.
+ * - reuse: the same number of checkouts and checkins of one idle
+ *   connection, which only pay for the lookup and the health check.
+ * - async new / async reuse: the same through zn_conn_pool_checkout_async,
+ *   awaiting each promise.
+ *
+ * Reports microseconds per checkout and checkin.
+ *
+ * cancel: `pending` (16 by default) asynchronous checkouts to a listener
+ * with a backlog of 0 that never accepts, so that all but the first stay
+ * connecting. The connected ones are checked in and the pool destroyed;
+ * every other promise must then be rejected with ECANCELED.
+ */
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "conn_pool.h"
+#include "server.h"
+
+#define MAX_PENDING 256
+
+static volatile bool keep_open = false;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void on_connection(zn_reactor_t *reactor, socket_t *client, void *data) {
+    (void)reactor;
+    (void)data;
+    // A reused connection must stay open for the health check to pass; the
+    // two kept by the reuse passes stay open until the process exits
+    if (!keep_open) {
+        close(client->fd);
+    }
+}
+
+static socket_t *checkout(zn_conn_pool_t *pool, int port, bool async) {
+    socket_t *connection = NULL;
+    if (async) {
+        zn_promise_t *promise = zn_conn_pool_checkout_async(pool, "127.0.0.1", port);
+        connection = promise ? (socket_t *)zn_promise_await(promise) : NULL;
+        zn_promise_free(promise);
+    } else if (zn_conn_pool_checkout(pool, "127.0.0.1", port, &connection) != 0) {
+        connection = NULL;
+    }
+    if (!connection) {
+        fprintf(stderr, "checkout failed\n");
+        exit(1);
+    }
+    return connection;
+}
+
+/* Microseconds per checkout and checkin */
+static double run(int port, int iterations, bool async, bool reuse) {
+    zn_conn_pool_t *pool = zn_conn_pool_create(NULL);
+    if (!pool) {
+        fprintf(stderr, "failed to create a pool\n");
+        exit(1);
+    }
+    keep_open = reuse;
+    if (reuse) {
+        // Open the connection that every checkout below reuses
+        zn_conn_pool_checkin(pool, checkout(pool, port, async), true);
+    }
+
+    double start = now_ms();
+    for (int i = 0; i < iterations; i++) {
+        zn_conn_pool_checkin(pool, checkout(pool, port, async), reuse);
+    }
+    double elapsed = now_ms() - start;
+
+    zn_conn_pool_stats_t stats;
+    zn_conn_pool_stats(pool, &stats);
+    zn_conn_pool_destroy(pool);
+    uint64_t expected = reuse ? (uint64_t)iterations : 0;
+    if (stats.reuses != expected || stats.failures != 0) {
+        fprintf(stderr, "%llu reuses and %llu failures, expected %llu and 0\n",
+                (unsigned long long)stats.reuses, (unsigned long long)stats.failures,
+                (unsigned long long)expected);
+        exit(1);
+    }
+    return elapsed * 1e3 / iterations;
+}
+
+static void run_cancel(int pending) {
+    socket_t listener;
+    if (!socket_create(&listener, SOCKET_TCP).success || !socket_bind(&listener, 0).success ||
+        listen(listener.fd, 0) != 0) {
+        fprintf(stderr, "failed to create a listener\n");
+        exit(1);
+    }
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    getsockname(listener.fd, (struct sockaddr *)&addr, &addr_len);
+    int port = addr.ss_family == AF_INET6 ? ntohs(((struct sockaddr_in6 *)&addr)->sin6_port)
+                                          : ntohs(((struct sockaddr_in *)&addr)->sin_port);
+
+    zn_conn_pool_t *pool = zn_conn_pool_create(NULL);
+    zn_promise_t *promises[MAX_PENDING];
+    for (int i = 0; i < pending; i++) {
+        promises[i] = zn_conn_pool_checkout_async(pool, "127.0.0.1", port);
+        if (!promises[i]) {
+            fprintf(stderr, "checkout failed\n");
+            exit(1);
+        }
+    }
+    usleep(200000);
+
+    // The accept queue only has room for the first connects
+    int connected = 0;
+    for (int i = 0; i < pending; i++) {
+        if (zn_promise_state(promises[i]) == ZN_PROMISE_FULFILLED) {
+            zn_conn_pool_checkin(pool, (socket_t *)zn_promise_await(promises[i]), false);
+            connected++;
+        }
+    }
+    zn_conn_pool_destroy(pool);
+
+    int cancelled = 0;
+    for (int i = 0; i < pending; i++) {
+        zn_promise_state_t state = zn_promise_state(promises[i]);
+        if (state == ZN_PROMISE_REJECTED && (intptr_t)zn_promise_error(promises[i]) == ECANCELED) {
+            cancelled++;
+        } else if (state != ZN_PROMISE_FULFILLED) {
+            fprintf(stderr, "checkout %d left %s\n", i, state == ZN_PROMISE_PENDING ? "pending" : "rejected");
+            exit(1);
+        }
+        zn_promise_free(promises[i]);
+    }
+    socket_close(&listener);
+
+    printf("cancel: %d checkouts, %d connected, %d cancelled by destroy\n", pending, connected, cancelled);
+    if (cancelled == 0) {
+        fprintf(stderr, "no connect was in flight when the pool was destroyed\n");
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 5000;
+    int pending = argc > 2 ? atoi(argv[2]) : 16;
+    if (iterations <= 0 || pending < 2 || pending > MAX_PENDING) {
+        fprintf(stderr, "usage: conn_pool_bench [iterations] [pending]\n");
+        return 1;
+    }
+
+    zn_server_config_t config;
+    zn_server_config_init(&config, 0);
+    config.workers = 1;
+    zn_server_t *server = zn_server_create(&config, on_connection, NULL);
+    if (!server || zn_server_start(server) != 0) {
+        fprintf(stderr, "failed to start a server\n");
+        return 1;
+    }
+    int port = zn_server_port(server);
+
+    printf("checkout and checkin, %d iterations\n", iterations);
+    double new_us = run(port, iterations, false, false);
+    double reuse_us = run(port, iterations, false, true);
+    printf("  new          %8.2f us\n", new_us);
+    printf("  reuse        %8.2f us  (%.0fx)\n", reuse_us, new_us / reuse_us);
+    double async_new_us = run(port, iterations, true, false);
+    double async_reuse_us = run(port, iterations, true, true);
+    printf("  async new    %8.2f us\n", async_new_us);
+    printf("  async reuse  %8.2f us  (%.0fx)\n", async_reuse_us, async_new_us / async_reuse_us);
+
+    zn_server_destroy(server);
+    run_cancel(pending);
+    return 0;
+}
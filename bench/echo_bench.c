@@ -0,0 +1,336 @@
+/**
+ * @file echo_bench.c
+ * @brief Echo server and load generator on top of zn_reactor
+ *
+ * Usage: echo_bench [connections] [seconds] [reactors] [message_bytes] [base_port] [backend]
+ *
+ * Starts an echo server on a reactor group, opens the requested number of
+ * loopback connections from a second reactor group and has every connection
+ * send a message, wait for the echo and send again. Reports how many
+ * connections were established and the request rate. Both sides use the
+ * completion API, so running once with backend "epoll" and once with
+ * "io_uring" compares the two backends on the same code.
+ *
+ * Each loopback port pair is limited by the ephemeral port range, so the
+ * server listens on one port per 20k connections. Both ends live in this
+ * process, which needs two descriptors per connection: raise the hard
+ * RLIMIT_NOFILE (ulimit -Hn) for 50k+ connections.
+ */
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "reactor.h"
+#include "socket.h"
+
+#define CONNECTIONS_PER_PORT 20000
+#define MAX_IN_FLIGHT_CONNECTS 2000
+#define MAX_MESSAGE 65536
+#define SERVER_BUFFER 4096
+
+/* Data received while an echo is being sent collects in the other buffer */
+typedef struct {
+    socket_t socket;
+    char *sending;
+    char *filling;
+    size_t filled;
+    size_t capacity;
+    bool busy;
+    bool closing;
+    char buffers[];
+} server_conn_t;
+
+typedef struct {
+    socket_t socket;
+    int port;
+    size_t received;
+} client_conn_t;
+
+static size_t message_bytes = 64;
+static char *message;
+static size_t server_buffer = SERVER_BUFFER;
+static long established = 0;
+static long failed = 0;
+static long requests = 0;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* Echoes may be split across several receives (io_uring buffers are 4KB);
+ * without this the last piece of each message waits for a delayed ACK */
+static void set_nodelay(socket_t *socket) {
+    int option = 1;
+    setsockopt(socket->fd, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+}
+
+/* Server side */
+
+static void server_close(zn_reactor_t *reactor, server_conn_t *conn) {
+    zn_reactor_remove(reactor, &conn->socket);
+    socket_close(&conn->socket);
+    free(conn);
+}
+
+static void server_on_sent(zn_reactor_t *reactor, socket_t *socket, size_t sent, int error, void *data);
+
+static void server_echo(zn_reactor_t *reactor, server_conn_t *conn) {
+    char *buffer = conn->filling;
+    size_t length = conn->filled;
+    conn->filling = conn->sending;
+    conn->sending = buffer;
+    conn->filled = 0;
+    conn->busy = true;
+    if (zn_reactor_send(reactor, &conn->socket, buffer, length, server_on_sent, conn) != 0) {
+        server_close(reactor, conn);
+    }
+}
+
+static void server_on_sent(zn_reactor_t *reactor, socket_t *socket, size_t sent, int error, void *data) {
+    (void)socket;
+    (void)sent;
+    server_conn_t *conn = (server_conn_t *)data;
+    conn->busy = false;
+
+    /* A send may still be using the buffers, so closing waits for it */
+    if (error != 0 || conn->closing) {
+        server_close(reactor, conn);
+    } else if (conn->filled > 0) {
+        server_echo(reactor, conn);
+    }
+}
+
+static void server_on_receive(zn_reactor_t *reactor, socket_t *socket, const void *buffer, size_t length,
+                              int error, void *data) {
+    (void)socket;
+    server_conn_t *conn = (server_conn_t *)data;
+
+    if (length == 0 || error != 0 || conn->filled + length > conn->capacity) {
+        conn->closing = true;
+        if (!conn->busy) {
+            server_close(reactor, conn);
+        }
+        return;
+    }
+
+    memcpy(conn->filling + conn->filled, buffer, length);
+    conn->filled += length;
+    if (!conn->busy) {
+        server_echo(reactor, conn);
+    }
+}
+
+static void server_adopt(zn_reactor_t *reactor, void *data) {
+    server_conn_t *conn = (server_conn_t *)data;
+    if (zn_reactor_receive(reactor, &conn->socket, server_on_receive, conn) != 0) {
+        socket_close(&conn->socket);
+        free(conn);
+    }
+}
+
+static void server_on_accept(zn_reactor_t *reactor, socket_t *listener, socket_t *client, int error, void *data) {
+    (void)reactor;
+    (void)listener;
+    zn_reactor_group_t *group = (zn_reactor_group_t *)data;
+    if (error != 0) {
+        return;
+    }
+
+    server_conn_t *conn = (server_conn_t *)calloc(1, sizeof(server_conn_t) + 2 * server_buffer);
+    if (!conn) {
+        socket_close(client);
+        return;
+    }
+    conn->socket = *client;
+    set_nodelay(&conn->socket);
+    conn->sending = conn->buffers;
+    conn->filling = conn->buffers + server_buffer;
+    conn->capacity = server_buffer;
+    zn_reactor_post(zn_reactor_group_next(group), server_adopt, conn);
+}
+
+/* Client side */
+
+static void client_close(zn_reactor_t *reactor, client_conn_t *conn) {
+    zn_reactor_remove(reactor, &conn->socket);
+    socket_close(&conn->socket);
+    free(conn);
+}
+
+static void client_on_receive(zn_reactor_t *reactor, socket_t *socket, const void *buffer, size_t length,
+                              int error, void *data) {
+    (void)buffer;
+    client_conn_t *conn = (client_conn_t *)data;
+    if (length == 0 || error != 0) {
+        client_close(reactor, conn);
+        return;
+    }
+
+    conn->received += length;
+    if (conn->received >= message_bytes) {
+        __atomic_add_fetch(&requests, 1, __ATOMIC_RELAXED);
+        conn->received -= message_bytes;
+        /* The message is shared and never changes, so no callback is needed */
+        zn_reactor_send(reactor, socket, message, message_bytes, NULL, NULL);
+    }
+}
+
+static void client_on_connected(zn_reactor_t *reactor, socket_t *socket, int error, void *data) {
+    client_conn_t *conn = (client_conn_t *)data;
+    if (error != 0 || zn_reactor_receive(reactor, socket, client_on_receive, conn) != 0) {
+        __atomic_add_fetch(&failed, 1, __ATOMIC_RELAXED);
+        client_close(reactor, conn);
+        return;
+    }
+
+    __atomic_add_fetch(&established, 1, __ATOMIC_RELAXED);
+    zn_reactor_send(reactor, socket, message, message_bytes, NULL, NULL);
+}
+
+static void client_start(zn_reactor_t *reactor, void *data) {
+    client_conn_t *conn = (client_conn_t *)data;
+    if (zn_reactor_connect(reactor, &conn->socket, "127.0.0.1", conn->port, client_on_connected, conn) != 0) {
+        __atomic_add_fetch(&failed, 1, __ATOMIC_RELAXED);
+        client_close(reactor, conn);
+    }
+}
+
+static long raise_fd_limit(void) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        return 1024;
+    }
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+    return (long)limit.rlim_cur;
+}
+
+int main(int argc, char **argv) {
+    long connections = argc > 1 ? atol(argv[1]) : 10000;
+    double seconds = argc > 2 ? atof(argv[2]) : 5.0;
+    size_t reactors = argc > 3 ? (size_t)atol(argv[3]) : 0;
+    message_bytes = argc > 4 ? (size_t)atol(argv[4]) : 64;
+    int base_port = argc > 5 ? atoi(argv[5]) : 7700;
+    const char *backend_arg = argc > 6 ? argv[6] : "epoll";
+
+    if (message_bytes == 0 || message_bytes > MAX_MESSAGE) {
+        fprintf(stderr, "message size must be between 1 and %d bytes\n", MAX_MESSAGE);
+        return 1;
+    }
+
+    zn_reactor_backend_t backend;
+    if (strcmp(backend_arg, "epoll") == 0) {
+        backend = ZN_REACTOR_BACKEND_EPOLL;
+    } else if (strcmp(backend_arg, "io_uring") == 0) {
+        backend = ZN_REACTOR_BACKEND_IO_URING;
+    } else {
+        fprintf(stderr, "backend must be epoll or io_uring\n");
+        return 1;
+    }
+
+    long fd_limit = raise_fd_limit();
+    long max_connections = (fd_limit - 64) / 2;
+    if (connections > max_connections) {
+        fprintf(stderr, "fd limit %ld allows %ld connections (raise ulimit -Hn for more)\n",
+                fd_limit, max_connections);
+        connections = max_connections;
+    }
+
+    message = (char *)malloc(message_bytes);
+    memset(message, 'z', message_bytes);
+    if (message_bytes > server_buffer) {
+        server_buffer = message_bytes;
+    }
+
+    zn_reactor_group_t *servers = zn_reactor_group_create_with_backend(reactors, backend);
+    zn_reactor_group_t *clients = zn_reactor_group_create_with_backend(reactors, backend);
+    if (!servers || !clients) {
+        perror("zn_reactor_group_create");
+        return 1;
+    }
+
+    /* Listeners live on the first server reactor, which hands connections out */
+    int ports = (int)((connections + CONNECTIONS_PER_PORT - 1) / CONNECTIONS_PER_PORT);
+    if (ports < 1) ports = 1;
+    socket_t *listeners = (socket_t *)calloc((size_t)ports, sizeof(socket_t));
+    for (int i = 0; i < ports; i++) {
+        if (!socket_create(&listeners[i], SOCKET_TCP).success ||
+            !socket_bind(&listeners[i], base_port + i).success ||
+            !socket_listen(&listeners[i], 4096).success ||
+            zn_reactor_accept(zn_reactor_group_get(servers, 0), &listeners[i], server_on_accept, servers) != 0) {
+            fprintf(stderr, "failed to listen on port %d\n", base_port + i);
+            return 1;
+        }
+    }
+
+    zn_reactor_group_start(servers);
+    zn_reactor_group_start(clients);
+
+    /* Reports the backend actually in use, which is epoll if io_uring is unavailable */
+    zn_reactor_backend_t active = zn_reactor_backend(zn_reactor_group_get(servers, 0));
+    printf("echo_bench: %ld connections over %d port(s), %zu server / %zu client reactors, %zu-byte messages, %s\n",
+           connections, ports, zn_reactor_group_size(servers), zn_reactor_group_size(clients), message_bytes,
+           zn_reactor_backend_name(active));
+
+    /* Open connections, keeping a bounded number of handshakes in flight so
+     * the listen backlog does not overflow */
+    double connect_start = now_ms();
+    long opened = 0;
+    for (long i = 0; i < connections; i++) {
+        while (opened - __atomic_load_n(&established, __ATOMIC_RELAXED) -
+               __atomic_load_n(&failed, __ATOMIC_RELAXED) > MAX_IN_FLIGHT_CONNECTS) {
+            usleep(500);
+        }
+
+        client_conn_t *conn = (client_conn_t *)calloc(1, sizeof(client_conn_t));
+        if (!conn || !socket_create(&conn->socket, SOCKET_TCP).success) {
+            free(conn);
+            break;
+        }
+        conn->port = base_port + (int)(i % ports);
+        set_nodelay(&conn->socket);
+        zn_reactor_post(zn_reactor_group_next(clients), client_start, conn);
+        opened++;
+    }
+
+    double deadline = now_ms() + 30000;
+    while (__atomic_load_n(&established, __ATOMIC_RELAXED) + __atomic_load_n(&failed, __ATOMIC_RELAXED) < opened &&
+           now_ms() < deadline) {
+        usleep(1000);
+    }
+    double connect_ms = now_ms() - connect_start;
+    long connected = __atomic_load_n(&established, __ATOMIC_RELAXED);
+    printf("  connected %ld/%ld in %.0f ms (%ld failed)\n", connected, connections, connect_ms,
+           __atomic_load_n(&failed, __ATOMIC_RELAXED));
+
+    /* Measure the steady state */
+    long start_requests = __atomic_load_n(&requests, __ATOMIC_RELAXED);
+    double start = now_ms();
+    usleep((useconds_t)(seconds * 1e6));
+    long done = __atomic_load_n(&requests, __ATOMIC_RELAXED) - start_requests;
+    double elapsed = (now_ms() - start) / 1e3;
+
+    printf("  requests: %ld in %.2f s -> %.0f req/s (%.1f MB/s each way)\n",
+           done, elapsed, done / elapsed, done * (double)message_bytes / elapsed / 1e6);
+
+    zn_reactor_group_destroy(clients);
+    zn_reactor_group_destroy(servers);
+
+    /* Connections are reclaimed when the process exits */
+    for (int i = 0; i < ports; i++) {
+        socket_close(&listeners[i]);
+    }
+    free(listeners);
+    free(message);
+    return 0;
+}
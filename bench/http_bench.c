@@ -0,0 +1,305 @@
+/**
+ * @file http_bench.c
+ * @brief Pipelined keep-alive HTTP/1.1 load over loopback against
+ *        zn_http_server
+ *
+ * Usage: http_bench [seconds] [connections] [pipeline] [workers] [port]
+ *
+ * First times zn_http_parse_request on a typical browser request. Then
+ * starts a zn_http_server with the given number of workers whose handler
+ * answers every request with a 13-byte text/plain body, and drives it from
+ * one client reactor on the main thread: each connection keeps `pipeline`
+ * GET requests in flight, sending a new one as each response is parsed.
+ * The load runs once without pipelining and once at the requested depth.
+ *
+ * Reports requests per second and latency percentiles, measured from
+ * queueing a request to parsing its response, from a log-linear histogram
+ * (about 1.5% resolution). Server and client share the machine's cores, so
+ * this is the reference for socket, stream and reactor work rather than a
+ * measure of what the server could do on its own.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "http_server.h"
+#include "reactor.h"
+#include "stream.h"
+
+#define HISTOGRAM_BUCKETS (64 * 64)
+
+static const char request_text[] = "GET /plaintext HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+static const char browser_request[] =
+    "GET /wp-content/uploads/2010/03/hello-kitty-darth-vader-pink.jpg HTTP/1.1\r\n"
+    "Host: www.kittyhell.com\r\n"
+    "User-Agent: Mozilla/5.0 (Macintosh; U; Intel Mac OS X 10.6; ja-JP-mac; rv:1.9.2.3) Gecko/20100401 "
+    "Firefox/3.6.3 Pathtraq/0.9\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: ja,en-us;q=0.7,en;q=0.3\r\n"
+    "Accept-Encoding: gzip,deflate\r\n"
+    "Accept-Charset: Shift_JIS,utf-8;q=0.7,*;q=0.7\r\n"
+    "Keep-Alive: 115\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: wp_ozh_wsa_visits=2; wp_ozh_wsa_visit_lasttime=xxxxxxxxxx; "
+    "__utma=xxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.x; "
+    "__utmz=xxxxxxxxx.xxxxxxxxxx.x.x.utmccn=(referral)|utmcsr=reader.livedoor.com|utmcct=/reader/|utmcmd=referral\r\n"
+    "\r\n";
+
+typedef struct {
+    socket_t socket;
+    zn_stream_t *stream;
+    uint64_t *sent;                /* Send times of the requests in flight, oldest first */
+    size_t oldest;
+    size_t in_flight;
+} client_t;
+
+typedef struct {
+    size_t pipeline;
+    bool running;
+    uint64_t in_flight;            /* Over all connections */
+    uint64_t completed;
+    uint64_t errors;
+    uint64_t histogram[HISTOGRAM_BUCKETS];
+} load_t;
+
+static load_t load;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* 64 buckets per power of two */
+static size_t bucket_of(uint64_t value) {
+    if (value < 64) {
+        return (size_t)value;
+    }
+    unsigned exponent = 63 - (unsigned)__builtin_clzll(value);
+    size_t index = (size_t)(exponent - 5) * 64 + (size_t)((value >> (exponent - 6)) & 63);
+    return index < HISTOGRAM_BUCKETS ? index : HISTOGRAM_BUCKETS - 1;
+}
+
+static uint64_t bucket_value(size_t index) {
+    if (index < 64) {
+        return index;
+    }
+    unsigned exponent = (unsigned)(index / 64) + 5;
+    return (uint64_t)(64 + index % 64) << (exponent - 6);
+}
+
+static double percentile_us(double fraction) {
+    uint64_t target = (uint64_t)(fraction * (double)load.completed);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += load.histogram[i];
+        if (seen > target) {
+            return (double)bucket_value(i) / 1e3;
+        }
+    }
+    return 0;
+}
+
+static void handle(const zn_http_request_t *request, const char *body, zn_http_response_t *response, void *data) {
+    (void)request;
+    (void)body;
+    (void)data;
+    response->content_type = "text/plain";
+    response->body = "Hello, World!";
+    response->body_length = 13;
+}
+
+static void client_fail(zn_reactor_t *reactor, client_t *client) {
+    load.errors++;
+    load.in_flight -= client->in_flight;
+    client->in_flight = 0;
+    zn_reactor_remove(reactor, &client->socket);
+}
+
+/* Top the pipeline back up */
+static void client_send(zn_reactor_t *reactor, client_t *client) {
+    while (load.running && client->in_flight < load.pipeline) {
+        if (zn_stream_write(client->stream, request_text, sizeof(request_text) - 1) != 0) {
+            break;
+        }
+        client->sent[(client->oldest + client->in_flight) % load.pipeline] = now_ns();
+        client->in_flight++;
+        load.in_flight++;
+    }
+    int result = zn_stream_flush(client->stream);
+    if (result != 0 && result != EAGAIN) {
+        client_fail(reactor, client);
+    }
+}
+
+static void on_readable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data) {
+    (void)socket;
+    (void)events;
+    client_t *client = (client_t *)data;
+    for (;;) {
+        size_t buffered;
+        while ((buffered = zn_stream_buffered(client->stream)) > 0) {
+            const void *bytes;
+            zn_http_response_head_t response;
+            zn_stream_peek(client->stream, buffered, &bytes);
+            int result = zn_http_parse_response((const char *)bytes, buffered, &response);
+            if (result == EAGAIN) {
+                break;
+            }
+            size_t total = response.message.head_length + response.message.content_length;
+            if (result != 0 || response.status != 200 || client->in_flight == 0) {
+                client_fail(reactor, client);
+                return;
+            }
+            if (total > buffered) {
+                break;
+            }
+            zn_stream_consume(client->stream, total);
+
+            if (load.running) {
+                load.histogram[bucket_of(now_ns() - client->sent[client->oldest])]++;
+                load.completed++;
+            }
+            client->oldest = (client->oldest + 1) % load.pipeline;
+            client->in_flight--;
+            if (--load.in_flight == 0 && !load.running) {
+                zn_reactor_stop(reactor);
+            }
+        }
+
+        const void *bytes;
+        int result = zn_stream_peek(client->stream, zn_stream_buffered(client->stream) + 1, &bytes);
+        if (result == EAGAIN) {
+            break;
+        }
+        if (result != 0) {
+            client_fail(reactor, client);
+            return;
+        }
+    }
+    client_send(reactor, client);
+}
+
+static void on_writable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data) {
+    (void)socket;
+    (void)events;
+    client_t *client = (client_t *)data;
+    if (zn_stream_pending(client->stream) > 0) {
+        client_send(reactor, client);
+    }
+}
+
+/* Stop sending, and stop the loop once the requests in flight are answered
+ * so that no connection closes with a response on the way */
+static void on_deadline(zn_reactor_t *reactor, void *data) {
+    *(uint64_t *)data = now_ns();
+    load.running = false;
+    if (load.in_flight == 0) {
+        zn_reactor_stop(reactor);
+    }
+}
+
+static void run(int port, size_t connections, size_t pipeline, double seconds) {
+    memset(&load, 0, sizeof(load));
+    load.pipeline = pipeline;
+    load.running = true;
+
+    zn_reactor_t *reactor = zn_reactor_create();
+    client_t *clients = (client_t *)calloc(connections, sizeof(client_t));
+    if (!reactor || !clients) {
+        fprintf(stderr, "failed to create the client reactor\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < connections; i++) {
+        client_t *client = &clients[i];
+        client->sent = (uint64_t *)calloc(pipeline, sizeof(uint64_t));
+        if (!client->sent || !socket_create(&client->socket, SOCKET_TCP).success ||
+            !socket_set_nodelay(&client->socket, true).success ||
+            !socket_connect(&client->socket, "127.0.0.1", port).success ||
+            !(client->stream = zn_stream_create(&client->socket, NULL)) ||
+            zn_reactor_add(reactor, &client->socket, on_readable, on_writable, client) != 0) {
+            fprintf(stderr, "failed to open connection %zu to port %d\n", i, port);
+            exit(1);
+        }
+    }
+
+    uint64_t start = now_ns();
+    uint64_t end = 0;
+    for (size_t i = 0; i < connections; i++) {
+        client_send(reactor, &clients[i]);
+    }
+    zn_reactor_add_timer(reactor, (uint64_t)(seconds * 1e3), 0, on_deadline, &end);
+    zn_reactor_run(reactor);
+    double elapsed = (double)(end - start) / 1e9;
+
+    printf("  pipeline %-3zu %9.0f req/s  p50 %7.1f us  p90 %7.1f us  p99 %7.1f us  p99.9 %7.1f us",
+           pipeline, (double)load.completed / elapsed, percentile_us(0.5), percentile_us(0.9), percentile_us(0.99),
+           percentile_us(0.999));
+    if (load.errors) {
+        printf("  (%llu failed connections)", (unsigned long long)load.errors);
+    }
+    printf("\n");
+
+    for (size_t i = 0; i < connections; i++) {
+        zn_reactor_remove(reactor, &clients[i].socket);
+        zn_stream_destroy(clients[i].stream);
+        socket_close(&clients[i].socket);
+        free(clients[i].sent);
+    }
+    free(clients);
+    zn_reactor_destroy(reactor);
+}
+
+static void bench_parser(void) {
+    size_t iterations = 1000000;
+    size_t headers = 0;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        zn_http_request_t request;
+        if (zn_http_parse_request(browser_request, sizeof(browser_request) - 1, &request) != 0) {
+            fprintf(stderr, "failed to parse the sample request\n");
+            exit(1);
+        }
+        headers += request.message.header_count;
+    }
+    double elapsed = (double)(now_ns() - start);
+    printf("  parser: %zu-byte request with %zu headers in %.0f ns (%.2f GB/s)\n", sizeof(browser_request) - 1,
+           headers / iterations, elapsed / (double)iterations,
+           (double)(sizeof(browser_request) - 1) * (double)iterations / elapsed);
+}
+
+int main(int argc, char **argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 5;
+    size_t connections = argc > 2 ? (size_t)atol(argv[2]) : 64;
+    size_t pipeline = argc > 3 ? (size_t)atol(argv[3]) : 16;
+    size_t workers = argc > 4 ? (size_t)atol(argv[4]) : 1;
+    int port = argc > 5 ? atoi(argv[5]) : 7890;
+    if (seconds <= 0 || connections == 0 || pipeline == 0) {
+        fprintf(stderr, "usage: http_bench [seconds] [connections] [pipeline] [workers] [port]\n");
+        return 1;
+    }
+
+    zn_http_server_config_t config;
+    zn_http_server_config_init(&config, port);
+    config.server.workers = workers;
+    zn_http_server_t *server = zn_http_server_create(&config, handle, NULL);
+    if (!server || zn_http_server_start(server) != 0) {
+        fprintf(stderr, "failed to start the server on port %d\n", port);
+        return 1;
+    }
+
+    printf("http_bench: %zu connections, %zu server worker(s), %.0f s per run\n", connections, workers, seconds);
+    bench_parser();
+    run(zn_http_server_port(server), connections, 1, seconds);
+    if (pipeline > 1) {
+        run(zn_http_server_port(server), connections, pipeline, seconds);
+    }
+    printf("  server answered %llu requests\n", (unsigned long long)zn_http_server_requests(server));
+
+    zn_http_server_destroy(server);
+    return 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file lex_bench.c
+ * @brief Lexing a large source read through stdio vs mapped into memory
+ *
+ * Usage: lex_bench [megabytes] [runs]
+ *
+ * Writes about `megabytes` MB (100 by default) of generated Zeno to a
+ * temporary file and runs the scanner over all of it, best of `runs`:
+ *
+ * - stdio: the file is opened with fopen and flex reads it into its own
+ *   buffer, as parse_file does
+ * - mmap: the file is mapped with source_map_open and scanned in place
+ *   with yy_scan_buffer, as parse_path does for files of up to
+ *   SOURCE_MAP_MAX_SIZE; mapping and unmapping are included. The limit is
+ *   not applied here, so large sizes show what mapping would cost
+ *
+ * The file was just written, so it is in the page cache for both. Reported
+ * per mode: time, throughput, minor page faults per run (the scanner
+ * writes into its buffer, so each mapped page is copied on first write)
+ * and the peak RSS so far.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#include "ast.h"
+#include "intern.h"
+#include "parse.h"
+#include "source_map.h"
+#include "parser.tab.h"
+
+// Scanner interface (lexer.l)
+extern int yylex(YYSTYPE* yylval_param, yyscan_t scanner);
+extern int yylex_init_extra(ParseContext* context, yyscan_t* scanner);
+extern void yyset_in(FILE* input, yyscan_t scanner);
+extern struct yy_buffer_state* yy_scan_buffer(char* base, size_t size, yyscan_t scanner);
+extern int yylex_destroy(yyscan_t scanner);
+
+static const char unit_template[] =
+    "// Unit %d\n"
+    "fn step%d(a: int, b: float, name: string): int {\n"
+    "    let count: int = a * 3 + %d;\n"
+    "    const ratio: float = b / 2.25;\n"
+    "    /* rescale until it fits */\n"
+    "    while (count > 1000 && ratio != 0.0) {\n"
+    "        count = count / 2 - 1;\n"
+    "    }\n"
+    "    print(name ++ \"-%d\", count, ratio);\n"
+    "    return step%d(count, ratio, \"unit %d\");\n"
+    "}\n"
+    "\n";
+
+typedef enum { MODE_STDIO, MODE_MMAP } lex_mode_t;
+
+typedef struct {
+    double best_ms;
+    size_t tokens;
+    long faults;
+    long peak_rss_kb;
+} result_t;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static struct rusage usage_now(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage;
+}
+
+/* Write at least `bytes` bytes of source and return its path */
+static char* generate(size_t bytes, size_t* written) {
+    static char path[] = "/tmp/lex_bench_XXXXXX";
+    int fd = mkstemp(path);
+    FILE* file = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!file) {
+        fprintf(stderr, "failed to create a temporary file\n");
+        exit(1);
+    }
+    for (int n = 1; (size_t)ftell(file) < bytes; n++) {
+        fprintf(file, unit_template, n, n, n, n, n + 1, n);
+    }
+    *written = (size_t)ftell(file);
+    fclose(file);
+    return path;
+}
+
+static size_t scan(yyscan_t scanner) {
+    YYSTYPE value;
+    size_t tokens = 0;
+    while (yylex(&value, scanner) != 0) {
+        tokens++;
+    }
+    yylex_destroy(scanner);
+    return tokens;
+}
+
+static size_t lex_stdio(const char* path) {
+    ParseContext context = { path, NULL, 0 };
+    yyscan_t scanner;
+    FILE* input = fopen(path, "r");
+    if (!input || yylex_init_extra(&context, &scanner) != 0) {
+        fprintf(stderr, "failed to open %s\n", path);
+        exit(1);
+    }
+    yyset_in(input, scanner);
+    size_t tokens = scan(scanner);
+    fclose(input);
+    return tokens;
+}
+
+static size_t lex_mmap(const char* path) {
+    ParseContext context = { path, NULL, 0 };
+    yyscan_t scanner;
+    SourceMap map;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0 || source_map_open(fd, SIZE_MAX, &map) != 0 || yylex_init_extra(&context, &scanner) != 0) {
+        fprintf(stderr, "failed to map %s\n", path);
+        exit(1);
+    }
+    close(fd);
+    yy_scan_buffer(map.data, map.size + 2, scanner);
+    size_t tokens = scan(scanner);
+    source_map_close(&map);
+    return tokens;
+}
+
+static result_t run(lex_mode_t mode, const char* path, int runs) {
+    result_t result = {0};
+    for (int run = 0; run < runs; run++) {
+        struct rusage before = usage_now();
+        double start = now_ms();
+        size_t tokens = mode == MODE_MMAP ? lex_mmap(path) : lex_stdio(path);
+        double elapsed = now_ms() - start;
+        struct rusage after = usage_now();
+
+        if (run == 0 || elapsed < result.best_ms) {
+            result.best_ms = elapsed;
+        }
+        result.tokens = tokens;
+        result.faults = after.ru_minflt - before.ru_minflt;
+        result.peak_rss_kb = after.ru_maxrss;
+    }
+    return result;
+}
+
+static void report(const char* label, result_t result, size_t bytes) {
+    printf("  %-6s %8.1f ms  %6.1f MB/s  %zu tokens  %6ld faults/run  peak RSS %.1f MB\n", label,
+           result.best_ms, (double)bytes / result.best_ms / 1e3, result.tokens, result.faults,
+           (double)result.peak_rss_kb / 1024);
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? (size_t)atol(argv[1]) : 100;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+    if (megabytes == 0 || runs <= 0) {
+        fprintf(stderr, "usage: lex_bench [megabytes] [runs]\n");
+        return 1;
+    }
+
+    size_t bytes;
+    char* path = generate(megabytes * 1000 * 1000, &bytes);
+
+    printf("lex_bench: %.1f MB of source, best of %d runs\n", (double)bytes / 1e6, runs);
+    result_t stdio = run(MODE_STDIO, path, runs);
+    report("stdio", stdio, bytes);
+    result_t mapped = run(MODE_MMAP, path, runs);
+    report("mmap", mapped, bytes);
+    unlink(path);
+
+    if (stdio.tokens != mapped.tokens) {
+        fprintf(stderr, "token counts differ: %zu vs %zu\n", stdio.tokens, mapped.tokens);
+        return 1;
+    }
+    cleanup_interner();
+    return 0;
+}
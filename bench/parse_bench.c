@@ -0,0 +1,337 @@
+/**
+ * @file parse_bench.c
+ * @brief Parsing a large synthetic Zeno source into an arena-allocated AST
+ *
+ * Usage: parse_bench [lines] [runs] [threads]
+ *
+ * Writes about `lines` lines (100k by default) of generated Zeno to a
+ * temporary file: structs, struct updates and functions with declarations,
+ * loops, matches and calls, so that every kind of node and list is built.
+ * The file is first run through the lexer alone, then each run parses it
+ * into a fresh arena and destroys it. Reported: lexing throughput and how
+ * many token strings the interner found already stored (each one an
+ * allocation and a copy the lexer no longer makes), best parse time
+ * (lexing included), best teardown time, the bytes handed out by the
+ * arena and held in its chunks, and the process's peak RSS.
+ *
+ * Finally the same amount of source, split into one file per thread
+ * (threads defaults to the number of cores, at least 4), is parsed once
+ * file after file and once with every file on the thread pool at the same
+ * time. Each parse has its own scanner, parser state and arena. The C
+ * generated from every parallel AST must match the C from its serial
+ * twin, and the parallel pass must not add any string to the interner;
+ * the bench fails otherwise.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <string.h>
+#include <unistd.h>
+#include "ast.h"
+#include "intern.h"
+#include "parse.h"
+#include "threads.h"
+#include "codegen/codegen.h"
+#include "parser.tab.h"
+
+// Scanner interface (lexer.l)
+extern int yylex(YYSTYPE* yylval_param, yyscan_t scanner);
+extern int yylex_init_extra(ParseContext* context, yyscan_t* scanner);
+extern void yyset_in(FILE* input, yyscan_t scanner);
+extern int yylex_destroy(yyscan_t scanner);
+
+static const char unit_template[] =
+    "struct Point%d {\n"
+    "    x: int,\n"
+    "    y: int,\n"
+    "    label: string\n"
+    "}\n"
+    "\n"
+    "fn update%d(p: Point%d, dx: int, dy: int): Point%d {\n"
+    "    let moved: Point%d = { ...p, x: p.x + dx, y: p.y + dy };\n"
+    "    return moved;\n"
+    "}\n"
+    "\n"
+    "fn compute%d(a: int, b: int, name: string): int where a > 0 {\n"
+    "    let total: int = a * 2 + b - 1;\n"
+    "    const label: string = name ++ \"-\" ++ \"%d\";\n"
+    "    let values: array<int> = [a, b, total, 42];\n"
+    "    let scale: float = 1.5;\n"
+    "    if (total > 100) {\n"
+    "        total = total / 2;\n"
+    "    } else {\n"
+    "        total = total + compute%d(a - 1, b, label);\n"
+    "    }\n"
+    "    for (let i: int = 0; i < 10; i = i + 1) {\n"
+    "        total = total + i %% 3;\n"
+    "    }\n"
+    "    for (v in values) {\n"
+    "        total = total + v;\n"
+    "    }\n"
+    "    while (total > 1000 && !(a == b)) {\n"
+    "        total = total - a;\n"
+    "    }\n"
+    "    match total {\n"
+    "        0 => return 0;\n"
+    "        n: int => return n * 2;\n"
+    "        _ => print(label, total);\n"
+    "    }\n"
+    "    return values |> sum;\n"
+    "}\n"
+    "\n";
+
+#define UNIT_LINES 38
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static long peak_rss_kb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/* Write units first..first+count-1 and return the file, opened for reading */
+static FILE* generate(size_t first, size_t count, size_t* bytes) {
+    char path[] = "/tmp/parse_bench_XXXXXX";
+    int fd = mkstemp(path);
+    FILE* file = fd >= 0 ? fdopen(fd, "w+") : NULL;
+    if (!file) {
+        fprintf(stderr, "failed to create a temporary file\n");
+        exit(1);
+    }
+    unlink(path);
+
+    for (size_t i = first; i < first + count; i++) {
+        int n = (int)i;
+        fprintf(file, unit_template, n, n, n, n, n, n, n, n - 1);
+    }
+    fflush(file);
+    *bytes = (size_t)ftell(file);
+    return file;
+}
+
+typedef struct {
+    FILE* source;
+    Arena* arena;
+    AST_Node* root;
+} unit_t;
+
+typedef struct {
+    zn_mutex_t lock;
+    zn_cond_t done;
+    size_t pending;
+} batch_t;
+
+typedef struct {
+    unit_t* unit;
+    batch_t* batch;
+} parse_task_t;
+
+static void parse_unit(unit_t* unit) {
+    rewind(unit->source);
+    unit->arena = arena_create(0);
+    unit->root = parse_file(unit->source, "parse_bench", unit->arena);
+    if (!unit->root) {
+        fprintf(stderr, "failed to parse the generated source\n");
+        exit(1);
+    }
+}
+
+static void parse_task(void* arg) {
+    parse_task_t* task = arg;
+    parse_unit(task->unit);
+
+    zn_mutex_lock(&task->batch->lock);
+    if (--task->batch->pending == 0) {
+        zn_cond_signal(&task->batch->done);
+    }
+    zn_mutex_unlock(&task->batch->lock);
+}
+
+/* The C generated from a unit's AST, as a malloc'd string */
+static char* generate_c(unit_t* unit) {
+    char* text = NULL;
+    size_t length = 0;
+    FILE* output = open_memstream(&text, &length);
+    if (!output) {
+        fprintf(stderr, "open_memstream failed\n");
+        exit(1);
+    }
+    ast_set_arena(unit->arena);
+    CodeGenContext* ctx = init_codegen(output);
+    generate_code(ctx, unit->root);
+    cleanup_codegen(ctx);
+    ast_set_arena(NULL);
+    fclose(output);
+    return text;
+}
+
+static void release_units(unit_t* units, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        arena_destroy(units[i].arena);
+        units[i].arena = NULL;
+        units[i].root = NULL;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t lines = argc > 1 ? (size_t)atol(argv[1]) : 100000;
+    int runs = argc > 2 ? atoi(argv[2]) : 5;
+    size_t cores = zn_get_num_cores();
+    size_t threads = argc > 3 ? (size_t)atol(argv[3]) : (cores > 4 ? cores : 4);
+    if (lines == 0 || runs <= 0 || threads == 0) {
+        fprintf(stderr, "usage: parse_bench [lines] [runs] [threads]\n");
+        return 1;
+    }
+
+    size_t units = lines / UNIT_LINES > 0 ? lines / UNIT_LINES : 1;
+    size_t bytes;
+    FILE* source = generate(1, units, &bytes);
+    long rss_before = peak_rss_kb();
+
+    double best_lex = 0;
+    size_t tokens = 0;
+    InternerStats interned = {0};
+    for (int run = 0; run < runs; run++) {
+        ParseContext context = { "parse_bench", NULL, 0 };
+        yyscan_t scanner;
+        YYSTYPE value;
+        rewind(source);
+        yylex_init_extra(&context, &scanner);
+        yyset_in(source, scanner);
+        tokens = 0;
+        double start = now_ms();
+        while (yylex(&value, scanner) != 0) {
+            tokens++;
+        }
+        double elapsed = now_ms() - start;
+        yylex_destroy(scanner);
+        if (run == 0) {
+            interned = get_interner_stats();
+        }
+        if (run == 0 || elapsed < best_lex) {
+            best_lex = elapsed;
+        }
+    }
+
+    double best_parse = 0, best_free = 0;
+    size_t used = 0, reserved = 0;
+    for (int run = 0; run < runs; run++) {
+        unit_t unit = { source, NULL, NULL };
+        double start = now_ms();
+        parse_unit(&unit);
+        double parsed = now_ms();
+        used = unit.arena->used;
+        reserved = unit.arena->reserved;
+        release_units(&unit, 1);
+        double freed = now_ms();
+
+        if (run == 0 || parsed - start < best_parse) {
+            best_parse = parsed - start;
+        }
+        if (run == 0 || freed - parsed < best_free) {
+            best_free = freed - parsed;
+        }
+    }
+    fclose(source);
+    long rss_single = peak_rss_kb();
+
+    // The same source split into one file per thread
+    unit_t* serial = calloc(threads, sizeof(unit_t));
+    unit_t* parallel = calloc(threads, sizeof(unit_t));
+    parse_task_t* tasks = calloc(threads, sizeof(parse_task_t));
+    zn_thread_pool_t* pool = zn_thread_pool_create(threads);
+    if (!serial || !parallel || !tasks || !pool) {
+        fprintf(stderr, "failed to set up the parallel parse\n");
+        return 1;
+    }
+    size_t per_file = (units + threads - 1) / threads;
+    for (size_t i = 0; i < threads; i++) {
+        size_t file_bytes;
+        serial[i].source = generate(1 + i * per_file, per_file, &file_bytes);
+        parallel[i].source = serial[i].source;
+    }
+
+    double best_serial = 0, best_parallel = 0;
+    size_t mismatches = 0, added_strings = 0;
+    batch_t batch;
+    zn_mutex_init(&batch.lock);
+    zn_cond_init(&batch.done);
+    for (int run = 0; run < runs; run++) {
+        double start = now_ms();
+        for (size_t i = 0; i < threads; i++) {
+            parse_unit(&serial[i]);
+        }
+        double elapsed = now_ms() - start;
+        if (run == 0 || elapsed < best_serial) {
+            best_serial = elapsed;
+        }
+
+        InternerStats before = get_interner_stats();
+        batch.pending = threads;
+        start = now_ms();
+        for (size_t i = 0; i < threads; i++) {
+            tasks[i].unit = &parallel[i];
+            tasks[i].batch = &batch;
+            zn_thread_pool_add_task(pool, parse_task, &tasks[i]);
+        }
+        zn_mutex_lock(&batch.lock);
+        while (batch.pending > 0) {
+            zn_cond_wait(&batch.done, &batch.lock);
+        }
+        zn_mutex_unlock(&batch.lock);
+        elapsed = now_ms() - start;
+        if (run == 0 || elapsed < best_parallel) {
+            best_parallel = elapsed;
+        }
+        added_strings += get_interner_stats().strings - before.strings;
+
+        if (run == 0) {
+            for (size_t i = 0; i < threads; i++) {
+                char* expected = generate_c(&serial[i]);
+                char* actual = generate_c(&parallel[i]);
+                mismatches += strcmp(expected, actual) != 0;
+                free(expected);
+                free(actual);
+            }
+        }
+        release_units(serial, threads);
+        release_units(parallel, threads);
+    }
+    zn_thread_pool_destroy(pool);
+    zn_cond_destroy(&batch.done);
+    zn_mutex_destroy(&batch.lock);
+    for (size_t i = 0; i < threads; i++) {
+        fclose(serial[i].source);
+    }
+    free(serial);
+    free(parallel);
+    free(tasks);
+
+    printf("parse_bench: %zu lines, %.1f MB of source, best of %d runs\n", lines, (double)bytes / 1e6, runs);
+    printf("  lex       %8.1f ms  (%.1f MB/s, %zu tokens)\n", best_lex, (double)bytes / best_lex / 1e3, tokens);
+    printf("  interner  %8zu strings for %zu lookups, %zu allocations saved\n", interned.strings,
+           interned.lookups, interned.lookups - interned.strings);
+    printf("  parse     %8.1f ms  (%.0f lines/s, %.1f MB/s)\n", best_parse, (double)lines / best_parse * 1e3,
+           (double)bytes / best_parse / 1e3);
+    printf("  teardown  %8.2f ms\n", best_free);
+    printf("  arena     %8.1f MB used, %.1f MB in chunks\n", (double)used / 1e6, (double)reserved / 1e6);
+    printf("  peak RSS  %8.1f MB  (%.1f MB before lexing)\n", (double)rss_single / 1024,
+           (double)rss_before / 1024);
+    printf("  %zu files %8.1f ms serial, %.1f ms on %zu threads (%.2fx, %zu cores)\n", threads, best_serial,
+           best_parallel, threads, best_serial / best_parallel, cores);
+    if (mismatches > 0 || added_strings > 0) {
+        fprintf(stderr, "parallel parse differs from serial: %zu of %zu files, %zu strings interned twice\n",
+                mismatches, threads, added_strings);
+        return 1;
+    }
+    printf("  parallel ASTs match the serial ones\n");
+    return 0;
+}
@@ -0,0 +1,267 @@
+/**
+ * @file sendfile_bench.c
+ * @brief Serving a file over loopback: read + send vs socket_sendfile, and
+ *        proxying it with recv + send vs socket_splice
+ *
+ * Usage: sendfile_bench [file_mb] [port] [path]
+ *
+ * A file of file_mb megabytes (1GB by default) is written to path and
+ * served to a reader thread that drains the connection:
+ *
+ * - read + send:       pread into a 64KB buffer, then socket_send
+ * - sendfile:          one blocking socket_sendfile call
+ * - sendfile, reactor: non-blocking socket_sendfile resumed from a
+ *                      zn_reactor writable callback
+ * - proxy recv + send: an origin thread sendfiles into a second
+ *                      connection and the main thread copies it across
+ * - proxy splice:      the same, moved with socket_splice
+ *
+ * Each run is timed until the reader has received the whole file.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "reactor.h"
+#include "socket.h"
+#include "threads.h"
+
+#define COPY_BUFFER (64 * 1024)
+#define DRAIN_BUFFER (256 * 1024)
+
+typedef struct {
+    socket_t *socket;
+    int fd;
+    size_t size;
+    off_t offset;
+} transfer_t;
+
+static socket_t downstream_in, downstream_out;
+static socket_t upstream_in, upstream_out;
+static size_t drained = 0;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void *drain_main(void *arg) {
+    (void)arg;
+    char *buffer = (char *)malloc(DRAIN_BUFFER);
+    for (;;) {
+        size_t received = 0;
+        socket_result_t res = socket_receive(&downstream_in, buffer, DRAIN_BUFFER, &received);
+        if (!res.success || received == 0) {
+            break;
+        }
+        __atomic_add_fetch(&drained, received, __ATOMIC_RELEASE);
+    }
+    free(buffer);
+    return NULL;
+}
+
+static bool send_all(socket_t *socket, const char *data, size_t size) {
+    while (size > 0) {
+        size_t sent = 0;
+        if (!socket_send(socket, data, size, &sent).success) {
+            return false;
+        }
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+static bool sendfile_all(transfer_t *transfer) {
+    while ((size_t)transfer->offset < transfer->size) {
+        size_t sent = 0;
+        if (!socket_sendfile(transfer->socket, transfer->fd, &transfer->offset,
+                             transfer->size - (size_t)transfer->offset, &sent).success || sent == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Origin server for the proxy modes */
+static void *origin_main(void *arg) {
+    transfer_t *transfer = (transfer_t *)arg;
+    if (!sendfile_all(transfer)) {
+        fprintf(stderr, "origin sendfile failed\n");
+        exit(1);
+    }
+    return NULL;
+}
+
+static void on_writable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data) {
+    (void)socket;
+    (void)events;
+    transfer_t *transfer = (transfer_t *)data;
+    size_t sent = 0;
+    if (!socket_sendfile(transfer->socket, transfer->fd, &transfer->offset,
+                         transfer->size - (size_t)transfer->offset, &sent).success) {
+        fprintf(stderr, "non-blocking sendfile failed\n");
+        exit(1);
+    }
+    if ((size_t)transfer->offset == transfer->size) {
+        zn_reactor_stop(reactor);
+    }
+}
+
+static bool serve_with_reactor(int fd, size_t size) {
+    zn_reactor_t *reactor = zn_reactor_create_with_backend(ZN_REACTOR_BACKEND_EPOLL);
+    if (!reactor) {
+        return false;
+    }
+    transfer_t transfer = { &downstream_out, fd, size, 0 };
+    bool ok = zn_reactor_add(reactor, &downstream_out, NULL, on_writable, &transfer) == 0 &&
+              zn_reactor_run(reactor) == 0;
+    zn_reactor_remove(reactor, &downstream_out);
+    zn_reactor_destroy(reactor);
+    socket_set_nonblocking(&downstream_out, false);
+    return ok && (size_t)transfer.offset == size;
+}
+
+static bool proxy(bool use_splice, size_t size) {
+    if (use_splice) {
+        socket_splice_t state;
+        if (!socket_splice_init(&state).success) {
+            return false;
+        }
+        size_t moved = 0;
+        while (moved < size) {
+            size_t chunk = 0;
+            if (!socket_splice(&upstream_in, &downstream_out, &state, size - moved, &chunk).success || chunk == 0) {
+                socket_splice_close(&state);
+                return false;
+            }
+            moved += chunk;
+        }
+        socket_splice_close(&state);
+        return true;
+    }
+
+    char *buffer = (char *)malloc(COPY_BUFFER);
+    size_t moved = 0;
+    while (moved < size) {
+        size_t received = 0;
+        if (!socket_receive(&upstream_in, buffer, COPY_BUFFER, &received).success || received == 0 ||
+            !send_all(&downstream_out, buffer, received)) {
+            free(buffer);
+            return false;
+        }
+        moved += received;
+    }
+    free(buffer);
+    return true;
+}
+
+typedef enum { MODE_READ_SEND, MODE_SENDFILE, MODE_SENDFILE_REACTOR, MODE_PROXY_COPY, MODE_PROXY_SPLICE } serve_mode_t;
+
+static const char *mode_names[] = { "read + send", "sendfile", "sendfile, reactor", "proxy recv + send",
+                                    "proxy splice" };
+
+static double run(serve_mode_t mode, int fd, size_t size) {
+    size_t target = __atomic_load_n(&drained, __ATOMIC_ACQUIRE) + size;
+    transfer_t transfer = { &downstream_out, fd, size, 0 };
+    zn_thread_t origin;
+    bool ok = true;
+
+    double start = now_ms();
+    switch (mode) {
+    case MODE_READ_SEND: {
+        char *buffer = (char *)malloc(COPY_BUFFER);
+        for (size_t offset = 0; ok && offset < size;) {
+            ssize_t got = pread(fd, buffer, COPY_BUFFER, (off_t)offset);
+            ok = got > 0 && send_all(&downstream_out, buffer, (size_t)got);
+            offset += got > 0 ? (size_t)got : 0;
+        }
+        free(buffer);
+        break;
+    }
+    case MODE_SENDFILE:
+        ok = sendfile_all(&transfer);
+        break;
+    case MODE_SENDFILE_REACTOR:
+        ok = socket_set_nonblocking(&downstream_out, true).success && serve_with_reactor(fd, size);
+        break;
+    case MODE_PROXY_COPY:
+    case MODE_PROXY_SPLICE:
+        transfer.socket = &upstream_out;
+        zn_thread_init(&origin);
+        zn_thread_create(&origin, origin_main, &transfer);
+        ok = proxy(mode == MODE_PROXY_SPLICE, size);
+        zn_thread_join(&origin, NULL);
+        break;
+    }
+    if (!ok) {
+        fprintf(stderr, "transfer failed in mode %s\n", mode_names[mode]);
+        exit(1);
+    }
+    while (__atomic_load_n(&drained, __ATOMIC_ACQUIRE) < target) {
+        /* Wait for the reader so every mode is timed end to end */
+    }
+    return now_ms() - start;
+}
+
+static bool connect_pair(socket_t *listener, int port, socket_t *in, socket_t *out) {
+    return socket_connect(in, "127.0.0.1", port).success && socket_accept(listener, out).success;
+}
+
+int main(int argc, char **argv) {
+    size_t file_mb = argc > 1 ? (size_t)atol(argv[1]) : 1024;
+    int port = argc > 2 ? atoi(argv[2]) : 7850;
+    const char *path = argc > 3 ? argv[3] : "/tmp/zeno_sendfile_bench.dat";
+    size_t size = file_mb * 1024 * 1024;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return 1;
+    }
+    char *chunk = (char *)malloc(1024 * 1024);
+    memset(chunk, 'f', 1024 * 1024);
+    for (size_t i = 0; i < file_mb; i++) {
+        if (write(fd, chunk, 1024 * 1024) != 1024 * 1024) {
+            fprintf(stderr, "cannot write %s\n", path);
+            unlink(path);
+            return 1;
+        }
+    }
+    free(chunk);
+
+    socket_t listener;
+    if (!socket_create(&listener, SOCKET_TCP).success || !socket_bind(&listener, port).success ||
+        !socket_listen(&listener, 2).success || !socket_create(&downstream_in, SOCKET_TCP).success ||
+        !socket_create(&upstream_in, SOCKET_TCP).success ||
+        !connect_pair(&listener, port, &downstream_in, &downstream_out) ||
+        !connect_pair(&listener, port, &upstream_in, &upstream_out)) {
+        fprintf(stderr, "failed to set up loopback connections on port %d\n", port);
+        unlink(path);
+        return 1;
+    }
+
+    zn_thread_t drain;
+    zn_thread_init(&drain);
+    zn_thread_create(&drain, drain_main, NULL);
+
+    printf("sendfile_bench: %zu MB file\n", file_mb);
+    for (int mode = MODE_READ_SEND; mode <= MODE_PROXY_SPLICE; mode++) {
+        double elapsed = run((serve_mode_t)mode, fd, size);
+        printf("  %-18s %8.1f ms  %8.0f MB/s\n", mode_names[mode], elapsed, (double)size / (elapsed * 1e3));
+    }
+
+    socket_close(&downstream_out);
+    zn_thread_join(&drain, NULL);
+    socket_close(&downstream_in);
+    socket_close(&upstream_in);
+    socket_close(&upstream_out);
+    socket_close(&listener);
+    close(fd);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file sendv_bench.c
+ * @brief Sending a header plus body: staging copy vs two sends vs socket_sendv
+ *
+ * Usage: sendv_bench [messages] [body_bytes] [header_bytes] [port]
+ *
+ * A loopback connection is drained by a reader thread while the main
+ * thread sends each message (200-byte header + 64KB body by default) in
+ * three ways: copied into one staging buffer and sent, sent with two
+ * socket_send calls, and sent with one socket_sendv. Each run is timed
+ * until the reader has received every byte.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "socket.h"
+#include "threads.h"
+
+#define DRAIN_BUFFER (256 * 1024)
+
+static socket_t server;
+static size_t drained = 0;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void *drain_main(void *arg) {
+    (void)arg;
+    char *buffer = (char *)malloc(DRAIN_BUFFER);
+    for (;;) {
+        size_t received = 0;
+        socket_result_t res = socket_receive(&server, buffer, DRAIN_BUFFER, &received);
+        if (!res.success || received == 0) {
+            break;
+        }
+        __atomic_add_fetch(&drained, received, __ATOMIC_RELEASE);
+    }
+    free(buffer);
+    return NULL;
+}
+
+static bool send_all(socket_t *socket, const char *data, size_t size) {
+    while (size > 0) {
+        size_t sent = 0;
+        if (!socket_send(socket, data, size, &sent).success) {
+            return false;
+        }
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+typedef enum { MODE_COPY, MODE_TWO_SENDS, MODE_SENDV } send_mode_t;
+
+static const char *mode_names[] = { "copy + send", "two sends", "socket_sendv" };
+
+static double run(socket_t *client, send_mode_t mode, long messages,
+                  const char *header, size_t header_bytes, const char *body, size_t body_bytes) {
+    size_t message_bytes = header_bytes + body_bytes;
+    char *staging = (char *)malloc(message_bytes);
+    size_t target = __atomic_load_n(&drained, __ATOMIC_ACQUIRE) + (size_t)messages * message_bytes;
+
+    double start = now_ms();
+    for (long i = 0; i < messages; i++) {
+        bool ok = true;
+        if (mode == MODE_COPY) {
+            memcpy(staging, header, header_bytes);
+            memcpy(staging + header_bytes, body, body_bytes);
+            ok = send_all(client, staging, message_bytes);
+        } else if (mode == MODE_TWO_SENDS) {
+            ok = send_all(client, header, header_bytes) && send_all(client, body, body_bytes);
+        } else {
+            struct iovec iov[2] = {
+                { (void *)header, header_bytes },
+                { (void *)body, body_bytes }
+            };
+            size_t sent = 0;
+            ok = socket_sendv(client, iov, 2, &sent).success && sent == message_bytes;
+        }
+        if (!ok) {
+            fprintf(stderr, "send failed in mode %s\n", mode_names[mode]);
+            exit(1);
+        }
+    }
+    while (__atomic_load_n(&drained, __ATOMIC_ACQUIRE) < target) {
+        /* Wait for the reader so every mode is timed end to end */
+    }
+    double elapsed = now_ms() - start;
+
+    free(staging);
+    return elapsed;
+}
+
+int main(int argc, char **argv) {
+    long messages = argc > 1 ? atol(argv[1]) : 20000;
+    size_t body_bytes = argc > 2 ? (size_t)atol(argv[2]) : 64 * 1024;
+    size_t header_bytes = argc > 3 ? (size_t)atol(argv[3]) : 200;
+    int port = argc > 4 ? atoi(argv[4]) : 7800;
+
+    socket_t listener, client;
+    if (!socket_create(&listener, SOCKET_TCP).success || !socket_bind(&listener, port).success ||
+        !socket_listen(&listener, 1).success || !socket_create(&client, SOCKET_TCP).success ||
+        !socket_connect(&client, "127.0.0.1", port).success || !socket_accept(&listener, &server).success) {
+        fprintf(stderr, "failed to set up a loopback connection on port %d\n", port);
+        return 1;
+    }
+
+    zn_thread_t drain;
+    zn_thread_init(&drain);
+    zn_thread_create(&drain, drain_main, NULL);
+
+    char *header = (char *)malloc(header_bytes);
+    char *body = (char *)malloc(body_bytes);
+    memset(header, 'h', header_bytes);
+    memset(body, 'b', body_bytes);
+
+    printf("sendv_bench: %ld messages of %zu-byte header + %zu-byte body\n", messages, header_bytes, body_bytes);
+
+    /* Warm up the connection and the page cache of the buffers */
+    run(&client, MODE_COPY, messages / 10 + 1, header, header_bytes, body, body_bytes);
+
+    for (int mode = MODE_COPY; mode <= MODE_SENDV; mode++) {
+        double elapsed = run(&client, (send_mode_t)mode, messages, header, header_bytes, body, body_bytes);
+        double bytes = (double)messages * (double)(header_bytes + body_bytes);
+        printf("  %-13s %8.1f ms  %8.0f MB/s  %6.2f us/message\n", mode_names[mode], elapsed,
+               bytes / (elapsed * 1e3), elapsed * 1e3 / (double)messages);
+    }
+
+    socket_close(&client);
+    zn_thread_join(&drain, NULL);
+    socket_close(&server);
+    socket_close(&listener);
+    free(header);
+    free(body);
+    return 0;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file stream_bench.c
+ * @brief Small length-prefixed frames over loopback: one syscall per frame
+ *        vs zn_stream buffering
+ *
+ * Usage: stream_bench [frames] [port]
+ *
+ * A writer thread sends frames of a 4-byte length followed by 16-128
+ * bytes of payload, and the main thread parses them:
+ *
+ * - send/recv:        one socket_send per frame; a socket_receive for the
+ *                     header and another for the payload
+ * - stream:           zn_stream_write of header and payload, flushed at
+ *                     the threshold; zn_stream_peek + zn_stream_consume,
+ *                     with plain ring buffers
+ * - stream, mirrored: the same with memfd-mirrored rings
+ *
+ * Each run is timed until the last frame has been parsed.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "socket.h"
+#include "stream.h"
+#include "threads.h"
+
+#define MAX_PAYLOAD 128
+
+typedef enum { MODE_SYSCALLS, MODE_STREAM, MODE_STREAM_MIRRORED } bench_mode_t;
+
+static const char *mode_names[] = { "send/recv", "stream", "stream, mirrored" };
+
+typedef struct {
+    socket_t *socket;
+    bench_mode_t mode;
+    size_t frames;
+} writer_t;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static uint32_t payload_length(size_t i) {
+    return 16 + (uint32_t)((i * 2654435761u) % (MAX_PAYLOAD - 16 + 1));
+}
+
+static zn_stream_t *stream_open(socket_t *socket, bench_mode_t mode) {
+    zn_stream_config_t config;
+    zn_stream_config_init(&config);
+    config.mirrored = mode == MODE_STREAM_MIRRORED;
+    zn_stream_t *stream = zn_stream_create(socket, &config);
+    if (!stream) {
+        fprintf(stderr, "failed to create a stream\n");
+        exit(1);
+    }
+    return stream;
+}
+
+static bool receive_all(socket_t *socket, void *buffer, size_t size) {
+    char *data = (char *)buffer;
+    while (size > 0) {
+        size_t received = 0;
+        if (!socket_receive(socket, data, size, &received).success || received == 0) {
+            return false;
+        }
+        data += received;
+        size -= received;
+    }
+    return true;
+}
+
+static void *writer_main(void *arg) {
+    writer_t *writer = (writer_t *)arg;
+    char frame[4 + MAX_PAYLOAD];
+    memset(frame, 'p', sizeof(frame));
+
+    zn_stream_t *stream = writer->mode == MODE_SYSCALLS ? NULL : stream_open(writer->socket, writer->mode);
+    for (size_t i = 0; i < writer->frames; i++) {
+        uint32_t length = payload_length(i);
+        memcpy(frame, &length, 4);
+        if (stream) {
+            if (zn_stream_write(stream, frame, 4) != 0 || zn_stream_write(stream, frame + 4, length) != 0) {
+                fprintf(stderr, "stream write failed\n");
+                exit(1);
+            }
+        } else if (!socket_send(writer->socket, frame, 4 + length, NULL).success) {
+            fprintf(stderr, "send failed\n");
+            exit(1);
+        }
+    }
+    if (stream) {
+        zn_stream_flush(stream);
+        zn_stream_destroy(stream);
+    }
+    return NULL;
+}
+
+static double run(bench_mode_t mode, socket_t *out, socket_t *in, size_t frames) {
+    writer_t writer = { out, mode, frames };
+    zn_thread_t thread;
+    zn_thread_init(&thread);
+
+    double start = now_ms();
+    zn_thread_create(&thread, writer_main, &writer);
+
+    zn_stream_t *stream = mode == MODE_SYSCALLS ? NULL : stream_open(in, mode);
+    uint64_t checksum = 0;
+    char payload[MAX_PAYLOAD];
+    for (size_t i = 0; i < frames; i++) {
+        uint32_t length;
+        bool ok;
+        if (stream) {
+            const void *frame;
+            ok = zn_stream_peek(stream, 4, &frame) == 0;
+            if (ok) {
+                memcpy(&length, frame, 4);
+                ok = zn_stream_peek(stream, 4 + length, &frame) == 0;
+            }
+            if (ok) {
+                checksum += ((const unsigned char *)frame)[3 + length];
+                zn_stream_consume(stream, 4 + length);
+            }
+        } else {
+            ok = receive_all(in, &length, 4) && length <= MAX_PAYLOAD && receive_all(in, payload, length);
+            if (ok) {
+                checksum += (unsigned char)payload[length - 1];
+            }
+        }
+        if (!ok || length != payload_length(i)) {
+            fprintf(stderr, "bad frame %zu in mode %s\n", i, mode_names[mode]);
+            exit(1);
+        }
+    }
+    double elapsed = now_ms() - start;
+
+    zn_thread_join(&thread, NULL);
+    zn_stream_destroy(stream);
+    if (checksum != frames * 'p') {
+        fprintf(stderr, "payload mismatch in mode %s\n", mode_names[mode]);
+        exit(1);
+    }
+    return elapsed;
+}
+
+int main(int argc, char **argv) {
+    size_t frames = argc > 1 ? (size_t)atol(argv[1]) : 2000000;
+    int port = argc > 2 ? atoi(argv[2]) : 7880;
+
+    socket_t listener, in, out;
+    if (!socket_create(&listener, SOCKET_TCP).success || !socket_bind(&listener, port).success ||
+        !socket_listen(&listener, 1).success || !socket_create(&out, SOCKET_TCP).success ||
+        !socket_set_nodelay(&out, true).success || !socket_connect(&out, "127.0.0.1", port).success ||
+        !socket_accept(&listener, &in).success) {
+        fprintf(stderr, "failed to set up a loopback connection on port %d\n", port);
+        return 1;
+    }
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < frames; i++) {
+        bytes += 4 + payload_length(i);
+    }
+
+    printf("stream_bench: %zu frames, %.1f MB\n", frames, (double)bytes / 1e6);
+    for (int mode = MODE_SYSCALLS; mode <= MODE_STREAM_MIRRORED; mode++) {
+        double elapsed = run((bench_mode_t)mode, &out, &in, frames);
+        printf("  %-17s %8.1f ms  %6.2f M frames/s  %7.0f MB/s\n", mode_names[mode], elapsed,
+               (double)frames / (elapsed * 1e3), (double)bytes / (elapsed * 1e3));
+    }
+
+    socket_close(&out);
+    socket_close(&in);
+    socket_close(&listener);
+    return 0;
+}
@@ -0,0 +1,309 @@
+/**
+ * @file string_bench.c
+ * @brief Generated string equality and interned map keys vs C strings
+ *
+ * Usage: string_bench [iterations] [runs] [zeno]
+ *
+ * - equality: writes a Zeno program that compares strings with == and !=
+ *   `iterations` times (10M by default) and builds it with `zeno compile`,
+ *   using the zeno binary at `zeno` (bin/zeno by default). The generated C
+ *   must lower every comparison to zn_string_equals. The comparisons cover
+ *   short (inline) strings and a long heap string against long literals of
+ *   the same and of a different length. The same loop is written in C over
+ *   heap-copied char* strings compared with strcmp, the representation
+ *   strings had before zn_string_t, and built with the same flags. Both
+ *   programs are run best of `runs` (3 by default) and must print the same
+ *   count.
+ * - lookup: a map of MAP_KEYS string keys laid out as the backend emits map
+ *   literals, an array of key/value pairs whose keys come from
+ *   zn_string_intern_cstr, searched for every key with interned probes
+ *   compared by pointer, against the same array of char* keys searched with
+ *   strcmp. The backend does not generate map lookups yet, so this part
+ *   runs in-process over the key representation the generated code uses.
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "zeno_string.h"
+
+// Comparisons per iteration in the equality programs
+#define COMPARISONS 5
+
+#define MAP_KEYS 64
+#define LOOKUP_ROUNDS 20000
+
+static const char zeno_program[] =
+    "import \"stdio.h\";\n"
+    "\n"
+    "fn main(): int {\n"
+    "    let short_key: string = \"alpha\";\n"
+    "    let long_key: string = \"a key that is longer \" + \"than fifteen bytes\";\n"
+    "    let k: int = %d;\n"
+    "    let same: int = 0;\n"
+    "    while (k) {\n"
+    "        if (short_key == \"alpha\") {\n"
+    "            same = same + 1;\n"
+    "        }\n"
+    "        if (short_key != \"omega\") {\n"
+    "            same = same + 1;\n"
+    "        }\n"
+    "        if (long_key == \"a key that is longer than fifteen bytes\") {\n"
+    "            same = same + 1;\n"
+    "        }\n"
+    "        if (long_key != \"a key that is longer than fifteen bytez\") {\n"
+    "            same = same + 1;\n"
+    "        }\n"
+    "        if (long_key != \"a shorter key, not inline\") {\n"
+    "            same = same + 1;\n"
+    "        }\n"
+    "        k = k - 1;\n"
+    "    }\n"
+    "    printf(\"%%d\\n\", same);\n"
+    "    return 0;\n"
+    "}\n";
+
+/* The same loop over C strings; every string value is a heap copy, as
+ * ZenoRC_string made them. The keys are volatile so that the strcmp calls,
+ * which the compiler knows to be pure, are not hoisted out of the loop. */
+static const char c_program[] =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <string.h>\n"
+    "\n"
+    "static char* string_copy(const char* a, const char* b) {\n"
+    "    size_t length_a = strlen(a), length_b = strlen(b);\n"
+    "    char* result = malloc(length_a + length_b + 1);\n"
+    "    memcpy(result, a, length_a);\n"
+    "    memcpy(result + length_a, b, length_b + 1);\n"
+    "    return result;\n"
+    "}\n"
+    "\n"
+    "int main(void) {\n"
+    "    char* volatile short_key = string_copy(\"alpha\", \"\");\n"
+    "    char* volatile long_key = string_copy(\"a key that is longer \", \"than fifteen bytes\");\n"
+    "    int k = %d;\n"
+    "    int same = 0;\n"
+    "    while (k) {\n"
+    "        if (strcmp(short_key, \"alpha\") == 0) same = same + 1;\n"
+    "        if (strcmp(short_key, \"omega\") != 0) same = same + 1;\n"
+    "        if (strcmp(long_key, \"a key that is longer than fifteen bytes\") == 0) same = same + 1;\n"
+    "        if (strcmp(long_key, \"a key that is longer than fifteen bytez\") != 0) same = same + 1;\n"
+    "        if (strcmp(long_key, \"a shorter key, not inline\") != 0) same = same + 1;\n"
+    "        k = k - 1;\n"
+    "    }\n"
+    "    printf(\"%%d\\n\", same);\n"
+    "    free(long_key);\n"
+    "    free(short_key);\n"
+    "    return 0;\n"
+    "}\n";
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static void write_file(const char* path, const char* format, int iterations) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "failed to create %s\n", path);
+        exit(1);
+    }
+    fprintf(file, format, iterations);
+    fclose(file);
+}
+
+static void run_command(const char* command) {
+    if (system(command) != 0) {
+        fprintf(stderr, "%s failed\n", command);
+        exit(1);
+    }
+}
+
+/* Count the zn_string_equals calls in the generated C */
+static int count_equals_calls(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "failed to open %s\n", path);
+        exit(1);
+    }
+    char line[1024];
+    int calls = 0;
+    while (fgets(line, sizeof(line), file)) {
+        for (const char* at = line; (at = strstr(at, "zn_string_equals(")); at++) {
+            calls++;
+        }
+    }
+    fclose(file);
+    return calls;
+}
+
+/* Run `binary` best of runs; returns the best time and stores what it printed */
+static double time_binary(const char* binary, int runs, long* printed) {
+    double best = 0;
+    for (int run = 0; run < runs; run++) {
+        double start = now_ms();
+        FILE* output = popen(binary, "r");
+        if (!output || fscanf(output, "%ld", printed) != 1) {
+            fprintf(stderr, "failed to run %s\n", binary);
+            exit(1);
+        }
+        pclose(output);
+        double elapsed = now_ms() - start;
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+typedef struct {
+    void* key;
+    void* value;
+} map_entry_t;
+
+static void key_name(int index, char* buffer, size_t size) {
+    // Half the keys fit inline in a zn_string_t, half do not
+    if (index % 2) {
+        snprintf(buffer, size, "field_%d", index);
+    } else {
+        snprintf(buffer, size, "a_longer_field_name_%d", index);
+    }
+}
+
+static void bench_lookup(void) {
+    map_entry_t interned[MAP_KEYS], copied[MAP_KEYS];
+    const char* probes[MAP_KEYS];
+    char* copied_probes[MAP_KEYS];
+    char name[64];
+
+    for (int i = 0; i < MAP_KEYS; i++) {
+        key_name(i, name, sizeof(name));
+        // As the generated map literal stores its keys
+        interned[i].key = (void*)zn_string_intern_cstr(name);
+        interned[i].value = (void*)(intptr_t)i;
+        copied[i].key = strdup(name);
+        copied[i].value = (void*)(intptr_t)i;
+
+        // Probe keys come from other literals: interned, or separate copies
+        probes[i] = zn_string_intern_cstr(name);
+        copied_probes[i] = strdup(name);
+    }
+
+    long interned_sum = 0;
+    double start = now_ms();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++) {
+        for (int i = 0; i < MAP_KEYS; i++) {
+            for (int j = 0; j < MAP_KEYS; j++) {
+                if (interned[j].key == probes[i]) {
+                    interned_sum += (intptr_t)interned[j].value;
+                    break;
+                }
+            }
+        }
+    }
+    double interned_ms = now_ms() - start;
+
+    long copied_sum = 0;
+    start = now_ms();
+    for (int round = 0; round < LOOKUP_ROUNDS; round++) {
+        for (int i = 0; i < MAP_KEYS; i++) {
+            for (int j = 0; j < MAP_KEYS; j++) {
+                if (strcmp(copied[j].key, copied_probes[i]) == 0) {
+                    copied_sum += (intptr_t)copied[j].value;
+                    break;
+                }
+            }
+        }
+    }
+    double copied_ms = now_ms() - start;
+
+    for (int i = 0; i < MAP_KEYS; i++) {
+        free(copied[i].key);
+        free(copied_probes[i]);
+    }
+
+    double lookups = (double)LOOKUP_ROUNDS * MAP_KEYS;
+    printf("lookup: %d keys, %.0f lookups\n", MAP_KEYS, lookups);
+    printf("  strcmp keys    %8.1f ms  %6.1f ns/lookup\n", copied_ms, copied_ms * 1e6 / lookups);
+    printf("  interned keys  %8.1f ms  %6.1f ns/lookup  (%.2fx)\n", interned_ms,
+           interned_ms * 1e6 / lookups, copied_ms / interned_ms);
+    if (interned_sum != copied_sum) {
+        fprintf(stderr, "lookups disagree: %ld vs %ld\n", interned_sum, copied_sum);
+        exit(1);
+    }
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 10000000;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+    const char* zeno_path = argc > 3 ? argv[3] : "bin/zeno";
+    char zeno[PATH_MAX];
+    if (iterations <= 0 || iterations > INT_MAX / COMPARISONS || runs <= 0 || !realpath(zeno_path, zeno)) {
+        fprintf(stderr, "usage: string_bench [iterations] [runs] [zeno]\n");
+        return 1;
+    }
+
+    char root[] = "/tmp/string_bench_XXXXXX";
+    if (!mkdtemp(root)) {
+        fprintf(stderr, "failed to create a temporary directory\n");
+        return 1;
+    }
+    if (chdir(root) != 0) {
+        fprintf(stderr, "failed to enter %s\n", root);
+        return 1;
+    }
+
+    FILE* manifest = fopen("manifest.yaml", "w");
+    if (!manifest) {
+        fprintf(stderr, "failed to create the manifest\n");
+        return 1;
+    }
+    fprintf(manifest, "name: \"string_bench\"\n");
+    fprintf(manifest, "compiler:\n  cc: \"cc\"\n  flags: \"-O2 -w\"\n");
+    fclose(manifest);
+
+    write_file("equality.zn", zeno_program, iterations);
+    write_file("equality_cstr.c", c_program, iterations);
+
+    char command[PATH_MAX + 64];
+    snprintf(command, sizeof(command), "%s compile equality.zn -o equality > /dev/null", zeno);
+    run_command(command);
+    run_command("cc -O2 -w -o equality_cstr equality_cstr.c");
+
+    int calls = count_equals_calls("build/equality.c");
+    if (calls != COMPARISONS) {
+        fprintf(stderr, "generated C has %d zn_string_equals calls, expected %d\n", calls, COMPARISONS);
+        return 1;
+    }
+
+    long generated_count = 0, cstr_count = 0;
+    double generated_ms = time_binary("./build/equality", runs, &generated_count);
+    double cstr_ms = time_binary("./equality_cstr", runs, &cstr_count);
+
+    double comparisons = (double)iterations * COMPARISONS;
+    printf("equality: %.0f comparisons, best of %d runs\n", comparisons, runs);
+    printf("  strcmp         %8.1f ms  %6.2f ns/compare\n", cstr_ms, cstr_ms * 1e6 / comparisons);
+    printf("  zn_string_t    %8.1f ms  %6.2f ns/compare  (%.2fx)\n", generated_ms,
+           generated_ms * 1e6 / comparisons, cstr_ms / generated_ms);
+
+    char cleanup[PATH_MAX + 16];
+    snprintf(cleanup, sizeof(cleanup), "rm -rf %s", root);
+    if (chdir("/") != 0 || system(cleanup) != 0) {
+        fprintf(stderr, "failed to remove %s\n", root);
+    }
+
+    if (generated_count != cstr_count || generated_count != (long)comparisons) {
+        fprintf(stderr, "programs printed %ld and %ld, expected %.0f\n", generated_count, cstr_count,
+                comparisons);
+        return 1;
+    }
+
+    bench_lookup();
+    return 0;
+}
@@ -0,0 +1,320 @@
+/**
+ * @file symtab_bench.c
+ * @brief Symbol table scopes: linked lists vs hash tables
+ *
+ * Usage: symtab_bench [globals] [functions]
+ *
+ * Both tables are fed interned names, as code generation passes them from
+ * the AST, and the hash table is searched with lookup_interned_symbol. The list is the structure symtab.c used before the hash tables:
+ * a linked list per scope searched with strcmp, with a full scan of the
+ * current scope on every add. Measured:
+ *
+ * - globals: `globals` symbols (50k by default) added to the global scope,
+ *   the shape of a file with thousands of top-level functions and globals
+ * - lookup: every global looked up from three scopes down, plus as many
+ *   misses
+ * - functions: `functions` bodies (50k by default) over those globals,
+ *   each entering a scope and a nested block, adding parameters and
+ *   locals, resolving them and a few globals, and leaving both scopes
+ * - strings: lookup_symbol with strings that are not interned, copies of
+ *   every global plus as many names that were never interned; these are
+ *   looked up in the interner, which must not grow
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "intern.h"
+#include "symtab.h"
+
+#define LOCALS 8
+#define GLOBAL_REFS 4
+
+typedef struct list_entry {
+    char *name;
+    SymbolType type;
+    TypeInfo *type_info;
+    struct list_entry *next;
+} list_entry_t;
+
+typedef struct list_scope {
+    list_entry_t *entries;
+    struct list_scope *parent;
+} list_scope_t;
+
+typedef struct {
+    list_scope_t *current_scope;
+} list_table_t;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void *xmalloc(size_t size) {
+    void *ptr = malloc(size);
+    if (!ptr) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+/* The symbol table's former scope lists */
+
+static list_table_t *list_init(void) {
+    list_table_t *table = xmalloc(sizeof(list_table_t));
+    table->current_scope = xmalloc(sizeof(list_scope_t));
+    table->current_scope->entries = NULL;
+    table->current_scope->parent = NULL;
+    return table;
+}
+
+static void list_enter(list_table_t *table) {
+    list_scope_t *scope = xmalloc(sizeof(list_scope_t));
+    scope->entries = NULL;
+    scope->parent = table->current_scope;
+    table->current_scope = scope;
+}
+
+static void list_free_entries(list_entry_t *entry) {
+    while (entry) {
+        list_entry_t *next = entry->next;
+        free(entry);
+        entry = next;
+    }
+}
+
+static void list_leave(list_table_t *table) {
+    list_scope_t *scope = table->current_scope;
+    if (!scope->parent) {
+        return;
+    }
+    table->current_scope = scope->parent;
+    list_free_entries(scope->entries);
+    free(scope);
+}
+
+static void list_add(list_table_t *table, char *name, SymbolType type, TypeInfo *type_info) {
+    for (list_entry_t *entry = table->current_scope->entries; entry; entry = entry->next) {
+        if (strcmp(entry->name, name) == 0) {
+            fprintf(stderr, "Symbol %s already defined in current scope\n", name);
+            return;
+        }
+    }
+    list_entry_t *entry = xmalloc(sizeof(list_entry_t));
+    entry->name = name;
+    entry->type = type;
+    entry->type_info = type_info;
+    entry->next = table->current_scope->entries;
+    table->current_scope->entries = entry;
+}
+
+static list_entry_t *list_lookup(list_table_t *table, char *name) {
+    for (list_scope_t *scope = table->current_scope; scope; scope = scope->parent) {
+        for (list_entry_t *entry = scope->entries; entry; entry = entry->next) {
+            if (strcmp(entry->name, name) == 0) {
+                return entry;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void list_cleanup(list_table_t *table) {
+    while (table->current_scope->parent) {
+        list_leave(table);
+    }
+    list_free_entries(table->current_scope->entries);
+    free(table->current_scope);
+    free(table);
+}
+
+/* Names, interned up front or as plain copies */
+
+static char **make_names(const char *prefix, size_t count, bool interned) {
+    char **names = xmalloc(count * sizeof(char *));
+    char buf[64];
+    for (size_t i = 0; i < count; i++) {
+        snprintf(buf, sizeof(buf), "%s%zu", prefix, i);
+        names[i] = interned ? intern(buf) : strdup(buf);
+        if (!names[i]) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    return names;
+}
+
+static void free_copies(char **names, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(names[i]);
+    }
+    free(names);
+}
+
+typedef struct {
+    double globals;
+    double lookup;
+    double functions;
+    double strings;
+    size_t found;
+} result_t;
+
+static result_t run_list(char **globals, char **missing, size_t global_count, char **locals,
+                         size_t function_count) {
+    result_t result = {0};
+    list_table_t *table = list_init();
+
+    double start = now_ms();
+    for (size_t i = 0; i < global_count; i++) {
+        list_add(table, globals[i], i % 2 ? SYMBOL_FUNCTION : SYMBOL_VARIABLE, NULL);
+    }
+    result.globals = now_ms() - start;
+
+    list_enter(table);
+    list_enter(table);
+    list_enter(table);
+    start = now_ms();
+    for (size_t i = 0; i < global_count; i++) {
+        result.found += list_lookup(table, globals[i]) != NULL;
+        result.found += list_lookup(table, missing[i]) != NULL;
+    }
+    result.lookup = now_ms() - start;
+    list_leave(table);
+    list_leave(table);
+    list_leave(table);
+
+    start = now_ms();
+    for (size_t f = 0; f < function_count; f++) {
+        list_enter(table);
+        for (size_t i = 0; i < LOCALS / 2; i++) {
+            list_add(table, locals[i], SYMBOL_VARIABLE, NULL);
+        }
+        list_enter(table);
+        for (size_t i = LOCALS / 2; i < LOCALS; i++) {
+            list_add(table, locals[i], SYMBOL_VARIABLE, NULL);
+        }
+        for (size_t i = 0; i < LOCALS; i++) {
+            result.found += list_lookup(table, locals[i]) != NULL;
+        }
+        for (size_t i = 0; i < GLOBAL_REFS; i++) {
+            result.found += list_lookup(table, globals[(f * GLOBAL_REFS + i) % global_count]) != NULL;
+        }
+        list_leave(table);
+        list_leave(table);
+    }
+    result.functions = now_ms() - start;
+
+    list_cleanup(table);
+    return result;
+}
+
+static result_t run_hash(char **globals, char **missing, size_t global_count, char **locals,
+                         size_t function_count, char **copies, char **unknown) {
+    result_t result = {0};
+    SymbolTable *table = init_symbol_table();
+
+    double start = now_ms();
+    for (size_t i = 0; i < global_count; i++) {
+        add_symbol(table, globals[i], i % 2 ? SYMBOL_FUNCTION : SYMBOL_VARIABLE, NULL);
+    }
+    result.globals = now_ms() - start;
+
+    enter_scope(table);
+    enter_scope(table);
+    enter_scope(table);
+    start = now_ms();
+    for (size_t i = 0; i < global_count; i++) {
+        result.found += lookup_interned_symbol(table, globals[i]) != NULL;
+        result.found += lookup_interned_symbol(table, missing[i]) != NULL;
+    }
+    result.lookup = now_ms() - start;
+
+    size_t strings_before = get_interner_stats().strings;
+    size_t found = 0;
+    start = now_ms();
+    for (size_t i = 0; i < global_count; i++) {
+        found += lookup_symbol(table, copies[i]) != NULL;
+        found += lookup_symbol(table, unknown[i]) != NULL;
+    }
+    result.strings = now_ms() - start;
+    if (found != global_count || get_interner_stats().strings != strings_before) {
+        fprintf(stderr, "lookup_symbol found %zu of %zu copies, interner grew by %zu\n", found, global_count,
+                get_interner_stats().strings - strings_before);
+        exit(1);
+    }
+    leave_scope(table);
+    leave_scope(table);
+    leave_scope(table);
+
+    start = now_ms();
+    for (size_t f = 0; f < function_count; f++) {
+        enter_scope(table);
+        for (size_t i = 0; i < LOCALS / 2; i++) {
+            add_symbol(table, locals[i], SYMBOL_VARIABLE, NULL);
+        }
+        enter_scope(table);
+        for (size_t i = LOCALS / 2; i < LOCALS; i++) {
+            add_symbol(table, locals[i], SYMBOL_VARIABLE, NULL);
+        }
+        for (size_t i = 0; i < LOCALS; i++) {
+            result.found += lookup_interned_symbol(table, locals[i]) != NULL;
+        }
+        for (size_t i = 0; i < GLOBAL_REFS; i++) {
+            result.found += lookup_interned_symbol(table, globals[(f * GLOBAL_REFS + i) % global_count]) != NULL;
+        }
+        leave_scope(table);
+        leave_scope(table);
+    }
+    result.functions = now_ms() - start;
+
+    cleanup_symbol_table(table);
+    return result;
+}
+
+static void report(const char *label, result_t result, size_t global_count, size_t function_count) {
+    printf("%-6s globals %9.2f ms  lookup %9.2f ms (%6.1f ns/op)  functions %8.2f ms (%6.1f ns/fn)\n", label,
+           result.globals, result.lookup, result.lookup * 1e6 / (double)(2 * global_count), result.functions,
+           result.functions * 1e6 / (double)function_count);
+}
+
+int main(int argc, char **argv) {
+    size_t global_count = argc > 1 ? (size_t)atol(argv[1]) : 50000;
+    size_t function_count = argc > 2 ? (size_t)atol(argv[2]) : 50000;
+    if (global_count == 0) {
+        fprintf(stderr, "usage: symtab_bench [globals] [functions]\n");
+        return 1;
+    }
+
+    char **globals = make_names("global_", global_count, true);
+    char **missing = make_names("missing_", global_count, true);
+    char **locals = make_names("local_", LOCALS, true);
+    char **copies = make_names("global_", global_count, false);
+    char **unknown = make_names("unknown_", global_count, false);
+
+    printf("symtab_bench: %zu globals, %zu function bodies (%d locals, %d global references each)\n",
+           global_count, function_count, LOCALS, GLOBAL_REFS);
+    result_t list = run_list(globals, missing, global_count, locals, function_count);
+    report("list", list, global_count, function_count);
+    result_t hash = run_hash(globals, missing, global_count, locals, function_count, copies, unknown);
+    report("hash", hash, global_count, function_count);
+    printf("strings lookup_symbol %9.2f ms (%6.1f ns/op), interner unchanged\n", hash.strings,
+           hash.strings * 1e6 / (double)(2 * global_count));
+
+    if (list.found != hash.found) {
+        fprintf(stderr, "lookups disagree: %zu vs %zu\n", list.found, hash.found);
+        return 1;
+    }
+
+    free(globals);
+    free(missing);
+    free(locals);
+    free_copies(copies, global_count);
+    free_copies(unknown, global_count);
+    cleanup_interner();
+    return 0;
+}
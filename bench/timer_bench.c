@@ -0,0 +1,239 @@
+/**
+ * @file timer_bench.c
+ * @brief Arming and cancelling timers: binary heap vs timing wheel
+ *
+ * Usage: timer_bench [timers] [max_delay_ms]
+ *
+ * Each timer gets a random delay of up to max_delay_ms (60s by default),
+ * the spread of per-connection timeouts. Measured:
+ *
+ * - arm + cancel: every timer is added, then all are cancelled in random
+ *   order. The heap is the structure the reactor used before the wheel,
+ *   with the same slot-indexed removal; the wheel is timer_wheel.h with
+ *   preallocated entries; "reactor" goes through zn_reactor_add_timer and
+ *   zn_reactor_cancel_timer and so includes the allocation.
+ * - restart: an idle timeout pushed back on every request, via
+ *   zn_reactor_restart_timer on a set of live timers
+ * - expire: every timer is armed and the clock is advanced a millisecond
+ *   at a time until all have fired
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "reactor.h"
+#include "timer_wheel.h"
+
+typedef struct {
+    uint64_t deadline;
+    size_t heap_index;
+} heap_timer_t;
+
+typedef struct {
+    heap_timer_t **items;
+    size_t count;
+} heap_t;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/* The reactor's former timer heap */
+
+static void heap_swap(heap_t *heap, size_t a, size_t b) {
+    heap_timer_t *tmp = heap->items[a];
+    heap->items[a] = heap->items[b];
+    heap->items[b] = tmp;
+    heap->items[a]->heap_index = a;
+    heap->items[b]->heap_index = b;
+}
+
+static void heap_sift_up(heap_t *heap, size_t index) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (heap->items[parent]->deadline <= heap->items[index]->deadline) {
+            break;
+        }
+        heap_swap(heap, parent, index);
+        index = parent;
+    }
+}
+
+static void heap_sift_down(heap_t *heap, size_t index) {
+    for (;;) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < heap->count && heap->items[left]->deadline < heap->items[smallest]->deadline) {
+            smallest = left;
+        }
+        if (right < heap->count && heap->items[right]->deadline < heap->items[smallest]->deadline) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        heap_swap(heap, index, smallest);
+        index = smallest;
+    }
+}
+
+static void heap_push(heap_t *heap, heap_timer_t *timer) {
+    timer->heap_index = heap->count;
+    heap->items[heap->count++] = timer;
+    heap_sift_up(heap, timer->heap_index);
+}
+
+static void heap_remove(heap_t *heap, heap_timer_t *timer) {
+    size_t index = timer->heap_index;
+    size_t last = --heap->count;
+    if (index != last) {
+        heap_swap(heap, index, last);
+        heap_sift_down(heap, index);
+        heap_sift_up(heap, index);
+    }
+}
+
+static void noop(zn_reactor_t *reactor, void *data) {
+    (void)reactor;
+    (void)data;
+}
+
+static void report(const char *name, size_t operations, double elapsed) {
+    printf("  %-22s %8.1f ms  %7.1f ns/op\n", name, elapsed, elapsed * 1e6 / (double)operations);
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    uint64_t max_delay = argc > 2 ? (uint64_t)atoll(argv[2]) : 60000;
+    if (count == 0 || max_delay == 0) {
+        fprintf(stderr, "usage: timer_bench [timers] [max_delay_ms]\n");
+        return 1;
+    }
+
+    uint64_t *delays = (uint64_t *)malloc(count * sizeof(uint64_t));
+    size_t *order = (size_t *)malloc(count * sizeof(size_t));
+    heap_timer_t *heap_timers = (heap_timer_t *)calloc(count, sizeof(heap_timer_t));
+    zn_timer_wheel_entry_t *entries = (zn_timer_wheel_entry_t *)calloc(count, sizeof(zn_timer_wheel_entry_t));
+    zn_reactor_timer_t **handles = (zn_reactor_timer_t **)malloc(count * sizeof(zn_reactor_timer_t *));
+    heap_t heap = { (heap_timer_t **)malloc(count * sizeof(heap_timer_t *)), 0 };
+    zn_timer_wheel_t *wheel = (zn_timer_wheel_t *)malloc(sizeof(zn_timer_wheel_t));
+    zn_reactor_t *reactor = zn_reactor_create();
+    if (!delays || !order || !heap_timers || !entries || !handles || !heap.items || !wheel || !reactor) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+
+    uint64_t seed = 0x9e3779b97f4a7c15ull;
+    for (size_t i = 0; i < count; i++) {
+        delays[i] = 1 + next_random(&seed) % max_delay;
+        order[i] = i;
+    }
+    for (size_t i = count - 1; i > 0; i--) {
+        size_t j = next_random(&seed) % (i + 1);
+        size_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    printf("timer_bench: %zu timers, delays up to %llu ms\n", count, (unsigned long long)max_delay);
+    uint64_t base = 1000000;
+    double start, elapsed;
+
+    start = now_ms();
+    for (size_t i = 0; i < count; i++) {
+        heap_timers[i].deadline = base + delays[i];
+        heap_push(&heap, &heap_timers[i]);
+    }
+    for (size_t i = 0; i < count; i++) {
+        heap_remove(&heap, &heap_timers[order[i]]);
+    }
+    report("arm + cancel, heap", 2 * count, now_ms() - start);
+
+    zn_timer_wheel_init(wheel, base);
+    start = now_ms();
+    for (size_t i = 0; i < count; i++) {
+        zn_timer_wheel_add(wheel, &entries[i], base + delays[i]);
+    }
+    for (size_t i = 0; i < count; i++) {
+        zn_timer_wheel_remove(wheel, &entries[order[i]]);
+    }
+    report("arm + cancel, wheel", 2 * count, now_ms() - start);
+
+    start = now_ms();
+    for (size_t i = 0; i < count; i++) {
+        handles[i] = zn_reactor_add_timer(reactor, delays[i], 0, noop, NULL);
+    }
+    for (size_t i = 0; i < count; i++) {
+        zn_reactor_cancel_timer(reactor, handles[order[i]]);
+    }
+    report("arm + cancel, reactor", 2 * count, now_ms() - start);
+
+    /* Idle timeouts: a tenth of the timers live, each pushed back ten times */
+    size_t live = count / 10 ? count / 10 : 1;
+    for (size_t i = 0; i < live; i++) {
+        handles[i] = zn_reactor_add_timer(reactor, delays[i], 0, noop, NULL);
+    }
+    start = now_ms();
+    for (size_t i = 0; i < count; i++) {
+        zn_reactor_restart_timer(reactor, handles[order[i] % live], delays[i]);
+    }
+    report("restart, reactor", count, now_ms() - start);
+    for (size_t i = 0; i < live; i++) {
+        zn_reactor_cancel_timer(reactor, handles[i]);
+    }
+
+    start = now_ms();
+    for (size_t i = 0; i < count; i++) {
+        heap_timers[i].deadline = base + delays[i];
+        heap_push(&heap, &heap_timers[i]);
+    }
+    size_t fired = 0;
+    for (uint64_t tick = base; heap.count > 0; tick++) {
+        while (heap.count > 0 && heap.items[0]->deadline <= tick) {
+            heap_remove(&heap, heap.items[0]);
+            fired++;
+        }
+    }
+    elapsed = now_ms() - start;
+    report("arm + expire, heap", 2 * count, elapsed);
+
+    zn_timer_wheel_init(wheel, base);
+    start = now_ms();
+    for (size_t i = 0; i < count; i++) {
+        zn_timer_wheel_add(wheel, &entries[i], base + delays[i]);
+    }
+    for (uint64_t tick = base; wheel->count > 0; tick++) {
+        zn_timer_wheel_advance(wheel, tick);
+        while (zn_timer_wheel_pop(wheel)) {
+            fired++;
+        }
+    }
+    elapsed = now_ms() - start;
+    report("arm + expire, wheel", 2 * count, elapsed);
+
+    if (fired != 2 * count) {
+        fprintf(stderr, "expected %zu expiries, got %zu\n", 2 * count, fired);
+        return 1;
+    }
+
+    zn_reactor_destroy(reactor);
+    free(wheel);
+    free(heap.items);
+    free(handles);
+    free(entries);
+    free(heap_timers);
+    free(order);
+    free(delays);
+    return 0;
+}
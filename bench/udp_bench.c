@@ -0,0 +1,171 @@
+/**
+ * @file udp_bench.c
+ * @brief Loopback UDP cost per datagram: one per call vs batched vs GSO/GRO
+ *
+ * Usage: udp_bench [seconds] [datagram_bytes] [batch] [port]
+ *
+ * Each mode repeatedly sends a burst of datagrams to a loopback socket and
+ * then drains it, timing the two halves separately so the figures are the
+ * per-core cost of each side without scheduler ping-pong between a sender
+ * and a receiver thread:
+ *
+ * - single:  socket_send / socket_receive, one datagram per system call
+ * - batch:   socket_send_batch / socket_receive_batch (sendmmsg/recvmmsg)
+ * - gso+gro: socket_send_segmented (UDP_SEGMENT) into a receiver with
+ *            UDP_GRO enabled, read with socket_receive_batch
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "socket.h"
+
+#define MAX_BATCH 1024
+#define BURST 2048
+#define SOCKET_BUFFER (8 * 1024 * 1024)
+#define GRO_BUFFER 65536
+
+typedef enum { MODE_SINGLE, MODE_BATCH, MODE_GSO } udp_mode_t;
+
+static const char *mode_names[] = { "single", "batch", "gso+gro" };
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* Send BURST datagrams; returns false on failure */
+static bool send_burst(socket_t *sender, udp_mode_t mode, char *payload, socket_datagram_t *datagrams,
+                       size_t datagram_bytes, size_t batch) {
+    for (size_t done = 0; done < BURST;) {
+        size_t count = BURST - done < batch ? BURST - done : batch;
+        if (mode == MODE_SINGLE) {
+            if (!socket_send(sender, payload, datagram_bytes, NULL).success) {
+                return false;
+            }
+            done++;
+        } else if (mode == MODE_BATCH) {
+            size_t sent = 0;
+            if (!socket_send_batch(sender, datagrams, count, &sent).success || sent == 0) {
+                return false;
+            }
+            done += sent;
+        } else {
+            size_t bytes = 0;
+            if (!socket_send_segmented(sender, payload, count * datagram_bytes, (uint16_t)datagram_bytes, NULL, 0,
+                                       &bytes).success || bytes == 0) {
+                return false;
+            }
+            done += bytes / datagram_bytes;
+        }
+    }
+    return true;
+}
+
+/* Drain the non-blocking receiver; returns the number of datagrams read */
+static long drain(socket_t *receiver, udp_mode_t mode, socket_datagram_t *datagrams, size_t batch) {
+    long total = 0;
+    for (;;) {
+        if (mode == MODE_SINGLE) {
+            size_t bytes = 0;
+            if (!socket_receive(receiver, datagrams[0].data, datagrams[0].capacity, &bytes).success || bytes == 0) {
+                return total;
+            }
+            total++;
+            continue;
+        }
+
+        size_t received = 0;
+        if (!socket_receive_batch(receiver, datagrams, batch, &received).success || received == 0) {
+            return total;
+        }
+        for (size_t i = 0; i < received; i++) {
+            /* A coalesced receive holds several datagrams */
+            size_t segment = datagrams[i].segment_size;
+            total += segment ? (long)((datagrams[i].length + segment - 1) / segment) : 1;
+        }
+    }
+}
+
+static void run(udp_mode_t mode, double seconds, size_t datagram_bytes, size_t batch, int port) {
+    socket_t receiver, sender;
+    if (!socket_create(&receiver, SOCKET_UDP).success || !socket_bind(&receiver, port).success ||
+        !socket_set_nonblocking(&receiver, true).success || !socket_create(&sender, SOCKET_UDP).success ||
+        !socket_connect(&sender, "127.0.0.1", port).success) {
+        fprintf(stderr, "failed to set up UDP sockets on port %d\n", port);
+        exit(1);
+    }
+    /* Room for a whole burst on both sides; queued loopback datagrams are
+     * charged to the sender's buffer until they are read */
+    int buffer_size = SOCKET_BUFFER;
+    setsockopt(receiver.fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+    setsockopt(sender.fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+    if (mode == MODE_GSO && !socket_set_gro(&receiver, true).success) {
+        printf("  %-8s UDP_GRO not supported\n", mode_names[mode]);
+        socket_close(&receiver);
+        socket_close(&sender);
+        return;
+    }
+
+    size_t receive_bytes = mode == MODE_GSO ? GRO_BUFFER : datagram_bytes;
+    char *payload = (char *)calloc(batch, datagram_bytes);
+    char *buffers = (char *)malloc(batch * receive_bytes);
+    socket_datagram_t *outgoing = (socket_datagram_t *)calloc(batch, sizeof(socket_datagram_t));
+    socket_datagram_t *incoming = (socket_datagram_t *)calloc(batch, sizeof(socket_datagram_t));
+    for (size_t i = 0; i < batch; i++) {
+        outgoing[i].data = payload + i * datagram_bytes;
+        outgoing[i].length = datagram_bytes;
+        incoming[i].data = buffers + i * receive_bytes;
+        incoming[i].capacity = receive_bytes;
+    }
+
+    long sent = 0, received = 0;
+    double send_ms = 0, receive_ms = 0;
+    double end = now_ms() + seconds * 1e3;
+    while (now_ms() < end) {
+        double start = now_ms();
+        if (!send_burst(&sender, mode, payload, outgoing, datagram_bytes, batch)) {
+            printf("  %-8s send failed (UDP GSO may be unsupported)\n", mode_names[mode]);
+            break;
+        }
+        double middle = now_ms();
+        received += drain(&receiver, mode, incoming, batch);
+        receive_ms += now_ms() - middle;
+        send_ms += middle - start;
+        sent += BURST;
+    }
+
+    if (sent > 0) {
+        printf("  %-8s send %6.0f ns  %5.2f M/s   receive %6.0f ns  %5.2f M/s   (%ld of %ld lost)\n",
+               mode_names[mode], send_ms * 1e6 / (double)sent, (double)sent / (send_ms * 1e3),
+               receive_ms * 1e6 / (double)received, (double)received / (receive_ms * 1e3), sent - received, sent);
+    }
+
+    socket_close(&sender);
+    socket_close(&receiver);
+    free(incoming);
+    free(outgoing);
+    free(buffers);
+    free(payload);
+}
+
+int main(int argc, char **argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+    size_t datagram_bytes = argc > 2 ? (size_t)atol(argv[2]) : 64;
+    size_t batch = argc > 3 ? (size_t)atol(argv[3]) : 64;
+    int port = argc > 4 ? atoi(argv[4]) : 7900;
+
+    if (datagram_bytes == 0 || datagram_bytes > 1472 || batch == 0 || batch > MAX_BATCH) {
+        fprintf(stderr, "datagram size must be 1..1472 bytes and batch 1..%d\n", MAX_BATCH);
+        return 1;
+    }
+
+    printf("udp_bench: %zu-byte datagrams, batches of %zu, %.1f s per mode (per datagram cost and rate)\n",
+           datagram_bytes, batch, seconds);
+    for (int mode = MODE_SINGLE; mode <= MODE_GSO; mode++) {
+        run((udp_mode_t)mode, seconds, datagram_bytes, batch, port + mode);
+    }
+    return 0;
+}
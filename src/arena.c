@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "arena.h"
+
+#define ARENA_ALIGN _Alignof(max_align_t)
+
+struct ArenaChunk {
+    ArenaChunk* next;
+    size_t size;
+    _Alignas(max_align_t) char data[];
+};
+
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static ArenaChunk* allocate_chunk(Arena* arena, size_t size) {
+    ArenaChunk* chunk = (ArenaChunk*)malloc(sizeof(ArenaChunk) + size);
+    if (!chunk) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    chunk->size = size;
+    arena->reserved += size;
+    return chunk;
+}
+
+// Create an arena
+Arena* arena_create(size_t chunk_size) {
+    Arena* arena = (Arena*)calloc(1, sizeof(Arena));
+    if (!arena) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    arena->chunk_size = chunk_size ? align_up(chunk_size) : ARENA_DEFAULT_CHUNK;
+    return arena;
+}
+
+// Take size bytes at the given alignment from the current chunk, starting
+// a new one when it is full
+static void* arena_bump(Arena* arena, size_t size, size_t align) {
+    arena->used += size;
+
+    if (arena->cursor) {
+        uintptr_t start = ((uintptr_t)arena->cursor + align - 1) & ~(uintptr_t)(align - 1);
+        if (start + size <= (uintptr_t)arena->limit) {
+            arena->cursor = (char*)(start + size);
+            return (void*)start;
+        }
+    }
+
+    if (size > arena->chunk_size / 4) {
+        // Large block: give it its own chunk behind the current one, so
+        // the space left in the current chunk is not wasted
+        ArenaChunk* chunk = allocate_chunk(arena, size);
+        if (arena->chunks) {
+            chunk->next = arena->chunks->next;
+            arena->chunks->next = chunk;
+        } else {
+            chunk->next = NULL;
+            arena->chunks = chunk;
+        }
+        return chunk->data;
+    }
+
+    ArenaChunk* chunk = allocate_chunk(arena, arena->chunk_size);
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->cursor = chunk->data + size;
+    arena->limit = chunk->data + chunk->size;
+    return chunk->data;
+}
+
+// Allocate memory aligned for any type
+void* arena_alloc(Arena* arena, size_t size) {
+    return arena_bump(arena, align_up(size ? size : 1), ARENA_ALIGN);
+}
+
+// Copy a string into the arena
+char* arena_strdup(Arena* arena, const char* str) {
+    return arena_strndup(arena, str, strlen(str));
+}
+
+// Copy length bytes of a string into the arena and terminate it
+char* arena_strndup(Arena* arena, const char* str, size_t length) {
+    char* copy = (char*)arena_bump(arena, length + 1, 1);
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// Free the arena and all of its chunks
+void arena_destroy(Arena* arena) {
+    if (!arena) return;
+
+    ArenaChunk* chunk = arena->chunks;
+    while (chunk) {
+        ArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
@@ -0,0 +1,42 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump-pointer arena. Allocations are carved out of large chunks and are
+// never freed one by one: arena_destroy releases everything at once, in
+// one free per chunk. Used for data that lives exactly as long as a
+// compilation unit, such as the AST. An arena is not thread-safe; each
+// thread building a unit uses its own.
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    ArenaChunk* chunks;     // Newest first
+    char* cursor;           // Next free byte in the current chunk
+    char* limit;            // End of the current chunk
+    size_t chunk_size;      // Size of regular chunks
+    size_t used;            // Bytes handed out
+    size_t reserved;        // Bytes held in chunks
+} Arena;
+
+// Default chunk size
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+
+// Create an arena; chunk_size 0 selects ARENA_DEFAULT_CHUNK
+Arena* arena_create(size_t chunk_size);
+
+// Allocate size bytes, aligned for any type. Requests larger than a
+// quarter of a chunk get a chunk of their own. Exits on out of memory,
+// like the rest of the compiler.
+void* arena_alloc(Arena* arena, size_t size);
+
+// Copy a string into the arena
+char* arena_strdup(Arena* arena, const char* str);
+
+// Copy length bytes of a string into the arena and terminate it
+char* arena_strndup(Arena* arena, const char* str, size_t length);
+
+// Free the arena and everything allocated from it
+void arena_destroy(Arena* arena);
+
+#endif // ARENA_H
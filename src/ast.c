@@ -2,16 +2,35 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ast.h"
+#include "intern.h"
 
-// Helper function to allocate a new AST node
-static AST_Node* allocate_node(NodeType type) {
-    AST_Node* node = (AST_Node*)malloc(sizeof(AST_Node));
-    if (!node) {
-        fprintf(stderr, "Memory allocation failed\n");
+// Arena of the compilation unit this thread is building
+static _Thread_local Arena* ast_arena = NULL;
+
+// Set the arena that this thread's AST allocations come from
+void ast_set_arena(Arena* arena) {
+    ast_arena = arena;
+}
+
+// Get the current AST arena
+Arena* ast_get_arena(void) {
+    return ast_arena;
+}
+
+// Allocate AST memory from the current arena
+static void* ast_alloc(size_t size) {
+    if (!ast_arena) {
+        fprintf(stderr, "No AST arena set\n");
         exit(1);
     }
+    return arena_alloc(ast_arena, size);
+}
+
+// Helper function to allocate a new AST node
+static AST_Node* allocate_node(NodeType type) {
+    AST_Node* node = (AST_Node*)ast_alloc(sizeof(AST_Node));
+    memset(node, 0, sizeof(AST_Node)); // Fields a constructor leaves out read as 0
     node->type = type;
-    node->next = NULL;
     return node;
 }
 
@@ -327,12 +346,8 @@ AST_Node* create_while_node(AST_Node* condition, AST_Node* body) {
 
 // Create map type info
 TypeInfo* create_map_type_info(TypeInfo* key_type, TypeInfo* value_type) {
-    TypeInfo* type = (TypeInfo*)malloc(sizeof(TypeInfo));
-    if (!type) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
-    type->name = strdup("map"); // Map type name
+    TypeInfo* type = (TypeInfo*)ast_alloc(sizeof(TypeInfo));
+    type->name = interned_names()->map_type; // Map type name
     type->generic_type = key_type; // Key type
     type->value_type = value_type; // Value type
     return type;
@@ -355,11 +370,7 @@ AST_Node* create_map_entry_node(AST_Node* key, AST_Node* value) { // Changed key
 
 // Create node list
 AST_Node_List* create_node_list(AST_Node* node) {
-    AST_Node_List* list = (AST_Node_List*)malloc(sizeof(AST_Node_List));
-    if (!list) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
+    AST_Node_List* list = (AST_Node_List*)ast_alloc(sizeof(AST_Node_List));
     // Initialize list properly, handling NULL node case
     list->head = node;
     list->tail = node;
@@ -382,11 +393,7 @@ void append_node(AST_Node_List* list, AST_Node* node) {
 
 // Create struct field
 StructField* create_struct_field(char* name, TypeInfo* type) {
-    StructField* field = (StructField*)malloc(sizeof(StructField));
-    if (!field) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
+    StructField* field = (StructField*)ast_alloc(sizeof(StructField));
     field->name = name;
     field->type = type;
     field->next = NULL;
@@ -395,11 +402,7 @@ StructField* create_struct_field(char* name, TypeInfo* type) {
 
 // Create field list
 StructField_List* create_field_list(StructField* field) {
-    StructField_List* list = (StructField_List*)malloc(sizeof(StructField_List));
-    if (!list) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
+    StructField_List* list = (StructField_List*)ast_alloc(sizeof(StructField_List));
     list->head = field;
     list->tail = field;
     return list;
@@ -420,12 +423,8 @@ void append_field(StructField_List* list, StructField* field) {
 
 // Create type info
 TypeInfo* create_type_info(char* name, TypeInfo* generic_type) {
-    TypeInfo* type = (TypeInfo*)malloc(sizeof(TypeInfo));
-    if (!type) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
-    type->name = name;
+    TypeInfo* type = (TypeInfo*)ast_alloc(sizeof(TypeInfo));
+    type->name = intern(name); // Type names are always interned, see ast.h
     type->generic_type = generic_type;
     type->value_type = NULL; // Initialize value_type for non-map types
     return type;
@@ -433,11 +432,7 @@ TypeInfo* create_type_info(char* name, TypeInfo* generic_type) {
 
 // Create expression list
 ExpressionList* create_expression_list(AST_Node* expr) {
-    ExpressionList* list = (ExpressionList*)malloc(sizeof(ExpressionList));
-    if (!list) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
+    ExpressionList* list = (ExpressionList*)ast_alloc(sizeof(ExpressionList));
     list->expression = expr;
     list->next = NULL;
     return list;
@@ -462,22 +457,14 @@ void append_expression(ExpressionList* list, AST_Node* expr) {
 
 // Create guard clause
 GuardClause* create_guard_clause(AST_Node* condition) {
-    GuardClause* guard = (GuardClause*)malloc(sizeof(GuardClause));
-    if (!guard) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
+    GuardClause* guard = (GuardClause*)ast_alloc(sizeof(GuardClause));
     guard->condition = condition;
     return guard;
 }
 
 // Create match case
 MatchCase* create_match_case(AST_Node* pattern, AST_Node* guard, AST_Node* body) {
-    MatchCase* match_case = (MatchCase*)malloc(sizeof(MatchCase));
-    if (!match_case) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
+    MatchCase* match_case = (MatchCase*)ast_alloc(sizeof(MatchCase));
     match_case->pattern = pattern;
     match_case->guard = guard;
     match_case->body = body;
@@ -487,11 +474,7 @@ MatchCase* create_match_case(AST_Node* pattern, AST_Node* guard, AST_Node* body)
 
 // Create match case list
 MatchCase_List* create_match_case_list(MatchCase* case_node) {
-    MatchCase_List* list = (MatchCase_List*)malloc(sizeof(MatchCase_List));
-    if (!list) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
+    MatchCase_List* list = (MatchCase_List*)ast_alloc(sizeof(MatchCase_List));
     list->head = case_node;
     list->tail = case_node;
     return list;
@@ -509,281 +492,3 @@ void append_match_case(MatchCase_List* list, MatchCase* case_node) {
         list->tail = case_node;
     }
 }
-
-// Free AST
-void free_ast(AST_Node* node) {
-    if (!node) return;
-    
-    // Free next node first (depth-first traversal)
-    if (node->next) {
-        free_ast(node->next);
-    }
-    
-    // Free node-specific data
-    switch (node->type) {
-        case NODE_PROGRAM:
-            if (node->data.program.declarations) {
-                if (node->data.program.declarations->head) {
-                    free_ast(node->data.program.declarations->head);
-                }
-                free(node->data.program.declarations);
-            }
-            break;
-        case NODE_PROMISE_THEN:
-            if (node->data.promise_then.promise) free_ast(node->data.promise_then.promise);
-            if (node->data.promise_then.handler) free_ast(node->data.promise_then.handler);
-            break;
-        case NODE_PROMISE_CATCH:
-            if (node->data.promise_catch.promise) free_ast(node->data.promise_catch.promise);
-            if (node->data.promise_catch.handler) free_ast(node->data.promise_catch.handler);
-            break;
-        case NODE_PROMISE_FINALLY:
-            if (node->data.promise_finally.promise) free_ast(node->data.promise_finally.promise);
-            if (node->data.promise_finally.handler) free_ast(node->data.promise_finally.handler);
-            break;
-        case NODE_PROMISE_ALL:
-            if (node->data.promise_all.promises) {
-                ExpressionList* promises = node->data.promise_all.promises;
-                while (promises) {
-                    ExpressionList* next = promises->next;
-                    if (promises->expression) free_ast(promises->expression);
-                    free(promises);
-                    promises = next;
-                }
-            }
-            break;
-        case NODE_AWAIT_EXPRESSION:
-            if (node->data.await_expr.promise) free_ast(node->data.await_expr.promise);
-            break;
-        case NODE_C_STYLE_FOR: // Added case for C-style for
-            if (node->data.c_style_for.initializer) free_ast(node->data.c_style_for.initializer);
-            if (node->data.c_style_for.condition) free_ast(node->data.c_style_for.condition);
-            if (node->data.c_style_for.incrementer) free_ast(node->data.c_style_for.incrementer);
-            if (node->data.c_style_for.body) free_ast(node->data.c_style_for.body);
-            break;
-        case NODE_FOR_IN: // Renamed from NODE_FOR_LOOP
-            if (node->data.for_in.variable) free_ast(node->data.for_in.variable);
-            if (node->data.for_in.iterable) free_ast(node->data.for_in.iterable); // Renamed field
-            if (node->data.for_in.body) free_ast(node->data.for_in.body);
-            break;
-        case NODE_FOR_MAP: // Renamed from NODE_FOREACH_LOOP
-            if (node->data.for_map.key_var) free_ast(node->data.for_map.key_var);
-            if (node->data.for_map.value_var) free_ast(node->data.for_map.value_var);
-            if (node->data.for_map.map_expr) free_ast(node->data.for_map.map_expr); // Renamed field
-            if (node->data.for_map.body) free_ast(node->data.for_map.body);
-            break;
-        case NODE_RANGE:
-            if (node->data.range.start) free_ast(node->data.range.start);
-            if (node->data.range.end) free_ast(node->data.range.end);
-            break;
-        case NODE_MAP_LITERAL:
-            if (node->data.map_literal.entries) {
-                AST_Node* entry_node = node->data.map_literal.entries->head; // Start from head of AST_Node_List
-                while (entry_node) {
-                    AST_Node* next_node = entry_node->next; // Get next node before freeing current
-                    free_ast(entry_node); // Free the map entry node itself
-                    entry_node = next_node;
-                }
-            }
-            break;
-        case NODE_MAP_ENTRY:
-            if (node->data.map_entry.key) free_ast(node->data.map_entry.key); // Changed free to free_ast
-            if (node->data.map_entry.value) free_ast(node->data.map_entry.value);
-            break;
-        case NODE_FUNCTION:
-            if (node->data.function.name) free(node->data.function.name);
-            if (node->data.function.parameters) {
-                if (node->data.function.parameters->head) {
-                    free_ast(node->data.function.parameters->head);
-                }
-                free(node->data.function.parameters);
-            }
-            if (node->data.function.return_type) {
-                if (node->data.function.return_type->generic_type)
-                    free(node->data.function.return_type->generic_type);
-                if (node->data.function.return_type->name)
-                    free(node->data.function.return_type->name);
-                free(node->data.function.return_type);
-            }
-            if (node->data.function.guard) free(node->data.function.guard);
-            if (node->data.function.body) free_ast(node->data.function.body);
-            break;
-        case NODE_VARIABLE:
-            if (node->data.variable.name) free(node->data.variable.name);
-            if (node->data.variable.type) {
-                if (node->data.variable.type->generic_type)
-                    free(node->data.variable.type->generic_type);
-                if (node->data.variable.type->name)
-                    free(node->data.variable.type->name);
-                free(node->data.variable.type);
-            }
-            if (node->data.variable.initializer) free_ast(node->data.variable.initializer);
-            break;
-        case NODE_STRUCT:
-            if (node->data.struct_decl.name) free(node->data.struct_decl.name);
-            if (node->data.struct_decl.composition) {
-                if (node->data.struct_decl.composition->head) {
-                    free_ast(node->data.struct_decl.composition->head);
-                }
-                free(node->data.struct_decl.composition);
-            }
-            // Free struct fields
-            if (node->data.struct_decl.fields) {
-                StructField* field = node->data.struct_decl.fields->head;
-                while (field) {
-                    StructField* next = field->next;
-                    if (field->name) free(field->name);
-                    if (field->type) {
-                        if (field->type->generic_type)
-                            free(field->type->generic_type);
-                        if (field->type->name)
-                            free(field->type->name);
-                        free(field->type);
-                    }
-                    free(field);
-                    field = next;
-                }
-                free(node->data.struct_decl.fields);
-            }
-            break;
-        case NODE_TYPE_DECLARATION:
-            if (node->data.type_decl.name) free(node->data.type_decl.name);
-            if (node->data.type_decl.type) {
-                if (node->data.type_decl.type->generic_type)
-                    free(node->data.type_decl.type->generic_type);
-                if (node->data.type_decl.type->name)
-                    free(node->data.type_decl.type->name);
-                free(node->data.type_decl.type);
-            }
-            break;
-        case NODE_IMPORT:
-            if (node->data.import.filename) free(node->data.import.filename);
-            break;
-        case NODE_BINARY_OP:
-            if (node->data.binary_op.left) free_ast(node->data.binary_op.left);
-            if (node->data.binary_op.right) free_ast(node->data.binary_op.right);
-            break;
-        case NODE_UNARY_OP:
-            if (node->data.unary_op.operand) free_ast(node->data.unary_op.operand);
-            break;
-        case NODE_IF:
-            if (node->data.if_stmt.condition) free_ast(node->data.if_stmt.condition);
-            if (node->data.if_stmt.true_branch) free_ast(node->data.if_stmt.true_branch);
-            if (node->data.if_stmt.false_branch) free_ast(node->data.if_stmt.false_branch);
-            break;
-        case NODE_MATCH:
-            if (node->data.match_stmt.expression) free_ast(node->data.match_stmt.expression);
-            // Free match cases
-            if (node->data.match_stmt.cases) {
-                MatchCase* match_case = node->data.match_stmt.cases->head;
-                while (match_case) {
-                    MatchCase* next = match_case->next;
-                    if (match_case->pattern) free_ast(match_case->pattern);
-                    if (match_case->guard) free_ast(match_case->guard);
-                    if (match_case->body) free_ast(match_case->body);
-                    free(match_case);
-                    match_case = next;
-                }
-                free(node->data.match_stmt.cases);
-            }
-            break;
-        case NODE_RETURN:
-            if (node->data.return_stmt.expression) free_ast(node->data.return_stmt.expression);
-            break;
-        case NODE_ASSIGNMENT:
-            if (node->data.assignment.name) free(node->data.assignment.name);
-            if (node->data.assignment.value) free_ast(node->data.assignment.value);
-            break;
-        case NODE_FUNCTION_CALL:
-            if (node->data.function_call.name) free(node->data.function_call.name);
-            // Free arguments
-            if (node->data.function_call.arguments) {
-                ExpressionList* arg = node->data.function_call.arguments;
-                while (arg) {
-                    ExpressionList* next = arg->next;
-                    if (arg->expression) free_ast(arg->expression);
-                    free(arg);
-                    arg = next;
-                }
-            }
-            break;
-        case NODE_COMPOUND_STATEMENT:
-            if (node->data.compound_stmt.statements) {
-                if (node->data.compound_stmt.statements->head) {
-                    free_ast(node->data.compound_stmt.statements->head);
-                }
-                free(node->data.compound_stmt.statements);
-            }
-            break;
-        case NODE_LITERAL_INT:
-        case NODE_LITERAL_FLOAT:
-        case NODE_LITERAL_STRING:
-        case NODE_LITERAL_BOOL:
-            if (node->data.literal.value) free(node->data.literal.value);
-            break;
-        case NODE_LITERAL_ARRAY:
-            // Free array elements (reused function_call.arguments)
-            if (node->data.function_call.arguments) {
-                ExpressionList* elem = node->data.function_call.arguments;
-                while (elem) {
-                    ExpressionList* next = elem->next;
-                    if (elem->expression) free_ast(elem->expression);
-                    free(elem);
-                    elem = next;
-                }
-            }
-            break;
-        case NODE_IDENTIFIER:
-            if (node->data.identifier.name) free(node->data.identifier.name);
-            break;
-        case NODE_MEMBER_ACCESS:
-            if (node->data.member_access.object) free_ast(node->data.member_access.object);
-            if (node->data.member_access.member) free(node->data.member_access.member);
-            break;
-        case NODE_STRUCT_INIT:
-            if (node->data.struct_init.fields) {
-                if (node->data.struct_init.fields->head) {
-                    free_ast(node->data.struct_init.fields->head);
-                }
-                free(node->data.struct_init.fields);
-            }
-            break;
-        case NODE_SPREAD:
-            if (node->data.spread.expression) free_ast(node->data.spread.expression);
-            break;
-        case NODE_PIPE:
-            if (node->data.pipe.left) free_ast(node->data.pipe.left);
-            if (node->data.pipe.right) free_ast(node->data.pipe.right);
-            break;
-        case NODE_BINDING_PATTERN:
-            if (node->data.binding.name) free(node->data.binding.name);
-            if (node->data.binding.type) {
-                if (node->data.binding.type->generic_type)
-                    free(node->data.binding.type->generic_type);
-                if (node->data.binding.type->name)
-                    free(node->data.binding.type->name);
-                free(node->data.binding.type);
-            }
-            break;
-        case NODE_WILDCARD:
-            // Nothing to free
-            break;
-        case NODE_ANONYMOUS_FUNCTION:
-            // Skip freeing the parameters and return type for now to avoid memory errors
-            // This is a workaround - we'll need a proper fix later
-            if (node->data.anon_function.body) {
-                free_ast(node->data.anon_function.body);
-            }
-            break;
-        case NODE_WHILE_STATEMENT:
-            if (node->data.while_statement.condition) free_ast(node->data.while_statement.condition);
-            if (node->data.while_statement.body) free_ast(node->data.while_statement.body);
-            break;
-        case NODE_EXPRESSION:
-            // Generic expression, no special handling needed
-            break;
-    }
-    
-    // Free the node itself
-    free(node);
-}
@@ -1,6 +1,8 @@
 #ifndef AST_H
 #define AST_H
 
+#include "arena.h"
+
 // Node types
 typedef enum {
     NODE_PROGRAM,
@@ -88,7 +90,7 @@ typedef struct MatchCase_List MatchCase_List;
 
 // Type information
 struct TypeInfo {
-    char* name;
+    char* name;             // Interned (see intern.h): compare with ==
     TypeInfo* generic_type; // For types like array<int>, or key_type for map<key, value>
     TypeInfo* value_type;   // For value_type for map<key, value>
 };
@@ -418,7 +420,13 @@ MatchCase* create_match_case(AST_Node* pattern, AST_Node* guard, AST_Node* body)
 MatchCase_List* create_match_case_list(MatchCase* case_node);
 void append_match_case(MatchCase_List* list, MatchCase* case_node);
 
-// AST traversal and code generation declarations
-void free_ast(AST_Node* node);
+// Memory management: every node, list and TypeInfo of a compilation
+// unit is allocated from one arena, so the tree is freed by destroying
+// that arena instead of walking it. Set the arena before parsing and
+// keep it until code generation is done. Token strings are interned
+// (see intern.h) and outlive the arena. The current arena is per thread,
+// so threads can build separate units at the same time.
+void ast_set_arena(Arena* arena);
+Arena* ast_get_arena(void);
 
 #endif // AST_H
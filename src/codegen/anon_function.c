@@ -6,22 +6,21 @@
 #include "utils.h"
 #include "codegen.h"
 
-// Global array to store anonymous functions
-#define MAX_ANON_FUNCS 100
-static AnonFunction anon_funcs[MAX_ANON_FUNCS];
-static int anon_func_count = 0;
-
-// Global array to store anonymous function forward declarations
-static char* anon_func_decls[MAX_ANON_FUNCS] = {0};
-
-// Function to add a new anonymous function
-int add_anon_function(const char* name, const char* return_type, const char* param_list, const char* param_types, const char* body) {
-    if (anon_func_count >= MAX_ANON_FUNCS) {
-        fprintf(stderr, "Too many anonymous functions\n");
-        return -1;
+// Function to add a new anonymous function to the unit being generated
+int add_anon_function(CodeGenContext* ctx, const char* name, const char* return_type, const char* param_list, const char* param_types, const char* body) {
+    if (ctx->anon_func_count == ctx->anon_func_capacity) {
+        int capacity = ctx->anon_func_capacity ? ctx->anon_func_capacity * 2 : 16;
+        AnonFunction* funcs = (AnonFunction*)realloc(ctx->anon_funcs, capacity * sizeof(AnonFunction));
+        if (!funcs) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        ctx->anon_funcs = funcs;
+        ctx->anon_func_capacity = capacity;
     }
     
-    int idx = anon_func_count++;
+    AnonFunction* anon_funcs = ctx->anon_funcs;
+    int idx = ctx->anon_func_count++;
     anon_funcs[idx].name = strdup(name);
     
     // Normalize types for anonymous functions used in promises
@@ -67,11 +66,10 @@ int add_anon_function(const char* name, const char* return_type, const char* par
 
 // Generate code for anonymous function
 void generate_anonymous_function(CodeGenContext* ctx, AST_Node* node) {
-    static int anon_func_counter = 0;
     char func_name[64];
     
-    // Create a unique function name
-    snprintf(func_name, sizeof(func_name), "__anon_func_%d", anon_func_counter++);
+    // Create a name unique within the unit; the function itself is static
+    snprintf(func_name, sizeof(func_name), "__anon_func_%d", ctx->anon_func_counter++);
     
     // Get the return type
     char* return_type = get_c_type(node->data.anon_function.return_type);
@@ -112,6 +110,11 @@ void generate_anonymous_function(CodeGenContext* ctx, AST_Node* node) {
     FILE* old_output = ctx->output;
     ctx->output = body_stream;
     
+    // The body is a separate C function; it is not part of the enclosing
+    // function's ownership pass
+    ArcFunction* old_arc = ctx->arc;
+    ctx->arc = NULL;
+    
     fprintf(ctx->output, "{\n");
     increase_indent(ctx);
     
@@ -134,18 +137,10 @@ void generate_anonymous_function(CodeGenContext* ctx, AST_Node* node) {
     fflush(body_stream);
     fclose(body_stream);
     ctx->output = old_output;
+    ctx->arc = old_arc;
     
-    // Add the anonymous function to our global list
-    add_anon_function(func_name, return_type, param_list, param_types, ctx->buffer);
-    
-    // Add it to the declaration array
-    char decl[1024];
-    sprintf(decl, "%s %s(%s);", return_type, func_name, param_list);
-    
-    if (anon_func_decls[anon_func_count-1])
-        free(anon_func_decls[anon_func_count-1]);
-        
-    anon_func_decls[anon_func_count-1] = strdup(decl);
+    // Add the anonymous function to the unit's list
+    add_anon_function(ctx, func_name, return_type, param_list, param_types, ctx->buffer);
     
     // Output just the function name 
     fprintf(ctx->output, "%s", func_name);
@@ -157,36 +152,43 @@ void generate_anonymous_function(CodeGenContext* ctx, AST_Node* node) {
 }
 
 // Generate code for all anonymous functions at program level
-void generate_all_anon_functions(FILE* output) {
+void generate_all_anon_functions(CodeGenContext* ctx) {
+    FILE* output = ctx->output;
+    AnonFunction* anon_funcs = ctx->anon_funcs;
+    
     // First, forward declare all anonymous functions
-    for (int i = 0; i < anon_func_count; i++) {
+    for (int i = 0; i < ctx->anon_func_count; i++) {
         fprintf(output, "// Forward declaration of anonymous function\n");
-        fprintf(output, "%s %s(%s);\n", 
+        fprintf(output, "static %s %s(%s);\n", 
                 anon_funcs[i].return_type, 
                 anon_funcs[i].name, 
                 anon_funcs[i].param_list);
-        
-        // Store the declaration for global access
-        if (anon_func_decls[i])
-            free(anon_func_decls[i]);
-            
-        char decl[1024];
-        sprintf(decl, "%s %s(%s);", 
-                anon_funcs[i].return_type, 
-                anon_funcs[i].name, 
-                anon_funcs[i].param_list);
-        anon_func_decls[i] = strdup(decl);
     }
     
     fprintf(output, "\n");
     
     // Then output the function implementations
-    for (int i = 0; i < anon_func_count; i++) {
+    for (int i = 0; i < ctx->anon_func_count; i++) {
         fprintf(output, "// Anonymous function definition\n");
-        fprintf(output, "%s %s(%s) %s\n\n", 
+        fprintf(output, "static %s %s(%s) %s\n\n", 
                 anon_funcs[i].return_type, 
                 anon_funcs[i].name, 
                 anon_funcs[i].param_list,
                 anon_funcs[i].body);
     }
 }
+
+// Free the unit's anonymous functions
+void cleanup_anon_functions(CodeGenContext* ctx) {
+    for (int i = 0; i < ctx->anon_func_count; i++) {
+        free(ctx->anon_funcs[i].name);
+        free(ctx->anon_funcs[i].return_type);
+        free(ctx->anon_funcs[i].param_list);
+        free(ctx->anon_funcs[i].param_types);
+        free(ctx->anon_funcs[i].body);
+    }
+    free(ctx->anon_funcs);
+    ctx->anon_funcs = NULL;
+    ctx->anon_func_count = 0;
+    ctx->anon_func_capacity = 0;
+}
@@ -6,6 +6,7 @@
 #include "statement.h"
 #include "declaration.h"
 #include "anon_function.h"
+#include "ownership.h"
 #include "utils.h"
 
 // Main code generation function
@@ -56,6 +57,9 @@ void generate_code(CodeGenContext* ctx, AST_Node* node) {
             generate_while_statement(ctx, node);
             break;
         default:
+            if (arc_discard_statement(ctx, node)) {
+                break;
+            }
             generate_expression(ctx, node);
             fprintf(ctx->output, ";\n");
             break;
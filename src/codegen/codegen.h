@@ -20,6 +20,6 @@ typedef struct CodeGenContext CodeGenContext;
 void generate_code(CodeGenContext* ctx, AST_Node* node);
 
 // Generate all anonymous functions at program level
-void generate_all_anon_functions(FILE* output);
+void generate_all_anon_functions(CodeGenContext* ctx);
 
 #endif // CODEGEN_H
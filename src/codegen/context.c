@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include "context.h"
+#include "ownership.h"
+#include "anon_function.h"
 
 // Initialize code generation context
 CodeGenContext* init_codegen(FILE* output) {
@@ -19,6 +21,17 @@ CodeGenContext* init_codegen(FILE* output) {
     ctx->buffer = NULL;
     ctx->buffer_size = 0;
     ctx->in_async_function = 0; // Initialize to not in async function
+    ctx->program = NULL;
+    ctx->arc = NULL;
+    ctx->arc_structs = NULL;
+    memset(&ctx->arc_stats, 0, sizeof(ctx->arc_stats));
+    ctx->anon_funcs = NULL;
+    ctx->anon_func_count = 0;
+    ctx->anon_func_capacity = 0;
+    ctx->anon_func_counter = 0;
+    ctx->string_concat_added = 0;
+    ctx->imports = NULL;
+    ctx->import_count = 0;
     
     return ctx;
 }
@@ -34,6 +47,9 @@ void cleanup_codegen(CodeGenContext* ctx) {
             free(ctx->buffer);
         }
         
+        arc_cleanup(ctx);
+        cleanup_anon_functions(ctx);
+        
         free(ctx);
     }
 }
@@ -4,6 +4,28 @@
 #include <stdio.h>
 #include "../symtab.h"
 
+// Counters for ARC operations, reported in verbose mode. "Naive" is what a
+// scheme that retains every copy and releases every managed variable on
+// every exit path would emit; the difference was removed by the ownership pass.
+typedef struct {
+    int retains_emitted;
+    int releases_emitted;
+    int retains_naive;
+    int releases_naive;
+} ArcStats;
+
+typedef struct ArcFunction ArcFunction;
+typedef struct ArcStructInfo ArcStructInfo;
+typedef struct AnonFunction AnonFunction;
+
+// A Zeno module imported by the unit being generated. Units generated on
+// their own have none and keep `import` as a plain #include.
+typedef struct {
+    const char* filename;   // Import string as written, quotes included
+    const char* header;     // Header generated for the module
+    AST_Node* program;      // The module's parsed program
+} CodeGenImport;
+
 // Code generation context
 typedef struct CodeGenContext {
     FILE* output;           // Output file
@@ -14,6 +36,17 @@ typedef struct CodeGenContext {
     char* buffer;           // Temporary buffer for string operations
     size_t buffer_size;     // Size of the temporary buffer
     int in_async_function;  // Flag to indicate we're inside an async function
+    AST_Node* program;      // Program being generated, for struct field lookups
+    ArcFunction* arc;       // Ownership state of the function being generated
+    ArcStructInfo* arc_structs; // Structs seen so far and whether they need ARC helpers
+    ArcStats arc_stats;     // Retain/release operations emitted and elided
+    AnonFunction* anon_funcs;   // Anonymous functions lifted to file scope
+    int anon_func_count;        // Number of lifted anonymous functions
+    int anon_func_capacity;     // Allocated size of anon_funcs
+    int anon_func_counter;      // Next __anon_func_N suffix
+    int string_concat_added;    // Whether the string_concat helper was emitted
+    CodeGenImport* imports;     // Zeno modules imported by this unit
+    int import_count;           // Number of entries in imports
 } CodeGenContext;
 
 // Initialize code generation context
@@ -5,16 +5,120 @@
 #include "expression.h"
 #include "statement.h"
 #include "utils.h"
+#include "ownership.h"
 #include "anon_function.h"
 #include "codegen.h"
 
+// The Zeno module an import refers to, if the unit was given one
+static const CodeGenImport* find_import(CodeGenContext* ctx, const char* filename) {
+    for (int i = 0; i < ctx->import_count; i++) {
+        if (strcmp(ctx->imports[i].filename, filename) == 0) {
+            return &ctx->imports[i];
+        }
+    }
+    return NULL;
+}
+
+// Whether a struct composes Entity (whose fields are hard-coded for User)
+static int struct_has_entity_fields(AST_Node* node) {
+    if (strcmp(node->data.struct_decl.name, "User") != 0 || !node->data.struct_decl.composition) {
+        return 0;
+    }
+    for (AST_Node* base = node->data.struct_decl.composition->head; base; base = base->next) {
+        if (base->type == NODE_IDENTIFIER && strcmp(base->data.identifier.name, "Entity") == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Register what an imported module's header declares, as if the unit had
+// declared it: functions, structs, type aliases and typed globals
+static void declare_import(CodeGenContext* ctx, AST_Node* program) {
+    AST_Node* decl = program->data.program.declarations->head;
+    while (decl) {
+        char* name = NULL;
+        switch (decl->type) {
+            case NODE_FUNCTION:
+                name = decl->data.function.name;
+                break;
+            case NODE_STRUCT:
+                name = decl->data.struct_decl.name;
+                break;
+            case NODE_TYPE_DECLARATION:
+                name = decl->data.type_decl.name;
+                break;
+            case NODE_VARIABLE:
+                name = decl->data.variable.type ? decl->data.variable.name : NULL;
+                break;
+            default:
+                break;
+        }
+        
+        // The unit's own declarations and earlier imports take precedence
+        if (name && !lookup_interned_symbol(ctx->symtab, name)) {
+            if (decl->type == NODE_FUNCTION) {
+                add_symbol(ctx->symtab, name, SYMBOL_FUNCTION,
+                           decl->data.function.is_async ? NULL : decl->data.function.return_type);
+            } else if (decl->type == NODE_STRUCT) {
+                add_symbol(ctx->symtab, name, SYMBOL_STRUCT, NULL);
+                arc_declare_struct(ctx, decl, struct_has_entity_fields(decl));
+            } else if (decl->type == NODE_TYPE_DECLARATION) {
+                add_symbol(ctx->symtab, name, SYMBOL_TYPE, decl->data.type_decl.type);
+            } else {
+                add_symbol(ctx->symtab, name, SYMBOL_VARIABLE, decl->data.variable.type);
+            }
+        }
+        decl = decl->next;
+    }
+}
+
+// Declare a function without defining it, as generate_function spells it
+static void generate_function_prototype(CodeGenContext* ctx, AST_Node* node) {
+    if (strcmp(node->data.function.name, "print_user_details") == 0) {
+        fprintf(ctx->output, "void print_user_details(struct User user);\n");
+        return;
+    }
+    
+    char* return_type = node->data.function.is_async ? strdup("zn_promise_t*")
+                                                     : get_c_type(node->data.function.return_type);
+    fprintf(ctx->output, "%s %s(", return_type, node->data.function.name);
+    
+    AST_Node* param = node->data.function.parameters->head;
+    if (!param) {
+        fprintf(ctx->output, "void");
+    }
+    while (param) {
+        char* param_type = get_c_type(param->data.variable.type);
+        fprintf(ctx->output, "%s %s%s", param_type, param->data.variable.name, param->next ? ", " : "");
+        free(param_type);
+        param = param->next;
+    }
+    fprintf(ctx->output, ");\n");
+    
+    free(return_type);
+}
+
+// Declare the tag of every struct a program defines, so that prototypes
+// can name struct types before their definitions
+static void generate_struct_tags(CodeGenContext* ctx, AST_Node* program) {
+    AST_Node* decl = program->data.program.declarations->head;
+    while (decl) {
+        if (decl->type == NODE_STRUCT) {
+            fprintf(ctx->output, "struct %s;\n", decl->data.struct_decl.name);
+        }
+        decl = decl->next;
+    }
+}
+
 // Generate code for program node
 void generate_program(CodeGenContext* ctx, AST_Node* node) {
     // Add standard includes
     fprintf(ctx->output, "#include <stdio.h>\n");
     fprintf(ctx->output, "#include <stdlib.h>\n");
     fprintf(ctx->output, "#include <string.h>\n");
-    fprintf(ctx->output, "#include <stdbool.h>\n\n");
+    fprintf(ctx->output, "#include <stdbool.h>\n");
+    fprintf(ctx->output, "#include \"zeno_string.h\"\n\n");
     
     // Use void* for any type to avoid type conflicts
     fprintf(ctx->output, "// Use void* for generic data in anonymous functions\n");
@@ -27,13 +131,38 @@ void generate_program(CodeGenContext* ctx, AST_Node* node) {
     fprintf(ctx->output, "typedef void* (*zn_catch_handler_t)(void*);\n");
     fprintf(ctx->output, "typedef void (*zn_finally_handler_t)(void);\n\n");
     
-    // Add promise-related functions
+    // Add promise-related functions; every unit carries its own copy, so
+    // they are static to keep units of one program linkable together
     fprintf(ctx->output, "// Forward declaration of promise functions\n");
-    fprintf(ctx->output, "zn_promise_t* zn_promise_then(zn_promise_t* promise, zn_then_handler_t handler);\n");
-    fprintf(ctx->output, "zn_promise_t* zn_promise_catch(zn_promise_t* promise, zn_catch_handler_t handler);\n");
-    fprintf(ctx->output, "zn_promise_t* zn_promise_finally(zn_promise_t* promise, zn_finally_handler_t handler);\n");
-    fprintf(ctx->output, "void* zn_promise_await(zn_promise_t* promise);\n");
-    fprintf(ctx->output, "zn_promise_t* promise_all(zn_promise_t** promises, int count);\n\n");
+    fprintf(ctx->output, "static inline zn_promise_t* zn_promise_then(zn_promise_t* promise, zn_then_handler_t handler);\n");
+    fprintf(ctx->output, "static inline zn_promise_t* zn_promise_catch(zn_promise_t* promise, zn_catch_handler_t handler);\n");
+    fprintf(ctx->output, "static inline zn_promise_t* zn_promise_finally(zn_promise_t* promise, zn_finally_handler_t handler);\n");
+    fprintf(ctx->output, "static inline void* zn_promise_await(zn_promise_t* promise);\n");
+    fprintf(ctx->output, "static inline zn_promise_t* promise_all(zn_promise_t** promises, int count);\n\n");
+    
+    // Register every function up front so calls that precede the
+    // definition still know the callee's parameter and return types
+    ctx->program = node;
+    AST_Node* function = node->data.program.declarations->head;
+    while (function) {
+        if (function->type == NODE_FUNCTION) {
+            add_symbol(ctx->symtab, function->data.function.name, SYMBOL_FUNCTION,
+                       function->data.function.is_async ? NULL : function->data.function.return_type);
+        }
+        function = function->next;
+    }
+    
+    // Then what the unit's Zeno imports declare in their headers
+    AST_Node* import = node->data.program.declarations->head;
+    while (import) {
+        if (import->type == NODE_IMPORT) {
+            const CodeGenImport* module = find_import(ctx, import->data.import.filename);
+            if (module) {
+                declare_import(ctx, module->program);
+            }
+        }
+        import = import->next;
+    }
     
     // Store statements for later output
     char* stmt_buffer = NULL;
@@ -55,21 +184,30 @@ void generate_program(CodeGenContext* ctx, AST_Node* node) {
     // Now we can first generate all anon function forward declarations
     // followed by their implementations, and finally the rest of the program
     
-    // Extract forward declarations for regular functions
+    // Prototypes of the unit's functions, which anonymous functions and
+    // earlier definitions may call; struct types are defined further down
     fprintf(ctx->output, "// Forward declarations of main functions\n");
-    fprintf(ctx->output, "char* processData(char* data);\n");
-    fprintf(ctx->output, "char* handleError(char* error);\n");
-    fprintf(ctx->output, "void cleanup(void);\n");
-    fprintf(ctx->output, "int main(void);\n\n");
+    generate_struct_tags(ctx, node);
+    for (int i = 0; i < ctx->import_count; i++) {
+        generate_struct_tags(ctx, ctx->imports[i].program);
+    }
+    function = node->data.program.declarations->head;
+    while (function) {
+        if (function->type == NODE_FUNCTION) {
+            generate_function_prototype(ctx, function);
+        }
+        function = function->next;
+    }
+    fprintf(ctx->output, "\n");
     
     // Add Promise-related function implementations
     fprintf(ctx->output, "// Promise helper functions\n");
-    fprintf(ctx->output, "zn_promise_t* zn_promise_resolve(void* value) {\n");
+    fprintf(ctx->output, "static inline zn_promise_t* zn_promise_resolve(void* value) {\n");
     fprintf(ctx->output, "    // Simulate a resolved promise\n");
     fprintf(ctx->output, "    return (zn_promise_t*)value;\n");
     fprintf(ctx->output, "}\n\n");
     
-    fprintf(ctx->output, "zn_promise_t* zn_promise_then(zn_promise_t* promise, zn_then_handler_t handler) {\n");
+    fprintf(ctx->output, "static inline zn_promise_t* zn_promise_then(zn_promise_t* promise, zn_then_handler_t handler) {\n");
     fprintf(ctx->output, "    // Execute handler with the promise's value\n");
     fprintf(ctx->output, "    if (handler && promise) {\n");
     fprintf(ctx->output, "        void* result = handler(promise);\n");
@@ -78,12 +216,12 @@ void generate_program(CodeGenContext* ctx, AST_Node* node) {
     fprintf(ctx->output, "    return promise;\n");
     fprintf(ctx->output, "}\n\n");
 
-    fprintf(ctx->output, "zn_promise_t* zn_promise_catch(zn_promise_t* promise, zn_catch_handler_t handler) {\n");
+    fprintf(ctx->output, "static inline zn_promise_t* zn_promise_catch(zn_promise_t* promise, zn_catch_handler_t handler) {\n");
     fprintf(ctx->output, "    // Since we're just simulating, we'll return the promise\n");
     fprintf(ctx->output, "    return promise;\n");
     fprintf(ctx->output, "}\n\n");
 
-    fprintf(ctx->output, "zn_promise_t* zn_promise_finally(zn_promise_t* promise, zn_finally_handler_t handler) {\n");
+    fprintf(ctx->output, "static inline zn_promise_t* zn_promise_finally(zn_promise_t* promise, zn_finally_handler_t handler) {\n");
     fprintf(ctx->output, "    // Call cleanup function in any case\n");
     fprintf(ctx->output, "    if (handler) {\n");
     fprintf(ctx->output, "        handler();\n");
@@ -91,12 +229,12 @@ void generate_program(CodeGenContext* ctx, AST_Node* node) {
     fprintf(ctx->output, "    return promise;\n");
     fprintf(ctx->output, "}\n\n");
 
-    fprintf(ctx->output, "void* zn_promise_await(zn_promise_t* promise) {\n");
+    fprintf(ctx->output, "static inline void* zn_promise_await(zn_promise_t* promise) {\n");
     fprintf(ctx->output, "    // Simply return the value as if we've waited for it\n");
     fprintf(ctx->output, "    return promise;\n");
     fprintf(ctx->output, "}\n\n");
 
-    fprintf(ctx->output, "zn_promise_t* promise_all(zn_promise_t** promises, int count) {\n");
+    fprintf(ctx->output, "static inline zn_promise_t* promise_all(zn_promise_t** promises, int count) {\n");
     fprintf(ctx->output, "    // Return the first promise as a simplification\n");
     fprintf(ctx->output, "    if (count > 0) {\n");
     fprintf(ctx->output, "        return promises[0];\n");
@@ -105,7 +243,7 @@ void generate_program(CodeGenContext* ctx, AST_Node* node) {
     fprintf(ctx->output, "}\n\n");
     
     // Generate forward declarations for the anonymous functions
-    generate_all_anon_functions(ctx->output);
+    generate_all_anon_functions(ctx);
     
     // Now output the rest of the program
     fprintf(ctx->output, "%s", stmt_buffer);
@@ -118,9 +256,9 @@ void generate_function(CodeGenContext* ctx, AST_Node* node) {
     if (strcmp(node->data.function.name, "print_user_details") == 0) {
         // Generate a fixed implementation for print_user_details
         fprintf(ctx->output, "void print_user_details(struct User user) {\n");
-        fprintf(ctx->output, "    printf(\"User ID: %%s\\n\", user.id);\n");
-        fprintf(ctx->output, "    printf(\"Name: %%s\\n\", user.name);\n");
-        fprintf(ctx->output, "    printf(\"Email: %%s\\n\", user.email);\n");
+        fprintf(ctx->output, "    printf(\"User ID: %%s\\n\", ZN_CSTR(user.id));\n");
+        fprintf(ctx->output, "    printf(\"Name: %%s\\n\", ZN_CSTR(user.name));\n");
+        fprintf(ctx->output, "    printf(\"Email: %%s\\n\", ZN_CSTR(user.email));\n");
         fprintf(ctx->output, "    printf(\"Created: %%d\\n\", user.created_at);\n");
         fprintf(ctx->output, "    if (user.active) {\n");
         fprintf(ctx->output, "        printf(\"Status: Active\\n\");\n");
@@ -146,10 +284,9 @@ void generate_function(CodeGenContext* ctx, AST_Node* node) {
         return_type = strdup("zn_promise_t*");
         
         // For async functions, add helper for string concatenation
-        static int string_concat_helper_added = 0;
-        if (!string_concat_helper_added) {
+        if (!ctx->string_concat_added) {
             fprintf(ctx->output, "// Helper for string concatenation\n");
-            fprintf(ctx->output, "char* string_concat(const char* str1, const char* str2) {\n");
+            fprintf(ctx->output, "static inline char* string_concat(const char* str1, const char* str2) {\n");
             fprintf(ctx->output, "    size_t len1 = strlen(str1);\n");
             fprintf(ctx->output, "    size_t len2 = strlen(str2);\n");
             fprintf(ctx->output, "    char* result = (char*)malloc(len1 + len2 + 1);\n");
@@ -159,7 +296,7 @@ void generate_function(CodeGenContext* ctx, AST_Node* node) {
             fprintf(ctx->output, "    }\n");
             fprintf(ctx->output, "    return result;\n");
             fprintf(ctx->output, "}\n\n");
-            string_concat_helper_added = 1;
+            ctx->string_concat_added = 1;
         }
     } else {
         return_type = get_c_type(node->data.function.return_type);
@@ -168,8 +305,12 @@ void generate_function(CodeGenContext* ctx, AST_Node* node) {
     // Start function declaration
     fprintf(ctx->output, "%s %s(", return_type, node->data.function.name);
     
-    // Add function to symbol table (pass NULL for type_info)
-    add_symbol(ctx->symtab, node->data.function.name, SYMBOL_FUNCTION, NULL); 
+    // Add function to symbol table unless generate_program already registered it
+    SymbolEntry* existing = lookup_interned_symbol(ctx->symtab, node->data.function.name);
+    if (!existing || existing->type != SYMBOL_FUNCTION) {
+        add_symbol(ctx->symtab, node->data.function.name, SYMBOL_FUNCTION,
+                   is_async ? NULL : node->data.function.return_type);
+    }
     
     // Create new scope for parameters
     enter_scope(ctx->symtab);
@@ -218,8 +359,8 @@ void generate_function(CodeGenContext* ctx, AST_Node* node) {
                 fprintf(ctx->output, "return 0;\n");
             } else if (strcmp(return_type, "float") == 0) {
                 fprintf(ctx->output, "return 0.0;\n");
-            } else if (strcmp(return_type, "char*") == 0) {
-                fprintf(ctx->output, "return NULL;\n");
+            } else if (strcmp(return_type, "zn_string_t") == 0) {
+                fprintf(ctx->output, "return ZN_STRING_EMPTY;\n");
             } else {
                 // For custom types, return NULL or empty struct
                 fprintf(ctx->output, "return (%s){0};\n", return_type);
@@ -235,6 +376,11 @@ void generate_function(CodeGenContext* ctx, AST_Node* node) {
     
     // Generate function body
     if (node->data.function.body) {
+        // Async functions hand their values to promises and are not tracked
+        if (!is_async && node->data.function.body->type == NODE_COMPOUND_STATEMENT) {
+            arc_begin_function(ctx, node, return_type);
+        }
+
         if (node->data.function.body->type == NODE_COMPOUND_STATEMENT) {
             // For compound statements, we generate the contents directly
             generate_compound_statement_contents(ctx, node->data.function.body);
@@ -243,6 +389,8 @@ void generate_function(CodeGenContext* ctx, AST_Node* node) {
             indent(ctx);
             generate_code(ctx, node->data.function.body);
         }
+
+        arc_end_function(ctx);
     }
     
     // Exit function scope
@@ -276,7 +424,7 @@ void generate_variable(CodeGenContext* ctx, AST_Node* node) {
                 var_type = strdup("float");
                 break;
             case NODE_LITERAL_STRING:
-                var_type = strdup("char*");
+                var_type = strdup("zn_string_t");
                 break;
             case NODE_LITERAL_BOOL:
                 var_type = strdup("int");
@@ -372,13 +520,20 @@ void generate_variable(CodeGenContext* ctx, AST_Node* node) {
         if (node->data.variable.name && strcmp(node->data.variable.name, "user") == 0 &&
             node->data.variable.type && strcmp(node->data.variable.type->name, "User") == 0) {
             // Generate a fully initialized User struct with the proper fields
-            fprintf(ctx->output, "{\"user-123\", \"Alice\", 1678234511, 1678234511, \"alice@example.com\", 1}");
+            fprintf(ctx->output, "{");
+            generate_string_literal(ctx, "\"user-123\"");
+            fprintf(ctx->output, ", ");
+            generate_string_literal(ctx, "\"Alice\"");
+            fprintf(ctx->output, ", 1678234511, 1678234511, ");
+            generate_string_literal(ctx, "\"alice@example.com\"");
+            fprintf(ctx->output, ", 1}");
         } else {
             generate_expression(ctx, node->data.variable.initializer);
         }
     }
     
     fprintf(ctx->output, ";\n");
+    arc_declare_variable(ctx, node);
     
     free(var_type);
 }
@@ -406,9 +561,9 @@ void generate_struct(CodeGenContext* ctx, AST_Node* node) {
                 if (strcmp(node->data.struct_decl.name, "User") == 0) {
                     if (strcmp(base->data.identifier.name, "Entity") == 0) {
                         indent(ctx);
-                        fprintf(ctx->output, "char* id;\n");
+                        fprintf(ctx->output, "zn_string_t id;\n");
                         indent(ctx);
-                        fprintf(ctx->output, "char* name;\n");
+                        fprintf(ctx->output, "zn_string_t name;\n");
                     } else if (strcmp(base->data.identifier.name, "Timestamps") == 0) {
                         indent(ctx);
                         fprintf(ctx->output, "int created_at;\n");
@@ -440,12 +595,16 @@ void generate_struct(CodeGenContext* ctx, AST_Node* node) {
     decrease_indent(ctx);
     fprintf(ctx->output, "};\n\n");
     
+    // Structs holding strings get retain/release helpers for the ownership pass
+    arc_emit_struct_helpers(ctx, node, struct_has_entity_fields(node));
+    
     // Generate the appropriate print function
     if (strcmp(node->data.struct_decl.name, "User") == 0) {
         // Skip the function declaration - it will be in the user's original code
     } else {
-        // Default print function for other structs
-        fprintf(ctx->output, "void print_%s_details(struct %s item) {\n", 
+        // Default print function for other structs, static like the ARC
+        // helpers since module headers repeat it in every importer
+        fprintf(ctx->output, "static inline void print_%s_details(struct %s item) {\n", 
                 node->data.struct_decl.name, node->data.struct_decl.name);
         increase_indent(ctx);
         
@@ -474,5 +633,58 @@ void generate_type_declaration(CodeGenContext* ctx, AST_Node* node) {
 
 // Generate code for import
 void generate_import(CodeGenContext* ctx, AST_Node* node) {
+    // Zeno modules are included through their generated headers
+    const CodeGenImport* module = find_import(ctx, node->data.import.filename);
+    if (module) {
+        fprintf(ctx->output, "#include \"%s\"\n", module->header);
+        return;
+    }
+    
     fprintf(ctx->output, "#include %s\n", node->data.import.filename);
 }
+
+// Generate the header other units include to use a module: its structs,
+// type aliases, function prototypes and typed globals
+void generate_module_header(CodeGenContext* ctx, AST_Node* node, const char* guard) {
+    fprintf(ctx->output, "#ifndef %s\n", guard);
+    fprintf(ctx->output, "#define %s\n\n", guard);
+    fprintf(ctx->output, "#include <stdio.h>\n");
+    fprintf(ctx->output, "#include <stdbool.h>\n");
+    fprintf(ctx->output, "#include \"zeno_string.h\"\n\n");
+    
+    // Repeated identically by every unit that includes the header
+    fprintf(ctx->output, "typedef void* any_t;\n");
+    fprintf(ctx->output, "typedef struct zn_promise zn_promise_t;\n\n");
+    
+    ctx->program = node;
+    
+    // Types come first, in source order, so that prototypes can use them
+    AST_Node* decl = node->data.program.declarations->head;
+    while (decl) {
+        if (decl->type == NODE_IMPORT) {
+            generate_import(ctx, decl);
+        } else if (decl->type == NODE_STRUCT) {
+            generate_struct(ctx, decl);
+        } else if (decl->type == NODE_TYPE_DECLARATION) {
+            generate_type_declaration(ctx, decl);
+        }
+        decl = decl->next;
+    }
+    fprintf(ctx->output, "\n");
+    
+    decl = node->data.program.declarations->head;
+    while (decl) {
+        if (decl->type == NODE_FUNCTION && strcmp(decl->data.function.name, "main") != 0) {
+            generate_function_prototype(ctx, decl);
+        } else if (decl->type == NODE_VARIABLE && decl->data.variable.type) {
+            char* var_type = get_c_type(decl->data.variable.type);
+            fprintf(ctx->output, "extern %s%s %s;\n",
+                    decl->data.variable.var_type == VAR_CONST ? "const " : "",
+                    var_type, decl->data.variable.name);
+            free(var_type);
+        }
+        decl = decl->next;
+    }
+    
+    fprintf(ctx->output, "\n#endif // %s\n", guard);
+}
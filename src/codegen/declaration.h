@@ -11,5 +11,6 @@ void generate_variable(CodeGenContext* ctx, AST_Node* node);
 void generate_struct(CodeGenContext* ctx, AST_Node* node);
 void generate_type_declaration(CodeGenContext* ctx, AST_Node* node);
 void generate_import(CodeGenContext* ctx, AST_Node* node);
+void generate_module_header(CodeGenContext* ctx, AST_Node* node, const char* guard);
 
 #endif // CODEGEN_DECLARATION_H
@@ -4,11 +4,29 @@
 #include "expression.h"
 #include "anon_function.h"
 #include "utils.h"
+#include "ownership.h"
+#include "../zeno_string.h"
+
+// Pass a string by address: variables directly, so comparisons do not copy
+// them on every evaluation, other values through a compound literal
+static void generate_string_operand(CodeGenContext* ctx, AST_Node* node) {
+    if (node->type == NODE_IDENTIFIER) {
+        fprintf(ctx->output, "&");
+        generate_expression(ctx, node);
+    } else {
+        fprintf(ctx->output, "(zn_string_t[]){ ");
+        generate_expression(ctx, node);
+        fprintf(ctx->output, " }");
+    }
+}
 
 // Generate code for expression
 void generate_expression(CodeGenContext* ctx, AST_Node* node) {
     if (!node) return;
     
+    // Owned values hoisted by the ownership pass are referenced by name
+    if (arc_emit_temporary(ctx, node)) return;
+    
     switch (node->type) {
         case NODE_ANONYMOUS_FUNCTION:
             generate_anonymous_function(ctx, node);
@@ -21,8 +39,7 @@ void generate_expression(CodeGenContext* ctx, AST_Node* node) {
             break;
             
         case NODE_LITERAL_STRING:
-            // Make sure string literals are properly quoted
-            fprintf(ctx->output, "%s", node->data.literal.value);
+            generate_string_literal(ctx, node->data.literal.value);
             break;
             
         case NODE_IDENTIFIER:
@@ -35,6 +52,11 @@ void generate_expression(CodeGenContext* ctx, AST_Node* node) {
             fprintf(ctx->output, ".%s", node->data.member_access.member);
             break;
             
+        case NODE_ASSIGNMENT:
+            fprintf(ctx->output, "%s = ", node->data.assignment.name);
+            generate_expression(ctx, node->data.assignment.value);
+            break;
+            
         case NODE_STRUCT_INIT: {
             // Create a default struct initialization with zeros
             // Note: This is a simplification that doesn't properly handle struct initialization,
@@ -46,22 +68,32 @@ void generate_expression(CodeGenContext* ctx, AST_Node* node) {
         case NODE_BINARY_OP: {
             // Special handling for string concatenation using "+" operator
             if (node->data.binary_op.op == OP_ADD &&
-                (node->data.binary_op.left->type == NODE_LITERAL_STRING || 
-                 node->data.binary_op.right->type == NODE_LITERAL_STRING)) {
-                // In the context of an async function return, wrap with a promise resolver
+                (is_string_expression(ctx, node->data.binary_op.left) || 
+                 is_string_expression(ctx, node->data.binary_op.right))) {
+                // In the context of an async function return, wrap with a promise resolver.
+                // Promise values are plain C strings, so use the C helper there.
                 if (ctx->in_async_function) {
                     fprintf(ctx->output, "zn_promise_resolve(string_concat(");
-                    generate_expression(ctx, node->data.binary_op.left);
+                    generate_c_string_argument(ctx, node->data.binary_op.left);
                     fprintf(ctx->output, ", ");
-                    generate_expression(ctx, node->data.binary_op.right);
+                    generate_c_string_argument(ctx, node->data.binary_op.right);
                     fprintf(ctx->output, "))");
                 } else {
-                    fprintf(ctx->output, "string_concat(");
+                    fprintf(ctx->output, "zn_string_concat(");
                     generate_expression(ctx, node->data.binary_op.left);
                     fprintf(ctx->output, ", ");
                     generate_expression(ctx, node->data.binary_op.right);
                     fprintf(ctx->output, ")");
                 }
+            } else if ((node->data.binary_op.op == OP_EQ || node->data.binary_op.op == OP_NEQ) &&
+                       is_string_expression(ctx, node->data.binary_op.left) &&
+                       is_string_expression(ctx, node->data.binary_op.right)) {
+                // String equality: pointer compare for interned strings, word compare for short ones
+                fprintf(ctx->output, "%szn_string_equals(", node->data.binary_op.op == OP_NEQ ? "!" : "");
+                generate_string_operand(ctx, node->data.binary_op.left);
+                fprintf(ctx->output, ", ");
+                generate_string_operand(ctx, node->data.binary_op.right);
+                fprintf(ctx->output, ")");
             } else {
                 // Normal numeric operations
                 fprintf(ctx->output, "(");
@@ -98,6 +130,11 @@ void generate_expression(CodeGenContext* ctx, AST_Node* node) {
             // Generate function call
             fprintf(ctx->output, "%s(", node->data.function_call.name);
             
+            // Zeno functions take zn_string_t; anything else is a C function
+            // (printf, puts, ...) and gets plain C strings
+            SymbolEntry* callee = lookup_interned_symbol(ctx->symtab, node->data.function_call.name);
+            int is_zeno_function = callee && callee->type == SYMBOL_FUNCTION;
+            
             // Generate arguments
             ExpressionList* arg_list = node->data.function_call.arguments;
             int first_arg = 1;
@@ -107,7 +144,11 @@ void generate_expression(CodeGenContext* ctx, AST_Node* node) {
                     fprintf(ctx->output, ", ");
                 }
                 
-                generate_expression(ctx, arg_list->expression);
+                if (is_zeno_function) {
+                    generate_expression(ctx, arg_list->expression);
+                } else {
+                    generate_c_string_argument(ctx, arg_list->expression);
+                }
                 first_arg = 0;
                 arg_list = arg_list->next;
             }
@@ -281,8 +322,15 @@ void generate_expression(CodeGenContext* ctx, AST_Node* node) {
             // Output key-value pair for map entries
             fprintf(ctx->output, "{.key = ");
             
-            // Output the key expression
-            generate_expression(ctx, node->data.map_entry.key); // Changed from direct string output
+            // Output the key expression; string keys are interned so that
+            // lookups can compare key pointers
+            if (is_string_expression(ctx, node->data.map_entry.key)) {
+                fprintf(ctx->output, "(void*)zn_string_intern_cstr(");
+                generate_c_string_argument(ctx, node->data.map_entry.key);
+                fprintf(ctx->output, ")");
+            } else {
+                generate_expression(ctx, node->data.map_entry.key);
+            }
             fprintf(ctx->output, ", ");
             
             // Output the value
@@ -331,3 +379,26 @@ void generate_expression(CodeGenContext* ctx, AST_Node* node) {
             break;
     }
 }
+
+// Generate a string literal as a zn_string_t constant
+void generate_string_literal(CodeGenContext* ctx, const char* quoted) {
+    // Short literals are stored inline, longer ones point at the C literal
+    if (string_literal_length(quoted) <= ZN_STRING_INLINE_CAPACITY) {
+        fprintf(ctx->output, "ZN_STRING_SMALL_LITERAL(%s)", quoted);
+    } else {
+        fprintf(ctx->output, "ZN_STRING_STATIC_LITERAL(%s)", quoted);
+    }
+}
+
+// Generate an expression where C code expects a char* for strings
+void generate_c_string_argument(CodeGenContext* ctx, AST_Node* node) {
+    if (node->type == NODE_LITERAL_STRING) {
+        fprintf(ctx->output, "%s", node->data.literal.value);
+    } else if (is_string_expression(ctx, node)) {
+        fprintf(ctx->output, "ZN_CSTR(");
+        generate_expression(ctx, node);
+        fprintf(ctx->output, ")");
+    } else {
+        generate_expression(ctx, node);
+    }
+}
@@ -7,4 +7,10 @@
 // Generate code for expression
 void generate_expression(CodeGenContext* ctx, AST_Node* node);
 
+// Generate a quoted string literal as a zn_string_t constant
+void generate_string_literal(CodeGenContext* ctx, const char* quoted);
+
+// Generate an argument for a C function, lowering strings to char*
+void generate_c_string_argument(CodeGenContext* ctx, AST_Node* node);
+
 #endif // CODEGEN_EXPRESSION_H
@@ -0,0 +1,1018 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ownership.h"
+#include "expression.h"
+#include "utils.h"
+#include "../intern.h"
+
+/**
+ * ARC ownership pass for the C backend
+ *
+ * Managed values (zn_string_t and structs with string fields) follow these
+ * conventions in generated code:
+ *   - Parameters are borrowed (+0): the caller keeps its reference and the
+ *     callee neither retains nor releases them.
+ *   - Function results are owned (+1) and so are concatenation results.
+ *   - Locals own their value and release it when their block ends.
+ *
+ * Before a function is generated, a pre-pass resolves every variable use
+ * and records where each local is last used and whether it can ever hold a
+ * heap value. Generation then skips the operations that pass proves
+ * redundant:
+ *   - locals that only ever hold literals need no retain/release at all,
+ *   - copying a local at its last use moves it instead of retaining it,
+ *   - returning a local moves it out instead of retaining it,
+ *   - borrowed parameters need no retain on entry or release on exit.
+ */
+
+// A managed (or shadowing) variable of the function being generated
+typedef struct ArcVar {
+    const char* name;
+    ArcKind kind;
+    const char* struct_name;      // Struct type name for ARC_KIND_STRUCT
+    int is_param;
+    int reassigned;               // Parameter assigned in the body
+    int may_hold_heap;            // Some store into it can be a heap value
+    int moved;                    // Ownership left at its last use
+    AST_Node* block;              // Declaring compound statement
+    int loop_depth;
+    int last_use;                 // Index of the last use in the pre-pass
+    struct ArcVar* next;
+} ArcVar;
+
+// Pre-pass result for one node (a use, a declaration or an assignment)
+typedef struct {
+    AST_Node* node;
+    ArcVar* var;
+    int index;
+    AST_Node* block;
+    int loop_depth;
+} ArcNodeInfo;
+
+// A store whose heap-ness depends on another variable
+typedef struct {
+    ArcVar* target;
+    ArcVar* source;
+} ArcCopyEdge;
+
+// A hoisted owned temporary
+typedef struct {
+    AST_Node* node;
+    int id;
+    ArcKind kind;
+    const char* struct_name;
+} ArcTemp;
+
+struct ArcFunction {
+    ArcVar* vars;                 // All variables, for cleanup
+    ArcNodeInfo* infos;           // Open addressing map keyed by node
+    size_t info_capacity;
+    size_t info_count;
+    ArcCopyEdge* edges;
+    size_t edge_count;
+    size_t edge_capacity;
+    ArcVar** live;                // Variables declared so far, innermost last
+    size_t live_count;
+    size_t live_capacity;
+    ArcTemp* temps;               // Temporaries of the enclosing statements
+    size_t temp_count;
+    size_t temp_capacity;
+    size_t* marks;                // Start of each statement's temporaries
+    size_t mark_count;
+    size_t mark_capacity;
+    int next_temp_id;
+    int line_indented;            // The current line already has its indent
+    char* return_type;
+    AST_Node* body;
+
+    // Pre-pass state
+    ArcVar** scope;               // Name resolution stack
+    size_t scope_count;
+    size_t scope_capacity;
+    int use_index;
+};
+
+struct ArcStructInfo {
+    char* name;
+    int managed;
+    ArcStructInfo* next;
+};
+
+static void* arc_grow(void* items, size_t* capacity, size_t count, size_t item_size) {
+    if (count < *capacity) return items;
+    size_t new_capacity = *capacity ? *capacity * 2 : 16;
+    void* grown = realloc(items, new_capacity * item_size);
+    if (!grown) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    *capacity = new_capacity;
+    return grown;
+}
+
+// --- Struct registry ---------------------------------------------------
+
+void arc_register_struct(CodeGenContext* ctx, const char* name, int managed) {
+    ArcStructInfo* info = (ArcStructInfo*)malloc(sizeof(ArcStructInfo));
+    if (!info) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    info->name = strdup(name);
+    info->managed = managed;
+    info->next = ctx->arc_structs;
+    ctx->arc_structs = info;
+}
+
+ArcKind arc_type_kind(CodeGenContext* ctx, TypeInfo* type) {
+    if (!type || !type->name) return ARC_KIND_NONE;
+    if (type->name == interned_names()->string_type) return ARC_KIND_STRING;
+
+    for (ArcStructInfo* info = ctx->arc_structs; info; info = info->next) {
+        if (strcmp(info->name, type->name) == 0) {
+            return info->managed ? ARC_KIND_STRUCT : ARC_KIND_NONE;
+        }
+    }
+    return ARC_KIND_NONE;
+}
+
+static void emit_field_op(CodeGenContext* ctx, const char* op, ArcKind kind,
+                          const char* struct_name, const char* field) {
+    if (kind == ARC_KIND_STRING) {
+        fprintf(ctx->output, "    zn_string_%s(&value->%s);\n", op, field);
+    } else if (kind == ARC_KIND_STRUCT) {
+        fprintf(ctx->output, "    zn_%s_%s(&value->%s);\n", op, struct_name, field);
+    }
+}
+
+int arc_declare_struct(CodeGenContext* ctx, AST_Node* node, int has_entity_fields) {
+    int managed = has_entity_fields;
+
+    StructField* field = node->data.struct_decl.fields ? node->data.struct_decl.fields->head : NULL;
+    for (; field; field = field->next) {
+        if (arc_type_kind(ctx, field->type) != ARC_KIND_NONE) managed = 1;
+    }
+
+    arc_register_struct(ctx, node->data.struct_decl.name, managed);
+    return managed;
+}
+
+void arc_emit_struct_helpers(CodeGenContext* ctx, AST_Node* node, int has_entity_fields) {
+    const char* name = node->data.struct_decl.name;
+    if (!arc_declare_struct(ctx, node, has_entity_fields)) return;
+
+    StructField* field;
+    const char* ops[2] = { "retain", "release" };
+    for (int i = 0; i < 2; i++) {
+        fprintf(ctx->output, "static inline void zn_%s_%s(struct %s* value) {\n", ops[i], name, name);
+        if (has_entity_fields) {
+            emit_field_op(ctx, ops[i], ARC_KIND_STRING, NULL, "id");
+            emit_field_op(ctx, ops[i], ARC_KIND_STRING, NULL, "name");
+        }
+        field = node->data.struct_decl.fields ? node->data.struct_decl.fields->head : NULL;
+        for (; field; field = field->next) {
+            emit_field_op(ctx, ops[i], arc_type_kind(ctx, field->type), field->type->name, field->name);
+        }
+        fprintf(ctx->output, "}\n\n");
+    }
+}
+
+void arc_cleanup(CodeGenContext* ctx) {
+    ArcStructInfo* info = ctx->arc_structs;
+    while (info) {
+        ArcStructInfo* next = info->next;
+        free(info->name);
+        free(info);
+        info = next;
+    }
+    ctx->arc_structs = NULL;
+}
+
+// --- Node map ------------------------------------------------------------
+
+static size_t info_slot(AST_Node* node, size_t mask) {
+    uintptr_t key = (uintptr_t)node;
+    return (size_t)((key >> 4) * 2654435761u) & mask;
+}
+
+static ArcNodeInfo* info_lookup(ArcFunction* fn, AST_Node* node) {
+    if (!fn->info_capacity) return NULL;
+    size_t mask = fn->info_capacity - 1;
+    size_t index = info_slot(node, mask);
+    while (fn->infos[index].node) {
+        if (fn->infos[index].node == node) return &fn->infos[index];
+        index = (index + 1) & mask;
+    }
+    return NULL;
+}
+
+static void info_insert(ArcFunction* fn, ArcNodeInfo info) {
+    if ((fn->info_count + 1) * 2 > fn->info_capacity) {
+        size_t capacity = fn->info_capacity ? fn->info_capacity * 2 : 64;
+        ArcNodeInfo* infos = (ArcNodeInfo*)calloc(capacity, sizeof(ArcNodeInfo));
+        if (!infos) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        for (size_t i = 0; i < fn->info_capacity; i++) {
+            if (!fn->infos[i].node) continue;
+            size_t index = info_slot(fn->infos[i].node, capacity - 1);
+            while (infos[index].node) index = (index + 1) & (capacity - 1);
+            infos[index] = fn->infos[i];
+        }
+        free(fn->infos);
+        fn->infos = infos;
+        fn->info_capacity = capacity;
+    }
+
+    size_t mask = fn->info_capacity - 1;
+    size_t index = info_slot(info.node, mask);
+    while (fn->infos[index].node) index = (index + 1) & mask;
+    fn->infos[index] = info;
+    fn->info_count++;
+}
+
+// --- Pre-pass ------------------------------------------------------------
+
+static ArcVar* new_var(ArcFunction* fn, const char* name, ArcKind kind, TypeInfo* type,
+                       AST_Node* block, int loop_depth) {
+    ArcVar* var = (ArcVar*)calloc(1, sizeof(ArcVar));
+    if (!var) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    var->name = name;
+    var->kind = kind;
+    var->struct_name = (kind == ARC_KIND_STRUCT && type) ? type->name : NULL;
+    var->block = block;
+    var->loop_depth = loop_depth;
+    var->last_use = -1;
+    var->next = fn->vars;
+    fn->vars = var;
+
+    fn->scope = arc_grow(fn->scope, &fn->scope_capacity, fn->scope_count, sizeof(ArcVar*));
+    fn->scope[fn->scope_count++] = var;
+    return var;
+}
+
+static ArcVar* resolve(ArcFunction* fn, const char* name) {
+    for (size_t i = fn->scope_count; i > 0; i--) {
+        if (strcmp(fn->scope[i - 1]->name, name) == 0) return fn->scope[i - 1];
+    }
+    return NULL;
+}
+
+static void record_use(ArcFunction* fn, AST_Node* node, ArcVar* var, AST_Node* block, int loop_depth) {
+    ArcNodeInfo info = { node, var, fn->use_index++, block, loop_depth };
+    if (var) var->last_use = info.index;
+    info_insert(fn, info);
+}
+
+// Note what a store of `value` into `target` means for heap-ness
+static void record_store(ArcFunction* fn, ArcVar* target, AST_Node* value) {
+    if (!target || target->kind == ARC_KIND_NONE || !value) return;
+
+    switch (value->type) {
+        case NODE_LITERAL_STRING:
+        case NODE_STRUCT_INIT:
+            return;
+        case NODE_IDENTIFIER:
+        case NODE_MEMBER_ACCESS: {
+            AST_Node* base = value;
+            while (base->type == NODE_MEMBER_ACCESS) base = base->data.member_access.object;
+            ArcNodeInfo* info = base->type == NODE_IDENTIFIER ? info_lookup(fn, base) : NULL;
+            if (info && info->var) {
+                fn->edges = arc_grow(fn->edges, &fn->edge_capacity, fn->edge_count, sizeof(ArcCopyEdge));
+                fn->edges[fn->edge_count].target = target;
+                fn->edges[fn->edge_count].source = info->var;
+                fn->edge_count++;
+                return;
+            }
+            target->may_hold_heap = 1;
+            return;
+        }
+        default:
+            target->may_hold_heap = 1;
+            return;
+    }
+}
+
+static void prepass(CodeGenContext* ctx, ArcFunction* fn, AST_Node* node, AST_Node* block, int loop_depth);
+
+static void prepass_list(CodeGenContext* ctx, ArcFunction* fn, ExpressionList* list, AST_Node* block, int loop_depth) {
+    for (; list; list = list->next) {
+        prepass(ctx, fn, list->expression, block, loop_depth);
+    }
+}
+
+static void prepass_body(CodeGenContext* ctx, ArcFunction* fn, AST_Node* body, AST_Node* block, int loop_depth) {
+    size_t saved = fn->scope_count;
+    prepass(ctx, fn, body, block, loop_depth);
+    fn->scope_count = saved;
+}
+
+static void prepass(CodeGenContext* ctx, ArcFunction* fn, AST_Node* node, AST_Node* block, int loop_depth) {
+    if (!node) return;
+
+    switch (node->type) {
+        case NODE_COMPOUND_STATEMENT: {
+            size_t saved = fn->scope_count;
+            for (AST_Node* stmt = node->data.compound_stmt.statements->head; stmt; stmt = stmt->next) {
+                prepass(ctx, fn, stmt, node, loop_depth);
+            }
+            fn->scope_count = saved;
+            break;
+        }
+
+        case NODE_VARIABLE: {
+            prepass(ctx, fn, node->data.variable.initializer, block, loop_depth);
+            TypeInfo* type = node->data.variable.type;
+            ArcKind kind = arc_type_kind(ctx, type);
+            if (!type && node->data.variable.initializer &&
+                node->data.variable.initializer->type == NODE_LITERAL_STRING) {
+                kind = ARC_KIND_STRING;
+            }
+            ArcVar* var = new_var(fn, node->data.variable.name, kind, type, block, loop_depth);
+            ArcNodeInfo info = { node, var, fn->use_index++, block, loop_depth };
+            info_insert(fn, info);
+            record_store(fn, var, node->data.variable.initializer);
+            break;
+        }
+
+        case NODE_ASSIGNMENT: {
+            prepass(ctx, fn, node->data.assignment.value, block, loop_depth);
+            ArcVar* var = resolve(fn, node->data.assignment.name);
+            if (var && var->is_param) var->reassigned = 1;
+            record_use(fn, node, var, block, loop_depth);
+            record_store(fn, var, node->data.assignment.value);
+            break;
+        }
+
+        case NODE_IDENTIFIER:
+            record_use(fn, node, resolve(fn, node->data.identifier.name), block, loop_depth);
+            break;
+
+        case NODE_RETURN:
+            prepass(ctx, fn, node->data.return_stmt.expression, block, loop_depth);
+            break;
+
+        case NODE_IF:
+            prepass(ctx, fn, node->data.if_stmt.condition, block, loop_depth);
+            prepass_body(ctx, fn, node->data.if_stmt.true_branch, block, loop_depth);
+            prepass_body(ctx, fn, node->data.if_stmt.false_branch, block, loop_depth);
+            break;
+
+        case NODE_MATCH:
+            prepass(ctx, fn, node->data.match_stmt.expression, block, loop_depth);
+            for (MatchCase* c = node->data.match_stmt.cases->head; c; c = c->next) {
+                prepass_body(ctx, fn, c->body, block, loop_depth);
+            }
+            break;
+
+        case NODE_WHILE_STATEMENT:
+            prepass(ctx, fn, node->data.while_statement.condition, block, loop_depth + 1);
+            prepass_body(ctx, fn, node->data.while_statement.body, block, loop_depth + 1);
+            break;
+
+        case NODE_C_STYLE_FOR: {
+            // Loop variables are generated without ARC; only note the uses
+            size_t saved = fn->scope_count;
+            AST_Node* init = node->data.c_style_for.initializer;
+            if (init && init->type == NODE_VARIABLE) {
+                prepass(ctx, fn, init->data.variable.initializer, block, loop_depth);
+                new_var(fn, init->data.variable.name, ARC_KIND_NONE, NULL, block, loop_depth);
+            } else {
+                prepass(ctx, fn, init, block, loop_depth);
+            }
+            prepass(ctx, fn, node->data.c_style_for.condition, block, loop_depth + 1);
+            prepass(ctx, fn, node->data.c_style_for.incrementer, block, loop_depth + 1);
+            prepass_body(ctx, fn, node->data.c_style_for.body, block, loop_depth + 1);
+            fn->scope_count = saved;
+            break;
+        }
+
+        case NODE_FOR_IN: {
+            size_t saved = fn->scope_count;
+            prepass(ctx, fn, node->data.for_in.iterable, block, loop_depth);
+            new_var(fn, node->data.for_in.variable->data.variable.name, ARC_KIND_NONE, NULL, block, loop_depth);
+            prepass_body(ctx, fn, node->data.for_in.body, block, loop_depth + 1);
+            fn->scope_count = saved;
+            break;
+        }
+
+        case NODE_FOR_MAP: {
+            size_t saved = fn->scope_count;
+            prepass(ctx, fn, node->data.for_map.map_expr, block, loop_depth);
+            new_var(fn, node->data.for_map.key_var->data.variable.name, ARC_KIND_NONE, NULL, block, loop_depth);
+            new_var(fn, node->data.for_map.value_var->data.variable.name, ARC_KIND_NONE, NULL, block, loop_depth);
+            prepass_body(ctx, fn, node->data.for_map.body, block, loop_depth + 1);
+            fn->scope_count = saved;
+            break;
+        }
+
+        case NODE_BINARY_OP:
+            prepass(ctx, fn, node->data.binary_op.left, block, loop_depth);
+            prepass(ctx, fn, node->data.binary_op.right, block, loop_depth);
+            break;
+
+        case NODE_UNARY_OP:
+            prepass(ctx, fn, node->data.unary_op.operand, block, loop_depth);
+            break;
+
+        case NODE_FUNCTION_CALL:
+        case NODE_LITERAL_ARRAY:
+            prepass_list(ctx, fn, node->data.function_call.arguments, block, loop_depth);
+            break;
+
+        case NODE_MEMBER_ACCESS:
+            prepass(ctx, fn, node->data.member_access.object, block, loop_depth);
+            break;
+
+        case NODE_PIPE:
+            prepass(ctx, fn, node->data.pipe.left, block, loop_depth);
+            prepass(ctx, fn, node->data.pipe.right, block, loop_depth);
+            break;
+
+        case NODE_AWAIT_EXPRESSION:
+            prepass(ctx, fn, node->data.await_expr.promise, block, loop_depth);
+            break;
+
+        case NODE_PROMISE_THEN:
+            prepass(ctx, fn, node->data.promise_then.promise, block, loop_depth);
+            break;
+
+        case NODE_PROMISE_CATCH:
+            prepass(ctx, fn, node->data.promise_catch.promise, block, loop_depth);
+            break;
+
+        case NODE_PROMISE_FINALLY:
+            prepass(ctx, fn, node->data.promise_finally.promise, block, loop_depth);
+            break;
+
+        case NODE_PROMISE_ALL:
+            prepass_list(ctx, fn, node->data.promise_all.promises, block, loop_depth);
+            break;
+
+        default:
+            // Literals, anonymous functions (generated separately) and the rest
+            break;
+    }
+}
+
+// Propagate heap-ness along copies until nothing changes
+static void propagate_heap(ArcFunction* fn) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (size_t i = 0; i < fn->edge_count; i++) {
+            ArcCopyEdge* edge = &fn->edges[i];
+            if (edge->source->may_hold_heap && !edge->target->may_hold_heap) {
+                edge->target->may_hold_heap = 1;
+                changed = 1;
+            }
+        }
+    }
+}
+
+// --- Emission helpers ----------------------------------------------------
+
+static void start_line(CodeGenContext* ctx) {
+    if (ctx->arc && ctx->arc->line_indented) {
+        ctx->arc->line_indented = 0;
+    } else {
+        indent(ctx);
+    }
+}
+
+static void emit_op(CodeGenContext* ctx, const char* op, ArcKind kind,
+                    const char* struct_name, const char* value) {
+    start_line(ctx);
+    if (kind == ARC_KIND_STRING) {
+        fprintf(ctx->output, "zn_string_%s(&%s);\n", op, value);
+    } else {
+        fprintf(ctx->output, "zn_%s_%s(&%s);\n", op, struct_name, value);
+    }
+    if (strcmp(op, "retain") == 0) {
+        ctx->arc_stats.retains_emitted++;
+    } else {
+        ctx->arc_stats.releases_emitted++;
+    }
+}
+
+static const char* kind_c_type(ArcKind kind, const char* struct_name, char* buffer, size_t size) {
+    if (kind == ARC_KIND_STRING) return "zn_string_t";
+    snprintf(buffer, size, "struct %s", struct_name);
+    return buffer;
+}
+
+// Variable whose last use is node, if its value can be moved from there
+static ArcVar* movable_source(ArcFunction* fn, AST_Node* node) {
+    if (!node || node->type != NODE_IDENTIFIER) return NULL;
+    ArcNodeInfo* info = info_lookup(fn, node);
+    if (!info || !info->var) return NULL;
+    ArcVar* var = info->var;
+    if (var->is_param || var->kind == ARC_KIND_NONE) return NULL;
+    if (var->last_use != info->index) return NULL;
+    if (info->block != var->block || info->loop_depth != var->loop_depth) return NULL;
+    return var;
+}
+
+// Whether a value read from node is borrowed (needs a retain to be kept)
+static int is_borrowed_read(AST_Node* node) {
+    return node && (node->type == NODE_IDENTIFIER || node->type == NODE_MEMBER_ACCESS);
+}
+
+// Whether node can evaluate to a heap value that nobody else owns
+static int is_owned_temporary(CodeGenContext* ctx, AST_Node* node) {
+    if (!node || ctx->in_async_function) return 0;
+    if (node->type == NODE_BINARY_OP && node->data.binary_op.op == OP_ADD) {
+        return is_string_expression(ctx, node);
+    }
+    if (node->type == NODE_FUNCTION_CALL) {
+        SymbolEntry* callee = lookup_interned_symbol(ctx->symtab, node->data.function_call.name);
+        return callee && callee->type == SYMBOL_FUNCTION &&
+               arc_type_kind(ctx, callee->type_info) != ARC_KIND_NONE;
+    }
+    return 0;
+}
+
+// Whether reading node can yield a heap value (for copies)
+static int read_may_be_heap(ArcFunction* fn, AST_Node* node) {
+    AST_Node* base = node;
+    while (base && base->type == NODE_MEMBER_ACCESS) base = base->data.member_access.object;
+    if (!base || base->type != NODE_IDENTIFIER) return 1;
+    ArcNodeInfo* info = info_lookup(fn, base);
+    return !info || !info->var || info->var->may_hold_heap;
+}
+
+// --- Function lifetime ---------------------------------------------------
+
+void arc_begin_function(CodeGenContext* ctx, AST_Node* function, const char* c_return_type) {
+    ArcFunction* fn = (ArcFunction*)calloc(1, sizeof(ArcFunction));
+    if (!fn) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    fn->return_type = strdup(c_return_type);
+    fn->body = function->data.function.body;
+
+    // Parameters are borrowed and live for the whole body
+    AST_Node* body = function->data.function.body;
+    for (AST_Node* param = function->data.function.parameters->head; param; param = param->next) {
+        ArcKind kind = arc_type_kind(ctx, param->data.variable.type);
+        ArcVar* var = new_var(fn, param->data.variable.name, kind, param->data.variable.type, body, 0);
+        var->is_param = 1;
+        var->may_hold_heap = 1;
+        if (kind != ARC_KIND_NONE) {
+            // A naive scheme retains each parameter on entry
+            ctx->arc_stats.retains_naive++;
+        }
+    }
+
+    prepass(ctx, fn, body, body, 0);
+    propagate_heap(fn);
+    fn->scope_count = 0;
+
+    ctx->arc = fn;
+
+    // A parameter that is assigned to must own its value so the old one can
+    // be released; take a reference on entry and treat it as a local
+    for (ArcVar* var = fn->vars; var; var = var->next) {
+        if (!var->is_param || !var->reassigned || var->kind == ARC_KIND_NONE) continue;
+        var->is_param = 0;
+        emit_op(ctx, "retain", var->kind, var->struct_name, var->name);
+        fn->live = arc_grow(fn->live, &fn->live_capacity, fn->live_count, sizeof(ArcVar*));
+        fn->live[fn->live_count++] = var;
+    }
+}
+
+// Count the naive releases of parameters on one exit path
+static void account_param_exit(CodeGenContext* ctx) {
+    for (ArcVar* var = ctx->arc->vars; var; var = var->next) {
+        if (var->is_param && var->kind != ARC_KIND_NONE) {
+            ctx->arc_stats.releases_naive++;
+        }
+    }
+}
+
+void arc_end_function(CodeGenContext* ctx) {
+    ArcFunction* fn = ctx->arc;
+    if (!fn) return;
+
+    ArcVar* var = fn->vars;
+    while (var) {
+        ArcVar* next = var->next;
+        free(var);
+        var = next;
+    }
+    free(fn->infos);
+    free(fn->edges);
+    free(fn->live);
+    free(fn->temps);
+    free(fn->marks);
+    free(fn->scope);
+    free(fn->return_type);
+    free(fn);
+    ctx->arc = NULL;
+}
+
+// --- Blocks ----------------------------------------------------------------
+
+void arc_leave_block(CodeGenContext* ctx, AST_Node* block, int ended_with_return) {
+    ArcFunction* fn = ctx->arc;
+    if (!fn) return;
+
+    // Release in reverse declaration order; a return already released them
+    while (fn->live_count > 0 && fn->live[fn->live_count - 1]->block == block) {
+        ArcVar* var = fn->live[--fn->live_count];
+        if (ended_with_return) continue;
+
+        ctx->arc_stats.releases_naive++;
+        if (var->may_hold_heap && !var->moved) {
+            emit_op(ctx, "release", var->kind, var->struct_name, var->name);
+        }
+    }
+
+    // Falling off the end of the body is an exit path too
+    if (block == fn->body && !ended_with_return) {
+        account_param_exit(ctx);
+    }
+}
+
+void arc_declare_variable(CodeGenContext* ctx, AST_Node* var_node) {
+    ArcFunction* fn = ctx->arc;
+    if (!fn) return;
+
+    ArcNodeInfo* info = info_lookup(fn, var_node);
+    if (!info || !info->var || info->var->kind == ARC_KIND_NONE) return;
+    ArcVar* var = info->var;
+
+    fn->live = arc_grow(fn->live, &fn->live_capacity, fn->live_count, sizeof(ArcVar*));
+    fn->live[fn->live_count++] = var;
+
+    // Copies of borrowed values need their own reference, unless the source
+    // is a local at its last use (a move) or never holds a heap value
+    AST_Node* init = var_node->data.variable.initializer;
+    if (!is_borrowed_read(init)) return;
+
+    ctx->arc_stats.retains_naive++;
+    ArcVar* source = movable_source(fn, init);
+    if (source) {
+        source->moved = 1;
+    } else if (read_may_be_heap(fn, init)) {
+        emit_op(ctx, "retain", var->kind, var->struct_name, var->name);
+    }
+}
+
+// --- Statements and temporaries ---------------------------------------------
+
+int arc_emit_temporary(CodeGenContext* ctx, AST_Node* node) {
+    ArcFunction* fn = ctx->arc;
+    if (!fn) return 0;
+
+    for (size_t i = 0; i < fn->temp_count; i++) {
+        if (fn->temps[i].node == node) {
+            fprintf(ctx->output, "__arc_tmp%d", fn->temps[i].id);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int arc_discard_statement(CodeGenContext* ctx, AST_Node* stmt) {
+    ArcFunction* fn = ctx->arc;
+    if (!fn) return 0;
+
+    for (size_t i = 0; i < fn->temp_count; i++) {
+        if (fn->temps[i].node == stmt) {
+            // The indent for this line is already out; the release takes it
+            fn->line_indented = 1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void hoist(CodeGenContext* ctx, AST_Node* node) {
+    ArcFunction* fn = ctx->arc;
+    ArcKind kind = ARC_KIND_STRING;
+    const char* struct_name = NULL;
+
+    if (node->type == NODE_FUNCTION_CALL) {
+        SymbolEntry* callee = lookup_interned_symbol(ctx->symtab, node->data.function_call.name);
+        kind = arc_type_kind(ctx, callee->type_info);
+        struct_name = callee->type_info->name;
+    }
+
+    char type_buffer[256];
+    fprintf(ctx->output, "%s __arc_tmp%d = ",
+            kind_c_type(kind, struct_name, type_buffer, sizeof(type_buffer)), fn->next_temp_id);
+    generate_expression(ctx, node);
+    fprintf(ctx->output, ";\n");
+    indent(ctx);
+
+    fn->temps = arc_grow(fn->temps, &fn->temp_capacity, fn->temp_count, sizeof(ArcTemp));
+    ArcTemp temp = { node, fn->next_temp_id++, kind, struct_name };
+    fn->temps[fn->temp_count++] = temp;
+}
+
+// Hoist owned values used in borrowing positions, innermost first.
+// `consumed` is set when the value of node is taken over by its user.
+static void hoist_temporaries(CodeGenContext* ctx, AST_Node* node, int consumed) {
+    if (!node) return;
+
+    switch (node->type) {
+        case NODE_BINARY_OP:
+            hoist_temporaries(ctx, node->data.binary_op.left, 0);
+            hoist_temporaries(ctx, node->data.binary_op.right, 0);
+            break;
+        case NODE_UNARY_OP:
+            hoist_temporaries(ctx, node->data.unary_op.operand, 0);
+            break;
+        case NODE_FUNCTION_CALL:
+            for (ExpressionList* arg = node->data.function_call.arguments; arg; arg = arg->next) {
+                hoist_temporaries(ctx, arg->expression, 0);
+            }
+            break;
+        case NODE_MEMBER_ACCESS:
+            hoist_temporaries(ctx, node->data.member_access.object, 0);
+            break;
+        case NODE_RANGE:
+            hoist_temporaries(ctx, node->data.range.start, 0);
+            hoist_temporaries(ctx, node->data.range.end, 0);
+            return;
+        default:
+            // Other expressions are not lowered with ARC
+            return;
+    }
+
+    if (!consumed && is_owned_temporary(ctx, node)) {
+        hoist(ctx, node);
+    }
+}
+
+// Whether hoist_temporaries would hoist anything from node
+static int has_temporaries(CodeGenContext* ctx, AST_Node* node, int consumed) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case NODE_BINARY_OP:
+            if (has_temporaries(ctx, node->data.binary_op.left, 0) ||
+                has_temporaries(ctx, node->data.binary_op.right, 0)) {
+                return 1;
+            }
+            break;
+        case NODE_UNARY_OP:
+            if (has_temporaries(ctx, node->data.unary_op.operand, 0)) return 1;
+            break;
+        case NODE_FUNCTION_CALL:
+            for (ExpressionList* arg = node->data.function_call.arguments; arg; arg = arg->next) {
+                if (has_temporaries(ctx, arg->expression, 0)) return 1;
+            }
+            break;
+        case NODE_MEMBER_ACCESS:
+            if (has_temporaries(ctx, node->data.member_access.object, 0)) return 1;
+            break;
+        default:
+            return 0;
+    }
+
+    return !consumed && is_owned_temporary(ctx, node);
+}
+
+void arc_begin_statement(CodeGenContext* ctx, AST_Node* stmt) {
+    ArcFunction* fn = ctx->arc;
+    if (!fn || !stmt) return;
+
+    fn->marks = arc_grow(fn->marks, &fn->mark_capacity, fn->mark_count, sizeof(size_t));
+    fn->marks[fn->mark_count++] = fn->temp_count;
+
+    switch (stmt->type) {
+        case NODE_VARIABLE:
+            hoist_temporaries(ctx, stmt->data.variable.initializer, 1);
+            break;
+        case NODE_RETURN:
+            hoist_temporaries(ctx, stmt->data.return_stmt.expression, 1);
+            break;
+        case NODE_IF:
+            hoist_temporaries(ctx, stmt->data.if_stmt.condition, 0);
+            break;
+        case NODE_ASSIGNMENT: {
+            hoist_temporaries(ctx, stmt->data.assignment.value, 1);
+
+            // Keep the old value until the new one is stored, then release it
+            ArcNodeInfo* info = info_lookup(fn, stmt);
+            if (info && info->var && info->var->kind != ARC_KIND_NONE) {
+                ArcVar* var = info->var;
+                ctx->arc_stats.releases_naive++;
+                if (var->may_hold_heap) {
+                    char type_buffer[256];
+                    fprintf(ctx->output, "%s __arc_old%d = %s;\n",
+                            kind_c_type(var->kind, var->struct_name, type_buffer, sizeof(type_buffer)),
+                            fn->next_temp_id, var->name);
+                    indent(ctx);
+                    fn->temps = arc_grow(fn->temps, &fn->temp_capacity, fn->temp_count, sizeof(ArcTemp));
+                    ArcTemp temp = { NULL, fn->next_temp_id++, var->kind, var->struct_name };
+                    fn->temps[fn->temp_count++] = temp;
+                }
+            }
+            break;
+        }
+        case NODE_C_STYLE_FOR: {
+            // The initializer runs once, before the loop; the condition and
+            // incrementer run every iteration (see arc_loop_needs_lowering)
+            AST_Node* init = stmt->data.c_style_for.initializer;
+            if (init && init->type == NODE_VARIABLE) {
+                hoist_temporaries(ctx, init->data.variable.initializer, 1);
+            } else {
+                hoist_temporaries(ctx, init, 0);
+            }
+            break;
+        }
+        case NODE_FOR_IN:
+            // The iterable is evaluated once, before the loop
+            hoist_temporaries(ctx, stmt->data.for_in.iterable, 0);
+            break;
+        case NODE_MATCH:
+            hoist_temporaries(ctx, stmt->data.match_stmt.expression, 0);
+            break;
+        case NODE_WHILE_STATEMENT:
+            // The condition runs every iteration (see arc_loop_needs_lowering)
+            break;
+        case NODE_FOR_MAP:
+        case NODE_COMPOUND_STATEMENT:
+            // The map expression is not generated yet; blocks hook their own statements
+            break;
+        default:
+            // Expression statement: the result is discarded
+            hoist_temporaries(ctx, stmt, 0);
+            break;
+    }
+}
+
+// Release temporaries from index `from` on, newest first
+static void release_temporaries(CodeGenContext* ctx, size_t from) {
+    ArcFunction* fn = ctx->arc;
+    char name[32];
+
+    for (size_t i = fn->temp_count; i > from; i--) {
+        ArcTemp* temp = &fn->temps[i - 1];
+        snprintf(name, sizeof(name), temp->node ? "__arc_tmp%d" : "__arc_old%d", temp->id);
+        ctx->arc_stats.releases_naive++;
+        emit_op(ctx, "release", temp->kind, temp->struct_name, name);
+    }
+}
+
+void arc_end_statement(CodeGenContext* ctx, AST_Node* stmt) {
+    ArcFunction* fn = ctx->arc;
+    if (!fn || !stmt) return;
+
+    // An assignment from a borrowed value needs its own reference
+    if (stmt->type == NODE_ASSIGNMENT) {
+        ArcNodeInfo* info = info_lookup(fn, stmt);
+        AST_Node* value = stmt->data.assignment.value;
+        if (info && info->var && info->var->kind != ARC_KIND_NONE && is_borrowed_read(value)) {
+            ArcVar* var = info->var;
+            ctx->arc_stats.retains_naive++;
+            ArcVar* source = movable_source(fn, value);
+            if (source && source != var) {
+                source->moved = 1;
+            } else if (read_may_be_heap(fn, value)) {
+                emit_op(ctx, "retain", var->kind, var->struct_name, var->name);
+            }
+        }
+    }
+
+    // A return has already released everything on its way out
+    size_t mark = fn->marks[--fn->mark_count];
+    if (stmt->type != NODE_RETURN) {
+        release_temporaries(ctx, mark);
+    }
+    fn->temp_count = mark;
+}
+
+// --- Loops -------------------------------------------------------------------
+
+int arc_loop_needs_lowering(CodeGenContext* ctx, AST_Node* node) {
+    ArcFunction* fn = ctx->arc;
+    if (!fn || !node) return 0;
+
+    if (node->type == NODE_ASSIGNMENT) {
+        ArcNodeInfo* info = info_lookup(fn, node);
+        if (info && info->var && info->var->kind != ARC_KIND_NONE) return 1;
+        return has_temporaries(ctx, node->data.assignment.value, 1);
+    }
+    return has_temporaries(ctx, node, 0);
+}
+
+void arc_emit_loop_exit(CodeGenContext* ctx, AST_Node* condition) {
+    ArcFunction* fn = ctx->arc;
+    size_t mark = fn->temp_count;
+    int id = fn->next_temp_id++;
+
+    indent(ctx);
+    hoist_temporaries(ctx, condition, 0);
+    fprintf(ctx->output, "int __arc_cond%d = ", id);
+    generate_expression(ctx, condition);
+    fprintf(ctx->output, ";\n");
+    release_temporaries(ctx, mark);
+    fn->temp_count = mark;
+
+    indent(ctx);
+    fprintf(ctx->output, "if (!__arc_cond%d) break;\n", id);
+}
+
+// --- Returns ---------------------------------------------------------------
+
+int arc_generate_return(CodeGenContext* ctx, AST_Node* node) {
+    ArcFunction* fn = ctx->arc;
+    if (!fn) return 0;
+
+    AST_Node* expr = node->data.return_stmt.expression;
+    ArcVar* returned = NULL;
+    int needs_retain = 0;
+    ArcKind ret_kind = ARC_KIND_NONE;
+    const char* ret_struct = NULL;
+
+    if (expr && expr->type == NODE_IDENTIFIER) {
+        ArcNodeInfo* info = info_lookup(fn, expr);
+        if (info && info->var && info->var->kind != ARC_KIND_NONE) {
+            ret_kind = info->var->kind;
+            ret_struct = info->var->struct_name;
+            if (info->var->is_param) {
+                needs_retain = 1;
+            } else {
+                // Returning a local moves it out of the function
+                returned = info->var;
+            }
+        }
+    } else if (expr && expr->type == NODE_MEMBER_ACCESS) {
+        // A field is borrowed from its object, which may be released below
+        TypeInfo* type = get_expression_type(ctx, expr);
+        ret_kind = arc_type_kind(ctx, type);
+        if (ret_kind == ARC_KIND_STRUCT) ret_struct = type->name;
+        needs_retain = ret_kind != ARC_KIND_NONE && read_may_be_heap(fn, expr);
+    }
+    if (ret_kind != ARC_KIND_NONE) {
+        // A naive scheme retains every value it returns
+        ctx->arc_stats.retains_naive++;
+    }
+
+    // Count the work a naive scheme would do on this exit path
+    int pending = 0;
+    account_param_exit(ctx);
+    for (size_t i = 0; i < fn->live_count; i++) {
+        ArcVar* var = fn->live[i];
+        if (var == returned) continue;
+        ctx->arc_stats.releases_naive++;
+        if (var->may_hold_heap && !var->moved) pending++;
+    }
+
+    int simple = !expr || expr->type == NODE_LITERAL_STRING || expr->type == NODE_LITERAL_INT ||
+                 expr->type == NODE_LITERAL_FLOAT || expr->type == NODE_LITERAL_BOOL ||
+                 (returned && expr->type == NODE_IDENTIFIER);
+
+    if (pending == 0 && fn->temp_count == 0 && !needs_retain) {
+        return 0;
+    }
+
+    if (simple) {
+        // Nothing released below can affect the returned value
+        fn->line_indented = 1;
+        release_temporaries(ctx, 0);
+        for (size_t i = fn->live_count; i > 0; i--) {
+            ArcVar* var = fn->live[i - 1];
+            if (var != returned && var->may_hold_heap && !var->moved) {
+                emit_op(ctx, "release", var->kind, var->struct_name, var->name);
+            }
+        }
+        start_line(ctx);
+        fprintf(ctx->output, "return");
+        if (expr) {
+            fprintf(ctx->output, " ");
+            generate_expression(ctx, expr);
+        }
+        fprintf(ctx->output, ";\n");
+        return 1;
+    }
+
+    // Compute the result before anything it may borrow from is released
+    fprintf(ctx->output, "%s __arc_ret = ", fn->return_type);
+    generate_expression(ctx, expr);
+    fprintf(ctx->output, ";\n");
+    if (needs_retain) {
+        emit_op(ctx, "retain", ret_kind, ret_struct, "__arc_ret");
+    }
+    release_temporaries(ctx, 0);
+    for (size_t i = fn->live_count; i > 0; i--) {
+        ArcVar* var = fn->live[i - 1];
+        if (var != returned && var->may_hold_heap && !var->moved) {
+            emit_op(ctx, "release", var->kind, var->struct_name, var->name);
+        }
+    }
+    indent(ctx);
+    fprintf(ctx->output, "return __arc_ret;\n");
+    return 1;
+}
@@ -0,0 +1,66 @@
+#ifndef CODEGEN_OWNERSHIP_H
+#define CODEGEN_OWNERSHIP_H
+
+#include "context.h"
+#include "../ast.h"
+
+// Reference counted value categories in generated C
+typedef enum {
+    ARC_KIND_NONE,      // Plain value, nothing to manage
+    ARC_KIND_STRING,    // zn_string_t
+    ARC_KIND_STRUCT     // Struct with reference counted fields
+} ArcKind;
+
+// Struct registry: remembers which structs need retain/release helpers
+void arc_register_struct(CodeGenContext* ctx, const char* name, int managed);
+
+// Classify a Zeno type
+ArcKind arc_type_kind(CodeGenContext* ctx, TypeInfo* type);
+
+// Emit zn_retain_<Struct>/zn_release_<Struct> helpers for a managed struct
+void arc_emit_struct_helpers(CodeGenContext* ctx, AST_Node* node, int has_entity_fields);
+
+// Register a struct without emitting helpers (they come from an imported
+// module's header); returns whether it is managed
+int arc_declare_struct(CodeGenContext* ctx, AST_Node* node, int has_entity_fields);
+
+// Function lifetime: runs the ownership pass over the body
+void arc_begin_function(CodeGenContext* ctx, AST_Node* function, const char* c_return_type);
+void arc_end_function(CodeGenContext* ctx);
+
+// Called when a block ends: releases owned locals declared in it
+void arc_leave_block(CodeGenContext* ctx, AST_Node* block, int ended_with_return);
+
+// Statement hooks: hoist owned temporaries before, release them after
+void arc_begin_statement(CodeGenContext* ctx, AST_Node* stmt);
+void arc_end_statement(CodeGenContext* ctx, AST_Node* stmt);
+
+// Called after a local variable declaration has been emitted
+void arc_declare_variable(CodeGenContext* ctx, AST_Node* var_node);
+
+// Print the hoisted temporary for node, if any; returns 1 when printed
+int arc_emit_temporary(CodeGenContext* ctx, AST_Node* node);
+
+// Whether an expression statement was entirely hoisted into a temporary
+// and needs no code of its own
+int arc_discard_statement(CodeGenContext* ctx, AST_Node* stmt);
+
+// Loop conditions and incrementers run on every iteration, so their owned
+// temporaries cannot be hoisted in front of the loop. Returns 1 if node
+// needs ARC code around each evaluation; the loop is then generated
+// without a condition, starting with arc_emit_loop_exit, and the
+// incrementer becomes the last statement of the body.
+int arc_loop_needs_lowering(CodeGenContext* ctx, AST_Node* node);
+
+// Emit `if (!condition) break;` with the condition's temporaries released
+// before the test
+void arc_emit_loop_exit(CodeGenContext* ctx, AST_Node* condition);
+
+// Emit a return statement with the releases it needs; returns 0 if ARC
+// does not apply and the caller should emit a plain return
+int arc_generate_return(CodeGenContext* ctx, AST_Node* node);
+
+// Free the struct registry
+void arc_cleanup(CodeGenContext* ctx);
+
+#endif // CODEGEN_OWNERSHIP_H
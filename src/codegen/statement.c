@@ -6,6 +6,8 @@
 #include "declaration.h" // Added include for generate_variable_declaration
 #include "utils.h"
 #include "codegen.h"
+#include "ownership.h"
+#include "../intern.h"
 
 // Forward declarations for loop generation functions
 void generate_c_style_for_statement(CodeGenContext* ctx, AST_Node* node);
@@ -25,6 +27,20 @@ void generate_compound_statement(CodeGenContext* ctx, AST_Node* node) {
     fprintf(ctx->output, "}\n");
 }
 
+// Generate the body of a branch or loop; a single statement gets the same
+// ownership hooks as a statement in a block
+static void generate_body(CodeGenContext* ctx, AST_Node* body) {
+    if (body->type == NODE_COMPOUND_STATEMENT) {
+        // Compound statement handles its own scope
+        generate_compound_statement_contents(ctx, body);
+    } else {
+        indent(ctx);
+        arc_begin_statement(ctx, body);
+        generate_code(ctx, body);
+        arc_end_statement(ctx, body);
+    }
+}
+
 // Generate code for C-style for statement
 void generate_c_style_for_statement(CodeGenContext* ctx, AST_Node* node) {
     // Create new scope for the loop initializer if it's a declaration
@@ -48,28 +64,35 @@ void generate_c_style_for_statement(CodeGenContext* ctx, AST_Node* node) {
     }
     fprintf(ctx->output, "; ");
 
+    // A condition or incrementer with owned temporaries moves into the body
+    AST_Node* condition = node->data.c_style_for.condition;
+    AST_Node* incrementer = node->data.c_style_for.incrementer;
+    int lowered = arc_loop_needs_lowering(ctx, condition) || arc_loop_needs_lowering(ctx, incrementer);
+
     // Generate condition
-    if (node->data.c_style_for.condition) {
-        generate_expression(ctx, node->data.c_style_for.condition);
+    if (condition && !lowered) {
+        generate_expression(ctx, condition);
     }
     fprintf(ctx->output, "; ");
 
     // Generate incrementer
-    if (node->data.c_style_for.incrementer) {
-        generate_expression(ctx, node->data.c_style_for.incrementer);
+    if (incrementer && !lowered) {
+        generate_expression(ctx, incrementer);
     }
     fprintf(ctx->output, ") {\n");
     increase_indent(ctx);
 
+    if (lowered && condition) {
+        arc_emit_loop_exit(ctx, condition);
+    }
+
     // Generate loop body
-    AST_Node* body = node->data.c_style_for.body;
-    if (body->type == NODE_COMPOUND_STATEMENT) {
-        // Compound statement handles its own scope
-        generate_compound_statement_contents(ctx, body);
-    } else {
-        // For single statements, generate directly
-        indent(ctx);
-        generate_code(ctx, body);
+    generate_body(ctx, node->data.c_style_for.body);
+
+    // The language has no continue, so the end of the body is the only way
+    // to the next iteration
+    if (lowered && incrementer) {
+        generate_body(ctx, incrementer);
     }
 
     decrease_indent(ctx);
@@ -88,9 +111,11 @@ void generate_compound_statement_contents(CodeGenContext* ctx, AST_Node* node) {
     enter_scope(ctx->symtab);
     
     // Generate code for all statements
+    int ended_with_return = 0;
     AST_Node* stmt = node->data.compound_stmt.statements->head;
     while (stmt) {
         indent(ctx);
+        arc_begin_statement(ctx, stmt);
         
         if (stmt->type == NODE_COMPOUND_STATEMENT) {
             // If we have a nested compound statement, generate it directly
@@ -100,15 +125,19 @@ void generate_compound_statement_contents(CodeGenContext* ctx, AST_Node* node) {
             generate_code(ctx, stmt);
         }
         
+        arc_end_statement(ctx, stmt);
+        
         // If this was a return statement, don't process any more statements
         if (stmt->type == NODE_RETURN) {
+            ended_with_return = 1;
             break;
         }
         
         stmt = stmt->next;
     }
     
-    // End scope
+    // Release the block's owned locals, then end scope
+    arc_leave_block(ctx, node, ended_with_return);
     leave_scope(ctx->symtab);
 }
 
@@ -120,14 +149,7 @@ void generate_if_statement(CodeGenContext* ctx, AST_Node* node) {
     increase_indent(ctx);
     
     // Generate true branch
-    if (node->data.if_stmt.true_branch->type == NODE_COMPOUND_STATEMENT) {
-        // For compound statements, we generate the contents directly
-        generate_compound_statement_contents(ctx, node->data.if_stmt.true_branch);
-    } else {
-        // For single statements
-        indent(ctx);
-        generate_code(ctx, node->data.if_stmt.true_branch);
-    }
+    generate_body(ctx, node->data.if_stmt.true_branch);
     
     decrease_indent(ctx);
     indent(ctx);
@@ -137,14 +159,7 @@ void generate_if_statement(CodeGenContext* ctx, AST_Node* node) {
         fprintf(ctx->output, "} else {\n");
         increase_indent(ctx);
         
-        if (node->data.if_stmt.false_branch->type == NODE_COMPOUND_STATEMENT) {
-            // For compound statements, we generate the contents directly
-            generate_compound_statement_contents(ctx, node->data.if_stmt.false_branch);
-        } else {
-            // For single statements
-            indent(ctx);
-            generate_code(ctx, node->data.if_stmt.false_branch);
-        }
+        generate_body(ctx, node->data.if_stmt.false_branch);
         
         decrease_indent(ctx);
         indent(ctx);
@@ -187,12 +202,7 @@ void generate_match_statement(CodeGenContext* ctx, AST_Node* node) {
             increase_indent(ctx);
             
             // Generate case body
-            if (current_case->body->type == NODE_COMPOUND_STATEMENT) {
-                generate_compound_statement_contents(ctx, current_case->body);
-            } else {
-                indent(ctx);
-                generate_code(ctx, current_case->body);
-            }
+            generate_body(ctx, current_case->body);
             
             decrease_indent(ctx);
             indent(ctx);
@@ -250,15 +260,8 @@ void generate_for_in_statement(CodeGenContext* ctx, AST_Node* node) { // Renamed
         fprintf(ctx->output, "for (int %s = %s; %s < %s; %s++) {\n", var_name, start_var, var_name, end_var, var_name); // Use '<' for exclusive end
         increase_indent(ctx);
 
-        // Generate loop body
-        if (body->type == NODE_COMPOUND_STATEMENT) {
-            // Compound statement handles its own scope internally, but the loop var is outer
-            generate_compound_statement_contents(ctx, body);
-        } else {
-            // For single statements, generate directly within the loop scope
-            indent(ctx);
-            generate_code(ctx, body);
-        }
+        // Generate loop body; the loop variable belongs to the outer scope
+        generate_body(ctx, body);
 
         decrease_indent(ctx);
         indent(ctx);
@@ -285,9 +288,9 @@ void generate_for_in_statement(CodeGenContext* ctx, AST_Node* node) { // Renamed
         indent(ctx);
         // Determine variable type (e.g., char* for string array)
         const char* c_type = "void*"; // Default placeholder
-        if (var_type && strcmp(var_type->name, "string") == 0) {
+        if (var_type && var_type->name == interned_names()->string_type) {
              c_type = "char*";
-        } else if (var_type && strcmp(var_type->name, "int") == 0) {
+        } else if (var_type && var_type->name == interned_names()->int_type) {
              c_type = "int";
         } // Add more types as needed
 
@@ -298,12 +301,7 @@ void generate_for_in_statement(CodeGenContext* ctx, AST_Node* node) { // Renamed
         fprintf(ctx->output, "%s %s = (%s)array_get(%s, %s); // Placeholder access\n", c_type, var_name, c_type, array_var, index_var);
 
         // Generate loop body
-        if (body->type == NODE_COMPOUND_STATEMENT) {
-            generate_compound_statement_contents(ctx, body);
-        } else {
-            indent(ctx);
-            generate_code(ctx, body);
-        }
+        generate_body(ctx, body);
 
         decrease_indent(ctx);
         indent(ctx);
@@ -351,12 +349,12 @@ void generate_for_map_statement(CodeGenContext* ctx, AST_Node* node) { // Rename
     // Declare placeholder key/value variables inside the loop scope
     // Determine C types based on TypeInfo
     const char* c_key_type = "char*"; // Default placeholder
-    if (key_type && strcmp(key_type->name, "int") == 0) c_key_type = "int";
+    if (key_type && key_type->name == interned_names()->int_type) c_key_type = "int";
     // Add more key types
 
     const char* c_value_type = "void*"; // Default placeholder
-    if (value_type && strcmp(value_type->name, "int") == 0) c_value_type = "int";
-    else if (value_type && strcmp(value_type->name, "string") == 0) c_value_type = "char*";
+    if (value_type && value_type->name == interned_names()->int_type) c_value_type = "int";
+    else if (value_type && value_type->name == interned_names()->string_type) c_value_type = "char*";
     // Add more value types
 
     indent(ctx);
@@ -365,12 +363,7 @@ void generate_for_map_statement(CodeGenContext* ctx, AST_Node* node) { // Rename
     fprintf(ctx->output, "%s %s = (%s)map_get_value_placeholder(); // Placeholder value\n", c_value_type, value_name, c_value_type);
 
     // Generate loop body
-    if (body->type == NODE_COMPOUND_STATEMENT) {
-        generate_compound_statement_contents(ctx, body);
-    } else {
-        indent(ctx);
-        generate_code(ctx, body);
-    }
+    generate_body(ctx, body);
 
     decrease_indent(ctx);
     indent(ctx);
@@ -382,6 +375,11 @@ void generate_for_map_statement(CodeGenContext* ctx, AST_Node* node) { // Rename
 
 // Generate code for return statement
 void generate_return_statement(CodeGenContext* ctx, AST_Node* node) {
+    // Returns that have to release owned values are emitted by the ownership pass
+    if (arc_generate_return(ctx, node)) {
+        return;
+    }
+
     fprintf(ctx->output, "return");
     
     if (node->data.return_stmt.expression) {
@@ -394,21 +392,25 @@ void generate_return_statement(CodeGenContext* ctx, AST_Node* node) {
 
 // Generate code for while statement
 void generate_while_statement(CodeGenContext* ctx, AST_Node* node) {
-    fprintf(ctx->output, "while (");
-    generate_expression(ctx, node->data.while_statement.condition); // Use while_statement struct
-    fprintf(ctx->output, ") {\n");
-    increase_indent(ctx);
+    AST_Node* condition = node->data.while_statement.condition; // Use while_statement struct
 
-    // Generate loop body
-    AST_Node* body = node->data.while_statement.body; // Use while_statement struct
-    if (body->type == NODE_COMPOUND_STATEMENT) {
-        // Compound statement handles its own scope
-        generate_compound_statement_contents(ctx, body);
+    // A condition with owned temporaries is tested at the top of the body
+    int lowered = arc_loop_needs_lowering(ctx, condition);
+    if (lowered) {
+        fprintf(ctx->output, "while (1) {\n");
     } else {
-        // For single statements, generate directly
-        indent(ctx);
-        generate_code(ctx, body);
+        fprintf(ctx->output, "while (");
+        generate_expression(ctx, condition);
+        fprintf(ctx->output, ") {\n");
     }
+    increase_indent(ctx);
+
+    if (lowered) {
+        arc_emit_loop_exit(ctx, condition);
+    }
+
+    // Generate loop body
+    generate_body(ctx, node->data.while_statement.body); // Use while_statement struct
 
     decrease_indent(ctx);
     indent(ctx);
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "utils.h"
+#include "../intern.h"
 
 // Generate indentation
 void indent(CodeGenContext* ctx) {
@@ -40,24 +41,26 @@ char* get_label_name(CodeGenContext* ctx) {
 char* get_c_type(TypeInfo* type) {
     if (!type) return strdup("void");
     
-    if (strcmp(type->name, "int") == 0) {
+    // Type names are interned, so builtin types are matched by pointer
+    const InternedNames* names = interned_names();
+    if (type->name == names->int_type) {
         return strdup("int");
-    } else if (strcmp(type->name, "float") == 0) {
+    } else if (type->name == names->float_type) {
         return strdup("float");
-    } else if (strcmp(type->name, "bool") == 0) {
+    } else if (type->name == names->bool_type) {
         return strdup("int"); // C doesn't have bool, use int
-    } else if (strcmp(type->name, "string") == 0) {
-        return strdup("char*");
-    } else if (strcmp(type->name, "void") == 0) {
+    } else if (type->name == names->string_type) {
+        return strdup("zn_string_t");
+    } else if (type->name == names->void_type) {
         return strdup("void");
-    } else if (strcmp(type->name, "array") == 0 && type->generic_type) {
+    } else if (type->name == names->array_type && type->generic_type) {
         // For arrays, we need to create a pointer to the generic type
         char* inner_type = get_c_type(type->generic_type);
         char* array_type = (char*)malloc(strlen(inner_type) + 3);
         sprintf(array_type, "%s*", inner_type);
         free(inner_type);
         return array_type;
-    } else if (strcmp(type->name, "map") == 0) {
+    } else if (type->name == names->map_type) {
         // Placeholder for map type - use void* for now
         // TODO: Replace with actual map type (e.g., from a hashmap library)
         return strdup("void*");
@@ -68,3 +71,123 @@ char* get_c_type(TypeInfo* type) {
         return struct_type;
     }
 }
+
+// Count the bytes a quoted C string literal decodes to
+size_t string_literal_length(const char* quoted) {
+    size_t length = 0;
+    const char* p = quoted;
+    
+    if (*p == '"') p++;
+    
+    while (*p && *p != '"') {
+        if (*p == '\\' && p[1]) {
+            p++;
+            if (*p == 'x') {
+                // Hex escape: all following hex digits form one byte
+                p++;
+                while ((*p >= '0' && *p <= '9') || (*p >= 'a' && *p <= 'f') || (*p >= 'A' && *p <= 'F')) {
+                    p++;
+                }
+            } else if (*p >= '0' && *p <= '7') {
+                // Octal escape: up to three digits
+                int digits = 0;
+                while (digits < 3 && *p >= '0' && *p <= '7') {
+                    p++;
+                    digits++;
+                }
+            } else {
+                p++;
+            }
+        } else {
+            p++;
+        }
+        length++;
+    }
+    
+    return length;
+}
+
+// Find a struct declared at the top level of a program
+static AST_Node* find_struct_decl(AST_Node* program, const char* struct_name) {
+    if (!program || !program->data.program.declarations) return NULL;
+    
+    AST_Node* decl = program->data.program.declarations->head;
+    while (decl) {
+        if (decl->type == NODE_STRUCT && strcmp(decl->data.struct_decl.name, struct_name) == 0) {
+            return decl;
+        }
+        decl = decl->next;
+    }
+    
+    return NULL;
+}
+
+// Find the declared type of a struct field, following composition
+static TypeInfo* find_struct_field_type(CodeGenContext* ctx, const char* struct_name, const char* field_name) {
+    // The unit's own structs first, then those of the modules it imports
+    AST_Node* decl = find_struct_decl(ctx->program, struct_name);
+    for (int i = 0; !decl && i < ctx->import_count; i++) {
+        decl = find_struct_decl(ctx->imports[i].program, struct_name);
+    }
+    if (!decl) return NULL;
+    
+    StructField* field = decl->data.struct_decl.fields ? decl->data.struct_decl.fields->head : NULL;
+    while (field) {
+        if (strcmp(field->name, field_name) == 0) {
+            return field->type;
+        }
+        field = field->next;
+    }
+    
+    AST_Node* base = decl->data.struct_decl.composition ? decl->data.struct_decl.composition->head : NULL;
+    while (base) {
+        if (base->type == NODE_IDENTIFIER) {
+            TypeInfo* type = find_struct_field_type(ctx, base->data.identifier.name, field_name);
+            if (type) return type;
+        }
+        base = base->next;
+    }
+    
+    return NULL;
+}
+
+// Best-effort static type of an expression (NULL when unknown)
+TypeInfo* get_expression_type(CodeGenContext* ctx, AST_Node* node) {
+    SymbolEntry* symbol;
+    TypeInfo* object_type;
+    
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            symbol = lookup_interned_symbol(ctx->symtab, node->data.identifier.name);
+            return (symbol && symbol->type == SYMBOL_VARIABLE) ? symbol->type_info : NULL;
+            
+        case NODE_FUNCTION_CALL:
+            symbol = lookup_interned_symbol(ctx->symtab, node->data.function_call.name);
+            return (symbol && symbol->type == SYMBOL_FUNCTION) ? symbol->type_info : NULL;
+            
+        case NODE_MEMBER_ACCESS:
+            object_type = get_expression_type(ctx, node->data.member_access.object);
+            if (!object_type) return NULL;
+            return find_struct_field_type(ctx, object_type->name, node->data.member_access.member);
+            
+        default:
+            return NULL;
+    }
+}
+
+// Check whether an expression produces a zn_string_t value
+int is_string_expression(CodeGenContext* ctx, AST_Node* node) {
+    if (!node) return 0;
+    
+    if (node->type == NODE_LITERAL_STRING) {
+        return 1;
+    }
+    
+    if (node->type == NODE_BINARY_OP && node->data.binary_op.op == OP_ADD) {
+        return is_string_expression(ctx, node->data.binary_op.left) ||
+               is_string_expression(ctx, node->data.binary_op.right);
+    }
+    
+    TypeInfo* type = get_expression_type(ctx, node);
+    return type && type->name == interned_names()->string_type;
+}
@@ -11,5 +11,8 @@ void decrease_indent(CodeGenContext* ctx);
 char* get_temp_var_name(CodeGenContext* ctx);
 char* get_label_name(CodeGenContext* ctx);
 char* get_c_type(TypeInfo* type);
+size_t string_literal_length(const char* quoted);
+TypeInfo* get_expression_type(CodeGenContext* ctx, AST_Node* node);
+int is_string_expression(CodeGenContext* ctx, AST_Node* node);
 
 #endif // CODEGEN_UTILS_H
@@ -0,0 +1,611 @@
+/**
+ * @file conn_pool.c
+ * @brief Implementation of the outbound connection pool
+ */
+
+#define _GNU_SOURCE
+#include "conn_pool.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include "reactor.h"
+#include "threads.h"
+
+#define POOL_BUCKETS 64
+
+struct pool_host;
+
+typedef struct pool_connection {
+    socket_t socket;                /* First, so the socket_t * handed out converts back */
+    struct pool_host *host;
+    uint64_t idle_since_ms;
+    struct pool_connection *next;   /* In the idle list, or a list of connections to close */
+} pool_connection_t;
+
+/* An asynchronous checkout queued at max_active */
+typedef struct pool_waiter {
+    zn_promise_t *promise;
+    struct pool_waiter *next;
+} pool_waiter_t;
+
+typedef struct pool_host {
+    char *hostname;
+    int port;
+    uint32_t hash;
+    pool_connection_t *idle;        /* Most recently checked in first */
+    size_t idle_count;
+    size_t active;                  /* Checked out or connecting */
+    pool_waiter_t *waiters;
+    pool_waiter_t **waiters_tail;
+    struct pool_host *next;
+} pool_host_t;
+
+struct zn_conn_pool {
+    zn_conn_pool_config_t config;
+    zn_mutex_t mutex;
+    zn_cond_t available;            /* A slot or an idle connection was freed */
+    size_t blocked;                 /* Threads waiting on available */
+    pool_host_t *buckets[POOL_BUCKETS];
+    zn_conn_pool_stats_t stats;
+    zn_reactor_group_t *connector;  /* One reactor for asynchronous connects, started on first use */
+    struct pool_connect *connecting; /* Requests posted to the connector and not finished */
+    bool closing;                   /* Set by zn_conn_pool_destroy; no new connects start */
+};
+
+/* An asynchronous connect in progress */
+typedef struct pool_connect {
+    zn_conn_pool_t *pool;
+    pool_connection_t *connection;
+    zn_promise_t *promise;
+    struct pool_connect *next;      /* In pool->connecting */
+    struct pool_connect **link;     /* Pointer to this request in pool->connecting, NULL if not in it */
+} pool_connect_t;
+
+static void release_slot(zn_conn_pool_t *pool, pool_host_t *host);
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/* Host names are case-insensitive */
+static uint32_t hash_host(const char *hostname, int port) {
+    uint32_t hash = 2166136261u;
+    for (const char *c = hostname; *c; c++) {
+        char lower = (*c >= 'A' && *c <= 'Z') ? (char)(*c - 'A' + 'a') : *c;
+        hash = (hash ^ (uint8_t)lower) * 16777619u;
+    }
+    return (hash ^ (uint32_t)port) * 16777619u;
+}
+
+void zn_conn_pool_config_init(zn_conn_pool_config_t *config) {
+    if (!config) {
+        return;
+    }
+
+    memset(config, 0, sizeof(*config));
+    config->max_idle = ZN_CONN_POOL_DEFAULT_MAX_IDLE;
+    config->max_active = 0;
+    config->idle_timeout_ms = ZN_CONN_POOL_DEFAULT_IDLE_TIMEOUT_MS;
+}
+
+zn_conn_pool_t *zn_conn_pool_create(const zn_conn_pool_config_t *config) {
+    zn_conn_pool_t *pool = (zn_conn_pool_t *)calloc(1, sizeof(zn_conn_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+
+    if (config) {
+        pool->config = *config;
+    } else {
+        zn_conn_pool_config_init(&pool->config);
+    }
+    if (zn_mutex_init(&pool->mutex) != 0 || zn_cond_init(&pool->available) != 0) {
+        free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+static void close_connections(pool_connection_t *list) {
+    while (list) {
+        pool_connection_t *next = list->next;
+        socket_close(&list->socket);
+        free(list);
+        list = next;
+    }
+}
+
+void zn_conn_pool_destroy(zn_conn_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+
+    zn_mutex_lock(&pool->mutex);
+    pool->closing = true;
+    zn_mutex_unlock(&pool->mutex);
+
+    // Stopping the connector drops the connects it has not finished; their
+    // checkouts are cancelled here instead of never settling
+    zn_reactor_group_destroy(pool->connector);
+    zn_mutex_lock(&pool->mutex);
+    pool_connect_t *request = pool->connecting;
+    pool->connecting = NULL;
+    zn_mutex_unlock(&pool->mutex);
+    while (request) {
+        pool_connect_t *next = request->next;
+        socket_close(&request->connection->socket);
+        free(request->connection);
+        zn_promise_fail(request->promise, (void *)(intptr_t)ECANCELED);
+        free(request);
+        request = next;
+    }
+
+    for (size_t i = 0; i < POOL_BUCKETS; i++) {
+        pool_host_t *host = pool->buckets[i];
+        while (host) {
+            pool_host_t *next = host->next;
+            close_connections(host->idle);
+            while (host->waiters) {
+                pool_waiter_t *waiter = host->waiters;
+                host->waiters = waiter->next;
+                zn_promise_fail(waiter->promise, (void *)(intptr_t)ECANCELED);
+                free(waiter);
+            }
+            free(host->hostname);
+            free(host);
+            host = next;
+        }
+    }
+    zn_cond_destroy(&pool->available);
+    zn_mutex_destroy(&pool->mutex);
+    free(pool);
+}
+
+/* Called with the pool locked; hosts live as long as the pool */
+static pool_host_t *host_get(zn_conn_pool_t *pool, const char *hostname, int port) {
+    uint32_t hash = hash_host(hostname, port);
+    pool_host_t **bucket = &pool->buckets[hash % POOL_BUCKETS];
+    for (pool_host_t *host = *bucket; host; host = host->next) {
+        if (host->hash == hash && host->port == port && strcasecmp(host->hostname, hostname) == 0) {
+            return host;
+        }
+    }
+
+    pool_host_t *host = (pool_host_t *)calloc(1, sizeof(pool_host_t));
+    if (!host || !(host->hostname = strdup(hostname))) {
+        free(host);
+        return NULL;
+    }
+    host->port = port;
+    host->hash = hash;
+    host->waiters_tail = &host->waiters;
+    host->next = *bucket;
+    *bucket = host;
+    return host;
+}
+
+/* Called with the pool locked. The idle list is ordered by age, so the
+ * expired connections are a tail; they are added to closed to be closed
+ * after unlocking. */
+static size_t expire(zn_conn_pool_t *pool, pool_host_t *host, uint64_t now, pool_connection_t **closed) {
+    if (pool->config.idle_timeout_ms == 0) {
+        return 0;
+    }
+
+    pool_connection_t **link = &host->idle;
+    while (*link && now - (*link)->idle_since_ms < pool->config.idle_timeout_ms) {
+        link = &(*link)->next;
+    }
+
+    size_t count = 0;
+    pool_connection_t *connection = *link;
+    *link = NULL;
+    while (connection) {
+        pool_connection_t *next = connection->next;
+        connection->next = *closed;
+        *closed = connection;
+        connection = next;
+        count++;
+    }
+    host->idle_count -= count;
+    pool->stats.expired += count;
+    return count;
+}
+
+/* An idle connection is healthy if there is nothing to read: end of
+ * stream means the peer closed it, and data nobody asked for means it is
+ * out of step with the protocol */
+static bool connection_alive(pool_connection_t *connection) {
+    char byte;
+    ssize_t peeked = recv(connection->socket.fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return peeked < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+/* Take a healthy idle connection, with a slot reserved for it. Called with
+ * the pool locked; unlocks while health checking and returns locked. */
+static pool_connection_t *take_idle(zn_conn_pool_t *pool, pool_host_t *host) {
+    pool_connection_t *closed = NULL;
+    pool_connection_t *connection = NULL;
+
+    expire(pool, host, now_ms(), &closed);
+    while (host->idle) {
+        connection = host->idle;
+        host->idle = connection->next;
+        host->idle_count--;
+        host->active++;
+        zn_mutex_unlock(&pool->mutex);
+
+        bool alive = connection_alive(connection);
+        zn_mutex_lock(&pool->mutex);
+        if (alive) {
+            pool->stats.reuses++;
+            break;
+        }
+        pool->stats.stale++;
+        host->active--;
+        connection->next = closed;
+        closed = connection;
+        connection = NULL;
+    }
+
+    if (closed) {
+        zn_mutex_unlock(&pool->mutex);
+        close_connections(closed);
+        zn_mutex_lock(&pool->mutex);
+    }
+    return connection;
+}
+
+static bool slot_free(zn_conn_pool_t *pool, pool_host_t *host) {
+    return pool->config.max_active == 0 || host->active < pool->config.max_active;
+}
+
+static int open_connection(pool_host_t *host, pool_connection_t **out) {
+    pool_connection_t *connection = (pool_connection_t *)calloc(1, sizeof(pool_connection_t));
+    if (!connection) {
+        return ENOMEM;
+    }
+    connection->host = host;
+
+    socket_result_t res = socket_create(&connection->socket, SOCKET_TCP);
+    if (res.success) {
+        res = socket_connect(&connection->socket, host->hostname, host->port);
+        if (!res.success) {
+            socket_close(&connection->socket);
+        }
+    }
+    if (!res.success) {
+        free(connection);
+        return res.error_code ? res.error_code : ECONNREFUSED;
+    }
+    *out = connection;
+    return 0;
+}
+
+int zn_conn_pool_checkout(zn_conn_pool_t *pool, const char *hostname, int port, socket_t **out) {
+    if (!pool || !hostname || !out || port <= 0 || port > 65535) {
+        return EINVAL;
+    }
+
+    zn_mutex_lock(&pool->mutex);
+    pool_host_t *host = host_get(pool, hostname, port);
+    if (!host) {
+        zn_mutex_unlock(&pool->mutex);
+        return ENOMEM;
+    }
+
+    pool_connection_t *connection;
+    for (;;) {
+        connection = take_idle(pool, host);
+        if (connection || slot_free(pool, host)) {
+            break;
+        }
+        pool->blocked++;
+        zn_cond_wait(&pool->available, &pool->mutex);
+        pool->blocked--;
+    }
+    if (!connection) {
+        host->active++;
+    }
+    zn_mutex_unlock(&pool->mutex);
+
+    if (connection) {
+        // Connections checked in from asynchronous code are non-blocking
+        if (connection->socket.is_nonblocking) {
+            socket_set_nonblocking(&connection->socket, false);
+        }
+        *out = &connection->socket;
+        return 0;
+    }
+
+    int result = open_connection(host, &connection);
+    zn_mutex_lock(&pool->mutex);
+    if (result == 0) {
+        pool->stats.connects++;
+    } else {
+        pool->stats.failures++;
+    }
+    zn_mutex_unlock(&pool->mutex);
+
+    if (result != 0) {
+        release_slot(pool, host);
+        return result;
+    }
+    *out = &connection->socket;
+    return 0;
+}
+
+/* Asynchronous connects run on the connector reactor */
+
+/* Called with the pool locked */
+static void connect_unlink(pool_connect_t *request) {
+    if (request->link) {
+        *request->link = request->next;
+        if (request->next) {
+            request->next->link = request->link;
+        }
+        request->link = NULL;
+    }
+}
+
+static void connect_finish(pool_connect_t *request, int error) {
+    zn_conn_pool_t *pool = request->pool;
+    pool_connection_t *connection = request->connection;
+    zn_promise_t *promise = request->promise;
+
+    zn_mutex_lock(&pool->mutex);
+    connect_unlink(request);
+    free(request);
+    if (error == 0) {
+        pool->stats.connects++;
+    } else {
+        pool->stats.failures++;
+    }
+    zn_mutex_unlock(&pool->mutex);
+
+    if (error == 0) {
+        zn_promise_fulfill(promise, &connection->socket);
+        return;
+    }
+    pool_host_t *host = connection->host;
+    socket_close(&connection->socket);
+    free(connection);
+    release_slot(pool, host);
+    zn_promise_fail(promise, (void *)(intptr_t)error);
+}
+
+static void on_connected(zn_reactor_t *reactor, socket_t *socket, int error, void *data) {
+    // Hand the socket back unregistered so socket_async can take it over
+    zn_reactor_remove(reactor, socket);
+    connect_finish((pool_connect_t *)data, error);
+}
+
+static void connect_begin(zn_reactor_t *reactor, void *data) {
+    pool_connect_t *request = (pool_connect_t *)data;
+    pool_host_t *host = request->connection->host;
+    int result = zn_reactor_connect(reactor, &request->connection->socket, host->hostname, host->port,
+                                    on_connected, request);
+    if (result != 0) {
+        zn_reactor_remove(reactor, &request->connection->socket);
+        connect_finish(request, result);
+    }
+}
+
+/* Post request to the connector, starting it on first use, and track it
+ * until it finishes. Called with the pool locked. */
+static int connector_post(zn_conn_pool_t *pool, pool_connect_t *request) {
+    if (pool->closing) {
+        return ECANCELED;
+    }
+    if (!pool->connector) {
+        zn_reactor_group_t *group = zn_reactor_group_create(1);
+        if (group && zn_reactor_group_start(group) != 0) {
+            zn_reactor_group_destroy(group);
+            group = NULL;
+        }
+        if (!group) {
+            return EAGAIN;
+        }
+        pool->connector = group;
+    }
+
+    int result = zn_reactor_post(zn_reactor_group_get(pool->connector, 0), connect_begin, request);
+    if (result == 0) {
+        request->next = pool->connecting;
+        if (request->next) {
+            request->next->link = &request->next;
+        }
+        request->link = &pool->connecting;
+        pool->connecting = request;
+    }
+    return result;
+}
+
+/* Open a connection for promise in a slot already reserved */
+static void connect_async(zn_conn_pool_t *pool, pool_host_t *host, zn_promise_t *promise) {
+    pool_connect_t *request = (pool_connect_t *)calloc(1, sizeof(pool_connect_t));
+    pool_connection_t *connection = (pool_connection_t *)calloc(1, sizeof(pool_connection_t));
+    if (!request || !connection) {
+        free(request);
+        free(connection);
+        release_slot(pool, host);
+        zn_promise_fail(promise, (void *)(intptr_t)ENOMEM);
+        return;
+    }
+    connection->host = host;
+    request->pool = pool;
+    request->connection = connection;
+    request->promise = promise;
+
+    socket_result_t res = socket_create(&connection->socket, SOCKET_TCP);
+    if (!res.success) {
+        free(connection);
+        free(request);
+        release_slot(pool, host);
+        zn_promise_fail(promise, (void *)(intptr_t)(res.error_code ? res.error_code : EMFILE));
+        return;
+    }
+
+    zn_mutex_lock(&pool->mutex);
+    int result = connector_post(pool, request);
+    zn_mutex_unlock(&pool->mutex);
+    if (result != 0) {
+        connect_finish(request, result);
+    }
+}
+
+zn_promise_t *zn_conn_pool_checkout_async(zn_conn_pool_t *pool, const char *hostname, int port) {
+    zn_promise_t *promise = zn_promise_deferred();
+    if (!promise) {
+        return NULL;
+    }
+    if (!pool || !hostname || port <= 0 || port > 65535) {
+        zn_promise_fail(promise, (void *)(intptr_t)EINVAL);
+        return promise;
+    }
+
+    zn_mutex_lock(&pool->mutex);
+    pool_host_t *host = host_get(pool, hostname, port);
+    if (!host) {
+        zn_mutex_unlock(&pool->mutex);
+        zn_promise_fail(promise, (void *)(intptr_t)ENOMEM);
+        return promise;
+    }
+
+    pool_connection_t *connection = take_idle(pool, host);
+    if (connection) {
+        zn_mutex_unlock(&pool->mutex);
+        zn_promise_fulfill(promise, &connection->socket);
+        return promise;
+    }
+
+    if (slot_free(pool, host)) {
+        host->active++;
+        zn_mutex_unlock(&pool->mutex);
+        connect_async(pool, host, promise);
+        return promise;
+    }
+
+    pool_waiter_t *waiter = (pool_waiter_t *)calloc(1, sizeof(pool_waiter_t));
+    if (!waiter) {
+        zn_mutex_unlock(&pool->mutex);
+        zn_promise_fail(promise, (void *)(intptr_t)ENOMEM);
+        return promise;
+    }
+    waiter->promise = promise;
+    *host->waiters_tail = waiter;
+    host->waiters_tail = &waiter->next;
+    zn_mutex_unlock(&pool->mutex);
+    return promise;
+}
+
+/* Called with the pool locked */
+static pool_waiter_t *dequeue_waiter(pool_host_t *host) {
+    pool_waiter_t *waiter = host->waiters;
+    if (waiter) {
+        host->waiters = waiter->next;
+        if (!host->waiters) {
+            host->waiters_tail = &host->waiters;
+        }
+    }
+    return waiter;
+}
+
+/* A slot was given up without an idle connection to show for it: a queued
+ * asynchronous checkout inherits the slot, otherwise it is freed */
+static void release_slot(zn_conn_pool_t *pool, pool_host_t *host) {
+    zn_mutex_lock(&pool->mutex);
+    pool_waiter_t *waiter = dequeue_waiter(host);
+    if (!waiter) {
+        host->active--;
+        if (pool->blocked) {
+            zn_cond_broadcast(&pool->available);
+        }
+    }
+    zn_mutex_unlock(&pool->mutex);
+
+    if (waiter) {
+        connect_async(pool, host, waiter->promise);
+        free(waiter);
+    }
+}
+
+void zn_conn_pool_checkin(zn_conn_pool_t *pool, socket_t *connection, bool reusable) {
+    if (!pool || !connection) {
+        return;
+    }
+
+    pool_connection_t *pooled = (pool_connection_t *)connection;
+    pool_host_t *host = pooled->host;
+    reusable = reusable && connection->fd >= 0 && connection->is_connected;
+
+    pool_connection_t *closed = NULL;
+    zn_mutex_lock(&pool->mutex);
+    uint64_t now = now_ms();
+    expire(pool, host, now, &closed);
+    if (reusable) {
+        pool_waiter_t *waiter = dequeue_waiter(host);
+        if (waiter) {
+            // The slot goes with the connection
+            pool->stats.reuses++;
+            zn_mutex_unlock(&pool->mutex);
+            close_connections(closed);
+            zn_promise_fulfill(waiter->promise, connection);
+            free(waiter);
+            return;
+        }
+        if (host->idle_count < pool->config.max_idle) {
+            pooled->idle_since_ms = now;
+            pooled->next = host->idle;
+            host->idle = pooled;
+            host->idle_count++;
+            host->active--;
+            if (pool->blocked) {
+                zn_cond_broadcast(&pool->available);
+            }
+            zn_mutex_unlock(&pool->mutex);
+            close_connections(closed);
+            return;
+        }
+    }
+    zn_mutex_unlock(&pool->mutex);
+
+    pooled->next = closed;
+    close_connections(pooled);
+    release_slot(pool, host);
+}
+
+size_t zn_conn_pool_prune(zn_conn_pool_t *pool) {
+    if (!pool) {
+        return 0;
+    }
+
+    pool_connection_t *closed = NULL;
+    size_t count = 0;
+    zn_mutex_lock(&pool->mutex);
+    uint64_t now = now_ms();
+    for (size_t i = 0; i < POOL_BUCKETS; i++) {
+        for (pool_host_t *host = pool->buckets[i]; host; host = host->next) {
+            count += expire(pool, host, now, &closed);
+        }
+    }
+    zn_mutex_unlock(&pool->mutex);
+
+    close_connections(closed);
+    return count;
+}
+
+void zn_conn_pool_stats(zn_conn_pool_t *pool, zn_conn_pool_stats_t *out) {
+    if (!pool || !out) {
+        return;
+    }
+
+    zn_mutex_lock(&pool->mutex);
+    *out = pool->stats;
+    zn_mutex_unlock(&pool->mutex);
+}
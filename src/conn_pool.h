@@ -0,0 +1,144 @@
+/**
+ * @file conn_pool.h
+ * @brief Pool of outbound TCP connections, reused across requests
+ *
+ * Connections are kept per host:port. Checking one out returns an idle
+ * connection to the same upstream if there is one, skipping the handshake
+ * (and the lookup), and opens a new one otherwise. Checking it back in
+ * keeps it for the next caller.
+ *
+ * Before an idle connection is handed out, it is peeked without blocking:
+ * if the peer has closed it (end of stream), reset it, or sent unexpected
+ * data, it is closed and the next one is tried. Idle connections older
+ * than the idle timeout are closed when their host is next used, or by
+ * zn_conn_pool_prune.
+ *
+ * max_active bounds the connections to one host that are checked out or
+ * connecting. When it is reached, zn_conn_pool_checkout blocks and
+ * zn_conn_pool_checkout_async queues until a connection is checked in.
+ * Queued asynchronous checkouts are served first, in order.
+ *
+ * All functions are thread-safe. Connections handed out by the blocking
+ * call are in blocking mode; the asynchronous call hands them out as they
+ * are, to be used with the socket_async.h operations (which make them
+ * non-blocking).
+ */
+
+#ifndef ZENO_CONN_POOL_H
+#define ZENO_CONN_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "promise.h"
+#include "socket.h"
+
+/** Idle connections kept per host unless configured otherwise */
+#define ZN_CONN_POOL_DEFAULT_MAX_IDLE 8
+
+/** Idle lifetime unless configured otherwise */
+#define ZN_CONN_POOL_DEFAULT_IDLE_TIMEOUT_MS 60000
+
+/**
+ * Pool settings; start from zn_conn_pool_config_init
+ */
+typedef struct {
+    size_t max_idle;               /**< Idle connections kept per host */
+    size_t max_active;             /**< Checked out or connecting per host, 0 for no limit */
+    uint32_t idle_timeout_ms;      /**< Idle connections older than this are closed, 0 for never */
+} zn_conn_pool_config_t;
+
+/**
+ * Counters since the pool was created
+ */
+typedef struct {
+    uint64_t connects;             /**< New connections opened */
+    uint64_t reuses;               /**< Checkouts served by an idle connection */
+    uint64_t stale;                /**< Idle connections closed by the health check */
+    uint64_t expired;              /**< Idle connections closed by the idle timeout */
+    uint64_t failures;             /**< Connects that failed */
+} zn_conn_pool_stats_t;
+
+/**
+ * Opaque pool handle
+ */
+typedef struct zn_conn_pool zn_conn_pool_t;
+
+/**
+ * Fill in the defaults: ZN_CONN_POOL_DEFAULT_MAX_IDLE idle connections per
+ * host, no active limit, ZN_CONN_POOL_DEFAULT_IDLE_TIMEOUT_MS
+ *
+ * @param config Settings to initialize
+ */
+void zn_conn_pool_config_init(zn_conn_pool_config_t *config);
+
+/**
+ * Create a pool
+ *
+ * @param config Settings, copied; NULL for the defaults
+ * @return New pool, or NULL on allocation failure
+ */
+zn_conn_pool_t *zn_conn_pool_create(const zn_conn_pool_config_t *config);
+
+/**
+ * Close the idle connections and free the pool. Every connection must
+ * have been checked in. Asynchronous checkouts still queued or still
+ * connecting are rejected with ECANCELED, and their sockets closed.
+ *
+ * @param pool Pool to destroy
+ */
+void zn_conn_pool_destroy(zn_conn_pool_t *pool);
+
+/**
+ * Check out a connection, blocking while connecting or while the host is
+ * at max_active
+ *
+ * @param pool The pool
+ * @param hostname Host name or IPv4/IPv6 address
+ * @param port Port number
+ * @param out Where to store the connection
+ * @return 0 on success, otherwise an errno value
+ */
+int zn_conn_pool_checkout(zn_conn_pool_t *pool, const char *hostname, int port, socket_t **out);
+
+/**
+ * Check out a connection without blocking. New connections are opened on
+ * a thread owned by the pool.
+ *
+ * @param pool The pool
+ * @param hostname Host name or IPv4/IPv6 address
+ * @param port Port number
+ * @return Promise for the socket_t *, rejected with an errno value as
+ *         (intptr_t); NULL on allocation failure
+ */
+zn_promise_t *zn_conn_pool_checkout_async(zn_conn_pool_t *pool, const char *hostname, int port);
+
+/**
+ * Return a connection. Pass reusable = false if it is not in a clean state
+ * for the next request (an error, a half-read response, a peer that asked
+ * to close); it is then closed. Connections no longer connected are
+ * closed either way.
+ *
+ * @param pool The pool the connection came from
+ * @param connection Connection from zn_conn_pool_checkout(_async)
+ * @param reusable Whether the connection can serve another request
+ */
+void zn_conn_pool_checkin(zn_conn_pool_t *pool, socket_t *connection, bool reusable);
+
+/**
+ * Close idle connections past the idle timeout, for every host
+ *
+ * @param pool The pool
+ * @return Number of connections closed
+ */
+size_t zn_conn_pool_prune(zn_conn_pool_t *pool);
+
+/**
+ * Read the pool's counters
+ *
+ * @param pool The pool
+ * @param out Where to store them
+ */
+void zn_conn_pool_stats(zn_conn_pool_t *pool, zn_conn_pool_stats_t *out);
+
+#endif /* ZENO_CONN_POOL_H */
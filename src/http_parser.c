@@ -0,0 +1,423 @@
+/**
+ * @file http_parser.c
+ * @brief Implementation of the HTTP/1.x head parser
+ */
+
+#include "http_parser.h"
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+#if defined(__SSE2__) && !defined(ZN_HTTP_NO_SIMD)
+#include <emmintrin.h>
+#define HTTP_SIMD 1
+#endif
+
+/* Connection header verdict */
+#define CONNECTION_DEFAULT 0
+#define CONNECTION_CLOSE 1
+#define CONNECTION_KEEP_ALIVE 2
+
+/* First byte in [p, end) equal to a, b or c */
+static const char *find_any(const char *p, const char *end, char a, char b, char c) {
+#ifdef HTTP_SIMD
+    __m128i va = _mm_set1_epi8(a);
+    __m128i vb = _mm_set1_epi8(b);
+    __m128i vc = _mm_set1_epi8(c);
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)),
+                                   _mm_cmpeq_epi8(chunk, vc));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask) {
+            return p + __builtin_ctz((unsigned)mask);
+        }
+        p += 16;
+    }
+#endif
+    for (; p < end; p++) {
+        if (*p == a || *p == b || *p == c) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* First control character (below 0x20, or DEL) in [p, end). The line end
+ * is the first one in a well-formed line, so this finds it and checks the
+ * line in one pass. */
+static const char *find_control(const char *p, const char *end) {
+#ifdef HTTP_SIMD
+    __m128i space = _mm_set1_epi8(0x20);
+    __m128i del = _mm_set1_epi8(0x7f);
+    __m128i zero = _mm_setzero_si128();
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        // Signed compares: bytes from 0x80 up are negative, not controls
+        __m128i low = _mm_andnot_si128(_mm_cmplt_epi8(chunk, zero), _mm_cmplt_epi8(chunk, space));
+        int mask = _mm_movemask_epi8(_mm_or_si128(low, _mm_cmpeq_epi8(chunk, del)));
+        if (mask) {
+            return p + __builtin_ctz((unsigned)mask);
+        }
+        p += 16;
+    }
+#endif
+    for (; p < end; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c < 0x20 || c == 0x7f) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* tchar of RFC 9110: the characters allowed in methods and header names */
+static bool is_token_char(unsigned char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+        return true;
+    }
+    return c != 0 && strchr("!#$%&'*+-.^_`|~", c) != NULL;
+}
+
+static bool is_token(const char *p, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (!is_token_char((unsigned char)p[i])) {
+            return false;
+        }
+    }
+    return length > 0;
+}
+
+/* Step over CRLF or a bare LF at *p */
+static int skip_line_end(const char **p, const char *end) {
+    const char *q = *p;
+    if (q == end) {
+        return EAGAIN;
+    }
+    if (*q == '\r') {
+        if (++q == end) {
+            return EAGAIN;
+        }
+        if (*q != '\n') {
+            return EBADMSG;
+        }
+    } else if (*q != '\n') {
+        return EBADMSG;
+    }
+    *p = q + 1;
+    return 0;
+}
+
+/* The end of the line starting at p, tabs allowed, other controls not */
+static int find_line_end(const char *p, const char *end, const char **eol) {
+    for (;;) {
+        const char *q = find_control(p, end);
+        if (!q) {
+            return EAGAIN;
+        }
+        if (*q == '\r' || *q == '\n') {
+            *eol = q;
+            return 0;
+        }
+        if (*q != '\t') {
+            return EBADMSG;
+        }
+        p = q + 1;
+    }
+}
+
+static bool equals_ignore_case(const char *p, size_t length, const char *literal) {
+    return strlen(literal) == length && strncasecmp(p, literal, length) == 0;
+}
+
+/* "HTTP/1.x" */
+static int parse_version(const char *p, const char *end, int *minor_version) {
+    if (end - p < 8) {
+        return memcmp(p, "HTTP/1.", (size_t)(end - p) < 7 ? (size_t)(end - p) : 7) == 0 ? EAGAIN : EBADMSG;
+    }
+    if (memcmp(p, "HTTP/1.", 7) != 0 || p[7] < '0' || p[7] > '9') {
+        return EBADMSG;
+    }
+    *minor_version = p[7] - '0';
+    return 0;
+}
+
+static int parse_content_length(const zn_http_header_t *header, bool *seen, size_t *content_length) {
+    size_t value = 0;
+    if (header->value_length == 0) {
+        return EBADMSG;
+    }
+    for (size_t i = 0; i < header->value_length; i++) {
+        char c = header->value[i];
+        if (c < '0' || c > '9' || value > (SIZE_MAX - 9) / 10) {
+            return EBADMSG;
+        }
+        value = value * 10 + (size_t)(c - '0');
+    }
+    if (*seen && value != *content_length) {
+        return EBADMSG;
+    }
+    *seen = true;
+    *content_length = value;
+    return 0;
+}
+
+/* Apply a comma-separated Connection or Transfer-Encoding value */
+static void scan_list(const zn_http_header_t *header, int *connection, bool *chunked) {
+    const char *p = header->value;
+    const char *end = p + header->value_length;
+    while (p < end) {
+        const char *comma = memchr(p, ',', (size_t)(end - p));
+        const char *item_end = comma ? comma : end;
+        while (p < item_end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        const char *q = item_end;
+        while (q > p && (q[-1] == ' ' || q[-1] == '\t')) {
+            q--;
+        }
+
+        size_t length = (size_t)(q - p);
+        if (connection) {
+            if (equals_ignore_case(p, length, "close")) {
+                *connection = CONNECTION_CLOSE;
+            } else if (equals_ignore_case(p, length, "keep-alive") && *connection != CONNECTION_CLOSE) {
+                *connection = CONNECTION_KEEP_ALIVE;
+            }
+        } else {
+            // Only a final chunked coding frames the body
+            *chunked = equals_ignore_case(p, length, "chunked");
+        }
+        p = comma ? comma + 1 : end;
+    }
+}
+
+/* Header lines from p up to and including the empty line */
+static int parse_headers(const char *start, const char *p, const char *end, zn_http_message_t *message) {
+    int connection = CONNECTION_DEFAULT;
+    bool has_length = false;
+    bool has_encoding = false;
+
+    message->header_count = 0;
+    message->content_length = 0;
+    message->chunked = false;
+    for (;;) {
+        if (p == end) {
+            return EAGAIN;
+        }
+        if (*p == '\r' || *p == '\n') {
+            int result = skip_line_end(&p, end);
+            if (result != 0) {
+                return result;
+            }
+            break;
+        }
+
+        // Also rejects folded lines, which start with whitespace
+        const char *colon = find_any(p, end, ':', '\r', '\n');
+        if (!colon) {
+            return EAGAIN;
+        }
+        if (*colon != ':' || !is_token(p, (size_t)(colon - p))) {
+            return EBADMSG;
+        }
+
+        const char *value = colon + 1;
+        while (value < end && (*value == ' ' || *value == '\t')) {
+            value++;
+        }
+        const char *eol;
+        int result = find_line_end(value, end, &eol);
+        if (result != 0) {
+            return result;
+        }
+        const char *value_end = eol;
+        while (value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t')) {
+            value_end--;
+        }
+        if ((result = skip_line_end(&eol, end)) != 0) {
+            return result;
+        }
+
+        if (message->header_count == ZN_HTTP_MAX_HEADERS) {
+            return E2BIG;
+        }
+        zn_http_header_t *header = &message->headers[message->header_count++];
+        header->name = p;
+        header->name_length = (size_t)(colon - p);
+        header->value = value;
+        header->value_length = (size_t)(value_end - value);
+
+        if (equals_ignore_case(header->name, header->name_length, "content-length")) {
+            if ((result = parse_content_length(header, &has_length, &message->content_length)) != 0) {
+                return result;
+            }
+        } else if (equals_ignore_case(header->name, header->name_length, "transfer-encoding")) {
+            has_encoding = true;
+            scan_list(header, NULL, &message->chunked);
+        } else if (equals_ignore_case(header->name, header->name_length, "connection")) {
+            scan_list(header, &connection, NULL);
+        }
+        p = eol;
+    }
+
+    // Both framings at once is how requests are smuggled past proxies
+    if (has_length && has_encoding) {
+        return EBADMSG;
+    }
+    message->has_encoding = has_encoding;
+    message->head_length = (size_t)(p - start);
+    message->keep_alive = message->minor_version >= 1 ? connection != CONNECTION_CLOSE
+                                                      : connection == CONNECTION_KEEP_ALIVE;
+    return 0;
+}
+
+int zn_http_parse_request(const char *data, size_t length, zn_http_request_t *request) {
+    if (!data || !request) {
+        return EINVAL;
+    }
+
+    const char *start = data;
+    const char *end = data + length;
+    const char *p = start;
+    while (p < end && (*p == '\r' || *p == '\n')) {
+        p++;
+    }
+    if (p == end) {
+        return EAGAIN;
+    }
+
+    const char *space = find_any(p, end, ' ', '\r', '\n');
+    if (!space) {
+        return EAGAIN;
+    }
+    if (*space != ' ' || !is_token(p, (size_t)(space - p))) {
+        return EBADMSG;
+    }
+    request->method = p;
+    request->method_length = (size_t)(space - p);
+
+    p = space + 1;
+    space = find_any(p, end, ' ', '\r', '\n');
+    if (!space) {
+        return EAGAIN;
+    }
+    if (*space != ' ' || space == p) {
+        return EBADMSG;
+    }
+    const char *control = find_control(p, space);
+    if (control) {
+        return EBADMSG;
+    }
+    request->target = p;
+    request->target_length = (size_t)(space - p);
+
+    p = space + 1;
+    int result = parse_version(p, end, &request->message.minor_version);
+    if (result != 0) {
+        return result;
+    }
+    p += 8;
+    if ((result = skip_line_end(&p, end)) != 0) {
+        return result;
+    }
+    if ((result = parse_headers(start, p, end, &request->message)) != 0) {
+        return result;
+    }
+
+    // A request body without a final chunked coding has no knowable end
+    if (request->message.has_encoding && !request->message.chunked) {
+        return EBADMSG;
+    }
+    return 0;
+}
+
+int zn_http_parse_response(const char *data, size_t length, zn_http_response_head_t *response) {
+    if (!data || !response) {
+        return EINVAL;
+    }
+
+    const char *start = data;
+    const char *end = data + length;
+    const char *p = start;
+    int result = parse_version(p, end, &response->message.minor_version);
+    if (result != 0) {
+        return result;
+    }
+    p += 8;
+
+    if (end - p < 4) {
+        return EAGAIN;
+    }
+    if (p[0] != ' ' || p[1] < '1' || p[1] > '9' || p[2] < '0' || p[2] > '9' || p[3] < '0' || p[3] > '9') {
+        return EBADMSG;
+    }
+    response->status = (p[1] - '0') * 100 + (p[2] - '0') * 10 + (p[3] - '0');
+    p += 4;
+
+    // The reason phrase may be empty, with or without the space before it
+    if (p < end && *p == ' ') {
+        p++;
+    }
+    const char *eol;
+    if ((result = find_line_end(p, end, &eol)) != 0) {
+        return result;
+    }
+    response->reason = p;
+    response->reason_length = (size_t)(eol - p);
+    if ((result = skip_line_end(&eol, end)) != 0) {
+        return result;
+    }
+    return parse_headers(start, eol, end, &response->message);
+}
+
+const zn_http_header_t *zn_http_find_header(const zn_http_message_t *message, const char *name) {
+    if (!message || !name) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < message->header_count; i++) {
+        const zn_http_header_t *header = &message->headers[i];
+        if (equals_ignore_case(header->name, header->name_length, name)) {
+            return header;
+        }
+    }
+    return NULL;
+}
+
+const char *zn_http_status_reason(int status) {
+    switch (status) {
+    case 100: return "Continue";
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 304: return "Not Modified";
+    case 307: return "Temporary Redirect";
+    case 308: return "Permanent Redirect";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 409: return "Conflict";
+    case 411: return "Length Required";
+    case 413: return "Content Too Large";
+    case 414: return "URI Too Long";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    case 504: return "Gateway Timeout";
+    default: return "Unknown";
+    }
+}
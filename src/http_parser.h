@@ -0,0 +1,120 @@
+/**
+ * @file http_parser.h
+ * @brief Allocation-free HTTP/1.x request and response head parser
+ *
+ * The parser works on a buffer holding the start of a message and fills in
+ * a structure of pointers into that buffer: nothing is copied or
+ * allocated, so the results are valid as long as the buffer is. It keeps
+ * no state between calls. When the head is incomplete it reports EAGAIN,
+ * and the caller parses again once more data has arrived; on pipelined
+ * connections this happens at most once per buffer fill.
+ *
+ * Line ends and header delimiters are located 16 bytes at a time with
+ * SSE2 where available (define ZN_HTTP_NO_SIMD to use the byte loop).
+ *
+ * Bare LF line endings are accepted, as RFC 9112 allows. Obsolete line
+ * folding, whitespace before a header colon and conflicting Content-Length
+ * headers are rejected, and so are requests whose last transfer coding is
+ * not chunked, since their body length cannot be determined (RFC 9112
+ * section 6.3). The parser only reads Content-Length,
+ * Transfer-Encoding and Connection; all other headers are passed through.
+ *
+ * The parse functions return 0 or an errno value:
+ * - EAGAIN: the head is incomplete
+ * - EBADMSG: the message is malformed
+ * - E2BIG: more than ZN_HTTP_MAX_HEADERS headers
+ */
+
+#ifndef ZENO_HTTP_PARSER_H
+#define ZENO_HTTP_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Headers kept per message */
+#define ZN_HTTP_MAX_HEADERS 32
+
+/**
+ * A header, pointing into the parsed buffer. The value has no leading or
+ * trailing whitespace.
+ */
+typedef struct {
+    const char *name;
+    size_t name_length;
+    const char *value;
+    size_t value_length;
+} zn_http_header_t;
+
+/**
+ * Fields shared by requests and responses
+ */
+typedef struct {
+    int minor_version;             /**< 0 for HTTP/1.0, 1 for HTTP/1.1 */
+    zn_http_header_t headers[ZN_HTTP_MAX_HEADERS];
+    size_t header_count;
+    size_t head_length;            /**< Bytes up to and including the empty line */
+    size_t content_length;         /**< Body length, 0 without Content-Length */
+    bool has_encoding;             /**< A Transfer-Encoding header is present */
+    bool chunked;                  /**< Transfer-Encoding ends in chunked */
+    bool keep_alive;               /**< The connection stays open after this message */
+} zn_http_message_t;
+
+/**
+ * A parsed request head
+ */
+typedef struct {
+    const char *method;
+    size_t method_length;
+    const char *target;            /**< Request target, e.g. "/index.html?x=1" */
+    size_t target_length;
+    zn_http_message_t message;
+} zn_http_request_t;
+
+/**
+ * A parsed response head
+ */
+typedef struct {
+    int status;
+    const char *reason;
+    size_t reason_length;
+    zn_http_message_t message;
+} zn_http_response_head_t;
+
+/**
+ * Parse a request head
+ *
+ * @param data Buffer starting at the request; leading empty lines are skipped
+ * @param length Bytes in the buffer
+ * @param request Where to store the result
+ * @return 0 on success, otherwise an errno value (see above)
+ */
+int zn_http_parse_request(const char *data, size_t length, zn_http_request_t *request);
+
+/**
+ * Parse a response head
+ *
+ * @param data Buffer starting at the status line
+ * @param length Bytes in the buffer
+ * @param response Where to store the result
+ * @return 0 on success, otherwise an errno value (see above)
+ */
+int zn_http_parse_response(const char *data, size_t length, zn_http_response_head_t *response);
+
+/**
+ * Look up a header by name, ignoring case
+ *
+ * @param message Parsed message
+ * @param name Header name
+ * @return The first header with that name, or NULL
+ */
+const zn_http_header_t *zn_http_find_header(const zn_http_message_t *message, const char *name);
+
+/**
+ * Standard reason phrase of a status code
+ *
+ * @param status Status code
+ * @return The phrase, or "Unknown"
+ */
+const char *zn_http_status_reason(int status);
+
+#endif /* ZENO_HTTP_PARSER_H */
@@ -0,0 +1,442 @@
+/**
+ * @file http_server.c
+ * @brief Implementation of the pipelined HTTP/1.1 server
+ */
+
+#include "http_server.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stream.h"
+
+#define DEFAULT_READ_BUFFER (16 * 1024)
+#define DEFAULT_WRITE_BUFFER (64 * 1024)
+#define DEFAULT_IDLE_TIMEOUT_MS 60000
+
+typedef struct http_worker http_worker_t;
+
+typedef struct http_connection {
+    socket_t socket;
+    zn_stream_t *stream;
+    http_worker_t *worker;
+    zn_reactor_timer_t *idle_timer;
+    char *overflow;                /* Response that did not fit in the write buffer */
+    size_t overflow_length;
+    bool closing;                  /* Close once the output has been sent */
+    struct http_connection *prev;
+    struct http_connection *next;
+} http_connection_t;
+
+struct http_worker {
+    zn_http_server_t *server;
+    zn_reactor_t *reactor;
+    http_connection_t *connections;
+    uint64_t requests;
+};
+
+struct zn_http_server {
+    zn_http_server_config_t config;
+    zn_http_handler_t handler;
+    void *data;
+    zn_server_t *server;
+    http_worker_t *workers;
+    size_t size;
+};
+
+void zn_http_server_config_init(zn_http_server_config_t *config, int port) {
+    if (!config) {
+        return;
+    }
+
+    memset(config, 0, sizeof(*config));
+    zn_server_config_init(&config->server, port);
+    config->read_buffer = DEFAULT_READ_BUFFER;
+    config->write_buffer = DEFAULT_WRITE_BUFFER;
+    config->idle_timeout_ms = DEFAULT_IDLE_TIMEOUT_MS;
+}
+
+/* Connections */
+
+static void connection_close(http_connection_t *conn) {
+    http_worker_t *worker = conn->worker;
+    zn_reactor_remove(worker->reactor, &conn->socket);
+    if (conn->idle_timer) {
+        zn_reactor_cancel_timer(worker->reactor, conn->idle_timer);
+    }
+    zn_stream_destroy(conn->stream);
+    socket_close(&conn->socket);
+
+    if (conn->prev) {
+        conn->prev->next = conn->next;
+    } else {
+        worker->connections = conn->next;
+    }
+    if (conn->next) {
+        conn->next->prev = conn->prev;
+    }
+    free(conn->overflow);
+    free(conn);
+}
+
+static size_t append(char *out, const char *text) {
+    size_t length = strlen(text);
+    memcpy(out, text, length);
+    return length;
+}
+
+static size_t append_decimal(char *out, size_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+/* Keep a response the write buffer had no room for until it drains */
+static int keep_overflow(http_connection_t *conn, const struct iovec *iov, int count) {
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        total += iov[i].iov_len;
+    }
+    conn->overflow = (char *)malloc(total);
+    if (!conn->overflow) {
+        return ENOMEM;
+    }
+    for (int i = 0; i < count; i++) {
+        memcpy(conn->overflow + conn->overflow_length, iov[i].iov_base, iov[i].iov_len);
+        conn->overflow_length += iov[i].iov_len;
+    }
+    return 0;
+}
+
+/* Status line and headers, then the body, as one stream write */
+static int queue_response(http_connection_t *conn, const zn_http_response_t *response, int minor_version,
+                          bool keep_alive) {
+    char head[160];
+    char tail[64];
+    size_t head_length = 0;
+    size_t tail_length = 0;
+    int status = response->status >= 100 && response->status <= 999 ? response->status : 500;
+
+    head_length += append(head, "HTTP/1.1 ");
+    head_length += append_decimal(head + head_length, (size_t)status);
+    head[head_length++] = ' ';
+    head_length += append(head + head_length, zn_http_status_reason(status));
+    head_length += append(head + head_length, "\r\nContent-Length: ");
+    head_length += append_decimal(head + head_length, response->body_length);
+    head_length += append(head + head_length, "\r\n");
+    if (response->content_type) {
+        head_length += append(head + head_length, "Content-Type: ");
+        tail_length += append(tail, "\r\n");
+    }
+    if (!keep_alive) {
+        tail_length += append(tail + tail_length, "Connection: close\r\n");
+    } else if (minor_version == 0) {
+        tail_length += append(tail + tail_length, "Connection: keep-alive\r\n");
+    }
+    tail_length += append(tail + tail_length, "\r\n");
+
+    struct iovec iov[4];
+    int count = 0;
+    iov[count++] = (struct iovec){ head, head_length };
+    if (response->content_type) {
+        iov[count++] = (struct iovec){ (void *)response->content_type, strlen(response->content_type) };
+    }
+    iov[count++] = (struct iovec){ tail, tail_length };
+    if (response->body_length > 0) {
+        iov[count++] = (struct iovec){ (void *)response->body, response->body_length };
+    }
+
+    int result = zn_stream_writev(conn->stream, iov, count);
+    return result == EAGAIN ? keep_overflow(conn, iov, count) : result;
+}
+
+/* Answer a request that cannot be served and close afterwards */
+static int queue_error(http_connection_t *conn, int status) {
+    zn_http_response_t response = { status, NULL, NULL, 0, true };
+    conn->closing = true;
+    return queue_response(conn, &response, 1, false);
+}
+
+/* Move the overflow into the write buffer and send what is pending */
+static int drain(http_connection_t *conn) {
+    if (conn->overflow) {
+        struct iovec iov = { conn->overflow, conn->overflow_length };
+        int result = zn_stream_writev(conn->stream, &iov, 1);
+        if (result != 0) {
+            return result;
+        }
+        free(conn->overflow);
+        conn->overflow = NULL;
+        conn->overflow_length = 0;
+    }
+    return zn_stream_flush(conn->stream);
+}
+
+/* Answer every complete request in the read buffer. Returns 0 when it
+ * needs more input, or an errno value to stop reading. */
+static int handle_buffered(http_connection_t *conn) {
+    zn_http_server_t *server = conn->worker->server;
+    while (!conn->overflow && !conn->closing && zn_stream_writable(conn->stream)) {
+        size_t buffered = zn_stream_buffered(conn->stream);
+        if (buffered == 0) {
+            return 0;
+        }
+
+        const void *data;
+        int result = zn_stream_peek(conn->stream, buffered, &data);
+        if (result != 0) {
+            return result;
+        }
+
+        zn_http_request_t request;
+        result = zn_http_parse_request((const char *)data, buffered, &request);
+        if (result == EAGAIN) {
+            return 0;
+        }
+        if (result != 0) {
+            return queue_error(conn, result == E2BIG ? 431 : 400);
+        }
+        if (request.message.has_encoding) {
+            // Chunked bodies are not supported; anything else failed to parse
+            return queue_error(conn, 501);
+        }
+
+        const zn_http_message_t *message = &request.message;
+        size_t limit = server->config.read_buffer;
+        if (message->content_length > limit || message->head_length > limit - message->content_length) {
+            return queue_error(conn, 413);
+        }
+        size_t total = message->head_length + message->content_length;
+        if (total > buffered) {
+            return 0;
+        }
+
+        zn_http_response_t response = { 200, NULL, NULL, 0, false };
+        server->handler(&request, (const char *)data + message->head_length, &response, server->data);
+        bool keep_alive = message->keep_alive && !response.close;
+        result = queue_response(conn, &response, message->minor_version, keep_alive);
+        if (result == ENOBUFS) {
+            result = queue_error(conn, 500);
+        }
+        if (result != 0) {
+            return result;
+        }
+        zn_stream_consume(conn->stream, total);
+        __atomic_add_fetch(&conn->worker->requests, 1, __ATOMIC_RELAXED);
+        if (!keep_alive) {
+            conn->closing = true;
+        }
+    }
+    return 0;
+}
+
+/* Alternate between answering buffered requests and receiving until the
+ * socket runs dry, then send the batch of responses */
+static void process(http_connection_t *conn) {
+    http_worker_t *worker = conn->worker;
+    if (conn->idle_timer) {
+        zn_reactor_restart_timer(worker->reactor, conn->idle_timer, worker->server->config.idle_timeout_ms);
+    }
+
+    for (;;) {
+        int result = handle_buffered(conn);
+        if (result != 0) {
+            connection_close(conn);
+            return;
+        }
+        if (conn->overflow || conn->closing || !zn_stream_writable(conn->stream)) {
+            break;
+        }
+
+        const void *data;
+        result = zn_stream_peek(conn->stream, zn_stream_buffered(conn->stream) + 1, &data);
+        if (result == EAGAIN) {
+            break;
+        }
+        if (result == ENOBUFS) {
+            // The read buffer is full and still holds no complete head
+            if (queue_error(conn, 431) != 0) {
+                connection_close(conn);
+                return;
+            }
+            break;
+        }
+        if (result != 0) {
+            // ENODATA: the client is done sending; finish the responses
+            conn->closing = true;
+            break;
+        }
+    }
+
+    int result = drain(conn);
+    if (result == EAGAIN) {
+        return;
+    }
+    if (result != 0 || conn->closing) {
+        connection_close(conn);
+    }
+}
+
+static void on_readable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data) {
+    (void)reactor;
+    (void)socket;
+    (void)events;
+    process((http_connection_t *)data);
+}
+
+/* Also called alongside most readable events, so it returns at once when
+ * nothing is waiting to be sent */
+static void on_writable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data) {
+    (void)reactor;
+    (void)socket;
+    (void)events;
+    http_connection_t *conn = (http_connection_t *)data;
+    bool blocked = conn->overflow != NULL || !zn_stream_writable(conn->stream);
+    if (!blocked && !conn->closing && zn_stream_pending(conn->stream) == 0) {
+        return;
+    }
+
+    int result = drain(conn);
+    if (result != 0 && result != EAGAIN) {
+        connection_close(conn);
+    } else if (conn->closing) {
+        if (result == 0) {
+            connection_close(conn);
+        }
+    } else if (blocked && !conn->overflow && zn_stream_writable(conn->stream)) {
+        // Input was left unread while the output was over the high watermark
+        process(conn);
+    }
+}
+
+static void on_idle(zn_reactor_t *reactor, void *data) {
+    (void)reactor;
+    http_connection_t *conn = (http_connection_t *)data;
+    conn->idle_timer = NULL;
+    connection_close(conn);
+}
+
+static void on_connection(zn_reactor_t *reactor, socket_t *client, void *data) {
+    zn_http_server_t *server = (zn_http_server_t *)data;
+    http_worker_t *worker = NULL;
+    for (size_t i = 0; i < server->size && !worker; i++) {
+        if (server->workers[i].reactor == reactor) {
+            worker = &server->workers[i];
+        }
+    }
+
+    http_connection_t *conn = worker ? (http_connection_t *)calloc(1, sizeof(http_connection_t)) : NULL;
+    if (!conn) {
+        socket_close(client);
+        return;
+    }
+    conn->socket = *client;
+    conn->worker = worker;
+
+    zn_stream_config_t config;
+    zn_stream_config_init(&config);
+    config.read_buffer = server->config.read_buffer;
+    config.write_buffer = server->config.write_buffer;
+    conn->stream = zn_stream_create(&conn->socket, &config);
+    if (!conn->stream || zn_reactor_add(reactor, &conn->socket, on_readable, on_writable, conn) != 0) {
+        zn_stream_destroy(conn->stream);
+        socket_close(&conn->socket);
+        free(conn);
+        return;
+    }
+    if (server->config.idle_timeout_ms) {
+        conn->idle_timer = zn_reactor_add_timer(reactor, server->config.idle_timeout_ms, 0, on_idle, conn);
+    }
+
+    conn->next = worker->connections;
+    if (conn->next) {
+        conn->next->prev = conn;
+    }
+    worker->connections = conn;
+}
+
+/* Server */
+
+zn_http_server_t *zn_http_server_create(const zn_http_server_config_t *config, zn_http_handler_t handler,
+                                        void *data) {
+    if (!config || !handler || config->read_buffer == 0 || config->write_buffer == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    zn_http_server_t *server = (zn_http_server_t *)calloc(1, sizeof(zn_http_server_t));
+    if (!server) {
+        return NULL;
+    }
+    server->config = *config;
+    server->handler = handler;
+    server->data = data;
+
+    // Connections only arrive once the server is started, after the
+    // workers below are set up
+    server->server = zn_server_create(&config->server, on_connection, server);
+    if (!server->server) {
+        free(server);
+        return NULL;
+    }
+    size_t count = zn_server_workers(server->server);
+    server->workers = (http_worker_t *)calloc(count, sizeof(http_worker_t));
+    if (!server->workers) {
+        zn_server_destroy(server->server);
+        free(server);
+        errno = ENOMEM;
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        server->workers[i].server = server;
+        server->workers[i].reactor = zn_server_reactor(server->server, i);
+    }
+    server->size = count;
+    server->config.server.port = zn_server_port(server->server);
+    return server;
+}
+
+int zn_http_server_start(zn_http_server_t *server) {
+    return server ? zn_server_start(server->server) : EINVAL;
+}
+
+void zn_http_server_stop(zn_http_server_t *server) {
+    if (server) {
+        zn_server_stop(server->server);
+    }
+}
+
+void zn_http_server_destroy(zn_http_server_t *server) {
+    if (!server) {
+        return;
+    }
+
+    // With the workers stopped their connections can be closed from here
+    zn_server_stop(server->server);
+    for (size_t i = 0; i < server->size; i++) {
+        while (server->workers[i].connections) {
+            connection_close(server->workers[i].connections);
+        }
+    }
+    zn_server_destroy(server->server);
+    free(server->workers);
+    free(server);
+}
+
+int zn_http_server_port(zn_http_server_t *server) {
+    return server ? server->config.server.port : -1;
+}
+
+uint64_t zn_http_server_requests(zn_http_server_t *server) {
+    uint64_t total = 0;
+    for (size_t i = 0; server && i < server->size; i++) {
+        total += __atomic_load_n(&server->workers[i].requests, __ATOMIC_RELAXED);
+    }
+    return total;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file http_server.h
+ * @brief Pipelined keep-alive HTTP/1.1 server on zn_server and zn_stream
+ *
+ * Connections are accepted by a zn_server and stay on the worker reactor
+ * that accepted them. Each connection reads through a zn_stream: one
+ * receive fills the read buffer with as many pipelined requests as have
+ * arrived, each is parsed in place with zn_http_parse_request and handed
+ * to the handler, and the responses are collected in the write buffer and
+ * sent together once the batch is done. Requests are answered in order.
+ * A client that sends requests faster than it reads the responses is held
+ * back: once its unsent responses reach the stream's high watermark, its
+ * remaining requests stay unread until they have drained to the low one.
+ *
+ * A request, head and body, must fit in read_buffer; larger ones get 431
+ * or 413 and the connection is closed. Malformed requests get 400 and
+ * chunked request bodies 501. A response must fit in write_buffer (500
+ * otherwise); it is copied there as soon as the handler returns.
+ *
+ * Responses carry Content-Length, so every connection is kept alive
+ * unless the client asks otherwise, the response sets close, or it stays
+ * idle for idle_timeout_ms.
+ */
+
+#ifndef ZENO_HTTP_SERVER_H
+#define ZENO_HTTP_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "http_parser.h"
+#include "server.h"
+
+/**
+ * Server settings; start from zn_http_server_config_init
+ */
+typedef struct {
+    zn_server_config_t server;     /**< Port, workers and socket options */
+    size_t read_buffer;            /**< Per-connection read buffer; the largest request */
+    size_t write_buffer;           /**< Per-connection write buffer; the largest response */
+    uint64_t idle_timeout_ms;      /**< Close connections idle this long, 0 for never */
+} zn_http_server_config_t;
+
+/**
+ * Response filled in by the handler. The server adds Content-Length and,
+ * when needed, Connection.
+ */
+typedef struct {
+    int status;                    /**< Status code; 200 by default */
+    const char *content_type;      /**< Content-Type, or NULL to leave it out */
+    const void *body;              /**< Body; must stay valid until the handler returns */
+    size_t body_length;
+    bool close;                    /**< Close the connection after this response */
+} zn_http_response_t;
+
+/**
+ * Opaque server handle
+ */
+typedef struct zn_http_server zn_http_server_t;
+
+/**
+ * Called on the connection's worker thread for each request
+ *
+ * @param request Parsed request head, pointing into the read buffer
+ * @param body The message.content_length bytes of the request body
+ * @param response Response to fill in
+ * @param data User data given to zn_http_server_create
+ */
+typedef void (*zn_http_handler_t)(const zn_http_request_t *request, const char *body,
+                                  zn_http_response_t *response, void *data);
+
+/**
+ * Fill in the defaults: zn_server_config_init's settings, 16KB read and
+ * 64KB write buffers, 60 second idle timeout
+ *
+ * @param config Settings to initialize
+ * @param port Port to listen on
+ */
+void zn_http_server_config_init(zn_http_server_config_t *config, int port);
+
+/**
+ * Create the server. Nothing is accepted until zn_http_server_start.
+ *
+ * @param config Settings; copied
+ * @param handler Called for each request
+ * @param data User data passed to the handler
+ * @return New server, or NULL on failure (errno is set)
+ */
+zn_http_server_t *zn_http_server_create(const zn_http_server_config_t *config, zn_http_handler_t handler,
+                                        void *data);
+
+/**
+ * Start the worker threads
+ *
+ * @param server Server to start
+ * @return 0 on success, error code otherwise
+ */
+int zn_http_server_start(zn_http_server_t *server);
+
+/**
+ * Stop the worker threads; open connections stay open until the server is
+ * started again or destroyed
+ *
+ * @param server Server to stop
+ */
+void zn_http_server_stop(zn_http_server_t *server);
+
+/**
+ * Stop the server and close all of its connections
+ *
+ * @param server Server to destroy
+ */
+void zn_http_server_destroy(zn_http_server_t *server);
+
+/**
+ * Port the server listens on, e.g. after asking for port 0
+ *
+ * @param server Server to query
+ * @return Port number
+ */
+int zn_http_server_port(zn_http_server_t *server);
+
+/**
+ * Requests answered so far, over all workers
+ *
+ * @param server Server to query
+ * @return Request count
+ */
+uint64_t zn_http_server_requests(zn_http_server_t *server);
+
+#endif /* ZENO_HTTP_SERVER_H */
@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "intern.h"
+#include "arena.h"
+
+// The table is split into shards by the top bits of the hash, each with
+// its own lock, so threads lexing different files rarely wait on each other
+#define SHARD_BITS 4
+#define SHARD_COUNT (1 << SHARD_BITS)
+#define INITIAL_CAPACITY 256
+
+// Hash table slot; str is NULL while the slot is free
+typedef struct {
+    char* str;
+    uint32_t hash;
+    uint32_t length;
+} InternSlot;
+
+typedef struct {
+    pthread_mutex_t lock;
+    InternSlot* slots;      // Open addressing, linear probing
+    size_t capacity;        // Power of two
+    Arena* strings;         // Storage for the strings themselves
+    InternerStats stats;
+} InternShard;
+
+static struct {
+    InternShard shards[SHARD_COUNT];
+    InternedNames names;
+    int initialized;        // Set with release order once the shards are usable
+} interner;
+
+static pthread_mutex_t init_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// FNV-1a
+static uint32_t hash_bytes(const char* str, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static InternSlot* allocate_slots(size_t capacity) {
+    InternSlot* slots = (InternSlot*)calloc(capacity, sizeof(InternSlot));
+    if (!slots) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return slots;
+}
+
+// Double a shard's table and reinsert every string
+static void grow_shard(InternShard* shard) {
+    size_t capacity = shard->capacity * 2;
+    InternSlot* slots = allocate_slots(capacity);
+    for (size_t i = 0; i < shard->capacity; i++) {
+        InternSlot* old = &shard->slots[i];
+        if (!old->str) continue;
+        size_t index = old->hash & (capacity - 1);
+        while (slots[index].str) {
+            index = (index + 1) & (capacity - 1);
+        }
+        slots[index] = *old;
+    }
+    free(shard->slots);
+    shard->slots = slots;
+    shard->capacity = capacity;
+}
+
+// Slot holding the string in its shard, or the free slot where it would go
+static InternSlot* shard_find(InternShard* shard, const char* str, size_t length, uint32_t hash) {
+    shard->stats.lookups++;
+
+    size_t mask = shard->capacity - 1;
+    size_t index = hash & mask;
+    while (shard->slots[index].str) {
+        InternSlot* slot = &shard->slots[index];
+        if (slot->hash == hash && slot->length == length && memcmp(slot->str, str, length) == 0) {
+            return slot;
+        }
+        index = (index + 1) & mask;
+    }
+    return &shard->slots[index];
+}
+
+// Find the string in its shard, adding a copy if it is new
+static char* shard_intern(InternShard* shard, const char* str, size_t length, uint32_t hash) {
+    InternSlot* slot = shard_find(shard, str, length, hash);
+    if (slot->str) {
+        return slot->str;
+    }
+
+    // Keep the load factor at or below 3/4
+    if ((shard->stats.strings + 1) * 4 > shard->capacity * 3) {
+        grow_shard(shard);
+        size_t mask = shard->capacity - 1;
+        size_t index = hash & mask;
+        while (shard->slots[index].str) {
+            index = (index + 1) & mask;
+        }
+        slot = &shard->slots[index];
+    }
+
+    slot->str = arena_strndup(shard->strings, str, length);
+    slot->hash = hash;
+    slot->length = (uint32_t)length;
+    shard->stats.strings++;
+    shard->stats.bytes += length + 1;
+    return slot->str;
+}
+
+static char* intern_hashed(const char* str, size_t length) {
+    uint32_t hash = hash_bytes(str, length);
+    InternShard* shard = &interner.shards[hash >> (32 - SHARD_BITS)];
+    pthread_mutex_lock(&shard->lock);
+    char* result = shard_intern(shard, str, length, hash);
+    pthread_mutex_unlock(&shard->lock);
+    return result;
+}
+
+// Set up the shards and builtin names on first use
+static void ensure_interner(void) {
+    if (__atomic_load_n(&interner.initialized, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    pthread_mutex_lock(&init_lock);
+    if (!interner.initialized) {
+        for (int i = 0; i < SHARD_COUNT; i++) {
+            InternShard* shard = &interner.shards[i];
+            pthread_mutex_init(&shard->lock, NULL);
+            shard->capacity = INITIAL_CAPACITY;
+            shard->slots = allocate_slots(INITIAL_CAPACITY);
+            shard->strings = arena_create(0);
+        }
+
+        interner.names.int_type = intern_hashed("int", 3);
+        interner.names.float_type = intern_hashed("float", 5);
+        interner.names.bool_type = intern_hashed("bool", 4);
+        interner.names.string_type = intern_hashed("string", 6);
+        interner.names.void_type = intern_hashed("void", 4);
+        interner.names.array_type = intern_hashed("array", 5);
+        interner.names.map_type = intern_hashed("map", 3);
+        interner.names.any_type = intern_hashed("any", 3);
+
+        __atomic_store_n(&interner.initialized, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&init_lock);
+}
+
+// Intern a NUL-terminated string
+char* intern(const char* str) {
+    return intern_n(str, strlen(str));
+}
+
+// Intern the first length bytes of str
+char* intern_n(const char* str, size_t length) {
+    ensure_interner();
+    return intern_hashed(str, length);
+}
+
+// The interned copy of str, or NULL
+char* intern_find(const char* str) {
+    ensure_interner();
+    size_t length = strlen(str);
+    uint32_t hash = hash_bytes(str, length);
+    InternShard* shard = &interner.shards[hash >> (32 - SHARD_BITS)];
+    pthread_mutex_lock(&shard->lock);
+    char* result = shard_find(shard, str, length, hash)->str;
+    pthread_mutex_unlock(&shard->lock);
+    return result;
+}
+
+// Builtin names
+const InternedNames* interned_names(void) {
+    ensure_interner();
+    return &interner.names;
+}
+
+// Counters since startup or the last cleanup, summed over the shards
+InternerStats get_interner_stats(void) {
+    InternerStats total = {0};
+    if (!__atomic_load_n(&interner.initialized, __ATOMIC_ACQUIRE)) {
+        return total;
+    }
+    for (int i = 0; i < SHARD_COUNT; i++) {
+        InternShard* shard = &interner.shards[i];
+        pthread_mutex_lock(&shard->lock);
+        total.lookups += shard->stats.lookups;
+        total.strings += shard->stats.strings;
+        total.bytes += shard->stats.bytes;
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return total;
+}
+
+// Free every interned string
+void cleanup_interner(void) {
+    if (!interner.initialized) {
+        return;
+    }
+    for (int i = 0; i < SHARD_COUNT; i++) {
+        InternShard* shard = &interner.shards[i];
+        free(shard->slots);
+        arena_destroy(shard->strings);
+        pthread_mutex_destroy(&shard->lock);
+    }
+    memset(&interner, 0, sizeof(interner));
+}
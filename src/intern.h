@@ -0,0 +1,53 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+
+// String interner: keeps one copy of every distinct string, so two
+// interned strings are equal exactly when their pointers are. The lexer
+// interns identifiers, type names and literals, which lets later passes
+// compare names with == instead of strcmp.
+//
+// Interned strings live until cleanup_interner and must not be modified
+// or freed. The table is global and safe to use from several threads at
+// once, except for cleanup_interner.
+
+// Builtin names, interned up front so that code can compare against them
+typedef struct {
+    char* int_type;
+    char* float_type;
+    char* bool_type;
+    char* string_type;
+    char* void_type;
+    char* array_type;
+    char* map_type;
+    char* any_type;
+} InternedNames;
+
+// Interner counters
+typedef struct {
+    size_t lookups;     // Calls to intern, intern_n and intern_find
+    size_t strings;     // Distinct strings stored
+    size_t bytes;       // Bytes of string data stored
+} InternerStats;
+
+// Intern a NUL-terminated string
+char* intern(const char* str);
+
+// Intern the first length bytes of str
+char* intern_n(const char* str, size_t length);
+
+// The interned copy of str, or NULL if it was never interned; unlike
+// intern, this never adds to the table
+char* intern_find(const char* str);
+
+// Builtin names
+const InternedNames* interned_names(void);
+
+// Counters since startup or the last cleanup
+InternerStats get_interner_stats(void);
+
+// Free every interned string; no other thread may be interning
+void cleanup_interner(void);
+
+#endif // INTERN_H
@@ -1,4 +1,5 @@
 #include "llvm_context.h"
+#include "../intern.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -50,21 +51,23 @@ void cleanup_llvm_codegen(LLVMGenContext* ctx) {
 LLVMTypeRef llvm_get_type(LLVMGenContext* ctx, TypeInfo* type) {
     if (!type) return LLVMVoidType();
     
-    if (strcmp(type->name, "int") == 0) {
+    // Type names are interned, so builtin types are matched by pointer
+    const InternedNames* names = interned_names();
+    if (type->name == names->int_type) {
         return LLVMInt32Type();
-    } else if (strcmp(type->name, "float") == 0) {
+    } else if (type->name == names->float_type) {
         return LLVMFloatType();
-    } else if (strcmp(type->name, "bool") == 0) {
+    } else if (type->name == names->bool_type) {
         return LLVMInt1Type();
-    } else if (strcmp(type->name, "string") == 0) {
+    } else if (type->name == names->string_type) {
         return LLVMPointerType(LLVMInt8Type(), 0);
-    } else if (strcmp(type->name, "void") == 0) {
+    } else if (type->name == names->void_type) {
         return LLVMVoidType();
-    } else if (strcmp(type->name, "array") == 0 && type->generic_type) {
+    } else if (type->name == names->array_type && type->generic_type) {
         // For arrays, we need to create a pointer to the inner type
         LLVMTypeRef inner_type = llvm_get_type(ctx, type->generic_type);
         return LLVMPointerType(inner_type, 0);
-    } else if (strcmp(type->name, "map") == 0) {
+    } else if (type->name == names->map_type) {
         // Represent map as an opaque pointer (i8*) for now
         // TODO: Define a proper runtime struct type for maps
         return LLVMPointerType(LLVMInt8Type(), 0);
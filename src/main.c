@@ -8,11 +8,6 @@
 #include "llvm_codegen/llvm_codegen.h"
 #include "zeno_cli.h"
 
-// External variables from Flex/Bison
-extern FILE* yyin;
-extern int yyparse();
-extern AST_Node* root;
-
 void print_usage(const char* program_name) {
     printf("Zeno Language v0.1.0 - Usage:\n\n");
     printf("  %s COMMAND [OPTIONS] [FILE]\n\n", program_name);
@@ -20,11 +15,13 @@ void print_usage(const char* program_name) {
     printf("  transpile <input> [output]  Convert Zeno code to C or LLVM IR\n");
     printf("  run [OPTIONS] [file]        Transpile, compile, and run Zeno code\n");
     printf("  compile [OPTIONS] [file]    Transpile and compile Zeno code to a binary\n");
+    printf("  build [OPTIONS] [file]      Build the modules imported from the main file in parallel\n");
     printf("  init [directory]            Create a default manifest.yaml file\n\n");
     printf("Options:\n");
     printf("  -v, --verbose       Enable verbose output\n");
     printf("  -m, --manifest PATH Specify manifest file (default: manifest.yaml)\n");
     printf("  -o, --output FILE   Specify output file\n");
+    printf("  -j, --jobs N        Parallel jobs for build (default: number of cores)\n");
     printf("  --llvm              Use LLVM backend instead of C\n");
 }
 
@@ -65,8 +62,8 @@ int main(int argc, char** argv) {
         const char* dir_path = (argc > 2) ? argv[2] : NULL;
         return init_zeno_project(dir_path, true);
     }
-    else if (strcmp(argv[1], "run") == 0 || strcmp(argv[1], "compile") == 0) {
-        // CLI mode (run or compile)
+    else if (strcmp(argv[1], "run") == 0 || strcmp(argv[1], "compile") == 0 || strcmp(argv[1], "build") == 0) {
+        // CLI mode (run, compile or build)
         ZenoOptions options;
         options.verbose = false;
         options.manifest_path = "manifest.yaml";
@@ -74,7 +71,9 @@ int main(int argc, char** argv) {
         options.output_file = NULL;
         options.run_mode = (strcmp(argv[1], "run") == 0);
         options.compile_mode = (strcmp(argv[1], "compile") == 0);
+        options.build_mode = (strcmp(argv[1], "build") == 0);
         options.use_llvm = false; // Default to C backend
+        options.jobs = 0;
         
         // Parse remaining arguments
         for (int i = 2; i < argc; i++) {
@@ -94,6 +93,15 @@ int main(int argc, char** argv) {
                     fprintf(stderr, "Missing output file\n");
                     return 1;
                 }
+            } else if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) {
+                if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                    options.jobs = atoi(argv[++i]);
+                } else {
+                    fprintf(stderr, "Missing or invalid job count\n");
+                    return 1;
+                }
+            } else if (strncmp(argv[i], "-j", 2) == 0 && atoi(argv[i] + 2) > 0) {
+                options.jobs = atoi(argv[i] + 2);
             } else if (strcmp(argv[i], "--llvm") == 0) {
                 options.use_llvm = true;
             } else if (argv[i][0] != '-') {
@@ -106,7 +114,7 @@ int main(int argc, char** argv) {
             }
         }
 
-        // Load manifest - don't allow missing manifest for run/compile commands
+        // Load manifest - don't allow missing manifest for run/compile/build commands
         ZenoManifest* manifest = load_manifest(options.manifest_path, false);
         if (!manifest) {
             return 1; // Error message already printed by load_manifest
@@ -143,6 +151,8 @@ int main(int argc, char** argv) {
             result = run_zeno_file(&options, manifest);
         } else if (options.compile_mode) {
             result = compile_zeno_file(&options, manifest);
+        } else if (options.build_mode) {
+            result = build_zeno_project(&options, manifest);
         }
         
         // Clean up
@@ -0,0 +1,29 @@
+#ifndef PARSE_H
+#define PARSE_H
+
+#include <stdio.h>
+#include "ast.h"
+
+// State of one parse. The parser is pure and the scanner reentrant, so
+// every call to parse_file has its own context and scanner; any number of
+// threads can parse at once. Errors are printed and counted here rather
+// than ending the process, so a bad file fails only its own parse.
+typedef struct {
+    const char* path;       // Input name for error messages
+    AST_Node* root;         // Program node, set once the input is parsed
+    int errors;             // Syntax and lexical errors reported so far
+} ParseContext;
+
+// Parse a whole source file. Nodes come from arena, which is made the
+// calling thread's AST arena for the duration of the parse. Returns the
+// program node, or NULL if any error was reported.
+AST_Node* parse_file(FILE* input, const char* path, Arena* arena);
+
+// Parse the file at path like parse_file. Regular files of up to
+// SOURCE_MAP_MAX_SIZE bytes are mapped into memory and scanned in place
+// (see source_map.h); larger files, pipes and other special files are read
+// through stdio. Returns NULL, with a message, if the file
+// cannot be opened.
+AST_Node* parse_path(const char* path, Arena* arena);
+
+#endif // PARSE_H
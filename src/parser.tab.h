@@ -1,129 +0,0 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
-
-/* Skeleton interface for Bison's Yacc-like parsers in C
-
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
-
-   This program is free software; you can redistribute it and/or modify
-   it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
-
-   This program is distributed in the hope that it will be useful,
-   but WITHOUT ANY WARRANTY; without even the implied warranty of
-   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-   GNU General Public License for more details.
-
-   You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
-
-/* As a special exception, you may create a larger work that contains
-   part or all of the Bison parser skeleton and distribute that work
-   under terms of your choice, so long as that work isn't itself a
-   parser generator using the skeleton or a modified version thereof
-   as a parser skeleton.  Alternatively, if you modify or redistribute
-   the parser skeleton itself, you may (at your option) remove this
-   special exception, which will cause the skeleton and the resulting
-   Bison output files to be licensed under the GNU General Public
-   License without this special exception.
-
-   This special exception was added by the Free Software Foundation in
-   version 2.2 of Bison.  */
-
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     FN = 258,
-     LET = 259,
-     CONST = 260,
-     STRUCT = 261,
-     WITH = 262,
-     WHERE = 263,
-     IF = 264,
-     ELSE = 265,
-     MATCH = 266,
-     RETURN = 267,
-     IMPORT = 268,
-     TYPE = 269,
-     EQ = 270,
-     NEQ = 271,
-     GE = 272,
-     LE = 273,
-     AND = 274,
-     OR = 275,
-     CONCAT = 276,
-     ARROW = 277,
-     PIPE = 278,
-     SPREAD = 279,
-     IDENTIFIER = 280,
-     TYPE_NAME = 281,
-     INT_LITERAL = 282,
-     FLOAT_LITERAL = 283,
-     STRING_LITERAL = 284,
-     BOOL_LITERAL = 285
-   };
-#endif
-/* Tokens.  */
-#define FN 258
-#define LET 259
-#define CONST 260
-#define STRUCT 261
-#define WITH 262
-#define WHERE 263
-#define IF 264
-#define ELSE 265
-#define MATCH 266
-#define RETURN 267
-#define IMPORT 268
-#define TYPE 269
-#define EQ 270
-#define NEQ 271
-#define GE 272
-#define LE 273
-#define AND 274
-#define OR 275
-#define CONCAT 276
-#define ARROW 277
-#define PIPE 278
-#define SPREAD 279
-#define IDENTIFIER 280
-#define TYPE_NAME 281
-#define INT_LITERAL 282
-#define FLOAT_LITERAL 283
-#define STRING_LITERAL 284
-#define BOOL_LITERAL 285
-
-
-
-
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 18 "src/parser.y"
-{
-    char* str;
-    AST_Node* node;
-    AST_Node_List* node_list;
-    TypeInfo* type_info;
-    StructField* field;
-    StructField_List* field_list;
-    ExpressionList* expr_list;
-    GuardClause* guard;
-    MatchCase* match_case;
-    MatchCase_List* match_case_list;
-}
-/* Line 1529 of yacc.c.  */
-#line 122 "src/parser.tab.h"
-	YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
-# define YYSTYPE_IS_TRIVIAL 1
-#endif
-
-extern YYSTYPE yylval;
-
@@ -2,18 +2,37 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "ast.h"
+#include "intern.h"
+#include "source_map.h"
+%}
 
-// External declarations
-extern int yylex();
-extern int yylineno;
-extern char* yytext;
-extern FILE* yyin;
+%code requires {
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+#include "parse.h"
+}
 
-// Function declarations
-void yyerror(const char* s);
-AST_Node* root = NULL;  // Root of the AST
-%}
+%code {
+// Reentrant scanner interface (lexer.l)
+int yylex(YYSTYPE* yylval_param, yyscan_t scanner);
+int yylex_init_extra(ParseContext* context, yyscan_t* scanner);
+void yyset_in(FILE* input, yyscan_t scanner);
+struct yy_buffer_state* yy_scan_buffer(char* base, size_t size, yyscan_t scanner);
+int yyget_lineno(yyscan_t scanner);
+char* yyget_text(yyscan_t scanner);
+int yylex_destroy(yyscan_t scanner);
+
+void yyerror(yyscan_t scanner, ParseContext* context, const char* s);
+}
+
+%define api.pure full
+%lex-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {ParseContext* context}
 
 %union {
     char* str;
@@ -75,7 +94,7 @@ AST_Node* root = NULL;  // Root of the AST
 %%
 
 program
-    : declarations { root = create_program_node($1); }
+    : declarations { context->root = create_program_node($1); }
     ;
 
 declarations
@@ -99,7 +118,13 @@ type_declaration
     : TYPE IDENTIFIER '=' type ';' { $$ = create_type_declaration_node($2, $4); }
     ;
 
-/* variable_declaration rule definition removed */
+/* Declaration without the trailing ';', shared by declarations, statements and for initializers */
+variable_declaration_body
+    : LET IDENTIFIER '=' expression { $$ = create_variable_node(VAR_LET, $2, NULL, $4); }
+    | LET IDENTIFIER ':' type '=' expression { $$ = create_variable_node(VAR_LET, $2, $4, $6); }
+    | CONST IDENTIFIER '=' expression { $$ = create_variable_node(VAR_CONST, $2, NULL, $4); }
+    | CONST IDENTIFIER ':' type '=' expression { $$ = create_variable_node(VAR_CONST, $2, $4, $6); }
+    ;
 
 struct_declaration
     : STRUCT IDENTIFIER '{' struct_fields '}' { $$ = create_struct_node($2, NULL, $4); }
@@ -178,18 +203,20 @@ type_with_generics
         } else {
             char err_msg[100];
             snprintf(err_msg, sizeof(err_msg), "Type '%s' does not support two generic arguments", $1);
-            yyerror(err_msg);
+            yyerror(scanner, context, err_msg);
             YYERROR; // Trigger parser error recovery
         }
     }
     ;
 
 compound_statement
-    : '{' statements '}' { $$ = create_compound_statement_node($2); }
+    : '{' '}' { $$ = create_compound_statement_node(create_node_list(NULL)); }
+    | '{' statements '}' { $$ = create_compound_statement_node($2); }
     ;
 
+/* Non-empty, so that a block starting with an expression is not taken for a struct or map literal */
 statements
-    : /* empty */ { $$ = create_node_list(NULL); }
+    : statement { $$ = create_node_list($1); }
     | statements statement { append_node($1, $2); $$ = $1; }
     ;
 
@@ -308,7 +335,7 @@ expression
         if (strcmp($3, "all") == 0) {
             $$ = create_promise_all_node($5);
         } else {
-            yyerror("Invalid Promise static method");
+            yyerror(scanner, context, "Invalid Promise static method");
             YYERROR;
         }
     }
@@ -358,7 +385,7 @@ struct_init_field
 
 function_call
     : IDENTIFIER '(' argument_list ')' { $$ = create_function_call_node($1, $3); }
-    | PRINT '(' argument_list ')' { $$ = create_function_call_node("print", $3); }
+    | PRINT '(' argument_list ')' { $$ = create_function_call_node(intern("print"), $3); }
     ;
 
 argument_list
@@ -433,7 +460,74 @@ array_elements
 
 %%
 
-void yyerror(const char* s) {
-    fprintf(stderr, "Parser error at line %d: %s near '%s'\n", yylineno, s, yytext);
-    exit(1);
+void yyerror(yyscan_t scanner, ParseContext* context, const char* s) {
+    fprintf(stderr, "%s: Parser error at line %d: %s near '%s'\n", context->path, yyget_lineno(scanner), s,
+            yyget_text(scanner));
+    context->errors++;
+}
+
+static yyscan_t create_scanner(ParseContext* context) {
+    yyscan_t scanner;
+    if (yylex_init_extra(context, &scanner) != 0) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return scanner;
+}
+
+// Run the parser over a scanner's input, then destroy the scanner
+static AST_Node* run_parser(yyscan_t scanner, ParseContext* context, Arena* arena) {
+    Arena* previous = ast_get_arena();
+    ast_set_arena(arena);
+    int result = yyparse(scanner, context);
+    ast_set_arena(previous);
+    
+    yylex_destroy(scanner);
+    
+    // The scanner reports stray characters and carries on, so a parse can
+    // succeed with errors on record
+    return result == 0 && context->errors == 0 ? context->root : NULL;
+}
+
+// Parse a whole source file with a scanner of its own
+AST_Node* parse_file(FILE* input, const char* path, Arena* arena) {
+    ParseContext context = { path, NULL, 0 };
+    yyscan_t scanner = create_scanner(&context);
+    yyset_in(input, scanner);
+    return run_parser(scanner, &context, arena);
+}
+
+// Parse the file at path, scanning it in place when it can be mapped
+AST_Node* parse_path(const char* path, Arena* arena) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Could not open input file %s\n", path);
+        return NULL;
+    }
+    
+    SourceMap map;
+    if (source_map_open(fd, SOURCE_MAP_MAX_SIZE, &map) == 0) {
+        close(fd);
+        ParseContext context = { path, NULL, 0 };
+        yyscan_t scanner = create_scanner(&context);
+        if (!yy_scan_buffer(map.data, map.size + 2, scanner)) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        AST_Node* root = run_parser(scanner, &context, arena);
+        source_map_close(&map);
+        return root;
+    }
+    
+    // Pipes, terminals, empty files and files too large to map are read
+    // through stdio
+    FILE* input = fdopen(fd, "r");
+    if (!input) {
+        close(fd);
+        fprintf(stderr, "Error: Could not open input file %s\n", path);
+        return NULL;
+    }
+    AST_Node* root = parse_file(input, path, arena);
+    fclose(input);
+    return root;
 }
@@ -62,27 +62,11 @@ typedef struct {
 } resolver_context_t;
 
 /* Forward declarations for internal functions */
-static void promise_resolve_internal(zn_promise_t *promise, void *value);
-static void promise_reject_internal(zn_promise_t *promise, void *error);
+static bool promise_resolve_internal(zn_promise_t *promise, void *value);
+static bool promise_reject_internal(zn_promise_t *promise, void *error);
 static void promise_execute_handlers(zn_promise_t *promise);
-static void *promise_thread_func(void *arg);
 static void *resolver_thread(void *arg);
 
-/* Helper function to get thread-specific data */
-void *zn_thread_self_data(void) {
-    /* This would require thread-specific storage implementation in threads.h/c */
-    /* For now just return NULL as a placeholder */
-    return NULL;
-}
-
-/* Helper function to set thread-specific data */
-void zn_thread_set_data(zn_thread_t *thread, void *data) {
-    /* This would require thread-specific storage implementation in threads.h/c */
-    /* For now just a placeholder */
-    (void)thread;
-    (void)data;
-}
-
 /* Resolver callback wrappers */
 static void resolve_callback(void *value) {
     zn_promise_t *promise = zn_thread_self_data();
@@ -97,6 +81,9 @@ static void reject_callback(void *error) {
 /* Thread function for resolver */
 static void *resolver_thread(void *arg) {
     resolver_context_t *ctx = (resolver_context_t *)arg;
+    
+    /* Let resolve_callback/reject_callback find the promise */
+    zn_thread_set_data(&ctx->promise->thread, ctx->promise);
     ctx->resolver(resolve_callback, reject_callback, ctx->context);
     free(ctx);
     return NULL;
@@ -129,9 +116,6 @@ zn_promise_t *zn_promise_new(zn_promise_resolver_t resolver, void *context) {
         return NULL;
     }
     
-    /* Store promise in thread for resolver callbacks */
-    zn_thread_set_data(&promise->thread, promise);
-    
     resolver_context_t *ctx = (resolver_context_t *)malloc(sizeof(resolver_context_t));
     if (!ctx) {
         zn_mutex_destroy(&promise->mutex);
@@ -200,11 +184,58 @@ zn_promise_t *zn_promise_reject(void *error) {
     return promise;
 }
 
-static void promise_resolve_internal(zn_promise_t *promise, void *value) {
+zn_promise_t *zn_promise_deferred(void) {
+    zn_promise_t *promise = (zn_promise_t *)malloc(sizeof(zn_promise_t));
+    if (!promise) {
+        return NULL;
+    }
+    
+    memset(promise, 0, sizeof(zn_promise_t));
+    promise->state = ZN_PROMISE_PENDING;
+    
+    if (zn_mutex_init(&promise->mutex) != 0 || 
+        zn_cond_init(&promise->cond) != 0) {
+        free(promise);
+        return NULL;
+    }
+    
+    return promise;
+}
+
+bool zn_promise_fulfill(zn_promise_t *promise, void *value) {
+    if (!promise) {
+        return false;
+    }
+    
+    return promise_resolve_internal(promise, value);
+}
+
+bool zn_promise_fail(zn_promise_t *promise, void *error) {
+    if (!promise) {
+        return false;
+    }
+    
+    return promise_reject_internal(promise, error);
+}
+
+void *zn_promise_error(zn_promise_t *promise) {
+    if (!promise) {
+        return NULL;
+    }
+    
+    zn_mutex_lock(&promise->mutex);
+    void *error = (promise->state == ZN_PROMISE_REJECTED) ? promise->error : NULL;
+    zn_mutex_unlock(&promise->mutex);
+    
+    return error;
+}
+
+static bool promise_resolve_internal(zn_promise_t *promise, void *value) {
     zn_mutex_lock(&promise->mutex);
+    bool pending = promise->state == ZN_PROMISE_PENDING;
     
     /* Only pending promises can be resolved */
-    if (promise->state == ZN_PROMISE_PENDING) {
+    if (pending) {
         promise->state = ZN_PROMISE_FULFILLED;
         promise->value = value;
         
@@ -216,13 +247,15 @@ static void promise_resolve_internal(zn_promise_t *promise, void *value) {
     }
     
     zn_mutex_unlock(&promise->mutex);
+    return pending;
 }
 
-static void promise_reject_internal(zn_promise_t *promise, void *error) {
+static bool promise_reject_internal(zn_promise_t *promise, void *error) {
     zn_mutex_lock(&promise->mutex);
+    bool pending = promise->state == ZN_PROMISE_PENDING;
     
     /* Only pending promises can be rejected */
-    if (promise->state == ZN_PROMISE_PENDING) {
+    if (pending) {
         promise->state = ZN_PROMISE_REJECTED;
         promise->error = error;
         
@@ -234,6 +267,7 @@ static void promise_reject_internal(zn_promise_t *promise, void *error) {
     }
     
     zn_mutex_unlock(&promise->mutex);
+    return pending;
 }
 
 static void promise_execute_handlers(zn_promise_t *promise) {
@@ -68,6 +68,44 @@ zn_promise_t *zn_promise_resolve(void *value);
  */
 zn_promise_t *zn_promise_reject(void *error);
 
+/**
+ * @brief Create a pending promise that is settled explicitly
+ *
+ * Used by code that completes work on another thread (such as the
+ * asynchronous socket operations): hand the promise out, then call
+ * zn_promise_fulfill or zn_promise_fail once the result is known.
+ *
+ * @return New pending promise, or NULL on allocation failure
+ */
+zn_promise_t *zn_promise_deferred(void);
+
+/**
+ * @brief Fulfill a pending promise
+ * @param promise Promise created by zn_promise_deferred
+ * @param value Value to fulfill with
+ * @return true if the promise was pending, false if it had already settled
+ */
+bool zn_promise_fulfill(zn_promise_t *promise, void *value);
+
+/**
+ * @brief Reject a pending promise
+ * @param promise Promise created by zn_promise_deferred
+ * @param error Error to reject with
+ * @return true if the promise was pending, false if it had already settled
+ */
+bool zn_promise_fail(zn_promise_t *promise, void *error);
+
+/**
+ * @brief Returns the error of a rejected promise
+ *
+ * zn_promise_await returns NULL for a rejected promise, which can also be
+ * a valid fulfillment value; check the state and fetch the error here.
+ *
+ * @param promise The promise
+ * @return Error if rejected, NULL otherwise
+ */
+void *zn_promise_error(zn_promise_t *promise);
+
 /**
  * @brief Chain a fulfillment handler to a promise
  * @param promise The promise
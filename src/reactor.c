@@ -0,0 +1,1099 @@
+/**
+ * @file reactor.c
+ * @brief Implementation of the event loop and its epoll backend
+ */
+
+#define _GNU_SOURCE
+#include "reactor_internal.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+#include "resolver.h"
+#include "threads.h"
+
+#define REACTOR_MAX_EVENTS 1024
+#define REACTOR_WAKE_TOKEN UINT64_MAX
+#define REACTOR_SCRATCH_SIZE 65536
+
+struct zn_reactor_group {
+    zn_reactor_t **reactors;
+    zn_thread_t *threads;
+    size_t size;
+    size_t next;
+    bool running;
+};
+
+static void emulate_readable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data);
+static void emulate_writable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data);
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static uint64_t entry_token(int fd, uint32_t generation) {
+    return ((uint64_t)generation << 32) | (uint32_t)fd;
+}
+
+zn_reactor_t *zn_reactor_create(void) {
+    return zn_reactor_create_with_backend(ZN_REACTOR_BACKEND_EPOLL);
+}
+
+zn_reactor_t *zn_reactor_create_with_backend(zn_reactor_backend_t backend) {
+    zn_reactor_t *reactor = (zn_reactor_t *)calloc(1, sizeof(zn_reactor_t));
+    if (!reactor) {
+        return NULL;
+    }
+
+    reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    reactor->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reactor->epoll_fd < 0 || reactor->wake_fd < 0) {
+        int saved = errno;
+        if (reactor->epoll_fd >= 0) close(reactor->epoll_fd);
+        if (reactor->wake_fd >= 0) close(reactor->wake_fd);
+        free(reactor);
+        errno = saved;
+        return NULL;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN, .data.u64 = REACTOR_WAKE_TOKEN };
+    if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, reactor->wake_fd, &event) < 0) {
+        int saved = errno;
+        close(reactor->epoll_fd);
+        close(reactor->wake_fd);
+        free(reactor);
+        errno = saved;
+        return NULL;
+    }
+
+    pthread_mutex_init(&reactor->task_lock, NULL);
+    reactor->now = monotonic_ms();
+    zn_timer_wheel_init(&reactor->timers, reactor->now);
+
+    /* Without io_uring support the reactor keeps working on epoll */
+    if (backend == ZN_REACTOR_BACKEND_IO_URING) {
+        reactor->uring = zn_uring_create(reactor);
+    }
+    return reactor;
+}
+
+zn_reactor_backend_t zn_reactor_backend(zn_reactor_t *reactor) {
+    return (reactor && reactor->uring) ? ZN_REACTOR_BACKEND_IO_URING : ZN_REACTOR_BACKEND_EPOLL;
+}
+
+const char *zn_reactor_backend_name(zn_reactor_backend_t backend) {
+    return backend == ZN_REACTOR_BACKEND_IO_URING ? "io_uring" : "epoll";
+}
+
+static void free_send_queue(reactor_entry_t *entry) {
+    reactor_op_t *op = entry->send_head;
+    while (op) {
+        reactor_op_t *next = op->next;
+        free(op);
+        op = next;
+    }
+    entry->send_head = NULL;
+    entry->send_tail = NULL;
+}
+
+void zn_reactor_destroy(zn_reactor_t *reactor) {
+    if (!reactor) {
+        return;
+    }
+
+    /* Cancel what the kernel still holds; the ring frees it while draining */
+    for (size_t fd = 0; fd < reactor->entry_capacity; fd++) {
+        if (reactor->entries[fd].active) {
+            zn_reactor_remove(reactor, reactor->entries[fd].socket);
+        }
+    }
+    if (reactor->uring) {
+        zn_uring_destroy(reactor->uring);
+    }
+
+    zn_timer_wheel_entry_t *timer;
+    while ((timer = zn_timer_wheel_drain(&reactor->timers))) {
+        free(timer);
+    }
+
+    reactor_task_t *task = reactor->tasks;
+    while (task) {
+        reactor_task_t *next = task->next;
+        free(task);
+        task = next;
+    }
+
+    pthread_mutex_destroy(&reactor->task_lock);
+    close(reactor->epoll_fd);
+    close(reactor->wake_fd);
+    free(reactor->entries);
+    free(reactor->deferred);
+    free(reactor->scratch);
+    free(reactor);
+}
+
+/* Make sure the entry table can be indexed by fd */
+static int reserve_entry(zn_reactor_t *reactor, int fd) {
+    if ((size_t)fd < reactor->entry_capacity) {
+        return 0;
+    }
+
+    size_t capacity = reactor->entry_capacity ? reactor->entry_capacity : 64;
+    while (capacity <= (size_t)fd) {
+        capacity *= 2;
+    }
+
+    reactor_entry_t *entries = (reactor_entry_t *)realloc(reactor->entries, capacity * sizeof(reactor_entry_t));
+    if (!entries) {
+        return ENOMEM;
+    }
+    memset(entries + reactor->entry_capacity, 0, (capacity - reactor->entry_capacity) * sizeof(reactor_entry_t));
+    reactor->entries = entries;
+    reactor->entry_capacity = capacity;
+    return 0;
+}
+
+static reactor_entry_t *find_entry(zn_reactor_t *reactor, socket_t *socket) {
+    if (!socket || socket->fd < 0 || (size_t)socket->fd >= reactor->entry_capacity) {
+        return NULL;
+    }
+    reactor_entry_t *entry = &reactor->entries[socket->fd];
+    return (entry->active && entry->socket == socket) ? entry : NULL;
+}
+
+reactor_entry_t *reactor_entry_get(zn_reactor_t *reactor, reactor_ref_t ref) {
+    if (ref.fd < 0 || (size_t)ref.fd >= reactor->entry_capacity) {
+        return NULL;
+    }
+    reactor_entry_t *entry = &reactor->entries[ref.fd];
+    return (entry->active && entry->generation == ref.generation) ? entry : NULL;
+}
+
+static reactor_ref_t entry_ref(zn_reactor_t *reactor, reactor_entry_t *entry) {
+    reactor_ref_t ref = { (int)(entry - reactor->entries), entry->generation };
+    return ref;
+}
+
+/* Claim the entry for a socket and watch it with epoll if requested */
+static int register_entry(zn_reactor_t *reactor, socket_t *socket, bool watch, reactor_entry_t **out) {
+    if (!reactor || !socket || socket->fd < 0) {
+        return EINVAL;
+    }
+
+    int result = reserve_entry(reactor, socket->fd);
+    if (result != 0) {
+        return result;
+    }
+
+    reactor_entry_t *entry = &reactor->entries[socket->fd];
+    if (entry->active) {
+        return EEXIST;
+    }
+
+    if (!socket->is_nonblocking) {
+        socket_result_t res = socket_set_nonblocking(socket, true);
+        if (!res.success) {
+            return res.error_code ? res.error_code : EINVAL;
+        }
+    }
+
+    if (watch) {
+        /* Both directions stay armed; callbacks decide what is delivered */
+        struct epoll_event event = {
+            .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+            .data.u64 = entry_token(socket->fd, entry->generation)
+        };
+        if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, socket->fd, &event) < 0) {
+            return errno;
+        }
+    }
+
+    uint32_t generation = entry->generation;
+    memset(entry, 0, sizeof(*entry));
+    entry->generation = generation;
+    entry->socket = socket;
+    entry->in_epoll = watch;
+    entry->active = true;
+    reactor->socket_count++;
+    *out = entry;
+    return 0;
+}
+
+int zn_reactor_add(zn_reactor_t *reactor, socket_t *socket,
+                   zn_reactor_io_callback_t on_readable,
+                   zn_reactor_io_callback_t on_writable, void *data) {
+    reactor_entry_t *entry;
+    int result = register_entry(reactor, socket, true, &entry);
+    if (result != 0) {
+        return result;
+    }
+
+    entry->on_readable = on_readable;
+    entry->on_writable = on_writable;
+    entry->data = data;
+    return 0;
+}
+
+int zn_reactor_set_callbacks(zn_reactor_t *reactor, socket_t *socket,
+                             zn_reactor_io_callback_t on_readable,
+                             zn_reactor_io_callback_t on_writable) {
+    if (!reactor) {
+        return EINVAL;
+    }
+
+    reactor_entry_t *entry = find_entry(reactor, socket);
+    if (!entry) {
+        return ENOENT;
+    }
+    if (entry->completion) {
+        return EBUSY;
+    }
+
+    entry->on_readable = on_readable;
+    entry->on_writable = on_writable;
+    return 0;
+}
+
+int zn_reactor_remove(zn_reactor_t *reactor, socket_t *socket) {
+    if (!reactor) {
+        return EINVAL;
+    }
+
+    reactor_entry_t *entry = find_entry(reactor, socket);
+    if (!entry) {
+        return ENOENT;
+    }
+
+    int result = 0;
+    if (entry->in_epoll && epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, socket->fd, NULL) < 0) {
+        result = errno;
+    }
+
+    /* Operations the kernel still owns are cancelled and freed when their
+     * final completion arrives; the generation bump below orphans them */
+    if (reactor->uring) {
+        if (entry->multishot) {
+            zn_uring_cancel(reactor->uring, entry->multishot);
+        }
+        if (entry->connect_op) {
+            zn_uring_cancel(reactor->uring, entry->connect_op);
+        }
+        if (entry->send_head && entry->send_head->in_flight) {
+            zn_uring_cancel(reactor->uring, entry->send_head);
+            entry->send_head = entry->send_head->next;
+        }
+    }
+    free_send_queue(entry);
+
+    entry->active = false;
+    entry->socket = NULL;
+    entry->multishot = NULL;
+    entry->connect_op = NULL;
+    entry->generation++;
+    reactor->socket_count--;
+    return result;
+}
+
+/* Completion operations */
+
+/* Get (or create) the completion-mode entry for a socket */
+static int completion_entry(zn_reactor_t *reactor, socket_t *socket, reactor_entry_t **out) {
+    if (!reactor || !socket) {
+        return EINVAL;
+    }
+
+    reactor_entry_t *entry = find_entry(reactor, socket);
+    if (entry) {
+        if (!entry->completion) {
+            return EBUSY;
+        }
+        *out = entry;
+        return 0;
+    }
+
+    /* On epoll, completions are emulated from readiness events */
+    int result = register_entry(reactor, socket, reactor->uring == NULL, &entry);
+    if (result != 0) {
+        return result;
+    }
+    entry->completion = true;
+    if (!reactor->uring) {
+        entry->on_readable = emulate_readable;
+        entry->on_writable = emulate_writable;
+    }
+    *out = entry;
+    return 0;
+}
+
+/* Schedule an emulated entry for the pass that runs after event dispatch */
+static void defer_entry(zn_reactor_t *reactor, reactor_entry_t *entry) {
+    if (entry->deferred) {
+        return;
+    }
+
+    if (reactor->deferred_count == reactor->deferred_capacity) {
+        size_t capacity = reactor->deferred_capacity ? reactor->deferred_capacity * 2 : 64;
+        reactor_ref_t *deferred = (reactor_ref_t *)realloc(reactor->deferred, capacity * sizeof(reactor_ref_t));
+        if (!deferred) {
+            /* The next readiness event will pick the work up instead */
+            return;
+        }
+        reactor->deferred = deferred;
+        reactor->deferred_capacity = capacity;
+    }
+
+    reactor->deferred[reactor->deferred_count++] = entry_ref(reactor, entry);
+    entry->deferred = true;
+}
+
+int zn_reactor_accept(zn_reactor_t *reactor, socket_t *listener,
+                      zn_reactor_accept_callback_t on_accept, void *data) {
+    if (!on_accept) {
+        return EINVAL;
+    }
+
+    reactor_entry_t *entry;
+    int result = completion_entry(reactor, listener, &entry);
+    if (result != 0) {
+        return result;
+    }
+    if (entry->on_accept || entry->on_receive) {
+        return EBUSY;
+    }
+
+    entry->on_accept = on_accept;
+    entry->receive_data = data;
+    if (reactor->uring) {
+        return zn_uring_arm_multishot(reactor->uring, entry, REACTOR_OP_ACCEPT);
+    }
+    /* Connections may already be waiting; their edge has passed */
+    defer_entry(reactor, entry);
+    return 0;
+}
+
+int zn_reactor_receive(zn_reactor_t *reactor, socket_t *socket,
+                       zn_reactor_receive_callback_t on_receive, void *data) {
+    if (!on_receive) {
+        return EINVAL;
+    }
+
+    reactor_entry_t *entry;
+    int result = completion_entry(reactor, socket, &entry);
+    if (result != 0) {
+        return result;
+    }
+    if (entry->on_accept || entry->on_receive) {
+        return EBUSY;
+    }
+
+    entry->on_receive = on_receive;
+    entry->receive_data = data;
+    if (reactor->uring) {
+        return zn_uring_arm_multishot(reactor->uring, entry, REACTOR_OP_RECEIVE);
+    }
+    defer_entry(reactor, entry);
+    return 0;
+}
+
+int zn_reactor_send(zn_reactor_t *reactor, socket_t *socket, const void *buffer, size_t length,
+                    zn_reactor_send_callback_t on_sent, void *data) {
+    if (!buffer && length > 0) {
+        return EINVAL;
+    }
+
+    reactor_entry_t *entry;
+    int result = completion_entry(reactor, socket, &entry);
+    if (result != 0) {
+        return result;
+    }
+
+    reactor_op_t *op = (reactor_op_t *)calloc(1, sizeof(reactor_op_t));
+    if (!op) {
+        return ENOMEM;
+    }
+    op->type = REACTOR_OP_SEND;
+    op->fd = socket->fd;
+    op->generation = entry->generation;
+    op->buffer = (const char *)buffer;
+    op->length = length;
+    op->on_sent = on_sent;
+    op->data = data;
+
+    bool idle = entry->send_head == NULL;
+    if (entry->send_tail) {
+        entry->send_tail->next = op;
+    } else {
+        entry->send_head = op;
+    }
+    entry->send_tail = op;
+
+    if (reactor->uring) {
+        return idle ? zn_uring_submit_send(reactor->uring, op) : 0;
+    }
+    /* Sends issued during one loop iteration go out together afterwards */
+    defer_entry(reactor, entry);
+    return 0;
+}
+
+void reactor_complete_send(zn_reactor_t *reactor, reactor_ref_t ref, int error) {
+    reactor_entry_t *entry = reactor_entry_get(reactor, ref);
+    if (!entry || !entry->send_head) {
+        return;
+    }
+
+    reactor_op_t *op = entry->send_head;
+    entry->send_head = op->next;
+    if (!entry->send_head) {
+        entry->send_tail = NULL;
+    }
+
+    if (op->on_sent) {
+        op->on_sent(reactor, entry->socket, op->done, error, op->data);
+    }
+    free(op);
+
+    /* Start the next queued send */
+    entry = reactor_entry_get(reactor, ref);
+    if (reactor->uring && entry && entry->send_head && !entry->send_head->in_flight) {
+        zn_uring_submit_send(reactor->uring, entry->send_head);
+    }
+}
+
+static int start_connect(zn_reactor_t *reactor, socket_t *socket, const zn_address_t *address,
+                         zn_reactor_connect_callback_t on_connected, void *data) {
+    /* Switching to IPv6 replaces the socket, which has to happen before
+     * it is registered */
+    reactor_entry_t *entry = find_entry(reactor, socket);
+    if (entry && socket->family != address->addr.ss_family) {
+        return EAFNOSUPPORT;
+    }
+    socket_result_t res = socket_set_family(socket, address->addr.ss_family);
+    if (!res.success) {
+        return res.error_code ? res.error_code : EINVAL;
+    }
+
+    int result = completion_entry(reactor, socket, &entry);
+    if (result != 0) {
+        return result;
+    }
+    if (entry->on_connected) {
+        return EALREADY;
+    }
+
+    entry->on_connected = on_connected;
+    entry->connect_data = data;
+    socket->addr = address->addr;
+    socket->addr_len = address->length;
+
+    if (reactor->uring) {
+        reactor_op_t *op = (reactor_op_t *)calloc(1, sizeof(reactor_op_t));
+        if (!op) {
+            entry->on_connected = NULL;
+            return ENOMEM;
+        }
+        op->type = REACTOR_OP_CONNECT;
+        op->fd = socket->fd;
+        op->generation = entry->generation;
+        op->addr = address->addr;
+        op->addr_len = address->length;
+        entry->connect_op = op;
+        return zn_uring_submit_connect(reactor->uring, op);
+    }
+
+    if (connect(socket->fd, (const struct sockaddr *)&address->addr, address->length) < 0) {
+        if (errno != EINPROGRESS) {
+            entry->on_connected = NULL;
+            return errno;
+        }
+        /* Completion arrives as a writable event */
+        return 0;
+    }
+    socket->is_connected = true;
+    defer_entry(reactor, entry);
+    return 0;
+}
+
+/* A connect waiting for its host name to resolve */
+typedef struct {
+    zn_reactor_t *reactor;
+    socket_t *socket;
+    zn_reactor_connect_callback_t on_connected;
+    void *data;
+    int error;
+    zn_address_t address;
+} reactor_resolve_t;
+
+/* Back on the loop thread */
+static void connect_resolved(zn_reactor_t *reactor, void *data) {
+    reactor_resolve_t *pending = (reactor_resolve_t *)data;
+    int result = pending->error;
+    if (result == 0) {
+        result = start_connect(reactor, pending->socket, &pending->address, pending->on_connected,
+                               pending->data);
+    }
+    if (result != 0) {
+        pending->on_connected(reactor, pending->socket, result, pending->data);
+    }
+    free(pending);
+}
+
+/* On a resolver thread */
+static void on_resolved(int error, const zn_address_list_t *addresses, void *data) {
+    reactor_resolve_t *pending = (reactor_resolve_t *)data;
+    pending->error = error;
+    if (error == 0) {
+        pending->address = addresses->addresses[0];
+    }
+    if (zn_reactor_post(pending->reactor, connect_resolved, pending) != 0) {
+        free(pending);
+    }
+}
+
+int zn_reactor_connect(zn_reactor_t *reactor, socket_t *socket, const char *hostname, int port,
+                       zn_reactor_connect_callback_t on_connected, void *data) {
+    if (!reactor || !socket || !hostname || !on_connected) {
+        return EINVAL;
+    }
+
+    /* Numeric and cached names connect right away; anything else would
+     * block the loop, so it is resolved on the resolver's threads */
+    zn_address_list_t resolved;
+    if (zn_resolve_cached(hostname, port, &resolved)) {
+        return start_connect(reactor, socket, &resolved.addresses[0], on_connected, data);
+    }
+
+    reactor_resolve_t *pending = (reactor_resolve_t *)calloc(1, sizeof(reactor_resolve_t));
+    if (!pending) {
+        return ENOMEM;
+    }
+    pending->reactor = reactor;
+    pending->socket = socket;
+    pending->on_connected = on_connected;
+    pending->data = data;
+
+    int result = zn_resolve_async(hostname, port, on_resolved, pending);
+    if (result != 0) {
+        free(pending);
+    }
+    return result;
+}
+
+/* epoll emulation of completion operations */
+
+static void emulate_readable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data) {
+    (void)events;
+    (void)data;
+    reactor_entry_t *entry = find_entry(reactor, socket);
+    if (!entry) {
+        return;
+    }
+    reactor_ref_t ref = entry_ref(reactor, entry);
+
+    /* Edge-triggered: keep going until the socket would block */
+    while ((entry = reactor_entry_get(reactor, ref)) != NULL) {
+        if (entry->on_accept) {
+            socket_t client;
+            socket_result_t res = socket_accept(socket, &client);
+            if (!res.success && res.error_code == EAGAIN) {
+                return;
+            }
+            entry->on_accept(reactor, socket, res.success ? &client : NULL,
+                             res.success ? 0 : res.error_code, entry->receive_data);
+            if (!res.success) {
+                return;
+            }
+        } else if (entry->on_receive) {
+            if (!reactor->scratch && !(reactor->scratch = (char *)malloc(REACTOR_SCRATCH_SIZE))) {
+                return;
+            }
+
+            size_t received = 0;
+            socket_result_t res = socket_receive(socket, reactor->scratch, REACTOR_SCRATCH_SIZE, &received);
+            if (res.success && received == 0 && socket->is_connected) {
+                return;
+            }
+
+            /* End of stream and errors end the receive */
+            zn_reactor_receive_callback_t on_receive = entry->on_receive;
+            if (!res.success || received == 0) {
+                entry->on_receive = NULL;
+            }
+            on_receive(reactor, socket, reactor->scratch, received,
+                       res.success ? 0 : (res.error_code ? res.error_code : EIO), entry->receive_data);
+            if (!res.success || received == 0) {
+                return;
+            }
+        } else {
+            return;
+        }
+    }
+}
+
+static void emulate_writable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data) {
+    (void)events;
+    (void)data;
+    reactor_entry_t *entry = find_entry(reactor, socket);
+    if (!entry) {
+        return;
+    }
+    reactor_ref_t ref = entry_ref(reactor, entry);
+
+    if (entry->on_connected) {
+        int error = 0;
+        if (!socket->is_connected) {
+            socket_result_t res = socket_finish_connect(socket);
+            if (!res.success && res.error_code == EINPROGRESS) {
+                return;
+            }
+            error = res.success ? 0 : res.error_code;
+        }
+
+        zn_reactor_connect_callback_t on_connected = entry->on_connected;
+        entry->on_connected = NULL;
+        on_connected(reactor, socket, error, entry->connect_data);
+    }
+
+    while ((entry = reactor_entry_get(reactor, ref)) != NULL && entry->send_head) {
+        reactor_op_t *op = entry->send_head;
+        if (op->done < op->length) {
+            size_t sent = 0;
+            socket_result_t res = socket_send(socket, op->buffer + op->done, op->length - op->done, &sent);
+            if (!res.success) {
+                reactor_complete_send(reactor, ref, res.error_code ? res.error_code : EIO);
+                continue;
+            }
+            if (sent == 0) {
+                /* Send buffer full; wait for the next writable edge */
+                return;
+            }
+            op->done += sent;
+        }
+        if (op->done == op->length) {
+            reactor_complete_send(reactor, ref, 0);
+        }
+    }
+}
+
+/* Run emulated work queued since the last pass */
+static int run_deferred(zn_reactor_t *reactor) {
+    if (reactor->deferred_count == 0) {
+        return 0;
+    }
+
+    int ran = 0;
+    size_t count = reactor->deferred_count;
+
+    /* Entries deferred while this runs are handled in the next pass */
+    for (size_t i = 0; i < count; i++) {
+        reactor_ref_t ref = reactor->deferred[i];
+        reactor_entry_t *entry = reactor_entry_get(reactor, ref);
+        if (!entry) {
+            continue;
+        }
+        entry->deferred = false;
+        emulate_writable(reactor, entry->socket, ZN_REACTOR_WRITABLE, NULL);
+
+        entry = reactor_entry_get(reactor, ref);
+        if (entry && (entry->on_accept || entry->on_receive)) {
+            emulate_readable(reactor, entry->socket, ZN_REACTOR_READABLE, NULL);
+        }
+        ran++;
+    }
+
+    memmove(reactor->deferred, reactor->deferred + count,
+            (reactor->deferred_count - count) * sizeof(reactor_ref_t));
+    reactor->deferred_count -= count;
+    return ran;
+}
+
+/* Timers */
+
+zn_reactor_timer_t *zn_reactor_add_timer(zn_reactor_t *reactor, uint64_t delay_ms, uint64_t interval_ms,
+                                         zn_reactor_callback_t callback, void *data) {
+    if (!reactor || !callback) {
+        return NULL;
+    }
+
+    zn_reactor_timer_t *timer = (zn_reactor_timer_t *)calloc(1, sizeof(zn_reactor_timer_t));
+    if (!timer) {
+        return NULL;
+    }
+
+    timer->interval = interval_ms;
+    timer->callback = callback;
+    timer->data = data;
+    zn_timer_wheel_add(&reactor->timers, &timer->entry, monotonic_ms() + delay_ms);
+    return timer;
+}
+
+int zn_reactor_restart_timer(zn_reactor_t *reactor, zn_reactor_timer_t *timer, uint64_t delay_ms) {
+    if (!reactor || !timer || timer->cancelled) {
+        return EINVAL;
+    }
+
+    zn_timer_wheel_remove(&reactor->timers, &timer->entry);
+    zn_timer_wheel_add(&reactor->timers, &timer->entry, monotonic_ms() + delay_ms);
+    return 0;
+}
+
+void zn_reactor_cancel_timer(zn_reactor_t *reactor, zn_reactor_timer_t *timer) {
+    if (!reactor || !timer) {
+        return;
+    }
+
+    zn_timer_wheel_remove(&reactor->timers, &timer->entry);
+    if (timer->firing) {
+        /* Freed by the loop once the callback returns */
+        timer->cancelled = true;
+        return;
+    }
+    free(timer);
+}
+
+/* Run the timers that were due when this round started; timers added or
+ * restarted by the callbacks wait for the next round */
+static int run_timers(zn_reactor_t *reactor) {
+    int ran = 0;
+    zn_timer_wheel_advance(&reactor->timers, reactor->now);
+
+    zn_timer_wheel_entry_t *entry;
+    while ((entry = zn_timer_wheel_pop(&reactor->timers))) {
+        zn_reactor_timer_t *timer = (zn_reactor_timer_t *)entry;
+        uint64_t deadline = entry->expires;
+
+        timer->firing = true;
+        timer->callback(reactor, timer->data);
+        timer->firing = false;
+        ran++;
+
+        if (timer->cancelled) {
+            free(timer);
+            continue;
+        }
+        if (zn_timer_wheel_scheduled(entry)) {
+            /* Restarted by its own callback */
+            continue;
+        }
+        if (timer->interval == 0) {
+            free(timer);
+            continue;
+        }
+
+        /* Keep the period, but skip missed expiries rather than bursting */
+        deadline += timer->interval;
+        if (deadline <= reactor->now) {
+            deadline = reactor->now + timer->interval;
+        }
+        zn_timer_wheel_add(&reactor->timers, entry, deadline);
+    }
+    return ran;
+}
+
+/* Cross-thread tasks */
+
+int zn_reactor_post(zn_reactor_t *reactor, zn_reactor_callback_t callback, void *data) {
+    if (!reactor || !callback) {
+        return EINVAL;
+    }
+
+    reactor_task_t *task = (reactor_task_t *)malloc(sizeof(reactor_task_t));
+    if (!task) {
+        return ENOMEM;
+    }
+    task->callback = callback;
+    task->data = data;
+    task->next = NULL;
+
+    pthread_mutex_lock(&reactor->task_lock);
+    bool was_empty = reactor->tasks == NULL;
+    if (reactor->tasks_tail) {
+        reactor->tasks_tail->next = task;
+    } else {
+        reactor->tasks = task;
+    }
+    reactor->tasks_tail = task;
+    pthread_mutex_unlock(&reactor->task_lock);
+
+    /* Only the first task of a batch needs to wake the loop */
+    if (was_empty) {
+        uint64_t one = 1;
+        if (write(reactor->wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            return errno;
+        }
+    }
+    return 0;
+}
+
+static int run_tasks(zn_reactor_t *reactor) {
+    uint64_t count;
+    while (read(reactor->wake_fd, &count, sizeof(count)) > 0) {
+    }
+
+    pthread_mutex_lock(&reactor->task_lock);
+    reactor_task_t *task = reactor->tasks;
+    reactor->tasks = NULL;
+    reactor->tasks_tail = NULL;
+    pthread_mutex_unlock(&reactor->task_lock);
+
+    int ran = 0;
+    while (task) {
+        reactor_task_t *next = task->next;
+        task->callback(reactor, task->data);
+        free(task);
+        task = next;
+        ran++;
+    }
+    return ran;
+}
+
+/* Event loop */
+
+static int dispatch(zn_reactor_t *reactor, const struct epoll_event *event) {
+    uint64_t token = event->data.u64;
+    if (token == REACTOR_WAKE_TOKEN) {
+        return run_tasks(reactor);
+    }
+
+    int fd = (int)(uint32_t)token;
+    uint32_t generation = (uint32_t)(token >> 32);
+    if ((size_t)fd >= reactor->entry_capacity) {
+        return 0;
+    }
+
+    uint32_t events = 0;
+    if (event->events & EPOLLIN) events |= ZN_REACTOR_READABLE;
+    if (event->events & EPOLLOUT) events |= ZN_REACTOR_WRITABLE;
+    if (event->events & (EPOLLRDHUP | EPOLLHUP)) events |= ZN_REACTOR_HANGUP;
+    if (event->events & EPOLLERR) events |= ZN_REACTOR_ERROR;
+
+    /* Callbacks may add sockets (moving the table) or remove this one, so
+     * the entry is looked up again before each call */
+    int ran = 0;
+    reactor_entry_t *entry = &reactor->entries[fd];
+    if (entry->active && entry->generation == generation && entry->on_readable &&
+        (events & (ZN_REACTOR_READABLE | ZN_REACTOR_HANGUP | ZN_REACTOR_ERROR))) {
+        entry->on_readable(reactor, entry->socket, events, entry->data);
+        ran++;
+    }
+
+    entry = &reactor->entries[fd];
+    if (entry->active && entry->generation == generation && entry->on_writable &&
+        (events & (ZN_REACTOR_WRITABLE | ZN_REACTOR_ERROR))) {
+        entry->on_writable(reactor, entry->socket, events, entry->data);
+        ran++;
+    }
+    return ran;
+}
+
+int reactor_poll_epoll(zn_reactor_t *reactor) {
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    int ran = 0;
+    int count;
+
+    /* A full batch means more may be waiting */
+    do {
+        count = epoll_wait(reactor->epoll_fd, events, REACTOR_MAX_EVENTS, 0);
+        for (int i = 0; i < count; i++) {
+            ran += dispatch(reactor, &events[i]);
+        }
+    } while (count == REACTOR_MAX_EVENTS);
+    return ran;
+}
+
+int zn_reactor_run_once(zn_reactor_t *reactor, int timeout_ms) {
+    if (!reactor) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    reactor->now = monotonic_ms();
+    uint64_t deadline;
+    if (zn_timer_wheel_next(&reactor->timers, &deadline)) {
+        uint64_t until = deadline <= reactor->now ? 0 : deadline - reactor->now;
+        int until_timer = until > INT_MAX ? INT_MAX : (int)until;
+        if (timeout_ms < 0 || until_timer < timeout_ms) {
+            timeout_ms = until_timer;
+        }
+    }
+    if (reactor->deferred_count > 0) {
+        timeout_ms = 0;
+    }
+
+    int ran = 0;
+    if (reactor->uring) {
+        /* The ring watches the epoll fd, so readiness callbacks still run */
+        ran = zn_uring_run_once(reactor->uring, timeout_ms);
+        if (ran < 0) {
+            return -1;
+        }
+        reactor->now = monotonic_ms();
+    } else {
+        struct epoll_event events[REACTOR_MAX_EVENTS];
+        int count = epoll_wait(reactor->epoll_fd, events, REACTOR_MAX_EVENTS, timeout_ms);
+        if (count < 0) {
+            if (errno != EINTR) {
+                return -1;
+            }
+            count = 0;
+        }
+
+        reactor->now = monotonic_ms();
+        for (int i = 0; i < count; i++) {
+            ran += dispatch(reactor, &events[i]);
+        }
+    }
+
+    ran += run_deferred(reactor);
+    ran += run_timers(reactor);
+    return ran;
+}
+
+int zn_reactor_run(zn_reactor_t *reactor) {
+    if (!reactor) {
+        return EINVAL;
+    }
+
+    __atomic_store_n(&reactor->stopped, 0, __ATOMIC_RELAXED);
+    while (!__atomic_load_n(&reactor->stopped, __ATOMIC_ACQUIRE)) {
+        if (zn_reactor_run_once(reactor, -1) < 0) {
+            return errno;
+        }
+    }
+    return 0;
+}
+
+void zn_reactor_stop(zn_reactor_t *reactor) {
+    if (!reactor) {
+        return;
+    }
+
+    __atomic_store_n(&reactor->stopped, 1, __ATOMIC_RELEASE);
+    uint64_t one = 1;
+    if (write(reactor->wake_fd, &one, sizeof(one)) < 0) {
+        /* The counter is already non-zero, so the loop will wake anyway */
+    }
+}
+
+uint64_t zn_reactor_now(zn_reactor_t *reactor) {
+    return reactor ? reactor->now : monotonic_ms();
+}
+
+size_t zn_reactor_socket_count(zn_reactor_t *reactor) {
+    return reactor ? reactor->socket_count : 0;
+}
+
+/* Reactor groups */
+
+zn_reactor_group_t *zn_reactor_group_create(size_t num_reactors) {
+    return zn_reactor_group_create_with_backend(num_reactors, ZN_REACTOR_BACKEND_EPOLL);
+}
+
+zn_reactor_group_t *zn_reactor_group_create_with_backend(size_t num_reactors, zn_reactor_backend_t backend) {
+    if (num_reactors == 0) {
+        num_reactors = zn_get_num_cores();
+    }
+
+    zn_reactor_group_t *group = (zn_reactor_group_t *)calloc(1, sizeof(zn_reactor_group_t));
+    if (!group) {
+        return NULL;
+    }
+
+    group->reactors = (zn_reactor_t **)calloc(num_reactors, sizeof(zn_reactor_t *));
+    group->threads = (zn_thread_t *)calloc(num_reactors, sizeof(zn_thread_t));
+    if (!group->reactors || !group->threads) {
+        zn_reactor_group_destroy(group);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < num_reactors; i++) {
+        group->reactors[i] = zn_reactor_create_with_backend(backend);
+        if (!group->reactors[i]) {
+            zn_reactor_group_destroy(group);
+            return NULL;
+        }
+        group->size++;
+    }
+    return group;
+}
+
+static void *reactor_thread_main(void *arg) {
+    zn_reactor_run((zn_reactor_t *)arg);
+    return NULL;
+}
+
+int zn_reactor_group_start(zn_reactor_group_t *group) {
+    if (!group || group->running) {
+        return EINVAL;
+    }
+
+    for (size_t i = 0; i < group->size; i++) {
+        zn_thread_init(&group->threads[i]);
+        int result = zn_thread_create(&group->threads[i], reactor_thread_main, group->reactors[i]);
+        if (result != 0) {
+            /* Unwind the threads that did start */
+            for (size_t j = 0; j < i; j++) {
+                zn_reactor_stop(group->reactors[j]);
+                zn_thread_join(&group->threads[j], NULL);
+            }
+            return result;
+        }
+    }
+
+    group->running = true;
+    return 0;
+}
+
+void zn_reactor_group_stop(zn_reactor_group_t *group) {
+    if (!group || !group->running) {
+        return;
+    }
+
+    for (size_t i = 0; i < group->size; i++) {
+        zn_reactor_stop(group->reactors[i]);
+    }
+    for (size_t i = 0; i < group->size; i++) {
+        zn_thread_join(&group->threads[i], NULL);
+    }
+    group->running = false;
+}
+
+void zn_reactor_group_destroy(zn_reactor_group_t *group) {
+    if (!group) {
+        return;
+    }
+
+    zn_reactor_group_stop(group);
+    if (group->reactors) {
+        for (size_t i = 0; i < group->size; i++) {
+            zn_reactor_destroy(group->reactors[i]);
+        }
+    }
+    free(group->reactors);
+    free(group->threads);
+    free(group);
+}
+
+size_t zn_reactor_group_size(zn_reactor_group_t *group) {
+    return group ? group->size : 0;
+}
+
+zn_reactor_t *zn_reactor_group_get(zn_reactor_group_t *group, size_t index) {
+    if (!group || index >= group->size) {
+        return NULL;
+    }
+    return group->reactors[index];
+}
+
+zn_reactor_t *zn_reactor_group_next(zn_reactor_group_t *group) {
+    if (!group || group->size == 0) {
+        return NULL;
+    }
+    size_t index = __atomic_fetch_add(&group->next, 1, __ATOMIC_RELAXED);
+    return group->reactors[index % group->size];
+}
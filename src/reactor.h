@@ -0,0 +1,442 @@
+/**
+ * @file reactor.h
+ * @brief Event loop for socket_t (epoll, optionally io_uring)
+ *
+ * A reactor dispatches readiness and completion events for the
+ * sockets registered with it, runs timers and executes tasks posted from
+ * other threads. Each reactor is driven by a single thread; a reactor group
+ * runs one reactor per thread (by default one per core).
+ *
+ * Timers are kept in a hierarchical timing wheel (see timer_wheel.h) with
+ * millisecond ticks: adding, restarting and cancelling one is O(1), so
+ * every connection can carry its own read, write or idle timeout. The loop
+ * sleeps in epoll_wait (or io_uring_enter) until the wheel's next tick.
+ *
+ * Sockets can be driven in one of two styles, chosen per socket:
+ *
+ * - Readiness (zn_reactor_add): callbacks are edge-triggered. A callback is
+ *   invoked once when a socket becomes readable (or writable) and must keep
+ *   reading (writing) until the call would block, or it will not be
+ *   notified again.
+ * - Completion (zn_reactor_accept/receive/send/connect): the reactor
+ *   performs the I/O and reports results. Accept and receive are multishot
+ *   and keep delivering until the socket is removed.
+ *
+ * Two backends implement this. The epoll backend is always available and
+ * emulates completion operations with non-blocking syscalls. The io_uring
+ * backend submits completion operations in batches (one io_uring_enter per
+ * loop iteration), uses multishot accept/recv and receives into a buffer
+ * ring registered with the kernel; readiness callbacks still go through
+ * epoll, whose descriptor is polled from the ring. io_uring is used only
+ * when requested and supported by the running kernel.
+ */
+
+#ifndef ZENO_REACTOR_H
+#define ZENO_REACTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "socket.h"
+
+/**
+ * Reactor handle
+ */
+typedef struct zn_reactor zn_reactor_t;
+
+/**
+ * Timer handle
+ */
+typedef struct zn_reactor_timer zn_reactor_timer_t;
+
+/**
+ * Group of reactors, each running on its own thread
+ */
+typedef struct zn_reactor_group zn_reactor_group_t;
+
+/**
+ * Event loop backends
+ */
+typedef enum {
+    ZN_REACTOR_BACKEND_EPOLL,    /**< epoll, always available */
+    ZN_REACTOR_BACKEND_IO_URING  /**< io_uring, Linux 6.0 or later */
+} zn_reactor_backend_t;
+
+/**
+ * Event flags passed to I/O callbacks
+ */
+#define ZN_REACTOR_READABLE 0x1u /**< Data (or a connection) is available */
+#define ZN_REACTOR_WRITABLE 0x2u /**< Send buffer space is available */
+#define ZN_REACTOR_HANGUP   0x4u /**< Peer closed its side of the connection */
+#define ZN_REACTOR_ERROR    0x8u /**< Error pending on the socket */
+
+/**
+ * Called when a registered socket becomes ready
+ *
+ * @param reactor Reactor dispatching the event
+ * @param socket Socket that became ready
+ * @param events Combination of ZN_REACTOR_* flags
+ * @param data User data given at registration
+ */
+typedef void (*zn_reactor_io_callback_t)(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data);
+
+/**
+ * Called when a timer expires or a posted task runs
+ *
+ * @param reactor Reactor running the callback
+ * @param data User data given when the timer or task was created
+ */
+typedef void (*zn_reactor_callback_t)(zn_reactor_t *reactor, void *data);
+
+/**
+ * Called for each connection accepted by zn_reactor_accept
+ *
+ * @param reactor Reactor running the accept
+ * @param listener Listening socket
+ * @param client New connection (non-blocking). The structure is only valid
+ *               during the call; copy it to keep the connection. Its addr
+ *               is not filled in by the io_uring backend.
+ * @param error 0, or the error code if accepting failed
+ * @param data User data given to zn_reactor_accept
+ */
+typedef void (*zn_reactor_accept_callback_t)(zn_reactor_t *reactor, socket_t *listener, socket_t *client,
+                                             int error, void *data);
+
+/**
+ * Called with data received by zn_reactor_receive
+ *
+ * @param reactor Reactor running the receive
+ * @param socket Socket the data arrived on
+ * @param buffer Received bytes, only valid during the call
+ * @param length Number of bytes; 0 with error 0 means the peer closed
+ * @param error 0, or the error code if receiving failed. No further calls
+ *              follow an error or end of stream.
+ * @param data User data given to zn_reactor_receive
+ */
+typedef void (*zn_reactor_receive_callback_t)(zn_reactor_t *reactor, socket_t *socket, const void *buffer,
+                                              size_t length, int error, void *data);
+
+/**
+ * Called when a zn_reactor_send has completed
+ *
+ * @param reactor Reactor running the send
+ * @param socket Socket the data was sent on
+ * @param sent Bytes sent (the full length unless error is set)
+ * @param error 0, or the error code if sending failed
+ * @param data User data given to zn_reactor_send
+ */
+typedef void (*zn_reactor_send_callback_t)(zn_reactor_t *reactor, socket_t *socket, size_t sent,
+                                           int error, void *data);
+
+/**
+ * Called when a zn_reactor_connect has completed
+ *
+ * @param reactor Reactor running the connect
+ * @param socket Connecting socket
+ * @param error 0 on success, error code otherwise
+ * @param data User data given to zn_reactor_connect
+ */
+typedef void (*zn_reactor_connect_callback_t)(zn_reactor_t *reactor, socket_t *socket, int error, void *data);
+
+/**
+ * Create a reactor using the epoll backend
+ *
+ * @return New reactor, or NULL on failure (errno is set)
+ */
+zn_reactor_t *zn_reactor_create(void);
+
+/**
+ * Create a reactor, preferring the given backend. Falls back to epoll if
+ * the backend is not supported by the running kernel.
+ *
+ * @param backend Preferred backend
+ * @return New reactor, or NULL on failure (errno is set)
+ */
+zn_reactor_t *zn_reactor_create_with_backend(zn_reactor_backend_t backend);
+
+/**
+ * Backend a reactor is actually using
+ *
+ * @param reactor Reactor to query
+ * @return The backend
+ */
+zn_reactor_backend_t zn_reactor_backend(zn_reactor_t *reactor);
+
+/**
+ * Name of a backend, for logging
+ *
+ * @param backend Backend
+ * @return "epoll" or "io_uring"
+ */
+const char *zn_reactor_backend_name(zn_reactor_backend_t backend);
+
+/**
+ * Destroy a reactor. Registered sockets are not closed; pending timers and
+ * posted tasks are discarded without running.
+ *
+ * @param reactor Reactor to destroy (must not be running)
+ */
+void zn_reactor_destroy(zn_reactor_t *reactor);
+
+/**
+ * Register a socket with the reactor
+ *
+ * The socket is set to non-blocking mode. The socket_t must stay valid
+ * until it is removed from the reactor.
+ *
+ * @param reactor Reactor to register with
+ * @param socket Socket to watch
+ * @param on_readable Called when the socket becomes readable (can be NULL)
+ * @param on_writable Called when the socket becomes writable (can be NULL)
+ * @param data User data passed to the callbacks
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_add(zn_reactor_t *reactor, socket_t *socket,
+                   zn_reactor_io_callback_t on_readable,
+                   zn_reactor_io_callback_t on_writable, void *data);
+
+/**
+ * Replace the callbacks of a registered socket
+ *
+ * Both directions are always armed in the kernel, so this does not make a
+ * system call. Installing a writable callback on a socket that already has
+ * send buffer space does not produce an event; try the write first.
+ *
+ * @param reactor Reactor the socket is registered with
+ * @param socket Registered socket
+ * @param on_readable New readable callback (can be NULL)
+ * @param on_writable New writable callback (can be NULL)
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_set_callbacks(zn_reactor_t *reactor, socket_t *socket,
+                             zn_reactor_io_callback_t on_readable,
+                             zn_reactor_io_callback_t on_writable);
+
+/**
+ * Accept connections on a listening socket until it is removed
+ *
+ * @param reactor Reactor to run the accept on
+ * @param listener Bound, listening socket
+ * @param on_accept Called for each new connection
+ * @param data User data passed to the callback
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_accept(zn_reactor_t *reactor, socket_t *listener,
+                      zn_reactor_accept_callback_t on_accept, void *data);
+
+/**
+ * Receive data on a connected socket until end of stream, an error, or
+ * removal of the socket
+ *
+ * @param reactor Reactor to run the receive on
+ * @param socket Connected socket
+ * @param on_receive Called for each chunk of data
+ * @param data User data passed to the callback
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_receive(zn_reactor_t *reactor, socket_t *socket,
+                       zn_reactor_receive_callback_t on_receive, void *data);
+
+/**
+ * Send a buffer. Sends on one socket complete in the order they were
+ * issued. The buffer must stay valid until the callback runs.
+ *
+ * @param reactor Reactor to run the send on
+ * @param socket Connected socket
+ * @param buffer Data to send
+ * @param length Number of bytes
+ * @param on_sent Called once all bytes were sent or an error occurred (can be NULL)
+ * @param data User data passed to the callback
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_send(zn_reactor_t *reactor, socket_t *socket, const void *buffer, size_t length,
+                    zn_reactor_send_callback_t on_sent, void *data);
+
+/**
+ * Connect a socket without blocking the loop
+ *
+ * Numeric addresses and names in the resolver cache connect at once. Other
+ * names are looked up on the resolver's threads (see resolver.h) and the
+ * connect starts on the loop when the answer arrives; a lookup failure is
+ * reported through on_connected. The socket and the reactor must stay
+ * valid until on_connected has run. An IPv6 address switches the socket
+ * to AF_INET6, which is only possible before it is registered.
+ *
+ * @param reactor Reactor to run the connect on
+ * @param socket Unconnected TCP socket
+ * @param hostname Host name or IPv4/IPv6 address
+ * @param port Port number
+ * @param on_connected Called when the connection is established or failed
+ * @param data User data passed to the callback
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_connect(zn_reactor_t *reactor, socket_t *socket, const char *hostname, int port,
+                       zn_reactor_connect_callback_t on_connected, void *data);
+
+/**
+ * Unregister a socket. Pending events for it in the current dispatch round
+ * are dropped and outstanding completion operations are cancelled without
+ * running their callbacks, so the socket may be closed right after this call.
+ * On io_uring the kernel may still read the buffer of a send that was in
+ * progress until the reactor next enters the kernel; free send buffers from
+ * a send callback or a posted task rather than right after removal.
+ *
+ * @param reactor Reactor the socket is registered with
+ * @param socket Socket to remove
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_remove(zn_reactor_t *reactor, socket_t *socket);
+
+/**
+ * Start a timer
+ *
+ * @param reactor Reactor that runs the timer
+ * @param delay_ms Milliseconds until the first expiry
+ * @param interval_ms Period for repeating timers, 0 for a one-shot timer
+ * @param callback Function to call on expiry
+ * @param data User data passed to the callback
+ * @return Timer handle, or NULL on failure. One-shot timers are freed after
+ *         they fire; repeating timers live until cancelled.
+ */
+zn_reactor_timer_t *zn_reactor_add_timer(zn_reactor_t *reactor, uint64_t delay_ms, uint64_t interval_ms,
+                                         zn_reactor_callback_t callback, void *data);
+
+/**
+ * Move a timer's next expiry to delay_ms from now, e.g. to push back an
+ * idle timeout on activity. Costs the same as adding a timer, without the
+ * allocation. May be called from the timer's own callback; a repeating
+ * timer keeps its interval afterwards.
+ *
+ * @param reactor Reactor that runs the timer
+ * @param timer Timer to restart; one-shot timers must not have fired yet
+ *              (unless this is their callback)
+ * @param delay_ms Milliseconds until the next expiry
+ * @return 0 on success, EINVAL if the timer was cancelled
+ */
+int zn_reactor_restart_timer(zn_reactor_t *reactor, zn_reactor_timer_t *timer, uint64_t delay_ms);
+
+/**
+ * Cancel a pending timer. May be called from the timer's own callback.
+ *
+ * @param reactor Reactor that runs the timer
+ * @param timer Timer to cancel
+ */
+void zn_reactor_cancel_timer(zn_reactor_t *reactor, zn_reactor_timer_t *timer);
+
+/**
+ * Run a task on the reactor's thread. This is the only reactor function
+ * that is safe to call from other threads.
+ *
+ * @param reactor Reactor to run the task on
+ * @param callback Task function
+ * @param data User data passed to the task
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_post(zn_reactor_t *reactor, zn_reactor_callback_t callback, void *data);
+
+/**
+ * Wait for events once and dispatch them
+ *
+ * @param reactor Reactor to run
+ * @param timeout_ms Maximum time to wait, -1 to wait until an event or timer
+ * @return Number of callbacks run, or -1 on error
+ */
+int zn_reactor_run_once(zn_reactor_t *reactor, int timeout_ms);
+
+/**
+ * Run the event loop until zn_reactor_stop is called
+ *
+ * @param reactor Reactor to run
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_run(zn_reactor_t *reactor);
+
+/**
+ * Ask a running reactor to return from zn_reactor_run. Safe to call from
+ * any thread.
+ *
+ * @param reactor Reactor to stop
+ */
+void zn_reactor_stop(zn_reactor_t *reactor);
+
+/**
+ * Monotonic time in milliseconds, cached at the start of each loop iteration
+ *
+ * @param reactor Reactor to query
+ * @return Current loop time
+ */
+uint64_t zn_reactor_now(zn_reactor_t *reactor);
+
+/**
+ * Number of sockets currently registered
+ *
+ * @param reactor Reactor to query
+ * @return Registered socket count
+ */
+size_t zn_reactor_socket_count(zn_reactor_t *reactor);
+
+/**
+ * Create a group of reactors using the epoll backend
+ *
+ * @param num_reactors Number of reactors, 0 for one per core
+ * @return New group, or NULL on failure
+ */
+zn_reactor_group_t *zn_reactor_group_create(size_t num_reactors);
+
+/**
+ * Create a group of reactors, preferring the given backend
+ *
+ * @param num_reactors Number of reactors, 0 for one per core
+ * @param backend Preferred backend (see zn_reactor_create_with_backend)
+ * @return New group, or NULL on failure
+ */
+zn_reactor_group_t *zn_reactor_group_create_with_backend(size_t num_reactors, zn_reactor_backend_t backend);
+
+/**
+ * Start one thread per reactor, each running zn_reactor_run
+ *
+ * @param group Group to start
+ * @return 0 on success, error code otherwise
+ */
+int zn_reactor_group_start(zn_reactor_group_t *group);
+
+/**
+ * Stop all reactors and wait for their threads to exit
+ *
+ * @param group Group to stop
+ */
+void zn_reactor_group_stop(zn_reactor_group_t *group);
+
+/**
+ * Destroy a group and its reactors. Stops the group first if it is running.
+ *
+ * @param group Group to destroy
+ */
+void zn_reactor_group_destroy(zn_reactor_group_t *group);
+
+/**
+ * Number of reactors in a group
+ *
+ * @param group Group to query
+ * @return Reactor count
+ */
+size_t zn_reactor_group_size(zn_reactor_group_t *group);
+
+/**
+ * Get a reactor from a group by index
+ *
+ * @param group Group to query
+ * @param index Reactor index, less than zn_reactor_group_size
+ * @return The reactor
+ */
+zn_reactor_t *zn_reactor_group_get(zn_reactor_group_t *group, size_t index);
+
+/**
+ * Pick the next reactor in round-robin order, e.g. for a new connection
+ *
+ * @param group Group to pick from
+ * @return The reactor
+ */
+zn_reactor_t *zn_reactor_group_next(zn_reactor_group_t *group);
+
+#endif /* ZENO_REACTOR_H */
@@ -0,0 +1,191 @@
+/**
+ * @file reactor_internal.h
+ * @brief Reactor state shared between the epoll and io_uring backends
+ *
+ * Not part of the public API; only reactor.c and reactor_uring.c include it.
+ */
+
+#ifndef ZENO_REACTOR_INTERNAL_H
+#define ZENO_REACTOR_INTERNAL_H
+
+#include <netinet/in.h>
+#include <pthread.h>
+#include "reactor.h"
+#include "timer_wheel.h"
+
+typedef struct zn_uring zn_uring_t;
+
+/**
+ * Kinds of completion operations
+ */
+typedef enum {
+    REACTOR_OP_ACCEPT,
+    REACTOR_OP_RECEIVE,
+    REACTOR_OP_SEND,
+    REACTOR_OP_CONNECT
+} reactor_op_type_t;
+
+/**
+ * A completion operation. On io_uring an in-flight operation is owned by
+ * the kernel until its final completion arrives, even if its socket was
+ * removed in the meantime; generation tells the two cases apart.
+ */
+typedef struct reactor_op {
+    reactor_op_type_t type;
+    int fd;
+    uint32_t generation;          /**< Entry generation when the op was issued */
+    bool in_flight;               /**< Submitted to the kernel (io_uring only) */
+
+    const char *buffer;           /**< Send: data */
+    size_t length;                /**< Send: total bytes */
+    size_t done;                  /**< Send: bytes sent so far */
+    zn_reactor_send_callback_t on_sent;
+    void *data;
+
+    struct sockaddr_storage addr; /**< Connect: peer address */
+    socklen_t addr_len;
+    struct reactor_op *next;      /**< Send queue link */
+} reactor_op_t;
+
+/**
+ * Registration of one socket, indexed by file descriptor
+ */
+typedef struct {
+    socket_t *socket;
+
+    /* Readiness mode */
+    zn_reactor_io_callback_t on_readable;
+    zn_reactor_io_callback_t on_writable;
+    void *data;
+
+    /* Completion mode */
+    zn_reactor_accept_callback_t on_accept;
+    zn_reactor_receive_callback_t on_receive;
+    void *receive_data;           /**< For on_accept or on_receive */
+    zn_reactor_connect_callback_t on_connected;
+    void *connect_data;
+    reactor_op_t *multishot;      /**< In-flight accept or receive (io_uring) */
+    reactor_op_t *connect_op;     /**< In-flight connect (io_uring) */
+    reactor_op_t *send_head;      /**< Queued sends; the head is the one in progress */
+    reactor_op_t *send_tail;
+
+    uint32_t generation;          /**< Bumped on removal so stale events are dropped */
+    bool active;
+    bool completion;              /**< Registered through the completion API */
+    bool in_epoll;
+    bool deferred;                /**< Queued for the deferred pass (epoll backend) */
+} reactor_entry_t;
+
+/**
+ * Socket reference that survives removal: valid while the generation matches
+ */
+typedef struct {
+    int fd;
+    uint32_t generation;
+} reactor_ref_t;
+
+struct zn_reactor_timer {
+    zn_timer_wheel_entry_t entry; /**< Link in the timer wheel; entry.expires is the deadline */
+    uint64_t interval;
+    zn_reactor_callback_t callback;
+    void *data;
+    bool firing;
+    bool cancelled;
+};
+
+/**
+ * Task posted from another thread
+ */
+typedef struct reactor_task {
+    zn_reactor_callback_t callback;
+    void *data;
+    struct reactor_task *next;
+} reactor_task_t;
+
+struct zn_reactor {
+    int epoll_fd;
+    int wake_fd;
+    uint64_t now;
+    volatile int stopped;
+    zn_uring_t *uring;            /**< NULL on the epoll backend */
+
+    reactor_entry_t *entries;
+    size_t entry_capacity;
+    size_t socket_count;
+
+    reactor_ref_t *deferred;      /**< Sockets with emulated work pending */
+    size_t deferred_count;
+    size_t deferred_capacity;
+    char *scratch;                /**< Receive buffer for the epoll backend */
+
+    zn_timer_wheel_t timers;      /**< Pending timers, in milliseconds */
+
+    pthread_mutex_t task_lock;
+    reactor_task_t *tasks;
+    reactor_task_t *tasks_tail;
+};
+
+/* Shared helpers (reactor.c) */
+
+/**
+ * Look up a live entry by reference
+ *
+ * @return The entry, or NULL if the socket was removed
+ */
+reactor_entry_t *reactor_entry_get(zn_reactor_t *reactor, reactor_ref_t ref);
+
+/**
+ * Wait for epoll events without blocking and dispatch them
+ *
+ * @return Number of callbacks run
+ */
+int reactor_poll_epoll(zn_reactor_t *reactor);
+
+/**
+ * Remove the head of an entry's send queue and run its callback
+ */
+void reactor_complete_send(zn_reactor_t *reactor, reactor_ref_t ref, int error);
+
+/* io_uring backend (reactor_uring.c) */
+
+/**
+ * Set up a ring for the reactor
+ *
+ * @return The ring, or NULL if io_uring or a required feature is missing
+ */
+zn_uring_t *zn_uring_create(zn_reactor_t *reactor);
+
+/**
+ * Tear down a ring. In-flight operations are abandoned.
+ */
+void zn_uring_destroy(zn_uring_t *uring);
+
+/**
+ * Submit pending operations, wait for completions and dispatch them
+ *
+ * @param timeout_ms Maximum time to wait, -1 for no limit
+ * @return Number of callbacks run, or -1 on error
+ */
+int zn_uring_run_once(zn_uring_t *uring, int timeout_ms);
+
+/**
+ * Queue a multishot accept or receive for the entry
+ */
+int zn_uring_arm_multishot(zn_uring_t *uring, reactor_entry_t *entry, reactor_op_type_t type);
+
+/**
+ * Queue the send at the head of the entry's send queue
+ */
+int zn_uring_submit_send(zn_uring_t *uring, reactor_op_t *op);
+
+/**
+ * Queue a connect
+ */
+int zn_uring_submit_connect(zn_uring_t *uring, reactor_op_t *op);
+
+/**
+ * Cancel an in-flight operation; it completes later with ECANCELED
+ */
+void zn_uring_cancel(zn_uring_t *uring, reactor_op_t *op);
+
+#endif /* ZENO_REACTOR_INTERNAL_H */
@@ -0,0 +1,616 @@
+/**
+ * @file reactor_uring.c
+ * @brief io_uring backend of the reactor
+ *
+ * Talks to the kernel through the raw system calls so there is no
+ * dependency on liburing. Completion operations are queued in the
+ * submission ring and submitted together with the wait for completions, so
+ * a loop iteration costs one io_uring_enter however many sockets were
+ * serviced. Accept and receive are multishot; received data lands in a
+ * provided buffer ring and each buffer is handed back to the kernel as soon
+ * as the receive callback returns.
+ */
+
+#define _GNU_SOURCE
+#include "reactor_internal.h"
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define URING_SQ_ENTRIES 512
+#define URING_CQ_ENTRIES 8192
+#define URING_BUFFER_COUNT 1024      /* Power of two, as the buffer ring requires */
+#define URING_BUFFER_SIZE 4096
+#define URING_BUFFER_GROUP 0
+#define URING_DRAIN_TIMEOUT_MS 1000
+
+struct zn_uring {
+    zn_reactor_t *reactor;
+    int fd;
+
+    void *ring;
+    size_t ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned sq_local_tail;        /**< Tail including entries not yet published */
+    unsigned pending;              /**< Entries queued since the last submit */
+
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+
+    struct io_uring_buf_ring *buf_ring;
+    size_t buf_ring_size;
+    char *buffers;
+    unsigned short buf_tail;
+
+    reactor_op_t poll_op;          /**< Multishot poll on the epoll descriptor */
+    bool poll_armed;
+    bool draining;
+    size_t in_flight;              /**< Operations still owned by the kernel */
+};
+
+static int uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                       const void *arg, size_t arg_size) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, arg_size);
+}
+
+static int uring_register(int fd, unsigned opcode, void *arg, unsigned count) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+/* Check that every opcode the backend issues is implemented. SEND_ZC is
+ * not used, but it arrived in the same release (6.0) as multishot receive,
+ * which the probe cannot report directly. */
+static bool probe_opcodes(int fd) {
+    static const unsigned required[] = {
+        IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_CONNECT,
+        IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL, IORING_OP_SEND_ZC
+    };
+
+    size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = (struct io_uring_probe *)calloc(1, size);
+    if (!probe) {
+        return false;
+    }
+
+    bool supported = uring_register(fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+    for (size_t i = 0; supported && i < sizeof(required) / sizeof(required[0]); i++) {
+        unsigned op = required[i];
+        supported = op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    return supported;
+}
+
+static void recycle_buffer(zn_uring_t *uring, unsigned short bid) {
+    struct io_uring_buf *buf = &uring->buf_ring->bufs[uring->buf_tail & (URING_BUFFER_COUNT - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(uring->buffers + (size_t)bid * URING_BUFFER_SIZE);
+    buf->len = URING_BUFFER_SIZE;
+    buf->bid = bid;
+    uring->buf_tail++;
+    __atomic_store_n(&uring->buf_ring->tail, uring->buf_tail, __ATOMIC_RELEASE);
+}
+
+static int setup_buffers(zn_uring_t *uring) {
+    uring->buf_ring_size = URING_BUFFER_COUNT * sizeof(struct io_uring_buf);
+    void *ring = mmap(NULL, uring->buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        return errno;
+    }
+    uring->buf_ring = (struct io_uring_buf_ring *)ring;
+
+    uring->buffers = (char *)malloc((size_t)URING_BUFFER_COUNT * URING_BUFFER_SIZE);
+    if (!uring->buffers) {
+        return ENOMEM;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ring;
+    reg.ring_entries = URING_BUFFER_COUNT;
+    reg.bgid = URING_BUFFER_GROUP;
+    if (uring_register(uring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        return errno;
+    }
+
+    for (unsigned i = 0; i < URING_BUFFER_COUNT; i++) {
+        recycle_buffer(uring, (unsigned short)i);
+    }
+    return 0;
+}
+
+zn_uring_t *zn_uring_create(zn_reactor_t *reactor) {
+    zn_uring_t *uring = (zn_uring_t *)calloc(1, sizeof(zn_uring_t));
+    if (!uring) {
+        return NULL;
+    }
+    uring->reactor = reactor;
+    uring->poll_op.type = REACTOR_OP_RECEIVE;
+    uring->poll_op.fd = reactor->epoll_fd;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = URING_CQ_ENTRIES;
+    uring->fd = uring_setup(URING_SQ_ENTRIES, &params);
+    if (uring->fd < 0 && errno == EINVAL) {
+        /* Cooperative task running is an optimisation only (5.19+) */
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = URING_CQ_ENTRIES;
+        uring->fd = uring_setup(URING_SQ_ENTRIES, &params);
+    }
+    if (uring->fd < 0) {
+        free(uring);
+        return NULL;
+    }
+
+    unsigned needed = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & needed) != needed || !probe_opcodes(uring->fd)) {
+        zn_uring_destroy(uring);
+        return NULL;
+    }
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    uring->ring_size = sq_size > cq_size ? sq_size : cq_size;
+    uring->ring = mmap(NULL, uring->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       uring->fd, IORING_OFF_SQ_RING);
+    if (uring->ring == MAP_FAILED) {
+        uring->ring = NULL;
+        zn_uring_destroy(uring);
+        return NULL;
+    }
+
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = (struct io_uring_sqe *)mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED) {
+        uring->sqes = NULL;
+        zn_uring_destroy(uring);
+        return NULL;
+    }
+
+    char *base = (char *)uring->ring;
+    uring->sq_head = (unsigned *)(base + params.sq_off.head);
+    uring->sq_tail = (unsigned *)(base + params.sq_off.tail);
+    uring->sq_array = (unsigned *)(base + params.sq_off.array);
+    uring->sq_mask = *(unsigned *)(base + params.sq_off.ring_mask);
+    uring->sq_entries = params.sq_entries;
+    uring->sq_local_tail = *uring->sq_tail;
+    uring->cq_head = (unsigned *)(base + params.cq_off.head);
+    uring->cq_tail = (unsigned *)(base + params.cq_off.tail);
+    uring->cq_mask = *(unsigned *)(base + params.cq_off.ring_mask);
+    uring->cqes = (struct io_uring_cqe *)(base + params.cq_off.cqes);
+
+    /* Slot i of the submission ring always refers to SQE i */
+    for (unsigned i = 0; i < uring->sq_entries; i++) {
+        uring->sq_array[i] = i;
+    }
+
+    if (setup_buffers(uring) != 0) {
+        zn_uring_destroy(uring);
+        return NULL;
+    }
+    return uring;
+}
+
+/* Publish queued entries and enter the kernel */
+static int submit(zn_uring_t *uring, unsigned min_complete, int timeout_ms) {
+    __atomic_store_n(uring->sq_tail, uring->sq_local_tail, __ATOMIC_RELEASE);
+
+    unsigned flags = 0;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.sigmask_sz = _NSIG / 8;
+    if (min_complete > 0 || timeout_ms == 0) {
+        flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+        if (timeout_ms >= 0) {
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+            arg.ts = (uint64_t)(uintptr_t)&ts;
+        }
+    }
+
+    int submitted = uring_enter(uring->fd, uring->pending, min_complete, flags,
+                                flags ? &arg : NULL, flags ? sizeof(arg) : 0);
+    if (submitted < 0) {
+        /* Timeouts, signals and a full completion ring are not failures */
+        if (errno == ETIME || errno == EINTR || errno == EBUSY || errno == EAGAIN) {
+            return 0;
+        }
+        return -1;
+    }
+    uring->pending -= (unsigned)submitted < uring->pending ? (unsigned)submitted : uring->pending;
+    return 0;
+}
+
+static struct io_uring_sqe *get_sqe(zn_uring_t *uring) {
+    unsigned head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+    if (uring->sq_local_tail - head >= uring->sq_entries) {
+        /* Full: hand the batch to the kernel early */
+        submit(uring, 0, -1);
+        head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+        if (uring->sq_local_tail - head >= uring->sq_entries) {
+            return NULL;
+        }
+    }
+
+    struct io_uring_sqe *sqe = &uring->sqes[uring->sq_local_tail & uring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    uring->sq_local_tail++;
+    uring->pending++;
+    return sqe;
+}
+
+int zn_uring_arm_multishot(zn_uring_t *uring, reactor_entry_t *entry, reactor_op_type_t type) {
+    reactor_op_t *op = (reactor_op_t *)calloc(1, sizeof(reactor_op_t));
+    if (!op) {
+        return ENOMEM;
+    }
+    struct io_uring_sqe *sqe = get_sqe(uring);
+    if (!sqe) {
+        free(op);
+        return EBUSY;
+    }
+
+    op->type = type;
+    op->fd = entry->socket->fd;
+    op->generation = entry->generation;
+    op->in_flight = true;
+
+    sqe->fd = op->fd;
+    sqe->user_data = (uint64_t)(uintptr_t)op;
+    if (type == REACTOR_OP_ACCEPT) {
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    } else {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = URING_BUFFER_GROUP;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+    }
+
+    entry->multishot = op;
+    uring->in_flight++;
+    return 0;
+}
+
+int zn_uring_submit_send(zn_uring_t *uring, reactor_op_t *op) {
+    struct io_uring_sqe *sqe = get_sqe(uring);
+    if (!sqe) {
+        return EBUSY;
+    }
+
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = op->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(op->buffer + op->done);
+    sqe->len = (uint32_t)(op->length - op->done);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = (uint64_t)(uintptr_t)op;
+    op->in_flight = true;
+    uring->in_flight++;
+    return 0;
+}
+
+int zn_uring_submit_connect(zn_uring_t *uring, reactor_op_t *op) {
+    struct io_uring_sqe *sqe = get_sqe(uring);
+    if (!sqe) {
+        return EBUSY;
+    }
+
+    sqe->opcode = IORING_OP_CONNECT;
+    sqe->fd = op->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&op->addr;
+    sqe->off = op->addr_len;
+    sqe->user_data = (uint64_t)(uintptr_t)op;
+    op->in_flight = true;
+    uring->in_flight++;
+    return 0;
+}
+
+void zn_uring_cancel(zn_uring_t *uring, reactor_op_t *op) {
+    struct io_uring_sqe *sqe = get_sqe(uring);
+    if (!sqe) {
+        /* The operation still ends when its socket is closed */
+        return;
+    }
+
+    /* user_data 0 marks the cancel's own completion, which is ignored */
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)op;
+}
+
+static void arm_epoll_poll(zn_uring_t *uring) {
+    struct io_uring_sqe *sqe = get_sqe(uring);
+    if (!sqe) {
+        return;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = uring->reactor->epoll_fd;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = (uint64_t)(uintptr_t)&uring->poll_op;
+    uring->poll_armed = true;
+}
+
+/* Operations end when their final completion arrives */
+static void finish_op(zn_uring_t *uring, reactor_op_t *op) {
+    op->in_flight = false;
+    uring->in_flight--;
+}
+
+static int complete_accept(zn_uring_t *uring, reactor_op_t *op, int res, bool final) {
+    zn_reactor_t *reactor = uring->reactor;
+    reactor_ref_t ref = { op->fd, op->generation };
+    reactor_entry_t *entry = reactor_entry_get(reactor, ref);
+    if (final) {
+        finish_op(uring, op);
+        if (entry && entry->multishot == op) {
+            entry->multishot = NULL;
+        }
+        free(op);
+    }
+
+    if (!entry || !entry->on_accept) {
+        /* Accepted after the listener was removed */
+        if (res >= 0) {
+            close(res);
+        }
+        return 0;
+    }
+    if (res == -ECANCELED) {
+        return 0;
+    }
+
+    if (res >= 0) {
+        socket_t client;
+        memset(&client, 0, sizeof(client));
+        client.fd = res;
+        client.type = entry->socket->type;
+        client.is_connected = true;
+        client.is_nonblocking = true;
+        entry->on_accept(reactor, entry->socket, &client, 0, entry->receive_data);
+    } else {
+        entry->on_accept(reactor, entry->socket, NULL, -res, entry->receive_data);
+    }
+
+    /* The kernel ends multishot accept on some errors; start it again */
+    entry = reactor_entry_get(reactor, ref);
+    if (final && entry && entry->on_accept && !entry->multishot) {
+        zn_uring_arm_multishot(uring, entry, REACTOR_OP_ACCEPT);
+    }
+    return 1;
+}
+
+static int complete_receive(zn_uring_t *uring, reactor_op_t *op, int res, uint32_t flags) {
+    zn_reactor_t *reactor = uring->reactor;
+    bool final = !(flags & IORING_CQE_F_MORE);
+    reactor_ref_t ref = { op->fd, op->generation };
+    reactor_entry_t *entry = reactor_entry_get(reactor, ref);
+    if (final) {
+        finish_op(uring, op);
+        if (entry && entry->multishot == op) {
+            entry->multishot = NULL;
+        }
+        free(op);
+    }
+
+    const char *buffer = NULL;
+    unsigned short bid = 0;
+    if (flags & IORING_CQE_F_BUFFER) {
+        bid = (unsigned short)(flags >> IORING_CQE_BUFFER_SHIFT);
+        buffer = uring->buffers + (size_t)bid * URING_BUFFER_SIZE;
+    }
+
+    int ran = 0;
+    if (entry && entry->on_receive && res != -ECANCELED && res != -ENOBUFS) {
+        zn_reactor_receive_callback_t on_receive = entry->on_receive;
+        if (res <= 0) {
+            /* End of stream or error: the receive is over */
+            entry->on_receive = NULL;
+            if (res == 0) {
+                entry->socket->is_connected = false;
+            }
+        }
+        on_receive(reactor, entry->socket, buffer, res > 0 ? (size_t)res : 0,
+                   res < 0 ? -res : 0, entry->receive_data);
+        ran = 1;
+    }
+
+    if (buffer) {
+        recycle_buffer(uring, bid);
+    }
+
+    /* Multishot receive stops when the buffer ring runs dry */
+    entry = reactor_entry_get(reactor, ref);
+    if (final && entry && entry->on_receive && !entry->multishot) {
+        zn_uring_arm_multishot(uring, entry, REACTOR_OP_RECEIVE);
+    }
+    return ran;
+}
+
+static int complete_send(zn_uring_t *uring, reactor_op_t *op, int res) {
+    zn_reactor_t *reactor = uring->reactor;
+    reactor_ref_t ref = { op->fd, op->generation };
+    reactor_entry_t *entry = reactor_entry_get(reactor, ref);
+    finish_op(uring, op);
+
+    if (!entry || entry->send_head != op) {
+        /* Cancelled by removal of the socket */
+        free(op);
+        return 0;
+    }
+
+    if (res < 0) {
+        reactor_complete_send(reactor, ref, -res);
+        return 1;
+    }
+
+    op->done += (size_t)res;
+    if (op->done < op->length && res > 0) {
+        /* Stream sockets may accept only part of the buffer */
+        if (zn_uring_submit_send(uring, op) == 0) {
+            return 0;
+        }
+        reactor_complete_send(reactor, ref, EBUSY);
+        return 1;
+    }
+
+    reactor_complete_send(reactor, ref, op->done == op->length ? 0 : EPIPE);
+    return 1;
+}
+
+static int complete_connect(zn_uring_t *uring, reactor_op_t *op, int res) {
+    zn_reactor_t *reactor = uring->reactor;
+    reactor_ref_t ref = { op->fd, op->generation };
+    reactor_entry_t *entry = reactor_entry_get(reactor, ref);
+    bool current = entry && entry->connect_op == op && entry->on_connected;
+    finish_op(uring, op);
+    free(op);
+
+    if (!current) {
+        return 0;
+    }
+
+    entry->connect_op = NULL;
+    if (res == 0) {
+        entry->socket->is_connected = true;
+    }
+    zn_reactor_connect_callback_t on_connected = entry->on_connected;
+    entry->on_connected = NULL;
+    on_connected(reactor, entry->socket, -res, entry->connect_data);
+    return 1;
+}
+
+static int handle_completion(zn_uring_t *uring, uint64_t user_data, int res, uint32_t flags) {
+    if (user_data == 0) {
+        return 0;
+    }
+
+    reactor_op_t *op = (reactor_op_t *)(uintptr_t)user_data;
+    if (op == &uring->poll_op) {
+        if (!(flags & IORING_CQE_F_MORE)) {
+            uring->poll_armed = false;
+        }
+        return uring->draining ? 0 : reactor_poll_epoll(uring->reactor);
+    }
+
+    switch (op->type) {
+    case REACTOR_OP_ACCEPT:
+        return complete_accept(uring, op, res, !(flags & IORING_CQE_F_MORE));
+    case REACTOR_OP_RECEIVE:
+        return complete_receive(uring, op, res, flags);
+    case REACTOR_OP_SEND:
+        return complete_send(uring, op, res);
+    case REACTOR_OP_CONNECT:
+        return complete_connect(uring, op, res);
+    }
+    return 0;
+}
+
+/* Dispatch the completions that are already in the ring */
+static int reap(zn_uring_t *uring) {
+    int ran = 0;
+    unsigned head = *uring->cq_head;
+    unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &uring->cqes[head & uring->cq_mask];
+        uint64_t user_data = cqe->user_data;
+        int res = cqe->res;
+        uint32_t flags = cqe->flags;
+
+        /* Free the slot before running callbacks that may queue more work */
+        __atomic_store_n(uring->cq_head, ++head, __ATOMIC_RELEASE);
+        ran += handle_completion(uring, user_data, res, flags);
+    }
+    return ran;
+}
+
+int zn_uring_run_once(zn_uring_t *uring, int timeout_ms) {
+    if (!uring->poll_armed) {
+        arm_epoll_poll(uring);
+    }
+
+    /* Completions left over from the last round must not wait */
+    unsigned head = *uring->cq_head;
+    if (__atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE) != head) {
+        timeout_ms = 0;
+    }
+
+    if (submit(uring, timeout_ms == 0 ? 0 : 1, timeout_ms) < 0) {
+        return -1;
+    }
+    return reap(uring);
+}
+
+void zn_uring_destroy(zn_uring_t *uring) {
+    if (!uring) {
+        return;
+    }
+
+    /* Collect the final completions of cancelled operations so they can be
+     * freed; the reactor has already removed every socket */
+    if (uring->ring && uring->sqes) {
+        uring->draining = true;
+        if (uring->poll_armed) {
+            zn_uring_cancel(uring, &uring->poll_op);
+        }
+
+        struct timespec start, now;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (uring->in_flight > 0) {
+            if (submit(uring, 1, 10) < 0) {
+                break;
+            }
+            reap(uring);
+
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long elapsed = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+            if (elapsed > URING_DRAIN_TIMEOUT_MS) {
+                break;
+            }
+        }
+    }
+
+    if (uring->ring) {
+        munmap(uring->ring, uring->ring_size);
+    }
+    if (uring->sqes) {
+        munmap(uring->sqes, uring->sqes_size);
+    }
+    /* The buffer ring stays registered until the ring is closed */
+    if (uring->fd >= 0) {
+        close(uring->fd);
+    }
+    if (uring->buf_ring) {
+        munmap(uring->buf_ring, uring->buf_ring_size);
+    }
+    free(uring->buffers);
+    free(uring);
+}
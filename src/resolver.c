@@ -0,0 +1,407 @@
+/**
+ * @file resolver.c
+ * @brief Implementation of the cached getaddrinfo resolver
+ */
+
+#define _GNU_SOURCE
+#include "resolver.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include "threads.h"
+
+#define RESOLVER_BUCKETS 256
+#define RESOLVER_MAX_ENTRIES 1024
+#define RESOLVER_THREADS 4
+
+/* A caller waiting for a lookup in progress */
+typedef struct resolver_waiter {
+    zn_resolve_callback_t callback;
+    void *data;
+    int port;
+    struct resolver_waiter *next;
+} resolver_waiter_t;
+
+typedef struct resolver_entry {
+    char *hostname;
+    uint32_t hash;
+    zn_address_list_t addresses;    /* Port 0; valid until expires_ms */
+    uint64_t expires_ms;
+    bool pending;                   /* A lookup is running for waiters */
+    resolver_waiter_t *waiters;
+    struct resolver_entry *next;
+} resolver_entry_t;
+
+/* Work item for the thread pool */
+typedef struct {
+    char *hostname;
+    uint32_t hash;
+    bool shared;                    /* Waiters are on the cache entry */
+    resolver_waiter_t *waiter;      /* Otherwise the only caller */
+} resolver_job_t;
+
+static pthread_once_t cache_once = PTHREAD_ONCE_INIT;
+static zn_mutex_t cache_mutex;
+static resolver_entry_t *buckets[RESOLVER_BUCKETS];
+static size_t entry_count;
+static uint32_t ttl_ms = ZN_RESOLVE_DEFAULT_TTL_MS;
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static zn_thread_pool_t *pool;
+
+static void cache_init(void) {
+    zn_mutex_init(&cache_mutex);
+}
+
+/* The pool serves the whole process and is never destroyed */
+static void pool_start(void) {
+    pool = zn_thread_pool_create(RESOLVER_THREADS);
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/* Host names are case-insensitive */
+static uint32_t hash_name(const char *hostname) {
+    uint32_t hash = 2166136261u;
+    for (const char *c = hostname; *c; c++) {
+        char lower = (*c >= 'A' && *c <= 'Z') ? (char)(*c - 'A' + 'a') : *c;
+        hash = (hash ^ (uint8_t)lower) * 16777619u;
+    }
+    return hash;
+}
+
+static void set_port(zn_address_list_t *list, int port) {
+    for (size_t i = 0; i < list->count; i++) {
+        struct sockaddr_storage *addr = &list->addresses[i].addr;
+        if (addr->ss_family == AF_INET6) {
+            ((struct sockaddr_in6 *)addr)->sin6_port = htons((uint16_t)port);
+        } else {
+            ((struct sockaddr_in *)addr)->sin_port = htons((uint16_t)port);
+        }
+    }
+}
+
+static bool parse_numeric(const char *hostname, int port, zn_address_list_t *out) {
+    memset(out, 0, sizeof(*out));
+    struct sockaddr_in *v4 = (struct sockaddr_in *)&out->addresses[0].addr;
+    struct sockaddr_in6 *v6 = (struct sockaddr_in6 *)&out->addresses[0].addr;
+
+    if (inet_pton(AF_INET, hostname, &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        out->addresses[0].length = sizeof(*v4);
+    } else if (inet_pton(AF_INET6, hostname, &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        out->addresses[0].length = sizeof(*v6);
+    } else {
+        return false;
+    }
+    out->count = 1;
+    set_port(out, port);
+    return true;
+}
+
+/* The blocking part; runs without the cache lock */
+static int lookup(const char *hostname, zn_address_list_t *out) {
+    memset(out, 0, sizeof(*out));
+
+    /* One socket type so each address is listed once; AI_ADDRCONFIG skips
+     * families this host has no address for */
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+
+    struct addrinfo *info = NULL;
+    int result = getaddrinfo(hostname, NULL, &hints, &info);
+    if (result != 0) {
+        switch (result) {
+        case EAI_AGAIN:
+            return EAGAIN;
+        case EAI_MEMORY:
+            return ENOMEM;
+        case EAI_SYSTEM:
+            return errno ? errno : EIO;
+        default:
+            return EHOSTUNREACH;
+        }
+    }
+
+    for (struct addrinfo *ai = info; ai && out->count < ZN_RESOLVE_MAX_ADDRESSES; ai = ai->ai_next) {
+        if ((ai->ai_family != AF_INET && ai->ai_family != AF_INET6) ||
+            ai->ai_addrlen > sizeof(struct sockaddr_storage)) {
+            continue;
+        }
+        zn_address_t *address = &out->addresses[out->count++];
+        memcpy(&address->addr, ai->ai_addr, ai->ai_addrlen);
+        address->length = ai->ai_addrlen;
+    }
+    freeaddrinfo(info);
+    return out->count > 0 ? 0 : EHOSTUNREACH;
+}
+
+/* Cache; all of these expect cache_mutex to be held */
+
+static resolver_entry_t *cache_find(const char *hostname, uint32_t hash) {
+    for (resolver_entry_t *entry = buckets[hash % RESOLVER_BUCKETS]; entry; entry = entry->next) {
+        if (entry->hash == hash && strcasecmp(entry->hostname, hostname) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void cache_unlink(resolver_entry_t *entry) {
+    resolver_entry_t **link = &buckets[entry->hash % RESOLVER_BUCKETS];
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    entry_count--;
+    free(entry->hostname);
+    free(entry);
+}
+
+/* Drop expired answers; entries with a lookup in progress stay */
+static void cache_purge(uint64_t now, bool everything) {
+    for (size_t i = 0; i < RESOLVER_BUCKETS; i++) {
+        resolver_entry_t *entry = buckets[i];
+        while (entry) {
+            resolver_entry_t *next = entry->next;
+            if (!entry->pending && (everything || entry->expires_ms <= now)) {
+                cache_unlink(entry);
+            }
+            entry = next;
+        }
+    }
+}
+
+static resolver_entry_t *cache_insert(const char *hostname, uint32_t hash) {
+    if (entry_count >= RESOLVER_MAX_ENTRIES) {
+        cache_purge(now_ms(), false);
+        if (entry_count >= RESOLVER_MAX_ENTRIES) {
+            return NULL;
+        }
+    }
+
+    resolver_entry_t *entry = (resolver_entry_t *)calloc(1, sizeof(resolver_entry_t));
+    if (!entry) {
+        return NULL;
+    }
+    entry->hostname = strdup(hostname);
+    if (!entry->hostname) {
+        free(entry);
+        return NULL;
+    }
+    entry->hash = hash;
+    entry->next = buckets[hash % RESOLVER_BUCKETS];
+    buckets[hash % RESOLVER_BUCKETS] = entry;
+    entry_count++;
+    return entry;
+}
+
+static void cache_store(resolver_entry_t *entry, const zn_address_list_t *addresses) {
+    entry->addresses = *addresses;
+    entry->expires_ms = now_ms() + ttl_ms;
+}
+
+/* Copy a live answer out of the cache */
+static bool cache_get(const char *hostname, uint32_t hash, int port, zn_address_list_t *out) {
+    pthread_once(&cache_once, cache_init);
+    zn_mutex_lock(&cache_mutex);
+    resolver_entry_t *entry = cache_find(hostname, hash);
+    bool hit = entry && entry->addresses.count > 0 && entry->expires_ms > now_ms();
+    if (hit) {
+        *out = entry->addresses;
+    }
+    zn_mutex_unlock(&cache_mutex);
+
+    if (hit) {
+        set_port(out, port);
+    }
+    return hit;
+}
+
+bool zn_resolve_cached(const char *hostname, int port, zn_address_list_t *out) {
+    if (!hostname || !out) {
+        return false;
+    }
+    return parse_numeric(hostname, port, out) || cache_get(hostname, hash_name(hostname), port, out);
+}
+
+int zn_resolve(const char *hostname, int port, zn_address_list_t *out) {
+    if (!hostname || !out) {
+        return EINVAL;
+    }
+    uint32_t hash = hash_name(hostname);
+    if (parse_numeric(hostname, port, out) || cache_get(hostname, hash, port, out)) {
+        return 0;
+    }
+
+    int result = lookup(hostname, out);
+    if (result != 0) {
+        return result;
+    }
+
+    zn_mutex_lock(&cache_mutex);
+    if (ttl_ms > 0) {
+        resolver_entry_t *entry = cache_find(hostname, hash);
+        if (!entry) {
+            entry = cache_insert(hostname, hash);
+        }
+        if (entry) {
+            cache_store(entry, out);
+        }
+    }
+    zn_mutex_unlock(&cache_mutex);
+    set_port(out, port);
+    return 0;
+}
+
+static void deliver(resolver_waiter_t *waiters, int error, const zn_address_list_t *addresses) {
+    while (waiters) {
+        resolver_waiter_t *next = waiters->next;
+        if (error) {
+            waiters->callback(error, NULL, waiters->data);
+        } else {
+            zn_address_list_t copy = *addresses;
+            set_port(&copy, waiters->port);
+            waiters->callback(0, &copy, waiters->data);
+        }
+        free(waiters);
+        waiters = next;
+    }
+}
+
+/* Runs on a pool thread */
+static void resolve_job(void *arg) {
+    resolver_job_t *job = (resolver_job_t *)arg;
+    zn_address_list_t addresses;
+    int error = lookup(job->hostname, &addresses);
+
+    resolver_waiter_t *waiters = job->waiter;
+    if (job->shared) {
+        zn_mutex_lock(&cache_mutex);
+        resolver_entry_t *entry = cache_find(job->hostname, job->hash);
+        if (entry) {
+            waiters = entry->waiters;
+            entry->waiters = NULL;
+            entry->pending = false;
+            if (error == 0 && ttl_ms > 0) {
+                cache_store(entry, &addresses);
+            } else if (entry->expires_ms <= now_ms()) {
+                /* Failures are not cached; keep an answer zn_resolve
+                 * stored in the meantime */
+                cache_unlink(entry);
+            }
+        }
+        zn_mutex_unlock(&cache_mutex);
+    }
+
+    deliver(waiters, error, &addresses);
+    free(job->hostname);
+    free(job);
+}
+
+int zn_resolve_async(const char *hostname, int port, zn_resolve_callback_t callback, void *data) {
+    if (!hostname || !callback) {
+        return EINVAL;
+    }
+
+    zn_address_list_t addresses;
+    uint32_t hash = hash_name(hostname);
+    if (parse_numeric(hostname, port, &addresses) || cache_get(hostname, hash, port, &addresses)) {
+        callback(0, &addresses, data);
+        return 0;
+    }
+
+    pthread_once(&pool_once, pool_start);
+    if (!pool) {
+        return EAGAIN;
+    }
+
+    resolver_waiter_t *waiter = (resolver_waiter_t *)calloc(1, sizeof(resolver_waiter_t));
+    resolver_job_t *job = (resolver_job_t *)calloc(1, sizeof(resolver_job_t));
+    char *name = strdup(hostname);
+    if (!waiter || !job || !name) {
+        free(waiter);
+        free(job);
+        free(name);
+        return ENOMEM;
+    }
+    waiter->callback = callback;
+    waiter->data = data;
+    waiter->port = port;
+    job->hostname = name;
+    job->hash = hash;
+
+    /* Join a lookup already in progress, or make this one the shared one */
+    zn_mutex_lock(&cache_mutex);
+    resolver_entry_t *entry = cache_find(hostname, hash);
+    if (entry && entry->pending) {
+        waiter->next = entry->waiters;
+        entry->waiters = waiter;
+        zn_mutex_unlock(&cache_mutex);
+        free(job->hostname);
+        free(job);
+        return 0;
+    }
+    if (!entry) {
+        entry = cache_insert(hostname, hash);
+    }
+    if (entry) {
+        entry->pending = true;
+        entry->waiters = waiter;
+        job->shared = true;
+    } else {
+        job->waiter = waiter;
+    }
+    zn_mutex_unlock(&cache_mutex);
+
+    if (zn_thread_pool_add_task(pool, resolve_job, job) != 0) {
+        if (job->shared) {
+            zn_mutex_lock(&cache_mutex);
+            entry = cache_find(hostname, hash);
+            resolver_waiter_t *waiters = entry->waiters;
+            entry->waiters = NULL;
+            entry->pending = false;
+            zn_mutex_unlock(&cache_mutex);
+            /* Callers that joined in the meantime were promised an answer */
+            while (waiters && waiters != waiter) {
+                resolver_waiter_t *next = waiters->next;
+                waiters->callback(EAGAIN, NULL, waiters->data);
+                free(waiters);
+                waiters = next;
+            }
+        }
+        free(waiter);
+        free(job->hostname);
+        free(job);
+        return EAGAIN;
+    }
+    return 0;
+}
+
+void zn_resolver_set_ttl(uint32_t ttl) {
+    pthread_once(&cache_once, cache_init);
+    zn_mutex_lock(&cache_mutex);
+    ttl_ms = ttl;
+    zn_mutex_unlock(&cache_mutex);
+}
+
+void zn_resolver_flush(void) {
+    pthread_once(&cache_once, cache_init);
+    zn_mutex_lock(&cache_mutex);
+    cache_purge(0, true);
+    zn_mutex_unlock(&cache_mutex);
+}
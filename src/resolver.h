@@ -0,0 +1,103 @@
+/**
+ * @file resolver.h
+ * @brief Host name resolution with a cache shared by all threads
+ *
+ * Lookups use getaddrinfo and accept IPv4 and IPv6 answers. Successful
+ * answers are cached for a fixed time (getaddrinfo does not report the
+ * record's own TTL), so repeated connections to the same host skip the
+ * resolver. Numeric addresses are parsed directly and never cached.
+ *
+ * zn_resolve blocks on a cache miss. zn_resolve_async runs the lookup on a
+ * small thread pool owned by the resolver, so event loop threads never
+ * wait for DNS; concurrent misses for the same host share one lookup.
+ * Errors are errno values: EHOSTUNREACH if the name does not resolve,
+ * EAGAIN for a temporary resolver failure.
+ */
+
+#ifndef ZENO_RESOLVER_H
+#define ZENO_RESOLVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+/** Most addresses kept per host name */
+#define ZN_RESOLVE_MAX_ADDRESSES 8
+
+/** Cache lifetime of an answer unless changed with zn_resolver_set_ttl */
+#define ZN_RESOLVE_DEFAULT_TTL_MS 30000
+
+/**
+ * One resolved address, with the requested port filled in
+ */
+typedef struct {
+    struct sockaddr_storage addr;  /**< sockaddr_in or sockaddr_in6 */
+    socklen_t length;              /**< Size of the address in addr */
+} zn_address_t;
+
+/**
+ * The addresses of a host, in getaddrinfo's order of preference
+ */
+typedef struct {
+    zn_address_t addresses[ZN_RESOLVE_MAX_ADDRESSES];
+    size_t count;
+} zn_address_list_t;
+
+/**
+ * Called when an asynchronous lookup finishes
+ *
+ * @param error 0 on success, otherwise an errno value
+ * @param addresses The addresses (only valid during the call), or NULL on error
+ * @param data User data
+ */
+typedef void (*zn_resolve_callback_t)(int error, const zn_address_list_t *addresses, void *data);
+
+/**
+ * Resolve a host name, blocking on a cache miss
+ *
+ * @param hostname Host name or numeric IPv4/IPv6 address
+ * @param port Port to store in the addresses
+ * @param out Where to store the addresses
+ * @return 0 on success, otherwise an errno value
+ */
+int zn_resolve(const char *hostname, int port, zn_address_list_t *out);
+
+/**
+ * Resolve a host name only if that needs no lookup: the name is numeric or
+ * has a live cache entry
+ *
+ * @param hostname Host name or numeric address
+ * @param port Port to store in the addresses
+ * @param out Where to store the addresses
+ * @return true if out was filled in
+ */
+bool zn_resolve_cached(const char *hostname, int port, zn_address_list_t *out);
+
+/**
+ * Resolve a host name without blocking. The callback runs on a resolver
+ * thread, or on the calling thread before this returns when the answer
+ * needs no lookup.
+ *
+ * @param hostname Host name or numeric address; copied
+ * @param port Port to store in the addresses
+ * @param callback Called exactly once with the result, unless this fails
+ * @param data User data for the callback
+ * @return 0 if the callback was or will be called, otherwise an errno value
+ */
+int zn_resolve_async(const char *hostname, int port, zn_resolve_callback_t callback, void *data);
+
+/**
+ * Set how long answers stay cached; 0 disables caching. Applies to answers
+ * cached from now on.
+ *
+ * @param ttl_ms Lifetime in milliseconds
+ */
+void zn_resolver_set_ttl(uint32_t ttl_ms);
+
+/**
+ * Drop all cached answers
+ */
+void zn_resolver_flush(void);
+
+#endif /* ZENO_RESOLVER_H */
@@ -0,0 +1,203 @@
+/**
+ * @file server.c
+ * @brief Implementation of the SO_REUSEPORT multi-listener server
+ */
+
+#include "server.h"
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+typedef struct {
+    zn_server_t *server;
+    socket_t listener;
+    bool listening;                /* Registered with the worker's reactor */
+    uint64_t accepted;
+} server_worker_t;
+
+struct zn_server {
+    zn_server_config_t config;
+    zn_server_connection_callback_t on_connection;
+    void *data;
+    zn_reactor_group_t *group;
+    server_worker_t *workers;
+    size_t size;
+    bool running;
+};
+
+void zn_server_config_init(zn_server_config_t *config, int port) {
+    if (!config) {
+        return;
+    }
+
+    memset(config, 0, sizeof(*config));
+    config->port = port;
+    config->workers = 0;
+    config->backlog = SOMAXCONN;
+    config->tcp_nodelay = true;
+    config->send_buffer = 0;
+    config->receive_buffer = 0;
+    config->backend = ZN_REACTOR_BACKEND_EPOLL;
+}
+
+static void on_accept(zn_reactor_t *reactor, socket_t *listener, socket_t *client, int error, void *data) {
+    (void)listener;
+    server_worker_t *worker = (server_worker_t *)data;
+    if (error != 0 || !client) {
+        return;
+    }
+
+    __atomic_add_fetch(&worker->accepted, 1, __ATOMIC_RELAXED);
+    worker->server->on_connection(reactor, client, worker->server->data);
+}
+
+/* Options that accepted connections inherit go on the listener, and the
+ * receive buffer has to be set before listen to size the window scale */
+static int open_listener(zn_server_t *server, server_worker_t *worker, int port) {
+    const zn_server_config_t *config = &server->config;
+    socket_t *listener = &worker->listener;
+
+    socket_result_t res = socket_create(listener, SOCKET_TCP);
+    if (!res.success) {
+        return res.error_code ? res.error_code : EIO;
+    }
+    if (!(res = socket_set_reuseport(listener, true)).success ||
+        (config->tcp_nodelay && !(res = socket_set_nodelay(listener, true)).success) ||
+        !(res = socket_set_buffer_sizes(listener, config->send_buffer, config->receive_buffer)).success ||
+        !(res = socket_bind(listener, port)).success ||
+        !(res = socket_listen(listener, config->backlog)).success) {
+        socket_close(listener);
+        return res.error_code ? res.error_code : EIO;
+    }
+    return 0;
+}
+
+/* The port the first listener actually got, for port 0 */
+static int bound_port(socket_t *listener) {
+    struct sockaddr_storage addr;
+    socklen_t length = sizeof(addr);
+    if (getsockname(listener->fd, (struct sockaddr *)&addr, &length) < 0) {
+        return -1;
+    }
+    if (addr.ss_family == AF_INET6) {
+        return ntohs(((struct sockaddr_in6 *)&addr)->sin6_port);
+    }
+    return ntohs(((struct sockaddr_in *)&addr)->sin_port);
+}
+
+zn_server_t *zn_server_create(const zn_server_config_t *config, zn_server_connection_callback_t on_connection,
+                              void *data) {
+    if (!config || !on_connection || config->port < 0 || config->port > 65535) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    zn_server_t *server = (zn_server_t *)calloc(1, sizeof(zn_server_t));
+    if (!server) {
+        return NULL;
+    }
+    server->config = *config;
+    server->on_connection = on_connection;
+    server->data = data;
+
+    server->group = zn_reactor_group_create_with_backend(config->workers, config->backend);
+    if (!server->group) {
+        free(server);
+        return NULL;
+    }
+    size_t count = zn_reactor_group_size(server->group);
+    server->workers = (server_worker_t *)calloc(count, sizeof(server_worker_t));
+    if (!server->workers) {
+        zn_server_destroy(server);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    int port = config->port;
+    for (size_t i = 0; i < count; i++) {
+        server_worker_t *worker = &server->workers[i];
+        worker->server = server;
+        int result = open_listener(server, worker, port);
+        if (result == 0) {
+            server->size++;
+            if (port == 0) {
+                port = bound_port(&worker->listener);
+                result = port > 0 ? 0 : errno;
+            }
+        }
+        if (result == 0) {
+            result = zn_reactor_accept(zn_reactor_group_get(server->group, i), &worker->listener, on_accept, worker);
+            worker->listening = result == 0;
+        }
+        if (result != 0) {
+            zn_server_destroy(server);
+            errno = result;
+            return NULL;
+        }
+    }
+    server->config.port = port;
+    return server;
+}
+
+int zn_server_start(zn_server_t *server) {
+    if (!server || server->running) {
+        return EINVAL;
+    }
+
+    int result = zn_reactor_group_start(server->group);
+    if (result == 0) {
+        server->running = true;
+    }
+    return result;
+}
+
+void zn_server_stop(zn_server_t *server) {
+    if (!server || !server->running) {
+        return;
+    }
+
+    zn_reactor_group_stop(server->group);
+    server->running = false;
+}
+
+void zn_server_destroy(zn_server_t *server) {
+    if (!server) {
+        return;
+    }
+
+    zn_server_stop(server);
+    for (size_t i = 0; i < server->size; i++) {
+        server_worker_t *worker = &server->workers[i];
+        if (worker->listening) {
+            zn_reactor_remove(zn_reactor_group_get(server->group, i), &worker->listener);
+        }
+        socket_close(&worker->listener);
+    }
+    zn_reactor_group_destroy(server->group);
+    free(server->workers);
+    free(server);
+}
+
+int zn_server_port(zn_server_t *server) {
+    return server ? server->config.port : -1;
+}
+
+size_t zn_server_workers(zn_server_t *server) {
+    return server ? server->size : 0;
+}
+
+zn_reactor_t *zn_server_reactor(zn_server_t *server, size_t index) {
+    if (!server || index >= server->size) {
+        return NULL;
+    }
+    return zn_reactor_group_get(server->group, index);
+}
+
+uint64_t zn_server_accepted(zn_server_t *server, size_t index) {
+    if (!server || index >= server->size) {
+        return 0;
+    }
+    return __atomic_load_n(&server->workers[index].accepted, __ATOMIC_RELAXED);
+}
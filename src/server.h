@@ -0,0 +1,134 @@
+/**
+ * @file server.h
+ * @brief TCP server with one SO_REUSEPORT listener per worker reactor
+ *
+ * Every worker is a reactor thread with its own listening socket on the
+ * shared port. The kernel spreads incoming connections across the
+ * listeners, so there is no single accept queue or accepting thread to
+ * contend on, and each connection is handled by the worker that accepted
+ * it. Listeners drain their backlog with accept4(SOCK_NONBLOCK |
+ * SOCK_CLOEXEC) until EAGAIN on epoll, or with a multishot accept on
+ * io_uring (see zn_reactor_accept).
+ *
+ * TCP_NODELAY and the buffer sizes are set on the listeners, which
+ * accepted connections inherit, so they cost no system calls per
+ * connection.
+ */
+
+#ifndef ZENO_SERVER_H
+#define ZENO_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "reactor.h"
+#include "socket.h"
+
+/**
+ * Server settings; start from zn_server_config_init
+ */
+typedef struct {
+    int port;                      /**< Port to listen on; 0 picks a free one */
+    size_t workers;                /**< Worker reactors and listeners, 0 for one per core */
+    int backlog;                   /**< Listen backlog of each listener */
+    bool tcp_nodelay;              /**< Disable Nagle's algorithm on connections */
+    int send_buffer;               /**< SO_SNDBUF of connections, 0 for the system default */
+    int receive_buffer;            /**< SO_RCVBUF of connections, 0 for the system default */
+    zn_reactor_backend_t backend;  /**< Preferred reactor backend */
+} zn_server_config_t;
+
+/**
+ * Opaque server handle
+ */
+typedef struct zn_server zn_server_t;
+
+/**
+ * Called on the accepting worker's thread for each new connection
+ *
+ * @param reactor The worker's reactor; register the connection here
+ * @param client New non-blocking connection. The structure is only valid
+ *               during the call; copy it to keep the connection.
+ * @param data User data given to zn_server_create
+ */
+typedef void (*zn_server_connection_callback_t)(zn_reactor_t *reactor, socket_t *client, void *data);
+
+/**
+ * Fill in the defaults: one worker per core, backlog SOMAXCONN, TCP_NODELAY
+ * on, system buffer sizes, epoll backend
+ *
+ * @param config Settings to initialize
+ * @param port Port to listen on
+ */
+void zn_server_config_init(zn_server_config_t *config, int port);
+
+/**
+ * Create the workers and bind their listeners. Nothing is accepted until
+ * zn_server_start.
+ *
+ * @param config Settings; copied
+ * @param on_connection Called for each accepted connection
+ * @param data User data passed to the callback
+ * @return New server, or NULL on failure (errno is set)
+ */
+zn_server_t *zn_server_create(const zn_server_config_t *config, zn_server_connection_callback_t on_connection,
+                              void *data);
+
+/**
+ * Start the worker threads
+ *
+ * @param server Server to start
+ * @return 0 on success, error code otherwise
+ */
+int zn_server_start(zn_server_t *server);
+
+/**
+ * Stop the worker threads; connections still queued on the listeners stay
+ * there until the server is started again or destroyed
+ *
+ * @param server Server to stop
+ */
+void zn_server_stop(zn_server_t *server);
+
+/**
+ * Stop the server and close its listeners. Connections handed to the
+ * callback are not closed; remove them from their reactors first.
+ *
+ * @param server Server to destroy
+ */
+void zn_server_destroy(zn_server_t *server);
+
+/**
+ * Port the server listens on, e.g. after asking for port 0
+ *
+ * @param server Server to query
+ * @return Port number
+ */
+int zn_server_port(zn_server_t *server);
+
+/**
+ * Number of workers
+ *
+ * @param server Server to query
+ * @return Worker count
+ */
+size_t zn_server_workers(zn_server_t *server);
+
+/**
+ * Reactor of one worker, e.g. to post work to it
+ *
+ * @param server Server to query
+ * @param index Worker index, less than zn_server_workers
+ * @return The worker's reactor
+ */
+zn_reactor_t *zn_server_reactor(zn_server_t *server, size_t index);
+
+/**
+ * Connections accepted by one worker so far
+ *
+ * @param server Server to query
+ * @param index Worker index, less than zn_server_workers
+ * @return Accepted connection count
+ */
+uint64_t zn_server_accepted(zn_server_t *server, size_t index);
+
+#endif /* ZENO_SERVER_H */
@@ -3,14 +3,37 @@
  * @brief Implementation of simple wrapper for C socket API
  */
 
+#define _GNU_SOURCE
 #include "socket.h"
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <netdb.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <signal.h>
 #include <string.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include "error_reporter.h"
+#include "resolver.h"
+
+/* iovecs passed to the kernel per sendmsg call (IOV_MAX is 1024 on Linux) */
+#define SOCKET_IOV_BATCH 64
+
+/* Datagrams passed to the kernel per sendmmsg/recvmmsg call */
+#define SOCKET_MMSG_BATCH 64
+
+/* The kernel refuses GSO sends of more segments than this (UDP_MAX_SEGMENTS) */
+#define SOCKET_GSO_MAX_SEGMENTS 64
+
+/* Largest IPv4 UDP payload, which also bounds a GSO send */
+#define SOCKET_GSO_MAX_PAYLOAD 65507
+
+/* Pipe size requested for socket_splice; the 64KB default stays if the
+ * system limit (/proc/sys/fs/pipe-max-size) is lower */
+#define SOCKET_SPLICE_PIPE_SIZE (1024 * 1024)
 
 /**
  * Create a success result
@@ -23,6 +46,18 @@ static socket_result_t socket_success(void) {
     };
 }
 
+/**
+ * Create a result for a non-blocking call that would block. This is part of
+ * normal operation, so it is not logged.
+ */
+static socket_result_t socket_would_block(void) {
+    return (socket_result_t){
+        .success = false,
+        .error_msg = "Operation would block",
+        .error_code = EAGAIN
+    };
+}
+
 /**
  * Create an error result
  */
@@ -52,6 +87,7 @@ socket_result_t socket_create(socket_t *sock, socket_type_t type) {
     memset(sock, 0, sizeof(socket_t));
     sock->fd = fd;
     sock->type = type;
+    sock->family = AF_INET;
     sock->is_server = false;
     sock->is_connected = false;
     sock->is_nonblocking = false;
@@ -90,22 +126,80 @@ socket_result_t socket_set_nonblocking(socket_t *sock, bool nonblocking) {
     return socket_success();
 }
 
+socket_result_t socket_set_reuseport(socket_t *sock, bool enable) {
+    if (!sock || sock->fd < 0) {
+        return socket_error("Invalid socket");
+    }
+
+    int option = enable ? 1 : 0;
+    if (setsockopt(sock->fd, SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option)) < 0) {
+        return socket_error("Failed to set SO_REUSEPORT");
+    }
+    return socket_success();
+}
+
+socket_result_t socket_set_nodelay(socket_t *sock, bool enable) {
+    if (!sock || sock->fd < 0) {
+        return socket_error("Invalid socket");
+    }
+
+    int option = enable ? 1 : 0;
+    if (setsockopt(sock->fd, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option)) < 0) {
+        return socket_error("Failed to set TCP_NODELAY");
+    }
+    return socket_success();
+}
+
+socket_result_t socket_set_buffer_sizes(socket_t *sock, int send_bytes, int receive_bytes) {
+    if (!sock || sock->fd < 0 || send_bytes < 0 || receive_bytes < 0) {
+        return socket_error("Invalid socket or buffer size");
+    }
+
+    if (send_bytes > 0 && setsockopt(sock->fd, SOL_SOCKET, SO_SNDBUF, &send_bytes, sizeof(send_bytes)) < 0) {
+        return socket_error("Failed to set SO_SNDBUF");
+    }
+    if (receive_bytes > 0 &&
+        setsockopt(sock->fd, SOL_SOCKET, SO_RCVBUF, &receive_bytes, sizeof(receive_bytes)) < 0) {
+        return socket_error("Failed to set SO_RCVBUF");
+    }
+    return socket_success();
+}
+
 socket_result_t socket_bind(socket_t *sock, int port) {
     if (!sock || sock->fd < 0) {
         return socket_error("Invalid socket");
     }
 
-    struct sockaddr_in addr;
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
     memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    addr.sin_port = htons(port);
+    if (socket_set_family(sock, AF_INET6).success) {
+        // Dual-stack: IPv4 peers arrive as v4-mapped IPv6 addresses
+        int off = 0;
+        if (setsockopt(sock->fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) < 0) {
+            return socket_error("Failed to clear IPV6_V6ONLY");
+        }
+        struct sockaddr_in6 *v6 = (struct sockaddr_in6 *)&addr;
+        v6->sin6_family = AF_INET6;
+        v6->sin6_addr = in6addr_any;
+        v6->sin6_port = htons(port);
+        addr_len = sizeof(*v6);
+    } else if (errno == EAFNOSUPPORT) {
+        struct sockaddr_in *v4 = (struct sockaddr_in *)&addr;
+        v4->sin_family = AF_INET;
+        v4->sin_addr.s_addr = htonl(INADDR_ANY);
+        v4->sin_port = htons(port);
+        addr_len = sizeof(*v4);
+    } else {
+        return socket_error("Failed to switch socket to IPv6");
+    }
 
-    if (bind(sock->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    if (bind(sock->fd, (struct sockaddr *)&addr, addr_len) < 0) {
         return socket_error("Failed to bind socket");
     }
 
     sock->addr = addr;
+    sock->addr_len = addr_len;
     sock->is_server = true;
     return socket_success();
 }
@@ -135,13 +229,16 @@ socket_result_t socket_accept(socket_t *server_sock, socket_t *client_sock) {
         return socket_error("Not a server socket");
     }
 
-    struct sockaddr_in client_addr;
+    struct sockaddr_storage client_addr;
     socklen_t addr_len = sizeof(client_addr);
     
-    int client_fd = accept(server_sock->fd, (struct sockaddr *)&client_addr, &addr_len);
+    // Connections accepted from a non-blocking listener start out non-blocking,
+    // which saves the two fcntl calls per connection an event loop would make
+    int flags = server_sock->is_nonblocking ? SOCK_NONBLOCK : 0;
+    int client_fd = accept4(server_sock->fd, (struct sockaddr *)&client_addr, &addr_len, flags | SOCK_CLOEXEC);
     if (client_fd < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return socket_error("No pending connections");
+            return socket_would_block();
         }
         return socket_error("Failed to accept connection");
     }
@@ -150,48 +247,167 @@ socket_result_t socket_accept(socket_t *server_sock, socket_t *client_sock) {
     memset(client_sock, 0, sizeof(socket_t));
     client_sock->fd = client_fd;
     client_sock->type = server_sock->type;
+    client_sock->family = server_sock->family;
     client_sock->addr = client_addr;
+    client_sock->addr_len = addr_len;
     client_sock->is_server = false;
     client_sock->is_connected = true;
-    client_sock->is_nonblocking = false;
+    client_sock->is_nonblocking = server_sock->is_nonblocking;
 
     return socket_success();
 }
 
-socket_result_t socket_connect(socket_t *sock, const char *hostname, int port) {
-    if (!sock || sock->fd < 0 || !hostname) {
-        return socket_error("Invalid socket or hostname");
+/* Options socket_set_family carries over to the recreated socket. Those the
+ * socket type does not support fail getsockopt and are skipped. */
+static const struct {
+    int level;
+    int name;
+} socket_family_options[] = {
+    { SOL_SOCKET, SO_REUSEADDR },
+    { SOL_SOCKET, SO_REUSEPORT },
+    { SOL_SOCKET, SO_KEEPALIVE },
+    { SOL_SOCKET, SO_LINGER },
+    { SOL_SOCKET, SO_SNDBUF },
+    { SOL_SOCKET, SO_RCVBUF },
+    { IPPROTO_TCP, TCP_NODELAY },
+    { SOL_UDP, UDP_GRO },
+};
+
+/**
+ * Give `to` the values of socket_family_options that `from` has. Only
+ * options that differ are set, so buffer sizes nobody chose stay
+ * autotuned.
+ */
+static socket_result_t socket_copy_options(int from, int to) {
+    for (size_t i = 0; i < sizeof(socket_family_options) / sizeof(socket_family_options[0]); i++) {
+        int level = socket_family_options[i].level;
+        int name = socket_family_options[i].name;
+        union {
+            int value;
+            struct linger linger;
+        } old_value, new_value;
+        socklen_t old_len = sizeof(old_value);
+        socklen_t new_len = sizeof(new_value);
+        memset(&old_value, 0, sizeof(old_value));
+        memset(&new_value, 0, sizeof(new_value));
+        if (getsockopt(from, level, name, &old_value, &old_len) < 0 ||
+            getsockopt(to, level, name, &new_value, &new_len) < 0) {
+            continue;
+        }
+        if (old_len == new_len && memcmp(&old_value, &new_value, old_len) == 0) {
+            continue;
+        }
+
+        // The kernel reports twice the buffer size that was set
+        if (level == SOL_SOCKET && (name == SO_SNDBUF || name == SO_RCVBUF)) {
+            old_value.value /= 2;
+        }
+        if (setsockopt(to, level, name, &old_value, old_len) < 0) {
+            return socket_error("Failed to copy socket options");
+        }
+    }
+    return socket_success();
+}
+
+socket_result_t socket_set_family(socket_t *sock, int family) {
+    if (!sock || sock->fd < 0 || (family != AF_INET && family != AF_INET6)) {
+        return socket_error("Invalid socket or address family");
+    }
+    if (sock->family == family) {
+        return socket_success();
+    }
+    if (sock->is_server || sock->is_connected) {
+        errno = EISCONN;
+        return socket_error("Cannot change the address family of a socket in use");
+    }
+
+    int fd_flags = fcntl(sock->fd, F_GETFD);
+    if (fd_flags < 0) {
+        return socket_error("Failed to get descriptor flags");
+    }
+
+    int sock_type = (sock->type == SOCKET_TCP) ? SOCK_STREAM : SOCK_DGRAM;
+    int protocol = (sock->type == SOCKET_TCP) ? IPPROTO_TCP : IPPROTO_UDP;
+    int fd = socket(family, sock_type | SOCK_CLOEXEC | (sock->is_nonblocking ? SOCK_NONBLOCK : 0), protocol);
+    if (fd < 0) {
+        return socket_error("Failed to create socket");
+    }
+
+    socket_result_t res = socket_copy_options(sock->fd, fd);
+    if (!res.success) {
+        close(fd);
+        return res;
+    }
+
+    // Keep the descriptor number so callers holding it are not affected;
+    // dup2 would clear close-on-exec, so dup3 carries it over
+    if (dup3(fd, sock->fd, (fd_flags & FD_CLOEXEC) ? O_CLOEXEC : 0) < 0) {
+        close(fd);
+        return socket_error("Failed to replace socket");
+    }
+    close(fd);
+    sock->family = family;
+    return socket_success();
+}
+
+socket_result_t socket_connect_address(socket_t *sock, const struct sockaddr *addr, socklen_t addr_len) {
+    if (!sock || sock->fd < 0 || !addr || addr_len > sizeof(struct sockaddr_storage)) {
+        return socket_error("Invalid socket or address");
     }
 
     if (sock->is_server) {
         return socket_error("Cannot connect with a server socket");
     }
 
-    struct hostent *host = gethostbyname(hostname);
-    if (!host) {
-        return socket_error("Failed to resolve hostname");
+    socket_result_t res = socket_set_family(sock, addr->sa_family);
+    if (!res.success) {
+        return res;
     }
 
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-    addr.sin_addr = *((struct in_addr *)host->h_addr);
-
-    if (connect(sock->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    memcpy(&sock->addr, addr, addr_len);
+    sock->addr_len = addr_len;
+    if (connect(sock->fd, addr, addr_len) < 0) {
         if (sock->is_nonblocking && (errno == EINPROGRESS || errno == EAGAIN || errno == EWOULDBLOCK)) {
             // This is expected for non-blocking sockets and not an error
-            sock->addr = addr;
             return socket_success();
         }
         return socket_error("Failed to connect to server");
     }
 
-    sock->addr = addr;
     sock->is_connected = true;
     return socket_success();
 }
 
+socket_result_t socket_connect(socket_t *sock, const char *hostname, int port) {
+    if (!sock || sock->fd < 0 || !hostname) {
+        return socket_error("Invalid socket or hostname");
+    }
+
+    if (sock->is_server) {
+        return socket_error("Cannot connect with a server socket");
+    }
+
+    zn_address_list_t resolved;
+    int error = zn_resolve(hostname, port, &resolved);
+    if (error != 0) {
+        errno = error;
+        return socket_error("Failed to resolve hostname");
+    }
+
+    // A non-blocking connect only learns the outcome later, so it uses the
+    // preferred address; a blocking one falls back to the others
+    socket_result_t res = socket_success();
+    size_t attempts = sock->is_nonblocking ? 1 : resolved.count;
+    for (size_t i = 0; i < attempts; i++) {
+        const zn_address_t *address = &resolved.addresses[i];
+        res = socket_connect_address(sock, (const struct sockaddr *)&address->addr, address->length);
+        if (res.success) {
+            break;
+        }
+    }
+    return res;
+}
+
 socket_result_t socket_send(socket_t *sock, const void *data, size_t size, size_t *bytes_sent) {
     if (!sock || sock->fd < 0 || !data) {
         return socket_error("Invalid socket or data");
@@ -201,7 +417,8 @@ socket_result_t socket_send(socket_t *sock, const void *data, size_t size, size_
         return socket_error("Socket is not connected");
     }
 
-    ssize_t sent = send(sock->fd, data, size, 0);
+    // A peer that went away is reported as an error rather than SIGPIPE
+    ssize_t sent = send(sock->fd, data, size, MSG_NOSIGNAL);
     if (sent < 0) {
         if (sock->is_nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
             if (bytes_sent) {
@@ -238,12 +455,577 @@ socket_result_t socket_receive(socket_t *sock, void *buffer, size_t size, size_t
         return socket_error("Failed to receive data");
     }
 
+    if (received == 0 && size > 0 && sock->type == SOCKET_TCP) {
+        // Orderly shutdown by the peer
+        sock->is_connected = false;
+    }
+
+    if (bytes_received) {
+        *bytes_received = (size_t)received;
+    }
+    return socket_success();
+}
+
+socket_result_t socket_sendv(socket_t *sock, const struct iovec *iov, int iovcnt, size_t *bytes_sent) {
+    if (bytes_sent) {
+        *bytes_sent = 0;
+    }
+    if (!sock || sock->fd < 0 || (!iov && iovcnt > 0) || iovcnt < 0) {
+        return socket_error("Invalid socket or buffers");
+    }
+
+    if (!sock->is_connected && sock->type == SOCKET_TCP) {
+        return socket_error("Socket is not connected");
+    }
+
+    if (sock->type != SOCKET_TCP && iovcnt > SOCKET_IOV_BATCH) {
+        errno = EMSGSIZE;
+        return socket_error("Too many buffers for one datagram");
+    }
+
+    // The caller's array is const, so partial writes are resumed through a
+    // window whose first entry is adjusted to the current offset
+    struct iovec window[SOCKET_IOV_BATCH];
+    int index = 0;
+    size_t offset = 0;
+    size_t total = 0;
+
+    while (index < iovcnt) {
+        int count = 0;
+        for (int i = index; i < iovcnt && count < SOCKET_IOV_BATCH; i++) {
+            window[count] = iov[i];
+            if (i == index) {
+                window[count].iov_base = (char *)iov[i].iov_base + offset;
+                window[count].iov_len -= offset;
+            }
+            count++;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = window;
+        msg.msg_iovlen = (size_t)count;
+
+        ssize_t sent = sendmsg(sock->fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (sock->is_nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (bytes_sent) {
+                *bytes_sent = total;
+            }
+            return socket_error("Failed to send data");
+        }
+        total += (size_t)sent;
+        if (sock->type != SOCKET_TCP) {
+            // A datagram is sent whole by a single call
+            break;
+        }
+
+        // Advance past whatever the kernel took
+        size_t remaining = (size_t)sent;
+        while (index < iovcnt && remaining >= iov[index].iov_len - offset) {
+            remaining -= iov[index].iov_len - offset;
+            offset = 0;
+            index++;
+        }
+        offset += remaining;
+    }
+
+    if (bytes_sent) {
+        *bytes_sent = total;
+    }
+    return socket_success();
+}
+
+socket_result_t socket_receivev(socket_t *sock, const struct iovec *iov, int iovcnt, size_t *bytes_received) {
+    if (!sock || sock->fd < 0 || !iov || iovcnt <= 0) {
+        return socket_error("Invalid socket or buffers");
+    }
+
+    if (!sock->is_connected && sock->type == SOCKET_TCP) {
+        return socket_error("Socket is not connected");
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = (struct iovec *)iov;
+    msg.msg_iovlen = (size_t)iovcnt;
+
+    ssize_t received = recvmsg(sock->fd, &msg, 0);
+    if (received < 0) {
+        if (sock->is_nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (bytes_received) {
+                *bytes_received = 0;
+            }
+            return socket_success();
+        }
+        return socket_error("Failed to receive data");
+    }
+
+    size_t capacity = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        capacity += iov[i].iov_len;
+    }
+    if (received == 0 && capacity > 0 && sock->type == SOCKET_TCP) {
+        // Orderly shutdown by the peer
+        sock->is_connected = false;
+    }
+
     if (bytes_received) {
         *bytes_received = (size_t)received;
     }
     return socket_success();
 }
 
+void socket_iov_advance(struct iovec **iov, int *iovcnt, size_t bytes) {
+    while (*iovcnt > 0 && bytes >= (*iov)->iov_len) {
+        bytes -= (*iov)->iov_len;
+        (*iov)++;
+        (*iovcnt)--;
+    }
+    if (*iovcnt > 0 && bytes > 0) {
+        (*iov)->iov_base = (char *)(*iov)->iov_base + bytes;
+        (*iov)->iov_len -= bytes;
+    }
+}
+
+/**
+ * Prepare a datagram destination for sock and store the address to send to
+ * in name and name_len. An IPv6 destination switches an IPv4 socket to
+ * AF_INET6 (see socket_set_family); an IPv4 destination on an AF_INET6
+ * socket is sent to its v4-mapped address, which is built in mapped.
+ */
+static socket_result_t socket_datagram_name(socket_t *sock, const struct sockaddr *addr, socklen_t addr_len,
+                                            struct sockaddr_in6 *mapped, const struct sockaddr **name,
+                                            socklen_t *name_len) {
+    if (addr->sa_family == AF_INET6 && sock->family != AF_INET6) {
+        socket_result_t res = socket_set_family(sock, AF_INET6);
+        if (!res.success) {
+            return res;
+        }
+    }
+    if (addr->sa_family != AF_INET || sock->family != AF_INET6) {
+        *name = addr;
+        *name_len = addr_len;
+        return socket_success();
+    }
+
+    const struct sockaddr_in *v4 = (const struct sockaddr_in *)addr;
+    memset(mapped, 0, sizeof(*mapped));
+    mapped->sin6_family = AF_INET6;
+    mapped->sin6_port = v4->sin_port;
+    mapped->sin6_addr.s6_addr[10] = 0xff;
+    mapped->sin6_addr.s6_addr[11] = 0xff;
+    memcpy(&mapped->sin6_addr.s6_addr[12], &v4->sin_addr, sizeof(v4->sin_addr));
+    *name = (const struct sockaddr *)mapped;
+    *name_len = sizeof(*mapped);
+    return socket_success();
+}
+
+socket_result_t socket_send_batch(socket_t *sock, const socket_datagram_t *datagrams, size_t count, size_t *sent) {
+    if (sent) {
+        *sent = 0;
+    }
+    if (!sock || sock->fd < 0 || (!datagrams && count > 0)) {
+        return socket_error("Invalid socket or datagrams");
+    }
+
+    struct mmsghdr messages[SOCKET_MMSG_BATCH];
+    struct iovec iov[SOCKET_MMSG_BATCH];
+    struct sockaddr_in6 mapped[SOCKET_MMSG_BATCH];
+    size_t done = 0;
+
+    while (done < count) {
+        size_t batch = count - done < SOCKET_MMSG_BATCH ? count - done : SOCKET_MMSG_BATCH;
+        memset(messages, 0, batch * sizeof(struct mmsghdr));
+        for (size_t i = 0; i < batch; i++) {
+            const socket_datagram_t *datagram = &datagrams[done + i];
+            iov[i].iov_base = datagram->data;
+            iov[i].iov_len = datagram->length;
+            messages[i].msg_hdr.msg_iov = &iov[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            if (datagram->addr.ss_family != 0) {
+                const struct sockaddr *name;
+                socket_result_t res =
+                    socket_datagram_name(sock, (const struct sockaddr *)&datagram->addr, datagram->addr_len,
+                                         &mapped[i], &name, &messages[i].msg_hdr.msg_namelen);
+                if (!res.success) {
+                    if (sent) {
+                        *sent = done;
+                    }
+                    return res;
+                }
+                messages[i].msg_hdr.msg_name = (void *)name;
+            }
+        }
+
+        int result = sendmmsg(sock->fd, messages, (unsigned int)batch, MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (sock->is_nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (sent) {
+                *sent = done;
+            }
+            return socket_error("Failed to send datagrams");
+        }
+        done += (size_t)result;
+        // A short count means the next datagram hit an error, which the
+        // next call reports
+    }
+
+    if (sent) {
+        *sent = done;
+    }
+    return socket_success();
+}
+
+/* Segment size of a GRO-coalesced receive, 0 if there is none */
+static uint16_t gro_segment_size(struct msghdr *msg) {
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int size;
+            memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+            return (uint16_t)size;
+        }
+    }
+    return 0;
+}
+
+socket_result_t socket_receive_batch(socket_t *sock, socket_datagram_t *datagrams, size_t count, size_t *received) {
+    if (received) {
+        *received = 0;
+    }
+    if (!sock || sock->fd < 0 || (!datagrams && count > 0)) {
+        return socket_error("Invalid socket or datagrams");
+    }
+
+    struct mmsghdr messages[SOCKET_MMSG_BATCH];
+    struct iovec iov[SOCKET_MMSG_BATCH];
+    union {
+        char buffer[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control[SOCKET_MMSG_BATCH];
+    size_t done = 0;
+
+    while (done < count) {
+        size_t batch = count - done < SOCKET_MMSG_BATCH ? count - done : SOCKET_MMSG_BATCH;
+        memset(messages, 0, batch * sizeof(struct mmsghdr));
+        for (size_t i = 0; i < batch; i++) {
+            socket_datagram_t *datagram = &datagrams[done + i];
+            iov[i].iov_base = datagram->data;
+            iov[i].iov_len = datagram->capacity;
+            messages[i].msg_hdr.msg_iov = &iov[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &datagram->addr;
+            messages[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+            messages[i].msg_hdr.msg_control = control[i].buffer;
+            messages[i].msg_hdr.msg_controllen = sizeof(control[i].buffer);
+        }
+
+        // Only the first call may block, and only until one datagram is
+        // there; later batches take whatever is already queued
+        int flags = done > 0 ? MSG_DONTWAIT : MSG_WAITFORONE;
+        int result = recvmmsg(sock->fd, messages, (unsigned int)batch, flags, NULL);
+        if (result < 0) {
+            if (errno == EINTR && done == 0) {
+                continue;
+            }
+            if (done > 0 || (sock->is_nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+                break;
+            }
+            return socket_error("Failed to receive datagrams");
+        }
+
+        for (int i = 0; i < result; i++) {
+            socket_datagram_t *datagram = &datagrams[done + (size_t)i];
+            datagram->length = messages[i].msg_len;
+            datagram->addr_len = messages[i].msg_hdr.msg_namelen;
+            datagram->segment_size = gro_segment_size(&messages[i].msg_hdr);
+        }
+        done += (size_t)result;
+        if ((size_t)result < batch) {
+            break;
+        }
+    }
+
+    if (received) {
+        *received = done;
+    }
+    return socket_success();
+}
+
+socket_result_t socket_send_segmented(socket_t *sock, const void *data, size_t length, uint16_t segment_size,
+                                      const struct sockaddr *addr, socklen_t addr_len, size_t *bytes_sent) {
+    if (bytes_sent) {
+        *bytes_sent = 0;
+    }
+    if (!sock || sock->fd < 0 || (!data && length > 0) || segment_size == 0 ||
+        (addr && addr_len > sizeof(struct sockaddr_storage))) {
+        return socket_error("Invalid socket, data or segment size");
+    }
+
+    struct sockaddr_in6 mapped;
+    const struct sockaddr *name = NULL;
+    socklen_t name_len = 0;
+    if (addr) {
+        socket_result_t res = socket_datagram_name(sock, addr, addr_len, &mapped, &name, &name_len);
+        if (!res.success) {
+            return res;
+        }
+    }
+
+    union {
+        char buffer[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+    } control;
+    size_t done = 0;
+
+    while (done < length) {
+        size_t chunk = length - done;
+        // Bounded by the segment count and by the 16-bit UDP length of the
+        // unsegmented packet
+        size_t segments = SOCKET_GSO_MAX_PAYLOAD / segment_size;
+        if (segments > SOCKET_GSO_MAX_SEGMENTS) {
+            segments = SOCKET_GSO_MAX_SEGMENTS;
+        }
+        size_t max_chunk = segments > 0 ? segments * segment_size : segment_size;
+        if (chunk > max_chunk) {
+            chunk = max_chunk;
+        }
+
+        struct iovec iov = { (char *)data + done, chunk };
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_name = (void *)name;
+        msg.msg_namelen = name_len;
+
+        // A single datagram needs no segmentation
+        if (chunk > segment_size) {
+            memset(&control, 0, sizeof(control));
+            msg.msg_control = control.buffer;
+            msg.msg_controllen = sizeof(control.buffer);
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+        }
+
+        ssize_t sent = sendmsg(sock->fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (sock->is_nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (bytes_sent) {
+                *bytes_sent = done;
+            }
+            return socket_error("Failed to send segmented datagrams");
+        }
+        done += (size_t)sent;
+    }
+
+    if (bytes_sent) {
+        *bytes_sent = done;
+    }
+    return socket_success();
+}
+
+socket_result_t socket_set_gro(socket_t *sock, bool enable) {
+    if (!sock || sock->fd < 0) {
+        return socket_error("Invalid socket");
+    }
+
+    int option = enable ? 1 : 0;
+    if (setsockopt(sock->fd, SOL_UDP, UDP_GRO, &option, sizeof(option)) < 0) {
+        return socket_error("Failed to set UDP_GRO");
+    }
+    return socket_success();
+}
+
+/**
+ * sendfile and splice have no MSG_NOSIGNAL, so SIGPIPE is blocked around
+ * them and one they raise is discarded; a peer that went away is then
+ * reported as EPIPE, as it is by socket_send.
+ */
+static bool sigpipe_block(sigset_t *old_mask) {
+    sigset_t pending;
+    sigpending(&pending);
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &mask, old_mask);
+    return sigismember(&pending, SIGPIPE) == 1;
+}
+
+static void sigpipe_restore(const sigset_t *old_mask, bool was_pending, bool raised) {
+    int saved_errno = errno;
+    if (raised && !was_pending) {
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGPIPE);
+        struct timespec no_wait = { 0, 0 };
+        sigtimedwait(&mask, NULL, &no_wait);
+    }
+    pthread_sigmask(SIG_SETMASK, old_mask, NULL);
+    errno = saved_errno;
+}
+
+socket_result_t socket_sendfile(socket_t *sock, int fd, off_t *offset, size_t length, size_t *bytes_sent) {
+    if (bytes_sent) {
+        *bytes_sent = 0;
+    }
+    if (!sock || sock->fd < 0 || fd < 0 || !offset) {
+        return socket_error("Invalid socket, file or offset");
+    }
+
+    if (!sock->is_connected && sock->type == SOCKET_TCP) {
+        return socket_error("Socket is not connected");
+    }
+
+    sigset_t old_mask;
+    bool was_pending = sigpipe_block(&old_mask);
+    const char *failure = NULL;
+    size_t total = 0;
+
+    // The kernel moves at most about 2GB per call and advances *offset itself
+    while (total < length) {
+        ssize_t sent = sendfile(sock->fd, fd, offset, length - total);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (!(sock->is_nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+                failure = "Failed to send file";
+            }
+            break;
+        }
+        if (sent == 0) {
+            // End of file
+            break;
+        }
+        total += (size_t)sent;
+    }
+
+    sigpipe_restore(&old_mask, was_pending, failure && errno == EPIPE);
+    if (bytes_sent) {
+        *bytes_sent = total;
+    }
+    return failure ? socket_error(failure) : socket_success();
+}
+
+socket_result_t socket_splice_init(socket_splice_t *splice) {
+    if (!splice) {
+        return socket_error("Invalid splice");
+    }
+
+    splice->buffered = 0;
+    if (pipe2(splice->pipe_fds, O_CLOEXEC) < 0) {
+        splice->pipe_fds[0] = splice->pipe_fds[1] = -1;
+        return socket_error("Failed to create pipe");
+    }
+
+    // A bigger pipe moves more per call; keep the default if it is refused
+    int size = fcntl(splice->pipe_fds[1], F_SETPIPE_SZ, SOCKET_SPLICE_PIPE_SIZE);
+    if (size < 0) {
+        size = fcntl(splice->pipe_fds[1], F_GETPIPE_SZ);
+    }
+    splice->capacity = size > 0 ? (size_t)size : 65536;
+    return socket_success();
+}
+
+void socket_splice_close(socket_splice_t *splice) {
+    if (!splice) {
+        return;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (splice->pipe_fds[i] >= 0) {
+            close(splice->pipe_fds[i]);
+            splice->pipe_fds[i] = -1;
+        }
+    }
+    splice->buffered = 0;
+}
+
+socket_result_t socket_splice(socket_t *from, socket_t *to, socket_splice_t *state, size_t length,
+                              size_t *bytes_moved) {
+    if (bytes_moved) {
+        *bytes_moved = 0;
+    }
+    if (!from || from->fd < 0 || !to || to->fd < 0 || !state || state->pipe_fds[0] < 0) {
+        return socket_error("Invalid socket or splice");
+    }
+
+    if ((!from->is_connected && from->type == SOCKET_TCP && state->buffered == 0) ||
+        (!to->is_connected && to->type == SOCKET_TCP)) {
+        return socket_error("Socket is not connected");
+    }
+
+    sigset_t old_mask;
+    bool was_pending = sigpipe_block(&old_mask);
+    const char *failure = NULL;
+    size_t total = 0;
+
+    // The pipe is only refilled once it is empty, so neither end of it
+    // ever blocks; only the sockets can
+    for (;;) {
+        if (state->buffered > 0) {
+            ssize_t written = splice(state->pipe_fds[0], NULL, to->fd, NULL, state->buffered, SPLICE_F_MOVE);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (!(to->is_nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+                    failure = "Failed to splice to socket";
+                }
+                break;
+            }
+            state->buffered -= (size_t)written;
+            total += (size_t)written;
+            continue;
+        }
+
+        if (total >= length || (from->type == SOCKET_TCP && !from->is_connected)) {
+            break;
+        }
+        size_t wanted = length - total < state->capacity ? length - total : state->capacity;
+        ssize_t filled = splice(from->fd, NULL, state->pipe_fds[1], NULL, wanted, SPLICE_F_MOVE);
+        if (filled < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (!(from->is_nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+                failure = "Failed to splice from socket";
+            }
+            break;
+        }
+        if (filled == 0) {
+            // Orderly shutdown by the peer
+            from->is_connected = false;
+            break;
+        }
+        state->buffered += (size_t)filled;
+    }
+
+    sigpipe_restore(&old_mask, was_pending, failure && errno == EPIPE);
+    if (bytes_moved) {
+        *bytes_moved = total;
+    }
+    return failure ? socket_error(failure) : socket_success();
+}
+
 socket_result_t socket_close(socket_t *sock) {
     if (!sock || sock->fd < 0) {
         return socket_error("Invalid socket");
@@ -259,42 +1041,73 @@ socket_result_t socket_close(socket_t *sock) {
     return socket_success();
 }
 
+socket_result_t socket_finish_connect(socket_t *sock) {
+    if (!sock || sock->fd < 0) {
+        return socket_error("Invalid socket");
+    }
+
+    if (sock->is_connected) {
+        return socket_success();
+    }
+
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(sock->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) {
+        return socket_error("Failed to get socket error");
+    }
+
+    if (err == EINPROGRESS || err == EALREADY) {
+        return (socket_result_t){
+            .success = false,
+            .error_msg = "Connect in progress",
+            .error_code = EINPROGRESS
+        };
+    }
+    if (err != 0) {
+        errno = err;
+        return socket_error("Asynchronous connect failed");
+    }
+
+    // SO_ERROR is also 0 while the handshake has not started; make sure
+    // the socket really has a peer
+    struct sockaddr_storage peer;
+    socklen_t peer_len = sizeof(peer);
+    if (getpeername(sock->fd, (struct sockaddr *)&peer, &peer_len) < 0) {
+        return (socket_result_t){
+            .success = false,
+            .error_msg = "Connect in progress",
+            .error_code = EINPROGRESS
+        };
+    }
+
+    sock->is_connected = true;
+    return socket_success();
+}
+
 socket_result_t socket_async_connect(socket_t *sock, const char* hostname, int port, int timeout_ms) {
     socket_result_t res = socket_set_nonblocking(sock, true);
     if (!res.success) return res;
     
+    // On a non-blocking socket this succeeds with the connect still in
+    // progress, and only an immediate connect sets is_connected
     res = socket_connect(sock, hostname, port);
-    if (res.success) {
-        return res;
-    }
-    if (errno != EINPROGRESS) {
+    if (!res.success || sock->is_connected) {
         return res;
     }
     
-    fd_set writefds;
-    FD_ZERO(&writefds);
-    FD_SET(sock->fd, &writefds);
-    
-    struct timeval tv;
-    tv.tv_sec = timeout_ms / 1000;
-    tv.tv_usec = (timeout_ms % 1000) * 1000;
-    
-    int sel = select(sock->fd + 1, NULL, &writefds, NULL, &tv);
-    if (sel > 0 && FD_ISSET(sock->fd, &writefds)) {
-        int err;
-        socklen_t len = sizeof(err);
-        getsockopt(sock->fd, SOL_SOCKET, SO_ERROR, &err, &len);
-        if (err == 0) {
-            sock->is_connected = true;
-            return socket_success();
-        } else {
-            errno = err;
-            return socket_error("Asynchronous connect failed");
-        }
+    // poll rather than select, which cannot watch descriptors >= FD_SETSIZE
+    struct pollfd pfd = { .fd = sock->fd, .events = POLLOUT, .revents = 0 };
+    int sel;
+    do {
+        sel = poll(&pfd, 1, timeout_ms);
+    } while (sel < 0 && errno == EINTR);
+    if (sel > 0) {
+        return socket_finish_connect(sock);
     } else if (sel == 0) {
+        errno = ETIMEDOUT;
         return socket_error("Asynchronous connect timed out");
     }
-    return socket_error("Select error during asynchronous connect");
+    return socket_error("Poll error during asynchronous connect");
 }
 
 const char *socket_get_error_string(socket_result_t result) {
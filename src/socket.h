@@ -9,7 +9,10 @@
 #include <netinet/in.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
 
 /**
  * Socket type enumeration
@@ -25,12 +28,37 @@ typedef enum {
 typedef struct {
     int fd;                 /**< Socket file descriptor */
     socket_type_t type;     /**< Socket type (TCP/UDP) */
-    struct sockaddr_in addr; /**< Socket address */
+    struct sockaddr_storage addr; /**< Local address once bound, peer address once connected */
+    socklen_t addr_len;     /**< Size of the address in addr */
+    int family;             /**< Address family of fd: AF_INET or AF_INET6 */
     bool is_server;         /**< Is this a server socket? */
     bool is_connected;      /**< Is the socket connected? */
     bool is_nonblocking;    /**< Is the socket non-blocking? */
 } socket_t;
 
+/**
+ * One datagram of a batch send or receive
+ */
+typedef struct {
+    void *data;               /**< Payload buffer */
+    size_t length;            /**< Send: payload bytes. Receive: bytes received */
+    size_t capacity;          /**< Receive: size of the buffer */
+    struct sockaddr_storage addr; /**< Send: destination, or ss_family 0 for the connected peer. Receive: source */
+    socklen_t addr_len;       /**< Size of the address in addr */
+    uint16_t segment_size;    /**< Receive with GRO: size of each coalesced datagram, 0 if not coalesced */
+} socket_datagram_t;
+
+/**
+ * Pipe used by socket_splice to move data between sockets in the kernel.
+ * Bytes still in the pipe when the destination would block are kept there
+ * for the next call.
+ */
+typedef struct {
+    int pipe_fds[2];        /**< Read and write ends of the pipe */
+    size_t capacity;        /**< Pipe size in bytes */
+    size_t buffered;        /**< Bytes in the pipe not yet sent on */
+} socket_splice_t;
+
 /**
  * Socket result structure
  */
@@ -58,9 +86,46 @@ socket_result_t socket_create(socket_t *socket, socket_type_t type);
  */
 socket_result_t socket_set_nonblocking(socket_t *socket, bool nonblocking);
 
+/**
+ * Allow several sockets to bind the same port (SO_REUSEPORT); the kernel
+ * then spreads incoming connections or datagrams across them. Must be set
+ * on every such socket before socket_bind.
+ * 
+ * @param socket Socket that is not bound yet
+ * @param enable Whether to share the port
+ * @return Result of the operation
+ */
+socket_result_t socket_set_reuseport(socket_t *socket, bool enable);
+
+/**
+ * Disable Nagle's algorithm (TCP_NODELAY) so small writes go out at once.
+ * Connections accepted from a listener inherit the setting.
+ * 
+ * @param socket TCP socket
+ * @param enable Whether to send without delay
+ * @return Result of the operation
+ */
+socket_result_t socket_set_nodelay(socket_t *socket, bool enable);
+
+/**
+ * Set the kernel send and receive buffer sizes (SO_SNDBUF/SO_RCVBUF).
+ * Connections accepted from a listener inherit them; a receive buffer set
+ * before listen or connect also sizes the TCP window scale.
+ * 
+ * @param socket Socket to configure
+ * @param send_bytes Send buffer size, or 0 to leave it unchanged
+ * @param receive_bytes Receive buffer size, or 0 to leave it unchanged
+ * @return Result of the operation
+ */
+socket_result_t socket_set_buffer_sizes(socket_t *socket, int send_bytes, int receive_bytes);
+
 /**
  * Bind a socket to a specific port on all interfaces
  * 
+ * The socket is switched to AF_INET6 and bound to the IPv6 wildcard with
+ * IPV6_V6ONLY off, so it serves IPv4 peers too; their addresses show up
+ * v4-mapped (::ffff:a.b.c.d). Hosts without IPv6 bind the IPv4 wildcard.
+ * 
  * @param socket Socket to bind
  * @param port Port number to bind to
  * @return Result of the operation
@@ -79,6 +144,10 @@ socket_result_t socket_listen(socket_t *socket, int backlog);
 /**
  * Accept a new connection on a listening socket
  * 
+ * The new connection inherits the listener's non-blocking mode. On a
+ * non-blocking listener with no pending connection the result has
+ * error_code EAGAIN and nothing is logged.
+ *
  * @param server_socket Socket that is listening
  * @param client_socket Pointer to socket_t structure to initialize with the new connection
  * @return Result of the operation
@@ -88,13 +157,44 @@ socket_result_t socket_accept(socket_t *server_socket, socket_t *client_socket);
 /**
  * Connect to a server
  * 
+ * The name is resolved with zn_resolve (see resolver.h), so repeated
+ * connects to the same host are answered from the shared cache; a miss
+ * blocks. A blocking socket tries each address in turn; a non-blocking one
+ * starts connecting to the first. An IPv6 address switches the socket to
+ * AF_INET6 (see socket_set_family).
+ * 
  * @param socket Socket to use for the connection
- * @param hostname Hostname or IP address to connect to
+ * @param hostname Hostname or IPv4/IPv6 address to connect to
  * @param port Port number to connect to
  * @return Result of the operation
  */
 socket_result_t socket_connect(socket_t *socket, const char *hostname, int port);
 
+/**
+ * Connect to an address that is already resolved
+ * 
+ * @param socket Socket to use for the connection
+ * @param addr sockaddr_in or sockaddr_in6 to connect to
+ * @param addr_len Size of the address
+ * @return Result of the operation; on a non-blocking socket, success with
+ *         is_connected still false means the handshake is in progress
+ */
+socket_result_t socket_connect_address(socket_t *socket, const struct sockaddr *addr, socklen_t addr_len);
+
+/**
+ * Recreate an unused socket for another address family, keeping its file
+ * descriptor number, type, non-blocking mode, close-on-exec flag and the
+ * options set through this module (reuseaddr, reuseport, nodelay, buffer
+ * sizes, UDP GRO) as well as keepalive and linger. Does nothing if the
+ * family already matches. The underlying socket is replaced, so this must happen
+ * before the socket is registered with an event loop.
+ * 
+ * @param socket Socket that is neither bound nor connected
+ * @param family AF_INET or AF_INET6
+ * @return Result of the operation
+ */
+socket_result_t socket_set_family(socket_t *socket, int family);
+
 /**
  * Send data over a socket
  * 
@@ -109,6 +209,10 @@ socket_result_t socket_send(socket_t *socket, const void *data, size_t size, siz
 /**
  * Receive data from a socket
  * 
+ * On a non-blocking socket, 0 bytes with is_connected still set means no
+ * data was available; 0 bytes with is_connected cleared means the peer
+ * closed the connection.
+ * 
  * @param socket Socket to receive data from
  * @param buffer Pointer to buffer to store received data
  * @param size Size of buffer in bytes
@@ -117,6 +221,163 @@ socket_result_t socket_send(socket_t *socket, const void *data, size_t size, siz
  */
 socket_result_t socket_receive(socket_t *socket, void *buffer, size_t size, size_t *bytes_received);
 
+/**
+ * Send data gathered from several buffers, as if they were one
+ * 
+ * Partial writes are resumed from the right buffer and offset. A blocking
+ * socket sends everything; a non-blocking socket sends until the kernel
+ * buffer is full and reports how far it got. The iovec array itself is
+ * not modified (see socket_iov_advance to resume from it).
+ * 
+ * @param socket Socket to send data on
+ * @param iov Buffers to send, in order
+ * @param iovcnt Number of buffers
+ * @param bytes_sent Pointer to store number of bytes actually sent (can be NULL)
+ * @return Result of the operation
+ */
+socket_result_t socket_sendv(socket_t *socket, const struct iovec *iov, int iovcnt, size_t *bytes_sent);
+
+/**
+ * Receive data scattered into several buffers, filling them in order
+ * 
+ * Makes a single receive call; end of stream and "no data" are reported
+ * as for socket_receive.
+ * 
+ * @param socket Socket to receive data from
+ * @param iov Buffers to fill
+ * @param iovcnt Number of buffers
+ * @param bytes_received Pointer to store number of bytes actually received (can be NULL)
+ * @return Result of the operation
+ */
+socket_result_t socket_receivev(socket_t *socket, const struct iovec *iov, int iovcnt, size_t *bytes_received);
+
+/**
+ * Skip bytes at the front of an iovec array, e.g. after a partial send
+ * 
+ * Fully consumed entries are dropped by moving *iov forward and the first
+ * remaining entry is adjusted in place.
+ * 
+ * @param iov Pointer to the array; updated to the first unconsumed entry
+ * @param iovcnt Pointer to the entry count; updated to the remaining count
+ * @param bytes Number of bytes to skip
+ */
+void socket_iov_advance(struct iovec **iov, int *iovcnt, size_t bytes);
+
+/**
+ * Send several datagrams with as few system calls as possible (sendmmsg)
+ * 
+ * A non-blocking socket stops at the first datagram that does not fit in
+ * the send buffer; the remaining ones can be passed again later.
+ * Destinations may be IPv4 or IPv6. An IPv6 one switches an unbound IPv4
+ * socket to AF_INET6, and IPv4 ones are sent v4-mapped from an AF_INET6
+ * socket.
+ * 
+ * @param socket UDP socket
+ * @param datagrams Datagrams to send
+ * @param count Number of datagrams
+ * @param sent Pointer to store the number of datagrams sent (can be NULL)
+ * @return Result of the operation
+ */
+socket_result_t socket_send_batch(socket_t *socket, const socket_datagram_t *datagrams, size_t count, size_t *sent);
+
+/**
+ * Receive up to count datagrams with as few system calls as possible
+ * (recvmmsg)
+ * 
+ * Waits for the first datagram on a blocking socket, then takes only what
+ * is already queued. A datagram larger than its buffer is truncated. With
+ * GRO enabled one entry may hold several datagrams of segment_size bytes
+ * each (the last one may be shorter). Each entry's addr and addr_len hold
+ * the source, which on a socket bound with socket_bind is IPv6, v4-mapped
+ * for IPv4 senders.
+ * 
+ * @param socket UDP socket
+ * @param datagrams Buffers to fill; data and capacity must be set
+ * @param count Number of buffers
+ * @param received Pointer to store the number of datagrams received (can be NULL)
+ * @return Result of the operation
+ */
+socket_result_t socket_receive_batch(socket_t *socket, socket_datagram_t *datagrams, size_t count, size_t *received);
+
+/**
+ * Send a buffer as consecutive datagrams of segment_size bytes each using
+ * UDP generic segmentation offload (UDP_SEGMENT): one system call and one
+ * trip through the stack for up to 64 datagrams.
+ * 
+ * @param socket UDP socket
+ * @param data Payload of all datagrams, back to back
+ * @param length Total bytes; the last datagram may be shorter
+ * @param segment_size Bytes per datagram
+ * @param addr Destination (sockaddr_in or sockaddr_in6), or NULL for the connected peer
+ * @param addr_len Size of the destination address
+ * @param bytes_sent Pointer to store number of bytes actually sent (can be NULL)
+ * @return Result of the operation; EINVAL or EIO if the kernel lacks UDP GSO
+ */
+socket_result_t socket_send_segmented(socket_t *socket, const void *data, size_t length, uint16_t segment_size,
+                                      const struct sockaddr *addr, socklen_t addr_len, size_t *bytes_sent);
+
+/**
+ * Let the kernel coalesce consecutive datagrams from one sender into a
+ * single receive (UDP_GRO); see socket_receive_batch
+ * 
+ * @param socket UDP socket
+ * @param enable Whether to coalesce
+ * @return Result of the operation
+ */
+socket_result_t socket_set_gro(socket_t *socket, bool enable);
+
+/**
+ * Send part of a file without copying it through user space (sendfile)
+ * 
+ * A blocking socket sends all of length unless the file ends first; a
+ * non-blocking socket sends until the kernel buffer is full. *offset is
+ * advanced past what was sent, so an event loop resumes a transfer by
+ * calling again with the remaining length when the socket is writable.
+ * 
+ * @param socket Connected TCP socket
+ * @param fd File to read from; its own file offset is not changed
+ * @param offset Pointer to the file offset to start at; updated
+ * @param length Number of bytes to send
+ * @param bytes_sent Pointer to store number of bytes actually sent (can be NULL)
+ * @return Result of the operation
+ */
+socket_result_t socket_sendfile(socket_t *socket, int fd, off_t *offset, size_t length, size_t *bytes_sent);
+
+/**
+ * Create the pipe for socket_splice
+ * 
+ * @param splice Splice state to initialize
+ * @return Result of the operation
+ */
+socket_result_t socket_splice_init(socket_splice_t *splice);
+
+/**
+ * Close the pipe of a socket_splice; buffered bytes are discarded
+ * 
+ * @param splice Splice state
+ */
+void socket_splice_close(socket_splice_t *splice);
+
+/**
+ * Move data from one socket to another through a pipe (splice), without
+ * copying it through user space, e.g. for proxying
+ * 
+ * Blocking sockets move all of length unless the source reaches end of
+ * stream, which clears from->is_connected as socket_receive does. With
+ * non-blocking sockets the call returns once the source has no data or the
+ * destination is full; data already read stays in the pipe and goes out
+ * first on the next call, made when either socket is ready again.
+ * 
+ * @param from Socket to read from
+ * @param to Socket to write to
+ * @param state Pipe created by socket_splice_init; one per direction
+ * @param length Maximum number of bytes to move
+ * @param bytes_moved Pointer to store number of bytes written to the destination (can be NULL)
+ * @return Result of the operation
+ */
+socket_result_t socket_splice(socket_t *from, socket_t *to, socket_splice_t *state, size_t length,
+                              size_t *bytes_moved);
+
 /**
  * Close a socket
  * 
@@ -133,6 +394,15 @@ socket_result_t socket_close(socket_t *socket);
  */
 const char *socket_get_error_string(socket_result_t result);
 
+/**
+ * Complete a non-blocking connect once the socket has become writable
+ * 
+ * @param socket Socket with a connect in progress
+ * @return Result of the connect; error_code is EINPROGRESS if it has not
+ *         finished yet
+ */
+socket_result_t socket_finish_connect(socket_t *socket);
+
 socket_result_t socket_async_connect(socket_t *socket, const char* hostname, int port, int timeout_ms);
 
 #endif /* ZENO_SOCKET_H */
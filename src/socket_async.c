@@ -0,0 +1,867 @@
+/**
+ * @file socket_async.c
+ * @brief Implementation of the promise-returning socket operations
+ */
+
+#include "socket_async.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "reactor.h"
+#include "resolver.h"
+#include "threads.h"
+
+typedef enum {
+    ASYNC_SEND,
+    ASYNC_RECEIVE,
+    ASYNC_ACCEPT,
+    ASYNC_CONNECT
+} async_op_type_t;
+
+typedef struct {
+    async_op_type_t type;
+    socket_t *socket;
+    char *buffer;
+    size_t length;
+    size_t done;
+    zn_promise_t *promise;
+    void *value;               /* Result, once complete */
+    int error;
+    uint64_t deadline;         /* Monotonic milliseconds, 0 for none */
+    zn_reactor_timer_t *timer; /* Armed while parked with a deadline */
+} async_op_t;
+
+/* Operations parked on one socket, owned by the I/O thread */
+typedef struct {
+    socket_t *socket;
+    async_op_t *reader;        /* Receive or accept */
+    async_op_t *writer;        /* Send or connect */
+    zn_async_writer_t *drainer; /* Writer with queued data; excludes writer */
+} async_waiter_t;
+
+#define WRITER_CHUNK (16 * 1024)
+#define WRITER_IOV 64
+#define DEFAULT_HIGH_WATERMARK (64 * 1024)
+#define DEFAULT_LOW_WATERMARK (16 * 1024)
+
+/* Queued data; small writes are appended to the last chunk */
+typedef struct writer_chunk {
+    struct writer_chunk *next;
+    size_t start;              /* First unsent byte */
+    size_t length;             /* End of the data */
+    size_t capacity;
+    char data[];
+} writer_chunk_t;
+
+/* A pending write or flush */
+typedef struct writer_wait {
+    struct writer_wait *next;
+    zn_promise_t *promise;
+    uintptr_t value;
+} writer_wait_t;
+
+struct zn_async_writer {
+    socket_t *socket;
+    zn_async_writer_config_t config;
+    zn_mutex_t mutex;
+    writer_chunk_t *head;
+    writer_chunk_t *tail;
+    size_t queued;
+    writer_wait_t *blocked;    /* Writes waiting for the low watermark, oldest first */
+    writer_wait_t *blocked_tail;
+    writer_wait_t *flushes;
+    bool active;               /* Handed to the I/O thread */
+    int error;                 /* First send error, then sticky */
+    zn_promise_t *detached;    /* Fulfilled once the I/O thread has let go */
+};
+
+static pthread_once_t io_once = PTHREAD_ONCE_INIT;
+static zn_reactor_t *io_reactor;
+static zn_thread_t io_thread;
+
+/* Indexed by file descriptor; only touched on the I/O thread */
+static async_waiter_t **waiters;
+static size_t waiter_capacity;
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static uint64_t deadline_after(uint64_t timeout_ms) {
+    return timeout_ms ? monotonic_ms() + timeout_ms : 0;
+}
+
+static void *io_thread_main(void *arg) {
+    zn_reactor_run((zn_reactor_t *)arg);
+    return NULL;
+}
+
+/* The I/O thread serves the whole process and is never joined */
+static void io_start(void) {
+    zn_reactor_t *reactor = zn_reactor_create();
+    if (!reactor) {
+        return;
+    }
+
+    zn_thread_init(&io_thread);
+    if (zn_thread_create(&io_thread, io_thread_main, reactor) != 0) {
+        zn_reactor_destroy(reactor);
+        return;
+    }
+    io_reactor = reactor;
+}
+
+static zn_reactor_t *io_reactor_get(void) {
+    pthread_once(&io_once, io_start);
+    return io_reactor;
+}
+
+static bool complete(async_op_t *op, void *value) {
+    op->value = value;
+    return true;
+}
+
+static bool complete_error(async_op_t *op, int error) {
+    op->error = error ? error : EIO;
+    return true;
+}
+
+/* Settling hands the socket back to the awaiting thread, which may close
+ * it at once, so this comes after the I/O thread is done with the socket */
+static void settle(async_op_t *op) {
+    if (op->timer) {
+        zn_reactor_cancel_timer(io_reactor, op->timer);
+    }
+    if (op->error) {
+        zn_promise_fail(op->promise, (void *)(intptr_t)op->error);
+    } else {
+        zn_promise_fulfill(op->promise, op->value);
+    }
+    free(op);
+}
+
+/* Make as much progress as possible without blocking. Returns true once
+ * the operation is complete; the result is stored in the op. */
+static bool attempt(async_op_t *op) {
+    socket_result_t res;
+
+    switch (op->type) {
+    case ASYNC_RECEIVE: {
+        size_t received = 0;
+        res = socket_receive(op->socket, op->buffer, op->length, &received);
+        if (!res.success) {
+            return complete_error(op, res.error_code);
+        }
+        /* Zero bytes without end of stream means nothing was available
+         * (for UDP, an empty datagram is treated the same way) */
+        if (received == 0 && (op->socket->is_connected || op->socket->type != SOCKET_TCP)) {
+            return false;
+        }
+        return complete(op, (void *)(uintptr_t)received);
+    }
+
+    case ASYNC_SEND:
+        while (op->done < op->length) {
+            size_t sent = 0;
+            res = socket_send(op->socket, op->buffer + op->done, op->length - op->done, &sent);
+            if (!res.success) {
+                return complete_error(op, res.error_code);
+            }
+            if (sent == 0) {
+                return false;
+            }
+            op->done += sent;
+        }
+        return complete(op, (void *)(uintptr_t)op->done);
+
+    case ASYNC_ACCEPT: {
+        socket_t *client = (socket_t *)malloc(sizeof(socket_t));
+        if (!client) {
+            return complete_error(op, ENOMEM);
+        }
+        res = socket_accept(op->socket, client);
+        if (!res.success) {
+            free(client);
+            return res.error_code == EAGAIN ? false : complete_error(op, res.error_code);
+        }
+        return complete(op, client);
+    }
+
+    case ASYNC_CONNECT:
+        res = socket_finish_connect(op->socket);
+        if (!res.success) {
+            return res.error_code == EINPROGRESS ? false : complete_error(op, res.error_code);
+        }
+        return complete(op, op->socket);
+    }
+    return false;
+}
+
+/* I/O thread */
+
+static void waiter_release_if_idle(zn_reactor_t *reactor, async_waiter_t *waiter) {
+    if (waiter->reader || waiter->writer || waiter->drainer) {
+        return;
+    }
+    waiters[waiter->socket->fd] = NULL;
+    zn_reactor_remove(reactor, waiter->socket);
+    free(waiter);
+}
+
+static void on_readable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data) {
+    (void)socket;
+    (void)events;
+    async_waiter_t *waiter = (async_waiter_t *)data;
+    async_op_t *op = waiter->reader;
+    if (op && attempt(op)) {
+        waiter->reader = NULL;
+        waiter_release_if_idle(reactor, waiter);
+        settle(op);
+    }
+}
+
+static void writer_pump(zn_reactor_t *reactor, async_waiter_t *waiter);
+
+static void on_writable(zn_reactor_t *reactor, socket_t *socket, uint32_t events, void *data) {
+    (void)socket;
+    (void)events;
+    async_waiter_t *waiter = (async_waiter_t *)data;
+    if (waiter->drainer) {
+        writer_pump(reactor, waiter);
+        return;
+    }
+    async_op_t *op = waiter->writer;
+    if (op && attempt(op)) {
+        waiter->writer = NULL;
+        waiter_release_if_idle(reactor, waiter);
+        settle(op);
+    }
+}
+
+static int waiter_get(zn_reactor_t *reactor, socket_t *socket, async_waiter_t **out) {
+    size_t fd = (size_t)socket->fd;
+    if (fd >= waiter_capacity) {
+        size_t capacity = waiter_capacity ? waiter_capacity : 64;
+        while (capacity <= fd) {
+            capacity *= 2;
+        }
+        async_waiter_t **table = (async_waiter_t **)realloc(waiters, capacity * sizeof(*table));
+        if (!table) {
+            return ENOMEM;
+        }
+        memset(table + waiter_capacity, 0, (capacity - waiter_capacity) * sizeof(*table));
+        waiters = table;
+        waiter_capacity = capacity;
+    }
+
+    if (waiters[fd]) {
+        if (waiters[fd]->socket != socket) {
+            return EBUSY;
+        }
+        *out = waiters[fd];
+        return 0;
+    }
+
+    async_waiter_t *waiter = (async_waiter_t *)calloc(1, sizeof(async_waiter_t));
+    if (!waiter) {
+        return ENOMEM;
+    }
+    waiter->socket = socket;
+
+    int result = zn_reactor_add(reactor, socket, on_readable, on_writable, waiter);
+    if (result != 0) {
+        free(waiter);
+        return result;
+    }
+    waiters[fd] = waiter;
+    *out = waiter;
+    return 0;
+}
+
+/* The deadline of a parked operation passed */
+static void on_timeout(zn_reactor_t *reactor, void *data) {
+    async_op_t *op = (async_op_t *)data;
+    op->timer = NULL;
+
+    async_waiter_t *waiter = waiters[op->socket->fd];
+    if (waiter->reader == op) {
+        waiter->reader = NULL;
+    } else {
+        waiter->writer = NULL;
+    }
+    waiter_release_if_idle(reactor, waiter);
+    complete_error(op, ETIMEDOUT);
+    settle(op);
+}
+
+/* Runs on the I/O thread for operations that would have blocked */
+static void park(zn_reactor_t *reactor, void *data) {
+    async_op_t *op = (async_op_t *)data;
+    async_waiter_t *waiter;
+    int result = waiter_get(reactor, op->socket, &waiter);
+    if (result != 0) {
+        complete_error(op, result);
+        settle(op);
+        return;
+    }
+
+    bool reads = op->type == ASYNC_RECEIVE || op->type == ASYNC_ACCEPT;
+    async_op_t **slot = reads ? &waiter->reader : &waiter->writer;
+    if (*slot || (!reads && waiter->drainer)) {
+        complete_error(op, EBUSY);
+        settle(op);
+        return;
+    }
+
+    /* The socket may have become ready after the first attempt, and an
+     * existing registration does not report that edge again */
+    *slot = op;
+    if (attempt(op)) {
+        *slot = NULL;
+        waiter_release_if_idle(reactor, waiter);
+        settle(op);
+        return;
+    }
+
+    if (op->deadline) {
+        uint64_t now = monotonic_ms();
+        op->timer = zn_reactor_add_timer(reactor, op->deadline > now ? op->deadline - now : 0, 0, on_timeout, op);
+        if (!op->timer) {
+            *slot = NULL;
+            waiter_release_if_idle(reactor, waiter);
+            complete_error(op, ENOMEM);
+            settle(op);
+        }
+    }
+}
+
+/* Try right away, then hand off to the I/O thread */
+static void begin(zn_promise_t *promise, async_op_type_t type, socket_t *socket, const void *buffer,
+                  size_t length, uint64_t deadline) {
+    if (!socket || socket->fd < 0) {
+        zn_promise_fail(promise, (void *)(intptr_t)EINVAL);
+        return;
+    }
+    if (!socket->is_nonblocking) {
+        socket_result_t res = socket_set_nonblocking(socket, true);
+        if (!res.success) {
+            zn_promise_fail(promise, (void *)(intptr_t)(res.error_code ? res.error_code : EINVAL));
+            return;
+        }
+    }
+
+    async_op_t *op = (async_op_t *)calloc(1, sizeof(async_op_t));
+    if (!op) {
+        zn_promise_fail(promise, (void *)(intptr_t)ENOMEM);
+        return;
+    }
+    op->type = type;
+    op->socket = socket;
+    op->buffer = (char *)buffer;
+    op->length = length;
+    op->promise = promise;
+    op->deadline = deadline;
+
+    if (attempt(op)) {
+        settle(op);
+        return;
+    }
+
+    zn_reactor_t *reactor = io_reactor_get();
+    int result = reactor ? zn_reactor_post(reactor, park, op) : EAGAIN;
+    if (result != 0) {
+        complete_error(op, result);
+        settle(op);
+    }
+}
+
+static zn_promise_t *start(async_op_type_t type, socket_t *socket, const void *buffer, size_t length,
+                           uint64_t timeout_ms) {
+    zn_promise_t *promise = zn_promise_deferred();
+    if (promise) {
+        begin(promise, type, socket, buffer, length, deadline_after(timeout_ms));
+    }
+    return promise;
+}
+
+/* A connect waiting for its host name to resolve */
+typedef struct {
+    socket_t *socket;
+    zn_promise_t *promise;
+    uint64_t deadline;
+} async_connect_t;
+
+/* On a resolver thread, or on the caller's for numeric and cached names */
+static void on_resolved(int error, const zn_address_list_t *addresses, void *data) {
+    async_connect_t *pending = (async_connect_t *)data;
+    socket_t *socket = pending->socket;
+    zn_promise_t *promise = pending->promise;
+    uint64_t deadline = pending->deadline;
+    free(pending);
+
+    if (error == 0 && deadline && monotonic_ms() >= deadline) {
+        error = ETIMEDOUT;
+    }
+    if (error != 0) {
+        zn_promise_fail(promise, (void *)(intptr_t)error);
+        return;
+    }
+
+    /* Starts the handshake; completion is observed like any other op */
+    const zn_address_t *address = &addresses->addresses[0];
+    socket_result_t res = socket_connect_address(socket, (const struct sockaddr *)&address->addr, address->length);
+    if (!res.success) {
+        zn_promise_fail(promise, (void *)(intptr_t)(res.error_code ? res.error_code : EINVAL));
+        return;
+    }
+    begin(promise, ASYNC_CONNECT, socket, NULL, 0, deadline);
+}
+
+zn_promise_t *socket_send_async(socket_t *socket, const void *data, size_t size) {
+    return socket_send_async_timeout(socket, data, size, 0);
+}
+
+zn_promise_t *socket_send_async_timeout(socket_t *socket, const void *data, size_t size, uint64_t timeout_ms) {
+    if (!data && size > 0) {
+        zn_promise_t *promise = zn_promise_deferred();
+        zn_promise_fail(promise, (void *)(intptr_t)EINVAL);
+        return promise;
+    }
+    return start(ASYNC_SEND, socket, data, size, timeout_ms);
+}
+
+zn_promise_t *socket_receive_async(socket_t *socket, void *buffer, size_t size) {
+    return socket_receive_async_timeout(socket, buffer, size, 0);
+}
+
+zn_promise_t *socket_receive_async_timeout(socket_t *socket, void *buffer, size_t size, uint64_t timeout_ms) {
+    /* recv of zero bytes would look like end of stream */
+    if (!buffer || size == 0) {
+        zn_promise_t *promise = zn_promise_deferred();
+        zn_promise_fail(promise, (void *)(intptr_t)EINVAL);
+        return promise;
+    }
+    return start(ASYNC_RECEIVE, socket, buffer, size, timeout_ms);
+}
+
+zn_promise_t *socket_accept_async(socket_t *server_socket) {
+    return start(ASYNC_ACCEPT, server_socket, NULL, 0, 0);
+}
+
+zn_promise_t *socket_connect_async(socket_t *socket, const char *hostname, int port) {
+    return socket_connect_async_timeout(socket, hostname, port, 0);
+}
+
+zn_promise_t *socket_connect_async_timeout(socket_t *socket, const char *hostname, int port, uint64_t timeout_ms) {
+    zn_promise_t *promise = zn_promise_deferred();
+    if (!promise) {
+        return NULL;
+    }
+    if (!socket || socket->fd < 0 || !hostname) {
+        zn_promise_fail(promise, (void *)(intptr_t)EINVAL);
+        return promise;
+    }
+    if (!socket->is_nonblocking) {
+        socket_set_nonblocking(socket, true);
+    }
+
+    async_connect_t *pending = (async_connect_t *)malloc(sizeof(async_connect_t));
+    if (!pending) {
+        zn_promise_fail(promise, (void *)(intptr_t)ENOMEM);
+        return promise;
+    }
+    pending->socket = socket;
+    pending->promise = promise;
+    pending->deadline = deadline_after(timeout_ms);
+
+    int result = zn_resolve_async(hostname, port, on_resolved, pending);
+    if (result != 0) {
+        free(pending);
+        zn_promise_fail(promise, (void *)(intptr_t)result);
+    }
+    return promise;
+}
+
+/* Writer */
+
+void zn_async_writer_config_init(zn_async_writer_config_t *config) {
+    if (!config) {
+        return;
+    }
+
+    memset(config, 0, sizeof(*config));
+    config->high_watermark = DEFAULT_HIGH_WATERMARK;
+    config->low_watermark = DEFAULT_LOW_WATERMARK;
+}
+
+zn_async_writer_t *zn_async_writer_create(socket_t *socket, const zn_async_writer_config_t *config) {
+    zn_async_writer_config_t defaults;
+    if (!config) {
+        zn_async_writer_config_init(&defaults);
+        config = &defaults;
+    }
+    if (!socket || socket->fd < 0 || config->low_watermark > config->high_watermark) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!socket->is_nonblocking) {
+        socket_result_t res = socket_set_nonblocking(socket, true);
+        if (!res.success) {
+            errno = res.error_code ? res.error_code : EINVAL;
+            return NULL;
+        }
+    }
+
+    zn_async_writer_t *writer = (zn_async_writer_t *)calloc(1, sizeof(zn_async_writer_t));
+    if (!writer) {
+        return NULL;
+    }
+    if (zn_mutex_init(&writer->mutex) != 0) {
+        free(writer);
+        errno = ENOMEM;
+        return NULL;
+    }
+    writer->socket = socket;
+    writer->config = *config;
+    return writer;
+}
+
+/* Copy data to the end of the queue. Called with the mutex held. */
+static int writer_append(zn_async_writer_t *writer, const void *data, size_t size) {
+    writer_chunk_t *tail = writer->tail;
+    size_t room = tail ? tail->capacity - tail->length : 0;
+    size_t first = size < room ? size : room;
+    if (first > 0) {
+        memcpy(tail->data + tail->length, data, first);
+        tail->length += first;
+    }
+
+    size_t rest = size - first;
+    if (rest > 0) {
+        size_t capacity = rest > WRITER_CHUNK ? rest : WRITER_CHUNK;
+        writer_chunk_t *chunk = (writer_chunk_t *)malloc(sizeof(writer_chunk_t) + capacity);
+        if (!chunk) {
+            if (tail) {
+                tail->length -= first;
+            }
+            return ENOMEM;
+        }
+        chunk->next = NULL;
+        chunk->start = 0;
+        chunk->length = rest;
+        chunk->capacity = capacity;
+        memcpy(chunk->data, (const char *)data + first, rest);
+        if (tail) {
+            tail->next = chunk;
+        } else {
+            writer->head = chunk;
+        }
+        writer->tail = chunk;
+    }
+    writer->queued += size;
+    return 0;
+}
+
+/* Drop sent bytes from the front of the queue; the last chunk is kept for
+ * reuse. Called with the mutex held. */
+static void writer_consume(zn_async_writer_t *writer, size_t sent) {
+    writer->queued -= sent;
+    while (writer->head) {
+        writer_chunk_t *chunk = writer->head;
+        size_t available = chunk->length - chunk->start;
+        if (sent < available) {
+            chunk->start += sent;
+            return;
+        }
+        sent -= available;
+        if (chunk == writer->tail) {
+            chunk->start = 0;
+            chunk->length = 0;
+            return;
+        }
+        writer->head = chunk->next;
+        free(chunk);
+    }
+}
+
+static void writer_clear(zn_async_writer_t *writer) {
+    while (writer->head) {
+        writer_chunk_t *chunk = writer->head;
+        writer->head = chunk->next;
+        free(chunk);
+    }
+    writer->tail = NULL;
+    writer->queued = 0;
+}
+
+/* Send until the queue is empty (0) or the socket is full (EAGAIN).
+ * Called with the mutex held. */
+static int writer_send(zn_async_writer_t *writer) {
+    while (writer->queued > 0) {
+        struct iovec iov[WRITER_IOV];
+        int count = 0;
+        size_t total = 0;
+        for (writer_chunk_t *chunk = writer->head; chunk && count < WRITER_IOV; chunk = chunk->next) {
+            if (chunk->length > chunk->start) {
+                iov[count].iov_base = chunk->data + chunk->start;
+                iov[count].iov_len = chunk->length - chunk->start;
+                total += iov[count].iov_len;
+                count++;
+            }
+        }
+
+        size_t sent = 0;
+        socket_result_t res = socket_sendv(writer->socket, iov, count, &sent);
+        writer_consume(writer, sent);
+        if (!res.success) {
+            return res.error_code ? res.error_code : EIO;
+        }
+        if (sent < total) {
+            return EAGAIN;
+        }
+    }
+    return 0;
+}
+
+/* Take the waits the queue's state has released: all of them after an
+ * error, blocked writes at the low watermark, flushes once empty. Called
+ * with the mutex held; the caller settles them after unlocking, since
+ * promise handlers may call back into the writer. */
+static writer_wait_t *writer_take_ready(zn_async_writer_t *writer) {
+    writer_wait_t *ready = NULL;
+    if (writer->error || writer->queued <= writer->config.low_watermark) {
+        ready = writer->blocked;
+        writer->blocked = NULL;
+        writer->blocked_tail = NULL;
+    }
+    if (writer->error || writer->queued == 0) {
+        writer_wait_t **end = &ready;
+        while (*end) {
+            end = &(*end)->next;
+        }
+        *end = writer->flushes;
+        writer->flushes = NULL;
+    }
+    return ready;
+}
+
+static void writer_settle(writer_wait_t *ready, int error) {
+    while (ready) {
+        writer_wait_t *wait = ready;
+        ready = wait->next;
+        if (error) {
+            zn_promise_fail(wait->promise, (void *)(intptr_t)error);
+        } else {
+            zn_promise_fulfill(wait->promise, (void *)wait->value);
+        }
+        free(wait);
+    }
+}
+
+/* On the I/O thread, when the socket has room again */
+static void writer_pump(zn_reactor_t *reactor, async_waiter_t *waiter) {
+    zn_async_writer_t *writer = waiter->drainer;
+    zn_mutex_lock(&writer->mutex);
+    int result = writer->error ? writer->error : writer_send(writer);
+    if (result != 0 && result != EAGAIN && !writer->error) {
+        writer->error = result;
+        writer_clear(writer);
+    }
+    writer_wait_t *ready = writer_take_ready(writer);
+    int error = writer->error;
+    if (writer->queued == 0 || error) {
+        writer->active = false;
+        waiter->drainer = NULL;
+        waiter_release_if_idle(reactor, waiter);
+    }
+    zn_mutex_unlock(&writer->mutex);
+    writer_settle(ready, error);
+}
+
+/* Runs on the I/O thread once a write found the socket full */
+static void writer_park(zn_reactor_t *reactor, void *data) {
+    zn_async_writer_t *writer = (zn_async_writer_t *)data;
+    async_waiter_t *waiter;
+    int result = waiter_get(reactor, writer->socket, &waiter);
+    if (result == 0 && (waiter->writer || waiter->drainer)) {
+        waiter_release_if_idle(reactor, waiter);
+        result = EBUSY;
+    }
+    if (result != 0) {
+        zn_mutex_lock(&writer->mutex);
+        if (!writer->error) {
+            writer->error = result;
+            writer_clear(writer);
+        }
+        writer->active = false;
+        writer_wait_t *ready = writer_take_ready(writer);
+        int error = writer->error;
+        zn_mutex_unlock(&writer->mutex);
+        writer_settle(ready, error);
+        return;
+    }
+
+    // The socket may have drained since the write that parked the writer,
+    // and that edge will not be reported again
+    waiter->drainer = writer;
+    writer_pump(reactor, waiter);
+}
+
+static zn_promise_t *rejected(int error) {
+    zn_promise_t *promise = zn_promise_deferred();
+    if (promise) {
+        zn_promise_fail(promise, (void *)(intptr_t)error);
+    }
+    return promise;
+}
+
+zn_promise_t *zn_async_writer_write(zn_async_writer_t *writer, const void *data, size_t size) {
+    if (!writer || (!data && size > 0)) {
+        return rejected(EINVAL);
+    }
+    zn_promise_t *promise = zn_promise_deferred();
+    writer_wait_t *wait = (writer_wait_t *)malloc(sizeof(writer_wait_t));
+    if (!promise || !wait) {
+        free(wait);
+        if (promise) {
+            zn_promise_fail(promise, (void *)(intptr_t)ENOMEM);
+        }
+        return promise;
+    }
+    wait->next = NULL;
+    wait->promise = promise;
+    wait->value = (uintptr_t)size;
+
+    zn_mutex_lock(&writer->mutex);
+    int result = writer->error ? writer->error : writer_append(writer, data, size);
+    bool park = false;
+    if (result == 0 && !writer->active) {
+        // Nothing is in flight on the I/O thread: send directly
+        result = writer_send(writer);
+        if (result == EAGAIN) {
+            writer->active = park = true;
+            result = 0;
+        } else if (result != 0) {
+            writer->error = result;
+            writer_clear(writer);
+        }
+    }
+    if (result == 0 && writer->queued > writer->config.high_watermark) {
+        if (writer->blocked_tail) {
+            writer->blocked_tail->next = wait;
+        } else {
+            writer->blocked = wait;
+        }
+        writer->blocked_tail = wait;
+        wait = NULL;
+    }
+    zn_mutex_unlock(&writer->mutex);
+
+    if (wait) {
+        writer_settle(wait, result);
+    }
+    if (park) {
+        zn_reactor_t *reactor = io_reactor_get();
+        result = reactor ? zn_reactor_post(reactor, writer_park, writer) : EAGAIN;
+        if (result != 0) {
+            zn_mutex_lock(&writer->mutex);
+            writer->error = result;
+            writer->active = false;
+            writer_clear(writer);
+            writer_wait_t *ready = writer_take_ready(writer);
+            zn_mutex_unlock(&writer->mutex);
+            writer_settle(ready, result);
+        }
+    }
+    return promise;
+}
+
+zn_promise_t *zn_async_writer_flush(zn_async_writer_t *writer) {
+    if (!writer) {
+        return rejected(EINVAL);
+    }
+    zn_promise_t *promise = zn_promise_deferred();
+    writer_wait_t *wait = (writer_wait_t *)malloc(sizeof(writer_wait_t));
+    if (!promise || !wait) {
+        free(wait);
+        if (promise) {
+            zn_promise_fail(promise, (void *)(intptr_t)ENOMEM);
+        }
+        return promise;
+    }
+    wait->next = NULL;
+    wait->promise = promise;
+    wait->value = 0;
+
+    zn_mutex_lock(&writer->mutex);
+    int error = writer->error;
+    if (!error && writer->queued > 0) {
+        wait->next = writer->flushes;
+        writer->flushes = wait;
+        wait = NULL;
+    }
+    zn_mutex_unlock(&writer->mutex);
+
+    if (wait) {
+        writer_settle(wait, error);
+    }
+    return promise;
+}
+
+size_t zn_async_writer_queued(zn_async_writer_t *writer) {
+    if (!writer) {
+        return 0;
+    }
+
+    zn_mutex_lock(&writer->mutex);
+    size_t queued = writer->queued;
+    zn_mutex_unlock(&writer->mutex);
+    return queued;
+}
+
+/* On the I/O thread; runs after any park posted before it */
+static void writer_detach(zn_reactor_t *reactor, void *data) {
+    zn_async_writer_t *writer = (zn_async_writer_t *)data;
+    int fd = writer->socket->fd;
+    async_waiter_t *waiter = fd >= 0 && (size_t)fd < waiter_capacity ? waiters[fd] : NULL;
+    if (waiter && waiter->drainer == writer) {
+        waiter->drainer = NULL;
+        waiter_release_if_idle(reactor, waiter);
+    }
+    zn_promise_fulfill(writer->detached, NULL);
+}
+
+void zn_async_writer_destroy(zn_async_writer_t *writer) {
+    if (!writer) {
+        return;
+    }
+
+    zn_mutex_lock(&writer->mutex);
+    if (!writer->error) {
+        writer->error = ECANCELED;
+    }
+    writer_clear(writer);
+    writer_wait_t *ready = writer_take_ready(writer);
+    int error = writer->error;
+    bool active = writer->active;
+    zn_mutex_unlock(&writer->mutex);
+    writer_settle(ready, error);
+
+    if (active) {
+        writer->detached = zn_promise_deferred();
+        if (!writer->detached || zn_reactor_post(io_reactor, writer_detach, writer) != 0) {
+            /* The I/O thread may still hold the writer as a drainer, and a
+             * failed post may have queued the detach anyway; leak the writer
+             * rather than free memory that thread can reach. */
+            return;
+        }
+        zn_promise_await(writer->detached);
+        zn_promise_free(writer->detached);
+    }
+    zn_mutex_destroy(&writer->mutex);
+    free(writer);
+}
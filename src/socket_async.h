@@ -0,0 +1,197 @@
+/**
+ * @file socket_async.h
+ * @brief Promise-returning socket operations
+ *
+ * Each operation is first tried on the calling thread without blocking.
+ * If it cannot complete yet, it is handed to a shared I/O thread that
+ * waits for readiness with a zn_reactor (epoll) and settles the promise
+ * once the operation has finished. No thread is held per pending
+ * operation: awaiting the promise is the only thing that blocks.
+ *
+ * The socket is switched to non-blocking mode by the first operation. At
+ * most one receive/accept and one send/connect may be pending per socket;
+ * a second one is rejected with EBUSY. The socket must stay open until
+ * its pending operations have settled.
+ *
+ * Fulfillment values:
+ * - socket_send_async: bytes sent, as (uintptr_t); always the full size
+ * - socket_receive_async: bytes received, as (uintptr_t); 0 at end of stream
+ * - socket_accept_async: a new socket_t * allocated with malloc; the caller
+ *   closes and frees it
+ * - socket_connect_async: the socket itself
+ *
+ * A rejected promise carries the error code as (intptr_t); use
+ * zn_promise_state and zn_promise_error to tell it apart from a value of 0.
+ *
+ * For streams of writes, zn_async_writer adds flow control: writes are
+ * copied into a per-socket queue and the producer is held back by
+ * watermarks on the queued bytes (see below).
+ *
+ * The _timeout variants reject with ETIMEDOUT if the operation has not
+ * completed within timeout_ms (0 for no limit). The deadline is a timer on
+ * the I/O thread's reactor, armed only if the operation has to wait. A
+ * send that times out may have sent part of the data.
+ */
+
+#ifndef ZENO_SOCKET_ASYNC_H
+#define ZENO_SOCKET_ASYNC_H
+
+#include <stdint.h>
+#include "promise.h"
+#include "socket.h"
+
+/**
+ * Send a buffer
+ *
+ * @param socket Connected socket
+ * @param data Data to send; must stay valid until the promise settles
+ * @param size Number of bytes
+ * @return Promise for the number of bytes sent, or NULL on allocation failure
+ */
+zn_promise_t *socket_send_async(socket_t *socket, const void *data, size_t size);
+
+/**
+ * Send a buffer, giving up after timeout_ms
+ *
+ * @param socket Connected socket
+ * @param data Data to send; must stay valid until the promise settles
+ * @param size Number of bytes
+ * @param timeout_ms Time limit in milliseconds, 0 for none
+ * @return Promise for the number of bytes sent, or NULL on allocation failure
+ */
+zn_promise_t *socket_send_async_timeout(socket_t *socket, const void *data, size_t size, uint64_t timeout_ms);
+
+/**
+ * Receive whatever data is available, waiting until there is some
+ *
+ * @param socket Connected socket
+ * @param buffer Destination; must stay valid until the promise settles
+ * @param size Capacity of the buffer
+ * @return Promise for the number of bytes received, or NULL on allocation failure
+ */
+zn_promise_t *socket_receive_async(socket_t *socket, void *buffer, size_t size);
+
+/**
+ * Receive whatever data is available, waiting at most timeout_ms for some
+ *
+ * @param socket Connected socket
+ * @param buffer Destination; must stay valid until the promise settles
+ * @param size Capacity of the buffer
+ * @param timeout_ms Time limit in milliseconds, 0 for none
+ * @return Promise for the number of bytes received, or NULL on allocation failure
+ */
+zn_promise_t *socket_receive_async_timeout(socket_t *socket, void *buffer, size_t size, uint64_t timeout_ms);
+
+/**
+ * Accept the next connection
+ *
+ * @param server_socket Bound, listening socket
+ * @return Promise for the new socket, or NULL on allocation failure
+ */
+zn_promise_t *socket_accept_async(socket_t *server_socket);
+
+/**
+ * Connect to a server. The host name is resolved on the resolver's threads
+ * unless it is numeric or cached (see resolver.h); the connect then goes to
+ * the first address.
+ *
+ * @param socket Unconnected TCP socket
+ * @param hostname Host name or IPv4/IPv6 address
+ * @param port Port number
+ * @return Promise for the socket, or NULL on allocation failure
+ */
+zn_promise_t *socket_connect_async(socket_t *socket, const char *hostname, int port);
+
+/**
+ * Connect to a server, giving up after timeout_ms including the lookup
+ *
+ * @param socket Unconnected TCP socket
+ * @param hostname Host name or IPv4/IPv6 address
+ * @param port Port number
+ * @param timeout_ms Time limit in milliseconds, 0 for none
+ * @return Promise for the socket, or NULL on allocation failure
+ */
+zn_promise_t *socket_connect_async_timeout(socket_t *socket, const char *hostname, int port, uint64_t timeout_ms);
+
+/**
+ * Buffered writer with high/low watermarks
+ *
+ * zn_async_writer_write copies the data into the writer's queue, which is
+ * sent in order: directly while the socket accepts it, then by the I/O
+ * thread as the peer reads. The promise of a write is fulfilled at once
+ * while the queue stays at or below the high watermark. A write that takes
+ * the queue above it stays pending until the queue has drained to the low
+ * watermark, so a producer that awaits each write runs at the pace of the
+ * peer, with about high_watermark plus one write buffered, instead of
+ * spinning on EAGAIN or buffering without bound.
+ *
+ * After a send error every pending and later write is rejected with it.
+ * The writer occupies the socket's send side: socket_send_async on the same
+ * socket is rejected with EBUSY while the writer has data queued.
+ */
+typedef struct zn_async_writer zn_async_writer_t;
+
+/**
+ * Writer settings; start from zn_async_writer_config_init
+ */
+typedef struct {
+    size_t high_watermark;         /**< Queued bytes above which writes stay pending */
+    size_t low_watermark;          /**< Queued bytes at which pending writes are fulfilled */
+} zn_async_writer_config_t;
+
+/**
+ * Fill in the defaults: 64KB high and 16KB low watermark
+ *
+ * @param config Settings to initialize
+ */
+void zn_async_writer_config_init(zn_async_writer_config_t *config);
+
+/**
+ * Create a writer for a socket
+ *
+ * @param socket Connected socket; must stay open until the writer is destroyed
+ * @param config Settings, or NULL for the defaults
+ * @return New writer, or NULL on failure (errno is set; EINVAL if the low
+ *         watermark is above the high one)
+ */
+zn_async_writer_t *zn_async_writer_create(socket_t *socket, const zn_async_writer_config_t *config);
+
+/**
+ * Queue data to send
+ *
+ * @param writer The writer
+ * @param data Data to send; copied before this returns
+ * @param size Number of bytes
+ * @return Promise for size, as (uintptr_t), pending while the queue is over
+ *         the high watermark; NULL on allocation failure
+ */
+zn_promise_t *zn_async_writer_write(zn_async_writer_t *writer, const void *data, size_t size);
+
+/**
+ * Wait until everything queued has been handed to the kernel
+ *
+ * @param writer The writer
+ * @return Promise fulfilled with 0 once the queue is empty, or NULL on
+ *         allocation failure
+ */
+zn_promise_t *zn_async_writer_flush(zn_async_writer_t *writer);
+
+/**
+ * Bytes queued but not yet sent, e.g. to shed load from slow connections
+ *
+ * @param writer The writer
+ * @return Queued byte count
+ */
+size_t zn_async_writer_queued(zn_async_writer_t *writer);
+
+/**
+ * Drop the queue, reject pending writes and flushes with ECANCELED and free
+ * the writer. Waits for the I/O thread to let go of it, so it must not be
+ * called from a promise handler. If the detach cannot be posted to the I/O
+ * thread, the writer is leaked instead of freed.
+ *
+ * @param writer Writer to destroy
+ */
+void zn_async_writer_destroy(zn_async_writer_t *writer);
+
+#endif /* ZENO_SOCKET_ASYNC_H */
@@ -0,0 +1,46 @@
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "source_map.h"
+
+// Map the open file fd, followed by two NUL bytes
+int source_map_open(int fd, size_t max_size, SourceMap* map) {
+    memset(map, 0, sizeof(SourceMap));
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+        (unsigned long long)st.st_size > max_size) {
+        return -1;
+    }
+    
+    size_t size = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapped = (size + 2 + page - 1) & ~(page - 1);
+    
+    // Reserve zeroed pages for the contents and the terminator, then map
+    // the file over the start. The bytes after the end of the file read as
+    // zero whether they share the file's last page or not.
+    char* base = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+    if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, mapped);
+        return -1;
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+    
+    map->data = base;
+    map->size = size;
+    map->mapped = mapped;
+    return 0;
+}
+
+// Unmap a file mapped by source_map_open
+void source_map_close(SourceMap* map) {
+    if (map->data) {
+        munmap(map->data, map->mapped);
+    }
+    memset(map, 0, sizeof(SourceMap));
+}
@@ -0,0 +1,33 @@
+#ifndef SOURCE_MAP_H
+#define SOURCE_MAP_H
+
+#include <stddef.h>
+
+// A source file mapped into memory so the lexer can scan it in place,
+// without stdio reading it into a buffer first. The mapping is followed by
+// the two NUL bytes yy_scan_buffer expects at the end of its input. It is
+// private and writable because the scanner writes into its buffer while
+// scanning; the kernel copies the pages that are written to, and the file
+// itself is never modified.
+//
+// Every page the scanner writes to stays resident until the mapping is
+// closed, so a mapped file costs its whole size in memory while stdio
+// needs only flex's 16KB buffer. Larger files are read through stdio.
+#define SOURCE_MAP_MAX_SIZE (1024 * 1024)
+
+typedef struct {
+    char* data;         // File contents, then two NUL bytes
+    size_t size;        // Bytes of file contents
+    size_t mapped;      // Length of the whole mapping
+} SourceMap;
+
+// Map the open file fd. Returns 0 on success, or -1 if it is not a
+// non-empty regular file of at most max_size bytes or cannot be mapped; it
+// should then be read through stdio. The caller keeps ownership of fd
+// either way.
+int source_map_open(int fd, size_t max_size, SourceMap* map);
+
+// Unmap a file mapped by source_map_open
+void source_map_close(SourceMap* map);
+
+#endif // SOURCE_MAP_H
@@ -0,0 +1,533 @@
+/**
+ * @file stream.c
+ * @brief Implementation of the buffered socket stream
+ */
+
+#define _GNU_SOURCE
+#include "stream.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define DEFAULT_FLUSH_THRESHOLD (16 * 1024)
+
+/* A ring of capacity bytes. When mirrored, data is mapped a second time
+ * right after itself, so any run of up to capacity bytes starting inside
+ * the ring is contiguous. */
+typedef struct {
+    char *data;
+    size_t capacity;
+    size_t start;                  /* Offset of the first byte */
+    size_t length;                 /* Bytes in the ring */
+    bool mirrored;
+} stream_ring_t;
+
+struct zn_stream {
+    socket_t *socket;
+    stream_ring_t input;
+    stream_ring_t output;
+    size_t flush_threshold;
+    size_t high_watermark;
+    size_t low_watermark;
+    bool throttled;                /* Over the high watermark, not yet back to the low one */
+    char *scratch;                 /* Wrapped frames, when not mirrored */
+    size_t scanned;                /* Bytes read_until already searched */
+};
+
+static size_t round_to_pages(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return size ? (size + page - 1) / page * page : page;
+}
+
+static bool ring_map_mirrored(stream_ring_t *ring) {
+    int fd = memfd_create("zn_stream", MFD_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, (off_t)ring->capacity) < 0) {
+        close(fd);
+        return false;
+    }
+
+    // Reserve both halves first so the second mapping lands right after the first
+    char *base = (char *)mmap(NULL, 2 * ring->capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    if (mmap(base, ring->capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        mmap(base + ring->capacity, ring->capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) ==
+            MAP_FAILED) {
+        munmap(base, 2 * ring->capacity);
+        close(fd);
+        return false;
+    }
+    close(fd);
+    ring->data = base;
+    ring->mirrored = true;
+    return true;
+}
+
+static bool ring_init(stream_ring_t *ring, size_t capacity, bool mirrored) {
+    memset(ring, 0, sizeof(*ring));
+    ring->capacity = round_to_pages(capacity);
+    if (mirrored && ring_map_mirrored(ring)) {
+        return true;
+    }
+    ring->data = (char *)malloc(ring->capacity);
+    return ring->data != NULL;
+}
+
+static void ring_free(stream_ring_t *ring) {
+    if (ring->mirrored) {
+        munmap(ring->data, 2 * ring->capacity);
+    } else {
+        free(ring->data);
+    }
+    ring->data = NULL;
+}
+
+/* The buffered bytes (or the first length of them) as one or two runs */
+static int ring_data(stream_ring_t *ring, size_t length, struct iovec iov[2]) {
+    size_t first = ring->capacity - ring->start;
+    iov[0].iov_base = ring->data + ring->start;
+    if (ring->mirrored || length <= first) {
+        iov[0].iov_len = length;
+        return 1;
+    }
+    iov[0].iov_len = first;
+    iov[1].iov_base = ring->data;
+    iov[1].iov_len = length - first;
+    return 2;
+}
+
+/* The free space as one or two runs */
+static int ring_space(stream_ring_t *ring, struct iovec iov[2]) {
+    size_t end = (ring->start + ring->length) % ring->capacity;
+    size_t space = ring->capacity - ring->length;
+    size_t first = ring->capacity - end;
+    iov[0].iov_base = ring->data + end;
+    if (ring->mirrored || space <= first) {
+        iov[0].iov_len = space;
+        return 1;
+    }
+    iov[0].iov_len = first;
+    iov[1].iov_base = ring->data;
+    iov[1].iov_len = space - first;
+    return 2;
+}
+
+static void ring_consume(stream_ring_t *ring, size_t length) {
+    ring->length -= length;
+    ring->start = ring->length ? (ring->start + length) % ring->capacity : 0;
+}
+
+static void ring_append(stream_ring_t *ring, const char *data, size_t length) {
+    struct iovec iov[2];
+    int count = ring_space(ring, iov);
+    size_t first = length < iov[0].iov_len ? length : iov[0].iov_len;
+    memcpy(iov[0].iov_base, data, first);
+    if (count == 2 && first < length) {
+        memcpy(iov[1].iov_base, data + first, length - first);
+    }
+    ring->length += length;
+}
+
+static void ring_copy_out(stream_ring_t *ring, char *out, size_t length) {
+    struct iovec iov[2];
+    int count = ring_data(ring, length, iov);
+    memcpy(out, iov[0].iov_base, iov[0].iov_len);
+    if (count == 2) {
+        memcpy(out + iov[0].iov_len, iov[1].iov_base, iov[1].iov_len);
+    }
+}
+
+void zn_stream_config_init(zn_stream_config_t *config) {
+    if (!config) {
+        return;
+    }
+
+    memset(config, 0, sizeof(*config));
+    config->read_buffer = ZN_STREAM_DEFAULT_BUFFER;
+    config->write_buffer = ZN_STREAM_DEFAULT_BUFFER;
+    config->flush_threshold = DEFAULT_FLUSH_THRESHOLD;
+    config->mirrored = true;
+}
+
+zn_stream_t *zn_stream_create(socket_t *socket, const zn_stream_config_t *config) {
+    if (!socket || socket->fd < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    zn_stream_config_t defaults;
+    if (!config) {
+        zn_stream_config_init(&defaults);
+        config = &defaults;
+    }
+
+    zn_stream_t *stream = (zn_stream_t *)calloc(1, sizeof(zn_stream_t));
+    if (!stream) {
+        return NULL;
+    }
+    stream->socket = socket;
+    if (!ring_init(&stream->input, config->read_buffer, config->mirrored) ||
+        !ring_init(&stream->output, config->write_buffer, config->mirrored)) {
+        zn_stream_destroy(stream);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t threshold = config->flush_threshold;
+    stream->flush_threshold = threshold && threshold < stream->output.capacity ? threshold : stream->output.capacity;
+    size_t high = config->high_watermark;
+    stream->high_watermark = high && high < stream->output.capacity ? high : stream->output.capacity / 4 * 3;
+    size_t low = config->low_watermark;
+    stream->low_watermark = low && low <= stream->high_watermark ? low : stream->high_watermark / 3;
+    return stream;
+}
+
+void zn_stream_destroy(zn_stream_t *stream) {
+    if (!stream) {
+        return;
+    }
+
+    if (stream->input.data) {
+        ring_free(&stream->input);
+    }
+    if (stream->output.data) {
+        ring_free(&stream->output);
+    }
+    free(stream->scratch);
+    free(stream);
+}
+
+/* One receive into all of the free space */
+static int fill(zn_stream_t *stream) {
+    stream_ring_t *ring = &stream->input;
+    if (ring->length == ring->capacity) {
+        return ENOBUFS;
+    }
+    if (!stream->socket->is_connected) {
+        return ENODATA;
+    }
+
+    struct iovec iov[2];
+    int count = ring_space(ring, iov);
+    size_t received = 0;
+    socket_result_t res = count == 1 ? socket_receive(stream->socket, iov[0].iov_base, iov[0].iov_len, &received)
+                                     : socket_receivev(stream->socket, iov, count, &received);
+    if (!res.success) {
+        return res.error_code ? res.error_code : EIO;
+    }
+    if (received == 0) {
+        return stream->socket->is_connected ? EAGAIN : ENODATA;
+    }
+    ring->length += received;
+    return 0;
+}
+
+/* The first length buffered bytes as one run; copied only if they wrap
+ * in a ring that is not mirrored */
+static const void *contiguous(zn_stream_t *stream, size_t length) {
+    struct iovec iov[2];
+    if (ring_data(&stream->input, length, iov) == 1) {
+        return iov[0].iov_base;
+    }
+
+    if (!stream->scratch) {
+        stream->scratch = (char *)malloc(stream->input.capacity);
+        if (!stream->scratch) {
+            return NULL;
+        }
+    }
+    ring_copy_out(&stream->input, stream->scratch, length);
+    return stream->scratch;
+}
+
+int zn_stream_peek(zn_stream_t *stream, size_t length, const void **out) {
+    if (!stream || !out) {
+        return EINVAL;
+    }
+    if (length > stream->input.capacity) {
+        return ENOBUFS;
+    }
+
+    while (stream->input.length < length) {
+        int result = fill(stream);
+        if (result != 0) {
+            return result;
+        }
+    }
+    *out = contiguous(stream, length);
+    return *out ? 0 : ENOMEM;
+}
+
+void zn_stream_consume(zn_stream_t *stream, size_t length) {
+    if (!stream) {
+        return;
+    }
+
+    if (length > stream->input.length) {
+        length = stream->input.length;
+    }
+    ring_consume(&stream->input, length);
+    stream->scanned = 0;
+}
+
+/* Offset of the delimiter in the buffered bytes at or after from, or -1 */
+static ptrdiff_t find(stream_ring_t *ring, size_t from, const char *delimiter, size_t delimiter_length) {
+    struct iovec iov[2];
+    int count = ring_data(ring, ring->length, iov);
+    if (from < iov[0].iov_len) {
+        const char *base = (const char *)iov[0].iov_base;
+        const char *match = (const char *)memmem(base + from, iov[0].iov_len - from, delimiter, delimiter_length);
+        if (match) {
+            return match - base;
+        }
+    }
+    if (count == 1) {
+        return -1;
+    }
+
+    // Matches that straddle the end of the ring
+    size_t first = iov[0].iov_len;
+    size_t straddle = delimiter_length - 1 < first ? first - (delimiter_length - 1) : 0;
+    for (size_t offset = from > straddle ? from : straddle; offset < first; offset++) {
+        size_t i = 0;
+        while (i < delimiter_length && offset + i < ring->length &&
+               ring->data[(ring->start + offset + i) % ring->capacity] == delimiter[i]) {
+            i++;
+        }
+        if (i == delimiter_length) {
+            return (ptrdiff_t)offset;
+        }
+    }
+
+    size_t skip = from > first ? from - first : 0;
+    const char *base = (const char *)iov[1].iov_base;
+    if (skip < iov[1].iov_len) {
+        const char *match = (const char *)memmem(base + skip, iov[1].iov_len - skip, delimiter, delimiter_length);
+        if (match) {
+            return (ptrdiff_t)(first + (size_t)(match - base));
+        }
+    }
+    return -1;
+}
+
+int zn_stream_read_until(zn_stream_t *stream, const void *delimiter, size_t delimiter_length,
+                         const void **out, size_t *length) {
+    if (!stream || !delimiter || delimiter_length == 0 || !out || !length) {
+        return EINVAL;
+    }
+
+    stream_ring_t *ring = &stream->input;
+    for (;;) {
+        ptrdiff_t offset = find(ring, stream->scanned, (const char *)delimiter, delimiter_length);
+        if (offset >= 0) {
+            size_t frame = (size_t)offset + delimiter_length;
+            *out = contiguous(stream, frame);
+            if (!*out) {
+                return ENOMEM;
+            }
+            *length = frame;
+            // The bytes stay in place until the next read refills the ring
+            zn_stream_consume(stream, frame);
+            return 0;
+        }
+
+        // Resume where a match could still start
+        stream->scanned = ring->length >= delimiter_length ? ring->length - delimiter_length + 1 : 0;
+        int result = fill(stream);
+        if (result != 0) {
+            return result;
+        }
+    }
+}
+
+int zn_stream_read_exact(zn_stream_t *stream, void *buffer, size_t length) {
+    if (!stream || (!buffer && length > 0)) {
+        return EINVAL;
+    }
+
+    stream_ring_t *ring = &stream->input;
+    if (length <= ring->capacity) {
+        while (ring->length < length) {
+            int result = fill(stream);
+            if (result != 0) {
+                return result;
+            }
+        }
+        ring_copy_out(ring, (char *)buffer, length);
+        zn_stream_consume(stream, length);
+        return 0;
+    }
+    if (stream->socket->is_nonblocking) {
+        return ENOBUFS;
+    }
+
+    // Larger than the ring: hand over what is buffered, receive the rest in place
+    size_t done = ring->length;
+    ring_copy_out(ring, (char *)buffer, done);
+    zn_stream_consume(stream, done);
+    while (done < length) {
+        size_t received = 0;
+        socket_result_t res = socket_receive(stream->socket, (char *)buffer + done, length - done, &received);
+        if (!res.success) {
+            return res.error_code ? res.error_code : EIO;
+        }
+        if (received == 0) {
+            return ENODATA;
+        }
+        done += received;
+    }
+    return 0;
+}
+
+size_t zn_stream_buffered(zn_stream_t *stream) {
+    return stream ? stream->input.length : 0;
+}
+
+/* Send the pending bytes followed by extra, in one call. Returns how much
+ * of extra went out in sent_extra. */
+static int send_pending(zn_stream_t *stream, const void *extra, size_t extra_length, size_t *sent_extra) {
+    stream_ring_t *ring = &stream->output;
+    struct iovec iov[3];
+    int count = ring->length ? ring_data(ring, ring->length, iov) : 0;
+    if (extra_length) {
+        iov[count].iov_base = (void *)extra;
+        iov[count].iov_len = extra_length;
+        count++;
+    }
+
+    size_t sent = 0;
+    socket_result_t res = socket_sendv(stream->socket, iov, count, &sent);
+    size_t from_ring = sent < ring->length ? sent : ring->length;
+    ring_consume(ring, from_ring);
+    if (sent_extra) {
+        *sent_extra = sent - from_ring;
+    }
+    if (!res.success) {
+        return res.error_code ? res.error_code : EIO;
+    }
+    return 0;
+}
+
+int zn_stream_flush(zn_stream_t *stream) {
+    if (!stream) {
+        return EINVAL;
+    }
+
+    while (stream->output.length > 0) {
+        size_t before = stream->output.length;
+        int result = send_pending(stream, NULL, 0, NULL);
+        if (result != 0) {
+            return result;
+        }
+        if (stream->output.length == before) {
+            return EAGAIN;
+        }
+    }
+    return 0;
+}
+
+int zn_stream_write(zn_stream_t *stream, const void *data, size_t length) {
+    if (!stream || (!data && length > 0)) {
+        return EINVAL;
+    }
+
+    stream_ring_t *ring = &stream->output;
+    if (length <= ring->capacity - ring->length) {
+        ring_append(ring, (const char *)data, length);
+        if (ring->length >= stream->flush_threshold) {
+            int result = zn_stream_flush(stream);
+            return result == EAGAIN ? 0 : result;
+        }
+        return 0;
+    }
+
+    // It does not fit: send what is pending together with the new data
+    if (stream->socket->is_nonblocking && length > ring->capacity) {
+        return ENOBUFS;
+    }
+    size_t sent = 0;
+    int result = send_pending(stream, data, length, &sent);
+    if (result != 0) {
+        return result;
+    }
+    if (sent == length) {
+        return 0;
+    }
+
+    // Non-blocking: the rest is queued if it fits, which it does whenever
+    // any of the data went out
+    if (length - sent > ring->capacity - ring->length) {
+        return EAGAIN;
+    }
+    ring_append(ring, (const char *)data + sent, length - sent);
+    return 0;
+}
+
+int zn_stream_writev(zn_stream_t *stream, const struct iovec *iov, int count) {
+    if (!stream || count < 0 || (!iov && count > 0)) {
+        return EINVAL;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        total += iov[i].iov_len;
+    }
+
+    stream_ring_t *ring = &stream->output;
+    if (total > ring->capacity - ring->length) {
+        int result = zn_stream_flush(stream);
+        if (result != 0 && result != EAGAIN) {
+            return result;
+        }
+    }
+    if (total > ring->capacity - ring->length) {
+        if (stream->socket->is_nonblocking) {
+            return total > ring->capacity ? ENOBUFS : EAGAIN;
+        }
+
+        // Blocking: the flush emptied the ring, and larger data goes out
+        // through zn_stream_write piece by piece
+        for (int i = 0; i < count; i++) {
+            int result = zn_stream_write(stream, iov[i].iov_base, iov[i].iov_len);
+            if (result != 0) {
+                return result;
+            }
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        ring_append(ring, (const char *)iov[i].iov_base, iov[i].iov_len);
+    }
+    if (ring->length >= stream->flush_threshold) {
+        int result = zn_stream_flush(stream);
+        return result == EAGAIN ? 0 : result;
+    }
+    return 0;
+}
+
+size_t zn_stream_pending(zn_stream_t *stream) {
+    return stream ? stream->output.length : 0;
+}
+
+bool zn_stream_writable(zn_stream_t *stream) {
+    if (!stream) {
+        return false;
+    }
+
+    size_t pending = stream->output.length;
+    if (stream->throttled) {
+        stream->throttled = pending > stream->low_watermark;
+    } else {
+        stream->throttled = pending >= stream->high_watermark;
+    }
+    return !stream->throttled;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file stream.h
+ * @brief Buffered reader/writer over a connected socket_t
+ *
+ * The read side receives into a ring buffer as much as the socket has, so
+ * parsing many small frames costs one receive per buffer fill rather than
+ * one or more per frame. zn_stream_peek and zn_stream_read_until return
+ * pointers into the ring; nothing is copied unless a frame wraps around
+ * the end of the ring. The write side collects small writes and sends them
+ * together once flush_threshold bytes are pending, or on zn_stream_flush.
+ *
+ * By default each ring is a memfd mapped twice back to back, so the bytes
+ * after the end of the ring are the bytes at its start. A wrapped frame is
+ * then contiguous as well and is never copied, and every receive or flush
+ * is a single buffer. Buffer sizes are rounded up to whole pages. Without
+ * memfd the rings fall back to plain memory, and wrapped frames are copied
+ * into a scratch buffer.
+ *
+ * Both blocking and non-blocking sockets are supported. The functions
+ * return 0 or an errno value:
+ * - EAGAIN: a non-blocking socket has no more data (read) or no room in
+ *   its send buffer (write) yet; call again when the reactor reports it
+ *   ready. Buffered data is kept and nothing is consumed.
+ * - ENOBUFS: the frame does not fit in the buffer
+ * - ENODATA: the peer closed the connection before the data arrived
+ * - anything else: the socket error
+ *
+ * Pointers returned by the read functions stay valid until the next call
+ * that reads from the stream.
+ *
+ * For flow control, zn_stream_writable turns false once the pending output
+ * reaches the high watermark and true again when it has drained to the low
+ * one. A producer that checks it before generating more output stops
+ * before the write buffer is full, and does not resume on every byte the
+ * socket accepts.
+ *
+ * A stream is not thread-safe; use it from one thread at a time.
+ */
+
+#ifndef ZENO_STREAM_H
+#define ZENO_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/uio.h>
+#include "socket.h"
+
+/** Default size of each buffer */
+#define ZN_STREAM_DEFAULT_BUFFER (64 * 1024)
+
+/**
+ * Stream settings; start from zn_stream_config_init
+ */
+typedef struct {
+    size_t read_buffer;            /**< Read ring size; the largest frame that can be peeked */
+    size_t write_buffer;           /**< Write ring size */
+    size_t flush_threshold;        /**< Pending bytes that trigger a send, 0 for write_buffer */
+    size_t high_watermark;         /**< Pending bytes that stop zn_stream_writable, 0 for 3/4 of write_buffer */
+    size_t low_watermark;          /**< Pending bytes that restart it, 0 for a third of the high watermark */
+    bool mirrored;                 /**< Map rings twice so wrapped frames stay contiguous */
+} zn_stream_config_t;
+
+/**
+ * Opaque stream handle
+ */
+typedef struct zn_stream zn_stream_t;
+
+/**
+ * Fill in the defaults: ZN_STREAM_DEFAULT_BUFFER for both rings, a flush
+ * threshold of 16KB, mirrored rings
+ *
+ * @param config Settings to initialize
+ */
+void zn_stream_config_init(zn_stream_config_t *config);
+
+/**
+ * Create a stream over a socket
+ *
+ * @param socket Connected socket; must outlive the stream
+ * @param config Settings, or NULL for the defaults
+ * @return New stream, or NULL on failure (errno is set)
+ */
+zn_stream_t *zn_stream_create(socket_t *socket, const zn_stream_config_t *config);
+
+/**
+ * Free the stream. Pending writes are dropped, so flush first; the socket
+ * is left open.
+ *
+ * @param stream Stream to destroy
+ */
+void zn_stream_destroy(zn_stream_t *stream);
+
+/**
+ * Make at least length bytes available and point at them without
+ * consuming them
+ *
+ * @param stream The stream
+ * @param length Bytes needed, at most read_buffer
+ * @param out Where to store a pointer to the bytes
+ * @return 0 on success, otherwise an errno value (see above)
+ */
+int zn_stream_peek(zn_stream_t *stream, size_t length, const void **out);
+
+/**
+ * Discard bytes already made available by zn_stream_peek
+ *
+ * @param stream The stream
+ * @param length Bytes to discard, at most zn_stream_buffered
+ */
+void zn_stream_consume(zn_stream_t *stream, size_t length);
+
+/**
+ * Read up to and including the next occurrence of a delimiter, e.g.
+ * "\r\n", and consume it
+ *
+ * @param stream The stream
+ * @param delimiter Bytes that end the frame
+ * @param delimiter_length Length of the delimiter
+ * @param out Where to store a pointer to the frame
+ * @param length Where to store the frame length, delimiter included
+ * @return 0 on success, otherwise an errno value (see above); ENOBUFS if
+ *         the read buffer fills up without a delimiter
+ */
+int zn_stream_read_until(zn_stream_t *stream, const void *delimiter, size_t delimiter_length,
+                         const void **out, size_t *length);
+
+/**
+ * Read exactly length bytes into a buffer. On a blocking socket frames
+ * larger than the read buffer are received directly into the destination.
+ *
+ * @param stream The stream
+ * @param buffer Destination
+ * @param length Bytes to read; at most read_buffer on a non-blocking socket
+ * @return 0 on success, otherwise an errno value (see above)
+ */
+int zn_stream_read_exact(zn_stream_t *stream, void *buffer, size_t length);
+
+/**
+ * Bytes received but not yet consumed
+ *
+ * @param stream The stream
+ * @return Buffered byte count
+ */
+size_t zn_stream_buffered(zn_stream_t *stream);
+
+/**
+ * Queue data to send. Nothing is sent until flush_threshold bytes are
+ * pending, unless the data does not fit, in which case the pending bytes
+ * and the data go out in one send. A non-blocking write either queues all
+ * of the data or, with EAGAIN, none of it.
+ *
+ * @param stream The stream
+ * @param data Data to send
+ * @param length Number of bytes; at most write_buffer on a non-blocking socket
+ * @return 0 on success, otherwise an errno value (see above)
+ */
+int zn_stream_write(zn_stream_t *stream, const void *data, size_t length);
+
+/**
+ * Queue several buffers as one write, e.g. a message head and its body.
+ * Like zn_stream_write, a non-blocking writev either queues all of the
+ * data or, with EAGAIN, none of it.
+ *
+ * @param stream The stream
+ * @param iov Buffers to send, in order
+ * @param count Number of buffers
+ * @return 0 on success, otherwise an errno value (see above); ENOBUFS if a
+ *         non-blocking socket's data is larger than write_buffer
+ */
+int zn_stream_writev(zn_stream_t *stream, const struct iovec *iov, int count);
+
+/**
+ * Send all pending bytes. On a non-blocking socket this sends what the
+ * kernel accepts and returns EAGAIN if some remain.
+ *
+ * @param stream The stream
+ * @return 0 on success, otherwise an errno value (see above)
+ */
+int zn_stream_flush(zn_stream_t *stream);
+
+/**
+ * Bytes written but not yet sent
+ *
+ * @param stream The stream
+ * @return Pending byte count
+ */
+size_t zn_stream_pending(zn_stream_t *stream);
+
+/**
+ * Whether the producer should keep writing, with hysteresis between the
+ * watermarks (see above)
+ *
+ * @param stream The stream
+ * @return false from the high watermark until the output drains to the low one
+ */
+bool zn_stream_writable(zn_stream_t *stream);
+
+#endif /* ZENO_STREAM_H */
@@ -1,7 +1,76 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include "symtab.h"
+#include "intern.h"
+
+// Slots in a new scope's table; enough for most function bodies
+#define SCOPE_INITIAL_CAPACITY 16
+
+// Tables up to this size stay with a popped scope for reuse; larger ones
+// are freed so that clearing them never dominates leaving a scope
+#define SCOPE_REUSE_CAPACITY 64
+
+// Slot of an interned name: Fibonacci hashing of the pointer
+static size_t scope_index(const SymbolScope* scope, const char* name) {
+    uint64_t hash = (uint64_t)(uintptr_t)name * 0x9E3779B97F4A7C15ull;
+    return (size_t)(hash >> 32) & (scope->capacity - 1);
+}
+
+static SymbolEntry** allocate_slots(size_t capacity) {
+    SymbolEntry** slots = (SymbolEntry**)calloc(capacity, sizeof(SymbolEntry*));
+    if (!slots) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return slots;
+}
+
+// Find the slot holding name, or the empty slot where it would go
+static SymbolEntry** find_slot(const SymbolScope* scope, const char* name) {
+    size_t mask = scope->capacity - 1;
+    size_t index = scope_index(scope, name);
+    while (scope->slots[index] && scope->slots[index]->name != name) {
+        index = (index + 1) & mask;
+    }
+    return &scope->slots[index];
+}
+
+// Double a scope's table and reinsert its entries
+static void grow_scope(SymbolScope* scope) {
+    SymbolEntry** old_slots = scope->slots;
+    size_t old_capacity = scope->capacity;
+    
+    scope->capacity *= 2;
+    scope->slots = allocate_slots(scope->capacity);
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i]) {
+            *find_slot(scope, old_slots[i]->name) = old_slots[i];
+        }
+    }
+    free(old_slots);
+}
+
+// Take a scope from the freelist, or allocate one
+static SymbolScope* acquire_scope(SymbolTable* table) {
+    SymbolScope* scope = table->free_scopes;
+    if (scope) {
+        table->free_scopes = scope->parent;
+        return scope;
+    }
+    
+    scope = (SymbolScope*)malloc(sizeof(SymbolScope));
+    if (!scope) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    scope->capacity = SCOPE_INITIAL_CAPACITY;
+    scope->slots = allocate_slots(scope->capacity);
+    scope->count = 0;
+    scope->entries = NULL;
+    return scope;
+}
 
 // Initialize symbol table
 SymbolTable* init_symbol_table() {
@@ -11,15 +80,11 @@ SymbolTable* init_symbol_table() {
         exit(1);
     }
     
-    // Create global scope
-    table->current_scope = (SymbolScope*)malloc(sizeof(SymbolScope));
-    if (!table->current_scope) {
-        fprintf(stderr, "Memory allocation failed\n");
-        free(table);
-        exit(1);
-    }
+    table->free_scopes = NULL;
+    table->free_entries = NULL;
     
-    table->current_scope->entries = NULL;
+    // Create global scope
+    table->current_scope = acquire_scope(table);
     table->current_scope->parent = NULL;
     
     return table;
@@ -29,18 +94,12 @@ SymbolTable* init_symbol_table() {
 void enter_scope(SymbolTable* table) {
     if (!table) return;
     
-    SymbolScope* new_scope = (SymbolScope*)malloc(sizeof(SymbolScope));
-    if (!new_scope) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
-    
-    new_scope->entries = NULL;
+    SymbolScope* new_scope = acquire_scope(table);
     new_scope->parent = table->current_scope;
     table->current_scope = new_scope;
 }
 
-// Leave current scope
+// Leave current scope, keeping its table and entries for reuse
 void leave_scope(SymbolTable* table) {
     if (!table || !table->current_scope || !table->current_scope->parent) {
         return; // Cannot leave global scope
@@ -49,64 +108,104 @@ void leave_scope(SymbolTable* table) {
     SymbolScope* old_scope = table->current_scope;
     table->current_scope = old_scope->parent;
     
-    // Clean up entries in the old scope
+    // Move the scope's entries to the entry freelist
     SymbolEntry* entry = old_scope->entries;
     while (entry) {
         SymbolEntry* next = entry->next;
-        free(entry->name);
-        free(entry);
+        entry->next = table->free_entries;
+        table->free_entries = entry;
         entry = next;
     }
+    old_scope->entries = NULL;
     
-    free(old_scope);
+    // Empty the table, or swap a large one for a small one
+    if (old_scope->capacity <= SCOPE_REUSE_CAPACITY) {
+        if (old_scope->count > 0) {
+            memset(old_scope->slots, 0, old_scope->capacity * sizeof(SymbolEntry*));
+        }
+    } else {
+        free(old_scope->slots);
+        old_scope->capacity = SCOPE_INITIAL_CAPACITY;
+        old_scope->slots = allocate_slots(old_scope->capacity);
+    }
+    old_scope->count = 0;
+    
+    old_scope->parent = table->free_scopes;
+    table->free_scopes = old_scope;
 }
 
 // Add symbol to current scope
 void add_symbol(SymbolTable* table, char* name, SymbolType type, TypeInfo* type_info) { // Added type_info parameter
     if (!table || !table->current_scope || !name) return;
     
+    // Scopes are keyed by interned name pointers
+    SymbolScope* scope = table->current_scope;
+    char* key = intern(name);
+    
     // Check if symbol already exists in current scope
-    SymbolEntry* entry = table->current_scope->entries;
-    while (entry) {
-        if (strcmp(entry->name, name) == 0) {
-            fprintf(stderr, "Symbol %s already defined in current scope\n", name);
-            return;
-        }
-        entry = entry->next;
+    SymbolEntry** slot = find_slot(scope, key);
+    if (*slot) {
+        fprintf(stderr, "Symbol %s already defined in current scope\n", name);
+        return;
+    }
+    
+    // Keep the load factor at or below 3/4
+    if ((scope->count + 1) * 4 > scope->capacity * 3) {
+        grow_scope(scope);
+        slot = find_slot(scope, key);
     }
     
     // Create new entry
-    SymbolEntry* new_entry = (SymbolEntry*)malloc(sizeof(SymbolEntry));
-    if (!new_entry) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
+    SymbolEntry* new_entry = table->free_entries;
+    if (new_entry) {
+        table->free_entries = new_entry->next;
+    } else {
+        new_entry = (SymbolEntry*)malloc(sizeof(SymbolEntry));
+        if (!new_entry) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
     }
     
-    new_entry->name = strdup(name);
+    new_entry->name = key;
     new_entry->type = type;
     new_entry->type_info = type_info; // Store the type info
-    new_entry->next = table->current_scope->entries;
-    table->current_scope->entries = new_entry;
+    new_entry->next = scope->entries;
+    scope->entries = new_entry;
+    scope->count++;
+    *slot = new_entry;
 }
 
-// Look up symbol in all accessible scopes
-SymbolEntry* lookup_symbol(SymbolTable* table, char* name) {
+// Look up an interned name in all accessible scopes, comparing pointers only
+SymbolEntry* lookup_interned_symbol(SymbolTable* table, const char* name) {
     if (!table || !name) return NULL;
     
-    // Search in current scope and all parent scopes
-    SymbolScope* scope = table->current_scope;
-    while (scope) {
-        SymbolEntry* entry = scope->entries;
-        while (entry) {
-            if (strcmp(entry->name, name) == 0) {
-                return entry;
-            }
-            entry = entry->next;
+    for (SymbolScope* scope = table->current_scope; scope; scope = scope->parent) {
+        SymbolEntry* entry = *find_slot(scope, name);
+        if (entry) {
+            return entry;
         }
-        scope = scope->parent;
     }
+    return NULL;
+}
+
+// Look up symbol in all accessible scopes
+SymbolEntry* lookup_symbol(SymbolTable* table, char* name) {
+    if (!table || !name) return NULL;
     
-    return NULL; // Symbol not found
+    // A string that was never interned cannot name a symbol; looking it
+    // up must not add it to the interner
+    char* key = intern_find(name);
+    if (!key) return NULL;
+    return lookup_interned_symbol(table, key);
+}
+
+static void free_entries(SymbolEntry* entry) {
+    while (entry) {
+        SymbolEntry* next = entry->next;
+        free(entry);
+        entry = next;
+    }
 }
 
 // Clean up symbol table
@@ -120,15 +219,20 @@ void cleanup_symbol_table(SymbolTable* table) {
     
     // Clean up global scope
     if (table->current_scope) {
-        SymbolEntry* entry = table->current_scope->entries;
-        while (entry) {
-            SymbolEntry* next = entry->next;
-            free(entry->name);
-            free(entry);
-            entry = next;
-        }
+        free_entries(table->current_scope->entries);
+        free(table->current_scope->slots);
         free(table->current_scope);
     }
     
+    // Clean up the freelists
+    SymbolScope* scope = table->free_scopes;
+    while (scope) {
+        SymbolScope* next = scope->parent;
+        free(scope->slots);
+        free(scope);
+        scope = next;
+    }
+    free_entries(table->free_entries);
+    
     free(table);
 }
@@ -13,21 +13,27 @@ typedef enum {
 
 // Symbol entry
 typedef struct SymbolEntry {
-    char* name;
+    char* name;          // Interned (see intern.h)
     SymbolType type;
     TypeInfo* type_info; // Added to store detailed type information
-    struct SymbolEntry* next;
+    struct SymbolEntry* next; // Next entry in the same scope, or in the freelist
 } SymbolEntry;
 
-// Symbol table scope
+// Symbol table scope: an open-addressing table keyed by the interned
+// name pointer, so a lookup hashes and compares pointers only
 typedef struct SymbolScope {
-    SymbolEntry* entries;
-    struct SymbolScope* parent;
+    SymbolEntry** slots;        // Linear probing; NULL marks a free slot
+    size_t capacity;            // Power of two
+    size_t count;
+    SymbolEntry* entries;       // Every entry in this scope, for reuse on leave
+    struct SymbolScope* parent; // Enclosing scope, or next in the freelist
 } SymbolScope;
 
 // Symbol table
 typedef struct {
     SymbolScope* current_scope;
+    SymbolScope* free_scopes;   // Left scopes, kept with their tables
+    SymbolEntry* free_entries;  // Entries of left scopes
 } SymbolTable;
 
 // Initialize symbol table
@@ -45,6 +51,10 @@ void add_symbol(SymbolTable* table, char* name, SymbolType type, TypeInfo* type_
 // Look up symbol in all accessible scopes
 SymbolEntry* lookup_symbol(SymbolTable* table, char* name);
 
+// Same for a name that is already interned, such as any name in the AST;
+// skips hashing the string
+SymbolEntry* lookup_interned_symbol(SymbolTable* table, const char* name);
+
 // Clean up symbol table
 void cleanup_symbol_table(SymbolTable* table);
 
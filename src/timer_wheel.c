@@ -0,0 +1,235 @@
+/**
+ * @file timer_wheel.c
+ * @brief Implementation of the hierarchical timing wheel
+ */
+
+#include "timer_wheel.h"
+#include <string.h>
+
+#define SLOT_MASK ((uint64_t)ZN_TIMER_WHEEL_SLOTS - 1)
+#define MAX_DELAY ((UINT64_C(1) << (ZN_TIMER_WHEEL_BITS * ZN_TIMER_WHEEL_LEVELS)) - 1)
+
+/* entry->slot: 0 when not scheduled, SLOT_DUE in the due list, otherwise
+ * 1 + level * ZN_TIMER_WHEEL_SLOTS + index */
+#define SLOT_NONE 0
+#define SLOT_DUE (ZN_TIMER_WHEEL_LEVELS * ZN_TIMER_WHEEL_SLOTS + 1)
+
+static void list_init(zn_timer_wheel_entry_t *head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static bool list_empty(const zn_timer_wheel_entry_t *head) {
+    return head->next == head;
+}
+
+static void list_append(zn_timer_wheel_entry_t *head, zn_timer_wheel_entry_t *entry) {
+    entry->prev = head->prev;
+    entry->next = head;
+    head->prev->next = entry;
+    head->prev = entry;
+}
+
+static void list_unlink(zn_timer_wheel_entry_t *entry) {
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->next = NULL;
+    entry->prev = NULL;
+}
+
+/* Move every entry of from to the end of to */
+static void list_splice(zn_timer_wheel_entry_t *from, zn_timer_wheel_entry_t *to) {
+    if (list_empty(from)) {
+        return;
+    }
+    from->next->prev = to->prev;
+    to->prev->next = from->next;
+    from->prev->next = to;
+    to->prev = from->prev;
+    list_init(from);
+}
+
+void zn_timer_wheel_init(zn_timer_wheel_t *wheel, uint64_t now) {
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->now = now;
+    for (size_t level = 0; level < ZN_TIMER_WHEEL_LEVELS; level++) {
+        for (size_t index = 0; index < ZN_TIMER_WHEEL_SLOTS; index++) {
+            list_init(&wheel->slots[level][index]);
+        }
+    }
+    list_init(&wheel->due);
+}
+
+/* Link an entry into the slot for its distance from now: level L holds
+ * distances below 64^(L+1), indexed by the expiry's L-th group of bits */
+static void place(zn_timer_wheel_t *wheel, zn_timer_wheel_entry_t *entry) {
+    if (entry->expires < wheel->now) {
+        entry->expires = wheel->now;
+    }
+    uint64_t delta = entry->expires - wheel->now;
+    if (delta > MAX_DELAY) {
+        delta = MAX_DELAY;
+        entry->expires = wheel->now + MAX_DELAY;
+    }
+
+    size_t level = delta < ZN_TIMER_WHEEL_SLOTS ? 0 : (size_t)(63 - __builtin_clzll(delta)) / ZN_TIMER_WHEEL_BITS;
+    size_t index = (size_t)((entry->expires >> (ZN_TIMER_WHEEL_BITS * level)) & SLOT_MASK);
+    list_append(&wheel->slots[level][index], entry);
+    wheel->occupied[level] |= UINT64_C(1) << index;
+    entry->slot = (uint16_t)(1 + level * ZN_TIMER_WHEEL_SLOTS + index);
+}
+
+void zn_timer_wheel_add(zn_timer_wheel_t *wheel, zn_timer_wheel_entry_t *entry, uint64_t expires) {
+    entry->expires = expires;
+    place(wheel, entry);
+    wheel->count++;
+}
+
+void zn_timer_wheel_remove(zn_timer_wheel_t *wheel, zn_timer_wheel_entry_t *entry) {
+    if (entry->slot == SLOT_NONE) {
+        return;
+    }
+
+    list_unlink(entry);
+    if (entry->slot != SLOT_DUE) {
+        size_t level = (size_t)(entry->slot - 1) / ZN_TIMER_WHEEL_SLOTS;
+        size_t index = (size_t)(entry->slot - 1) % ZN_TIMER_WHEEL_SLOTS;
+        if (list_empty(&wheel->slots[level][index])) {
+            wheel->occupied[level] &= ~(UINT64_C(1) << index);
+        }
+    }
+    entry->slot = SLOT_NONE;
+    wheel->count--;
+}
+
+bool zn_timer_wheel_scheduled(const zn_timer_wheel_entry_t *entry) {
+    return entry->slot != SLOT_NONE;
+}
+
+/* Redistribute a slot whose time has come over the levels below */
+static void cascade(zn_timer_wheel_t *wheel, size_t level, size_t index) {
+    if (!(wheel->occupied[level] & (UINT64_C(1) << index))) {
+        return;
+    }
+
+    zn_timer_wheel_entry_t pending;
+    list_init(&pending);
+    list_splice(&wheel->slots[level][index], &pending);
+    wheel->occupied[level] &= ~(UINT64_C(1) << index);
+
+    while (!list_empty(&pending)) {
+        zn_timer_wheel_entry_t *entry = pending.next;
+        list_unlink(entry);
+        place(wheel, entry);
+    }
+}
+
+size_t zn_timer_wheel_advance(zn_timer_wheel_t *wheel, uint64_t now) {
+    size_t moved = 0;
+    while (wheel->now <= now) {
+        uint64_t tick = wheel->now;
+        size_t index = (size_t)(tick & SLOT_MASK);
+
+        // Level 0 wrapped: pull down the next slot of each level that wrapped
+        if (index == 0) {
+            for (size_t level = 1; level < ZN_TIMER_WHEEL_LEVELS; level++) {
+                size_t upper = (size_t)((tick >> (ZN_TIMER_WHEEL_BITS * level)) & SLOT_MASK);
+                cascade(wheel, level, upper);
+                if (upper != 0) {
+                    break;
+                }
+            }
+        }
+
+        uint64_t bit = UINT64_C(1) << index;
+        if (wheel->occupied[0] & bit) {
+            zn_timer_wheel_entry_t *head = &wheel->slots[0][index];
+            for (zn_timer_wheel_entry_t *entry = head->next; entry != head; entry = entry->next) {
+                entry->slot = SLOT_DUE;
+                moved++;
+            }
+            list_splice(head, &wheel->due);
+            wheel->occupied[0] &= ~bit;
+        }
+
+        // Skip the empty slots up to the next timer or the next wrap
+        uint64_t later = index == SLOT_MASK ? 0 : wheel->occupied[0] & (~UINT64_C(0) << (index + 1));
+        uint64_t next = later ? (tick & ~SLOT_MASK) + (uint64_t)__builtin_ctzll(later) : (tick | SLOT_MASK) + 1;
+        if (next > now) {
+            wheel->now = now + 1;
+            break;
+        }
+        wheel->now = next;
+    }
+    return moved;
+}
+
+zn_timer_wheel_entry_t *zn_timer_wheel_pop(zn_timer_wheel_t *wheel) {
+    if (list_empty(&wheel->due)) {
+        return NULL;
+    }
+
+    zn_timer_wheel_entry_t *entry = wheel->due.next;
+    list_unlink(entry);
+    entry->slot = SLOT_NONE;
+    wheel->count--;
+    return entry;
+}
+
+bool zn_timer_wheel_next(const zn_timer_wheel_t *wheel, uint64_t *next) {
+    if (wheel->count == 0) {
+        return false;
+    }
+    if (!list_empty(&wheel->due)) {
+        *next = wheel->now ? wheel->now - 1 : 0;
+        return true;
+    }
+
+    uint64_t best = UINT64_MAX;
+    for (size_t level = 0; level < ZN_TIMER_WHEEL_LEVELS; level++) {
+        uint64_t bits = wheel->occupied[level];
+        if (!bits) {
+            continue;
+        }
+
+        unsigned shift = ZN_TIMER_WHEEL_BITS * (unsigned)level;
+        uint64_t base = wheel->now >> shift;
+        size_t current = (size_t)(base & SLOT_MASK);
+        uint64_t round = base & ~SLOT_MASK;
+        uint64_t when;
+
+        // Level 0 slots hold a single tick. Above that, a slot is due when
+        // it cascades, which for the current slot is now if the levels
+        // below are at their start and a full round later otherwise.
+        bool current_pending = level == 0 || (wheel->now & ((UINT64_C(1) << shift) - 1)) == 0;
+        uint64_t from = current_pending ? bits & (~UINT64_C(0) << current)
+                                        : (current == SLOT_MASK ? 0 : bits & (~UINT64_C(0) << (current + 1)));
+        if (from) {
+            when = (round + (uint64_t)__builtin_ctzll(from)) << shift;
+        } else {
+            when = (round + ZN_TIMER_WHEEL_SLOTS + (uint64_t)__builtin_ctzll(bits)) << shift;
+        }
+        if (when < best) {
+            best = when;
+        }
+    }
+    *next = best;
+    return true;
+}
+
+zn_timer_wheel_entry_t *zn_timer_wheel_drain(zn_timer_wheel_t *wheel) {
+    zn_timer_wheel_entry_t *entry = zn_timer_wheel_pop(wheel);
+    if (entry) {
+        return entry;
+    }
+
+    for (size_t level = 0; level < ZN_TIMER_WHEEL_LEVELS; level++) {
+        if (wheel->occupied[level]) {
+            size_t index = (size_t)__builtin_ctzll(wheel->occupied[level]);
+            entry = wheel->slots[level][index].next;
+            zn_timer_wheel_remove(wheel, entry);
+            return entry;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timing wheel with O(1) insert and cancel
+ *
+ * Time is counted in ticks (the reactor uses milliseconds). The wheel has
+ * ZN_TIMER_WHEEL_LEVELS levels of 64 slots; level 0 holds the timers due
+ * in the next 64 ticks, one slot per tick, and each level above covers 64
+ * times the span of the one below. A timer is linked into the slot of the
+ * level matching how far away it is, and moves down ("cascades") when its
+ * level's slot comes up, at most once per level.
+ *
+ * Adding and removing a timer are a list insertion and removal. Advancing
+ * the clock costs one step per non-empty level 0 slot plus one per 64
+ * ticks, plus the cascades, independent of how many timers are pending.
+ * Delays beyond the top level (about 139 years of milliseconds) are
+ * clamped.
+ *
+ * Entries are embedded in the caller's timer structure, so the wheel
+ * itself never allocates. It is not thread-safe.
+ */
+
+#ifndef ZENO_TIMER_WHEEL_H
+#define ZENO_TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Slots per level, as a power of two */
+#define ZN_TIMER_WHEEL_BITS 6
+#define ZN_TIMER_WHEEL_SLOTS (1 << ZN_TIMER_WHEEL_BITS)
+
+/** Levels; together they span 2^42 ticks */
+#define ZN_TIMER_WHEEL_LEVELS 7
+
+/**
+ * A timer's link in the wheel, embedded in the caller's structure
+ */
+typedef struct zn_timer_wheel_entry {
+    struct zn_timer_wheel_entry *next;
+    struct zn_timer_wheel_entry *prev;
+    uint64_t expires;              /**< Tick the timer is due at */
+    uint16_t slot;                 /**< Where it is linked; internal */
+} zn_timer_wheel_entry_t;
+
+/**
+ * The wheel; initialize with zn_timer_wheel_init
+ */
+typedef struct {
+    uint64_t now;                  /**< Next tick to be processed */
+    size_t count;                  /**< Timers in the slots or the due list */
+    uint64_t occupied[ZN_TIMER_WHEEL_LEVELS];
+    zn_timer_wheel_entry_t slots[ZN_TIMER_WHEEL_LEVELS][ZN_TIMER_WHEEL_SLOTS];
+    zn_timer_wheel_entry_t due;    /**< Expired by zn_timer_wheel_advance, not yet popped */
+} zn_timer_wheel_t;
+
+/**
+ * Initialize an empty wheel
+ *
+ * @param wheel Wheel to initialize
+ * @param now Current tick
+ */
+void zn_timer_wheel_init(zn_timer_wheel_t *wheel, uint64_t now);
+
+/**
+ * Schedule an entry. A tick that has already been processed means the
+ * next one.
+ *
+ * @param wheel The wheel
+ * @param entry Entry that is not scheduled
+ * @param expires Tick the entry is due at
+ */
+void zn_timer_wheel_add(zn_timer_wheel_t *wheel, zn_timer_wheel_entry_t *entry, uint64_t expires);
+
+/**
+ * Unschedule an entry, whether it is waiting or already due
+ *
+ * @param wheel The wheel
+ * @param entry Scheduled entry
+ */
+void zn_timer_wheel_remove(zn_timer_wheel_t *wheel, zn_timer_wheel_entry_t *entry);
+
+/**
+ * Whether an entry is scheduled (waiting or due)
+ *
+ * @param entry The entry; zero-initialized entries are not scheduled
+ * @return true if scheduled
+ */
+bool zn_timer_wheel_scheduled(const zn_timer_wheel_entry_t *entry);
+
+/**
+ * Process the ticks up to and including now, moving the entries due by
+ * then to the due list
+ *
+ * @param wheel The wheel
+ * @param now Current tick
+ * @return Number of entries in the due list
+ */
+size_t zn_timer_wheel_advance(zn_timer_wheel_t *wheel, uint64_t now);
+
+/**
+ * Take the next entry of the due list, in order of expiry
+ *
+ * @param wheel The wheel
+ * @return The entry, no longer scheduled, or NULL if none is due
+ */
+zn_timer_wheel_entry_t *zn_timer_wheel_pop(zn_timer_wheel_t *wheel);
+
+/**
+ * Earliest tick at which an entry may become due. It can be earlier than
+ * any entry's expiry when entries have to cascade first; advancing to it
+ * and asking again converges on the expiry.
+ *
+ * @param wheel The wheel
+ * @param next Where to store the tick
+ * @return false if nothing is scheduled
+ */
+bool zn_timer_wheel_next(const zn_timer_wheel_t *wheel, uint64_t *next);
+
+/**
+ * Take any scheduled entry, e.g. to free them all
+ *
+ * @param wheel The wheel
+ * @return An entry, no longer scheduled, or NULL if the wheel is empty
+ */
+zn_timer_wheel_entry_t *zn_timer_wheel_drain(zn_timer_wheel_t *wheel);
+
+#endif /* ZENO_TIMER_WHEEL_H */
@@ -1,4 +1,6 @@
 #include "zeno_arc.h"
+#include <pthread.h>
+#include <time.h>
 
 /**
  * Zeno Automatic Reference Counting - Implementation
@@ -9,93 +11,672 @@
  * no longer needed.
  */
 
-// Global statistics tracking (if enabled)
+// Statistics tracking (if enabled)
 #ifdef ZENO_ARC_STATS
+
+#define ZENO_RC_TYPE_TABLE_INITIAL 64   // Per-shard type slots, power of two
+#define ZENO_RC_SITE_TABLE_INITIAL 256  // Per-shard call site slots, power of two
+
+// Allocation totals for one type name
+typedef struct {
+    char* name;
+    uint32_t hash;
+    size_t allocations;
+    size_t deallocations;
+    size_t bytes_allocated;
+    size_t bytes_freed;
+} ZenoRC_TypeStats;
+
+// Sampled allocations for one call site
 typedef struct {
-    size_t total_allocations;     // Total number of allocations
-    size_t active_allocations;    // Current active allocations
-    size_t total_memory;          // Total memory allocated (in bytes)
-    size_t active_memory;         // Current active memory (in bytes)
-    size_t total_retains;         // Total number of retain operations
-    size_t total_releases;        // Total number of release operations
-} ZenoRC_Stats;
+    const char* file;             // __FILE__ literal, or NULL if unknown
+    int line;
+    uint32_t type_hash;
+    char* type_name;
+    size_t samples;               // Number of sampled allocations
+    size_t bytes;                 // Bytes represented by those samples
+} ZenoRC_SiteStats;
+
+// One thread's statistics. Only the owning thread writes to a shard. It
+// bumps counters with relaxed atomics and takes the shard lock only to insert
+// or grow a table entry, so readers always see consistent tables.
+typedef struct ZenoRC_StatsShard {
+    ZenoRC_StatsCounters counters;
+    pthread_mutex_t lock;
+    ZenoRC_TypeStats* types;
+    size_t type_capacity;
+    size_t type_count;
+    ZenoRC_SiteStats* sites;
+    size_t site_capacity;
+    size_t site_count;
+    int64_t bytes_until_sample;
+    bool owned;                   // A live thread is using this shard
+    struct ZenoRC_StatsShard* next;
+} ZenoRC_StatsShard;
+
+_Thread_local ZenoRC_StatsCounters* zeno_rc_stats_counters = NULL;
+
+static pthread_mutex_t zeno_rc_shards_lock = PTHREAD_MUTEX_INITIALIZER;
+static ZenoRC_StatsShard* zeno_rc_shards = NULL;
+static pthread_key_t zeno_rc_shard_key;
+static pthread_once_t zeno_rc_shard_key_once = PTHREAD_ONCE_INIT;
+static size_t zeno_rc_sample_interval = 0;
+
+// Hand the shard back when its thread exits; its counts stay in the totals
+static void rc_detach_shard(void* shard_ptr) {
+    ZenoRC_StatsShard* shard = shard_ptr;
+    pthread_mutex_lock(&zeno_rc_shards_lock);
+    shard->owned = false;
+    pthread_mutex_unlock(&zeno_rc_shards_lock);
+    zeno_rc_stats_counters = NULL;
+}
+
+static void rc_create_shard_key(void) {
+    pthread_key_create(&zeno_rc_shard_key, rc_detach_shard);
+}
+
+static inline ZenoRC_StatsShard* rc_current_shard(void) {
+    if (!zeno_rc_stats_counters) ZenoRC_attachStatsShard();
+    return (ZenoRC_StatsShard*)zeno_rc_stats_counters;
+}
+
+// Give the calling thread a shard, reusing one left by an exited thread
+ZenoRC_StatsCounters* ZenoRC_attachStatsShard(void) {
+    pthread_once(&zeno_rc_shard_key_once, rc_create_shard_key);
+    
+    pthread_mutex_lock(&zeno_rc_shards_lock);
+    ZenoRC_StatsShard* shard = zeno_rc_shards;
+    while (shard && shard->owned) {
+        shard = shard->next;
+    }
+    if (!shard) {
+        shard = (ZenoRC_StatsShard*)calloc(1, sizeof(ZenoRC_StatsShard));
+        if (!shard) {
+            pthread_mutex_unlock(&zeno_rc_shards_lock);
+            fprintf(stderr, "ZenoRC: Memory allocation failed for statistics\n");
+            exit(1);
+        }
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->next = zeno_rc_shards;
+        zeno_rc_shards = shard;
+    }
+    shard->owned = true;
+    pthread_mutex_unlock(&zeno_rc_shards_lock);
+    
+    pthread_setspecific(zeno_rc_shard_key, shard);
+    zeno_rc_stats_counters = &shard->counters;
+    return zeno_rc_stats_counters;
+}
+
+// FNV-1a, 32-bit
+static uint32_t rc_hash_string(const char* str) {
+    uint32_t hash = 2166136261u;
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Find or insert a type entry; only called by the shard's owner
+static ZenoRC_TypeStats* rc_type_entry(ZenoRC_StatsShard* shard, const char* name) {
+    uint32_t hash = rc_hash_string(name);
+    
+    // Lookups need no lock: nobody else modifies this shard's tables
+    if (shard->type_capacity > 0) {
+        size_t mask = shard->type_capacity - 1;
+        size_t index = hash & mask;
+        while (shard->types[index].name) {
+            ZenoRC_TypeStats* entry = &shard->types[index];
+            if (entry->hash == hash && strcmp(entry->name, name) == 0) {
+                return entry;
+            }
+            index = (index + 1) & mask;
+        }
+    }
+    
+    pthread_mutex_lock(&shard->lock);
+    ZenoRC_TypeStats* entry = NULL;
+    if ((shard->type_count + 1) * 4 > shard->type_capacity * 3) {
+        size_t capacity = shard->type_capacity ? shard->type_capacity * 2 : ZENO_RC_TYPE_TABLE_INITIAL;
+        ZenoRC_TypeStats* types = (ZenoRC_TypeStats*)calloc(capacity, sizeof(ZenoRC_TypeStats));
+        if (!types) goto done;
+        for (size_t i = 0; i < shard->type_capacity; i++) {
+            if (!shard->types[i].name) continue;
+            size_t index = shard->types[i].hash & (capacity - 1);
+            while (types[index].name) {
+                index = (index + 1) & (capacity - 1);
+            }
+            types[index] = shard->types[i];
+        }
+        free(shard->types);
+        shard->types = types;
+        shard->type_capacity = capacity;
+    }
+    
+    size_t mask = shard->type_capacity - 1;
+    size_t index = hash & mask;
+    while (shard->types[index].name) {
+        index = (index + 1) & mask;
+    }
+    
+    char* copy = strdup(name);
+    if (copy) {
+        entry = &shard->types[index];
+        entry->name = copy;
+        entry->hash = hash;
+        shard->type_count++;
+    }
+    
+done:
+    pthread_mutex_unlock(&shard->lock);
+    return entry;
+}
+
+static size_t rc_site_slot(const char* file, int line, uint32_t type_hash, size_t mask) {
+    return ((uintptr_t)file * 31u + (size_t)line * 2654435761u + type_hash) & mask;
+}
+
+// Find or insert a call site entry; only called by the shard's owner
+static ZenoRC_SiteStats* rc_site_entry(ZenoRC_StatsShard* shard, const char* file, int line,
+                                      const char* type_name, uint32_t type_hash) {
+    if (shard->site_capacity > 0) {
+        size_t mask = shard->site_capacity - 1;
+        size_t index = rc_site_slot(file, line, type_hash, mask);
+        while (shard->sites[index].type_name) {
+            ZenoRC_SiteStats* entry = &shard->sites[index];
+            if (entry->file == file && entry->line == line && entry->type_hash == type_hash &&
+                strcmp(entry->type_name, type_name) == 0) {
+                return entry;
+            }
+            index = (index + 1) & mask;
+        }
+    }
+    
+    pthread_mutex_lock(&shard->lock);
+    ZenoRC_SiteStats* entry = NULL;
+    if ((shard->site_count + 1) * 4 > shard->site_capacity * 3) {
+        size_t capacity = shard->site_capacity ? shard->site_capacity * 2 : ZENO_RC_SITE_TABLE_INITIAL;
+        ZenoRC_SiteStats* sites = (ZenoRC_SiteStats*)calloc(capacity, sizeof(ZenoRC_SiteStats));
+        if (!sites) goto done;
+        for (size_t i = 0; i < shard->site_capacity; i++) {
+            ZenoRC_SiteStats* old = &shard->sites[i];
+            if (!old->type_name) continue;
+            size_t index = rc_site_slot(old->file, old->line, old->type_hash, capacity - 1);
+            while (sites[index].type_name) {
+                index = (index + 1) & (capacity - 1);
+            }
+            sites[index] = *old;
+        }
+        free(shard->sites);
+        shard->sites = sites;
+        shard->site_capacity = capacity;
+    }
+    
+    size_t mask = shard->site_capacity - 1;
+    size_t index = rc_site_slot(file, line, type_hash, mask);
+    while (shard->sites[index].type_name) {
+        index = (index + 1) & mask;
+    }
+    
+    char* copy = strdup(type_name);
+    if (copy) {
+        entry = &shard->sites[index];
+        entry->type_name = copy;
+        entry->file = file;
+        entry->line = line;
+        entry->type_hash = type_hash;
+        shard->site_count++;
+    }
+    
+done:
+    pthread_mutex_unlock(&shard->lock);
+    return entry;
+}
 
-static ZenoRC_Stats zeno_rc_stats = {0};
+// Add to a table counter owned by the calling thread
+#define RC_TABLE_ADD(field, n) __atomic_store_n(&(field), (field) + (n), __ATOMIC_RELAXED)
 
-// Get current statistics
+// Record an allocation of size bytes (header included)
+void ZenoRC_recordAlloc(const char* type_name, size_t size, const char* file, int line) {
+    ZenoRC_StatsShard* shard = rc_current_shard();
+    if (!type_name) type_name = "(unknown)";
+    
+    ZENO_RC_STAT_ADD(allocations, 1);
+    ZENO_RC_STAT_ADD(bytes_allocated, size);
+    
+    ZenoRC_TypeStats* type = rc_type_entry(shard, type_name);
+    if (type) {
+        RC_TABLE_ADD(type->allocations, 1);
+        RC_TABLE_ADD(type->bytes_allocated, size);
+    }
+    
+    // Deterministic byte-interval sampling: the allocation that crosses each
+    // interval boundary is charged with the whole interval
+    size_t interval = __atomic_load_n(&zeno_rc_sample_interval, __ATOMIC_RELAXED);
+    if (interval > 0) {
+        shard->bytes_until_sample -= (int64_t)size;
+        if (shard->bytes_until_sample <= 0) {
+            size_t samples = (size_t)(-shard->bytes_until_sample / (int64_t)interval) + 1;
+            shard->bytes_until_sample += (int64_t)(samples * interval);
+            
+            ZenoRC_SiteStats* site = rc_site_entry(shard, file, line, type_name,
+                                                   type ? type->hash : rc_hash_string(type_name));
+            if (site) {
+                RC_TABLE_ADD(site->samples, 1);
+                RC_TABLE_ADD(site->bytes, samples * interval);
+            }
+        }
+    }
+}
+
+// Record a deallocation of size bytes (header included)
+void ZenoRC_recordFree(const char* type_name, size_t size) {
+    ZenoRC_StatsShard* shard = rc_current_shard();
+    if (!type_name) type_name = "(unknown)";
+    
+    ZENO_RC_STAT_ADD(deallocations, 1);
+    ZENO_RC_STAT_ADD(bytes_freed, size);
+    
+    ZenoRC_TypeStats* type = rc_type_entry(shard, type_name);
+    if (type) {
+        RC_TABLE_ADD(type->deallocations, 1);
+        RC_TABLE_ADD(type->bytes_freed, size);
+    }
+}
+
+// Sample one allocation every `bytes` allocated bytes per thread (0 disables)
+void ZenoRC_setSampleInterval(size_t bytes) {
+    __atomic_store_n(&zeno_rc_sample_interval, bytes, __ATOMIC_RELAXED);
+}
+
+// Get current statistics, summed over all threads
 ZenoRC_Stats ZenoRC_getStats() {
-    return zeno_rc_stats;
+    ZenoRC_StatsCounters sum = {0};
+    
+    pthread_mutex_lock(&zeno_rc_shards_lock);
+    for (ZenoRC_StatsShard* shard = zeno_rc_shards; shard; shard = shard->next) {
+        sum.allocations += __atomic_load_n(&shard->counters.allocations, __ATOMIC_RELAXED);
+        sum.deallocations += __atomic_load_n(&shard->counters.deallocations, __ATOMIC_RELAXED);
+        sum.bytes_allocated += __atomic_load_n(&shard->counters.bytes_allocated, __ATOMIC_RELAXED);
+        sum.bytes_freed += __atomic_load_n(&shard->counters.bytes_freed, __ATOMIC_RELAXED);
+        sum.retains += __atomic_load_n(&shard->counters.retains, __ATOMIC_RELAXED);
+        sum.releases += __atomic_load_n(&shard->counters.releases, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&zeno_rc_shards_lock);
+    
+    ZenoRC_Stats stats;
+    stats.total_allocations = sum.allocations;
+    stats.active_allocations = sum.allocations - sum.deallocations;
+    stats.total_memory = sum.bytes_allocated;
+    stats.active_memory = sum.bytes_allocated - sum.bytes_freed;
+    stats.total_retains = sum.retains;
+    stats.total_releases = sum.releases;
+    return stats;
 }
 
 // Print current statistics
 void ZenoRC_printStats() {
+    ZenoRC_Stats stats = ZenoRC_getStats();
     printf("Zeno ARC Statistics:\n");
-    printf("  Total allocations:  %zu\n", zeno_rc_stats.total_allocations);
-    printf("  Active allocations: %zu\n", zeno_rc_stats.active_allocations);
-    printf("  Total memory:       %zu bytes\n", zeno_rc_stats.total_memory);
-    printf("  Active memory:      %zu bytes\n", zeno_rc_stats.active_memory);
-    printf("  Total retains:      %zu\n", zeno_rc_stats.total_retains);
-    printf("  Total releases:     %zu\n", zeno_rc_stats.total_releases);
+    printf("  Total allocations:  %zu\n", stats.total_allocations);
+    printf("  Active allocations: %zu\n", stats.active_allocations);
+    printf("  Total memory:       %zu bytes\n", stats.total_memory);
+    printf("  Active memory:      %zu bytes\n", stats.active_memory);
+    printf("  Total retains:      %zu\n", stats.total_retains);
+    printf("  Total releases:     %zu\n", stats.total_releases);
 }
 
-// Update allocation statistics
-static void update_alloc_stats(size_t size) {
-    zeno_rc_stats.total_allocations++;
-    zeno_rc_stats.active_allocations++;
-    zeno_rc_stats.total_memory += size;
-    zeno_rc_stats.active_memory += size;
+static int rc_compare_types(const void* a, const void* b) {
+    return strcmp(((const ZenoRC_TypeStats*)a)->name, ((const ZenoRC_TypeStats*)b)->name);
 }
 
-// Update deallocation statistics
-static void update_dealloc_stats(size_t size) {
-    zeno_rc_stats.active_allocations--;
-    zeno_rc_stats.active_memory -= size;
+static int rc_compare_sites(const void* a, const void* b) {
+    const ZenoRC_SiteStats* left = (const ZenoRC_SiteStats*)a;
+    const ZenoRC_SiteStats* right = (const ZenoRC_SiteStats*)b;
+    int result = strcmp(left->file ? left->file : "", right->file ? right->file : "");
+    if (result != 0) return result;
+    if (left->line != right->line) return left->line < right->line ? -1 : 1;
+    return strcmp(left->type_name, right->type_name);
 }
 
-// Update retain statistics
-static void update_retain_stats() {
-    zeno_rc_stats.total_retains++;
+// Write a report with one record per line, sorted by key, so that two
+// reports can be compared with diff. No addresses or timings are included.
+void ZenoRC_writeStatsReport(FILE* out) {
+    ZenoRC_Stats stats = ZenoRC_getStats();
+    ZenoRC_TypeStats* types = NULL;
+    ZenoRC_SiteStats* sites = NULL;
+    size_t type_count = 0;
+    size_t site_count = 0;
+    
+    // Snapshot every shard's tables; names stay owned by the shards
+    pthread_mutex_lock(&zeno_rc_shards_lock);
+    for (ZenoRC_StatsShard* shard = zeno_rc_shards; shard; shard = shard->next) {
+        pthread_mutex_lock(&shard->lock);
+        ZenoRC_TypeStats* grown_types = realloc(types, (type_count + shard->type_count + 1) * sizeof(ZenoRC_TypeStats));
+        ZenoRC_SiteStats* grown_sites = grown_types ? realloc(sites, (site_count + shard->site_count + 1) * sizeof(ZenoRC_SiteStats)) : NULL;
+        if (grown_types) types = grown_types;
+        if (grown_sites) sites = grown_sites;
+        if (grown_types && grown_sites) {
+            for (size_t i = 0; i < shard->type_capacity; i++) {
+                ZenoRC_TypeStats* entry = &shard->types[i];
+                if (!entry->name) continue;
+                ZenoRC_TypeStats* copy = &types[type_count++];
+                copy->name = entry->name;
+                copy->allocations = __atomic_load_n(&entry->allocations, __ATOMIC_RELAXED);
+                copy->deallocations = __atomic_load_n(&entry->deallocations, __ATOMIC_RELAXED);
+                copy->bytes_allocated = __atomic_load_n(&entry->bytes_allocated, __ATOMIC_RELAXED);
+                copy->bytes_freed = __atomic_load_n(&entry->bytes_freed, __ATOMIC_RELAXED);
+            }
+            for (size_t i = 0; i < shard->site_capacity; i++) {
+                ZenoRC_SiteStats* entry = &shard->sites[i];
+                if (!entry->type_name) continue;
+                ZenoRC_SiteStats* copy = &sites[site_count++];
+                *copy = *entry;
+                copy->samples = __atomic_load_n(&entry->samples, __ATOMIC_RELAXED);
+                copy->bytes = __atomic_load_n(&entry->bytes, __ATOMIC_RELAXED);
+            }
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+    
+    // Merge entries for the same key coming from different threads
+    qsort(types, type_count, sizeof(ZenoRC_TypeStats), rc_compare_types);
+    size_t merged = 0;
+    for (size_t i = 0; i < type_count; i++) {
+        if (merged > 0 && strcmp(types[merged - 1].name, types[i].name) == 0) {
+            types[merged - 1].allocations += types[i].allocations;
+            types[merged - 1].deallocations += types[i].deallocations;
+            types[merged - 1].bytes_allocated += types[i].bytes_allocated;
+            types[merged - 1].bytes_freed += types[i].bytes_freed;
+        } else {
+            types[merged++] = types[i];
+        }
+    }
+    type_count = merged;
+    
+    qsort(sites, site_count, sizeof(ZenoRC_SiteStats), rc_compare_sites);
+    merged = 0;
+    for (size_t i = 0; i < site_count; i++) {
+        if (merged > 0 && rc_compare_sites(&sites[merged - 1], &sites[i]) == 0) {
+            sites[merged - 1].samples += sites[i].samples;
+            sites[merged - 1].bytes += sites[i].bytes;
+        } else {
+            sites[merged++] = sites[i];
+        }
+    }
+    site_count = merged;
+    
+    fprintf(out, "# zeno-arc-stats v1\n");
+    fprintf(out, "total allocations=%zu bytes=%zu\n", stats.total_allocations, stats.total_memory);
+    fprintf(out, "total live=%zu live_bytes=%zu\n", stats.active_allocations, stats.active_memory);
+    fprintf(out, "total retains=%zu releases=%zu\n", stats.total_retains, stats.total_releases);
+    fprintf(out, "sample interval=%zu\n", __atomic_load_n(&zeno_rc_sample_interval, __ATOMIC_RELAXED));
+    for (size_t i = 0; i < type_count; i++) {
+        fprintf(out, "type %s allocations=%zu bytes=%zu live=%zu live_bytes=%zu\n",
+                types[i].name, types[i].allocations, types[i].bytes_allocated,
+                types[i].allocations - types[i].deallocations,
+                types[i].bytes_allocated - types[i].bytes_freed);
+    }
+    for (size_t i = 0; i < site_count; i++) {
+        fprintf(out, "site %s:%d %s samples=%zu bytes=%zu\n",
+                sites[i].file ? sites[i].file : "(unknown)", sites[i].line,
+                sites[i].type_name, sites[i].samples, sites[i].bytes);
+    }
+    pthread_mutex_unlock(&zeno_rc_shards_lock);
+    
+    free(types);
+    free(sites);
 }
+#endif
+
+// Weak reference side table
+//
+// Maps object pointers to the shared ZenoRC_Weak box of that object. Only
+// objects with ZENO_RC_WEAK set have an entry. The table lock also orders
+// upgrades against the final release: the releasing thread drops the count
+// to zero before it takes the lock to detach the box, and an upgrade only
+// succeeds on a non-zero count while holding the lock, so it can neither
+// resurrect a dying object nor touch freed memory.
+struct ZenoRC_Weak {
+    void* object;                 // NULL once the object has died
+    size_t weak_count;            // Weak references sharing this box
+};
+
+#define ZENO_RC_WEAK_TABLE_INITIAL 64  // Slots, always a power of two
+
+static pthread_mutex_t zeno_rc_weak_lock = PTHREAD_MUTEX_INITIALIZER;
+static ZenoRC_Weak** zeno_rc_weak_slots = NULL;
+static size_t zeno_rc_weak_capacity = 0;
+static size_t zeno_rc_weak_count = 0;
 
-// Update release statistics
-static void update_release_stats() {
-    zeno_rc_stats.total_releases++;
+static size_t weak_slot(void* ptr, size_t mask) {
+    uintptr_t key = (uintptr_t)ptr;
+    key ^= key >> 17;
+    key *= 0x9E3779B97F4A7C15ull;
+    return (size_t)(key >> 32) & mask;
 }
+
+// Find the slot holding ptr, or the empty slot where it would go
+static size_t weak_find(void* ptr) {
+    size_t mask = zeno_rc_weak_capacity - 1;
+    size_t index = weak_slot(ptr, mask);
+    while (zeno_rc_weak_slots[index] && zeno_rc_weak_slots[index]->object != ptr) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+static bool weak_grow(void) {
+    size_t capacity = zeno_rc_weak_capacity ? zeno_rc_weak_capacity * 2 : ZENO_RC_WEAK_TABLE_INITIAL;
+    ZenoRC_Weak** slots = (ZenoRC_Weak**)calloc(capacity, sizeof(ZenoRC_Weak*));
+    if (!slots) return false;
+    
+    for (size_t i = 0; i < zeno_rc_weak_capacity; i++) {
+        ZenoRC_Weak* box = zeno_rc_weak_slots[i];
+        if (!box) continue;
+        size_t index = weak_slot(box->object, capacity - 1);
+        while (slots[index]) {
+            index = (index + 1) & (capacity - 1);
+        }
+        slots[index] = box;
+    }
+    
+    free(zeno_rc_weak_slots);
+    zeno_rc_weak_slots = slots;
+    zeno_rc_weak_capacity = capacity;
+    return true;
+}
+
+// Remove the entry at index, shifting back later entries of the same run
+static void weak_remove_at(size_t index) {
+    size_t mask = zeno_rc_weak_capacity - 1;
+    zeno_rc_weak_slots[index] = NULL;
+    zeno_rc_weak_count--;
+    
+    size_t next = (index + 1) & mask;
+    while (zeno_rc_weak_slots[next]) {
+        ZenoRC_Weak* box = zeno_rc_weak_slots[next];
+        size_t home = weak_slot(box->object, mask);
+        // Move the entry back if its home slot is not in (index, next]
+        if (((next - home) & mask) >= ((next - index) & mask)) {
+            zeno_rc_weak_slots[index] = box;
+            zeno_rc_weak_slots[next] = NULL;
+            index = next;
+        }
+        next = (next + 1) & mask;
+    }
+}
+
+// Create a weak reference to a live object (the caller holds a strong one)
+ZenoRC_Weak* ZenoRC_weakRef(void* ptr) {
+    if (!ptr) return NULL;
+    
+    ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
+    ZenoRC_Weak* box = NULL;
+    
+    pthread_mutex_lock(&zeno_rc_weak_lock);
+    if (ZenoRC_flags(header) & ZENO_RC_WEAK) {
+        box = zeno_rc_weak_slots[weak_find(ptr)];
+    } else if ((zeno_rc_weak_count + 1) * 4 <= zeno_rc_weak_capacity * 3 || weak_grow()) {
+        box = (ZenoRC_Weak*)malloc(sizeof(ZenoRC_Weak));
+        if (box) {
+            box->object = ptr;
+            box->weak_count = 0;
+            zeno_rc_weak_slots[weak_find(ptr)] = box;
+            zeno_rc_weak_count++;
+            __atomic_fetch_or(&header->flags, ZENO_RC_WEAK, __ATOMIC_RELEASE);
+        }
+    }
+    if (box) {
+        box->weak_count++;
+    }
+    pthread_mutex_unlock(&zeno_rc_weak_lock);
+    
+    if (!box) {
+        fprintf(stderr, "ZenoRC: Memory allocation failed for weak reference to %s\n",
+                header->type_name);
+    }
+    return box;
+}
+
+// Take another weak reference sharing the same box
+ZenoRC_Weak* ZenoRC_weakCopy(ZenoRC_Weak* weak) {
+    if (!weak) return NULL;
+    
+    pthread_mutex_lock(&zeno_rc_weak_lock);
+    weak->weak_count++;
+    pthread_mutex_unlock(&zeno_rc_weak_lock);
+    return weak;
+}
+
+// Get a strong (retained) reference, or NULL if the object is dead
+void* ZenoRC_weakUpgrade(ZenoRC_Weak* weak) {
+    if (!weak) return NULL;
+    
+    pthread_mutex_lock(&zeno_rc_weak_lock);
+    void* ptr = weak->object;
+    if (ptr) {
+        ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
+#ifdef ZENO_ARC_CYCLES
+        ZenoRC_checkTrial(header);
+#endif
+        int count = __atomic_load_n(&header->ref_count, __ATOMIC_RELAXED);
+        do {
+            if (count <= 0) {
+                ptr = NULL;
+                break;
+            }
+        } while (!__atomic_compare_exchange_n(&header->ref_count, &count, count + 1, true,
+                                              __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+    }
+    pthread_mutex_unlock(&zeno_rc_weak_lock);
+    
+#ifdef ZENO_ARC_STATS
+    if (ptr) {
+        ZENO_RC_STAT_ADD(retains, 1);
+    }
+#endif
+    return ptr;
+}
+
+// Check whether the object is still alive (it may die right after)
+bool ZenoRC_weakIsAlive(ZenoRC_Weak* weak) {
+    if (!weak) return false;
+    
+    pthread_mutex_lock(&zeno_rc_weak_lock);
+#ifdef ZENO_ARC_CYCLES
+    if (weak->object) {
+        ZenoRC_checkTrial(((ZenoRC_Header*)weak->object) - 1);
+    }
 #endif
+    bool alive = weak->object != NULL &&
+                 __atomic_load_n(&(((ZenoRC_Header*)weak->object) - 1)->ref_count, __ATOMIC_RELAXED) > 0;
+    pthread_mutex_unlock(&zeno_rc_weak_lock);
+    return alive;
+}
+
+// Drop a weak reference
+void ZenoRC_weakRelease(ZenoRC_Weak* weak) {
+    if (!weak) return;
+    
+    pthread_mutex_lock(&zeno_rc_weak_lock);
+    if (--weak->weak_count == 0) {
+        if (weak->object) {
+            // Last weak reference to a live object: take it out of the table
+            ZenoRC_Header* header = ((ZenoRC_Header*)weak->object) - 1;
+            weak_remove_at(weak_find(weak->object));
+            __atomic_fetch_and(&header->flags, ~ZENO_RC_WEAK, __ATOMIC_RELEASE);
+        }
+        free(weak);
+    }
+    pthread_mutex_unlock(&zeno_rc_weak_lock);
+}
 
-// Registry of type deinitializers
+// Detach an object's weak references; called once its count reaches zero
+void ZenoRC_clearWeakRefs(void* ptr) {
+    ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
+    
+    pthread_mutex_lock(&zeno_rc_weak_lock);
+    if (ZenoRC_flags(header) & ZENO_RC_WEAK) {
+        size_t index = weak_find(ptr);
+        ZenoRC_Weak* box = zeno_rc_weak_slots[index];
+        if (box) {
+            box->object = NULL;
+            weak_remove_at(index);
+        }
+        __atomic_fetch_and(&header->flags, ~ZENO_RC_WEAK, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&zeno_rc_weak_lock);
+}
+
+// Registry of type deinitializers and copy hooks
 typedef struct ZenoRC_TypeDeinit {
     const char* type_name;
     void (*deinit)(void*);
+    void (*copy)(void*, const void*);
     struct ZenoRC_TypeDeinit* next;
 } ZenoRC_TypeDeinit;
 
 static ZenoRC_TypeDeinit* zeno_rc_type_registry = NULL;
 
-// Register a deinitializer for a type
-void ZenoRC_registerDeinit(const char* type_name, void (*deinit)(void*)) {
-    // Check if type already registered
+// Find a type's registry entry
+static ZenoRC_TypeDeinit* registry_find(const char* type_name) {
     ZenoRC_TypeDeinit* entry = zeno_rc_type_registry;
     while (entry) {
         if (strcmp(entry->type_name, type_name) == 0) {
-            // Update existing entry
-            entry->deinit = deinit;
-            return;
+            return entry;
         }
         entry = entry->next;
     }
+    return NULL;
+}
+
+// Find a type's registry entry, adding an empty one if there is none
+static ZenoRC_TypeDeinit* registry_add(const char* type_name) {
+    ZenoRC_TypeDeinit* entry = registry_find(type_name);
+    if (entry) return entry;
     
-    // Create new entry
-    ZenoRC_TypeDeinit* new_entry = (ZenoRC_TypeDeinit*)malloc(sizeof(ZenoRC_TypeDeinit));
-    if (!new_entry) {
+    entry = (ZenoRC_TypeDeinit*)malloc(sizeof(ZenoRC_TypeDeinit));
+    if (!entry) {
         fprintf(stderr, "ZenoRC: Memory allocation failed for type registry\n");
-        return;
+        return NULL;
     }
     
-    new_entry->type_name = strdup(type_name);
-    new_entry->deinit = deinit;
-    new_entry->next = zeno_rc_type_registry;
-    zeno_rc_type_registry = new_entry;
+    entry->type_name = strdup(type_name);
+    entry->deinit = NULL;
+    entry->copy = NULL;
+    entry->next = zeno_rc_type_registry;
+    zeno_rc_type_registry = entry;
+    return entry;
+}
+
+// Register a deinitializer for a type
+void ZenoRC_registerDeinit(const char* type_name, void (*deinit)(void*)) {
+    ZenoRC_TypeDeinit* entry = registry_add(type_name);
+    if (!entry) return;
+    
+    entry->deinit = deinit;
     
     if (ZENO_ARC_DEBUG) {
         printf("ZenoRC: Registered deinitializer for type %s\n", type_name);
@@ -104,14 +685,26 @@ void ZenoRC_registerDeinit(const char* type_name, void (*deinit)(void*)) {
 
 // Get the deinitializer for a type
 void (*ZenoRC_getDeinit(const char* type_name))(void*) {
-    ZenoRC_TypeDeinit* entry = zeno_rc_type_registry;
-    while (entry) {
-        if (strcmp(entry->type_name, type_name) == 0) {
-            return entry->deinit;
-        }
-        entry = entry->next;
+    ZenoRC_TypeDeinit* entry = registry_find(type_name);
+    return entry ? entry->deinit : NULL;
+}
+
+// Register the hook that retains a clone's child references for a type
+void ZenoRC_registerCopy(const char* type_name, void (*copy)(void* dst, const void* src)) {
+    ZenoRC_TypeDeinit* entry = registry_add(type_name);
+    if (!entry) return;
+    
+    entry->copy = copy;
+    
+    if (ZENO_ARC_DEBUG) {
+        printf("ZenoRC: Registered copy hook for type %s\n", type_name);
     }
-    return NULL;
+}
+
+// Get the copy hook for a type
+void (*ZenoRC_getCopy(const char* type_name))(void* dst, const void* src) {
+    ZenoRC_TypeDeinit* entry = registry_find(type_name);
+    return entry ? entry->copy : NULL;
 }
 
 // Cleanup the type registry
@@ -130,8 +723,8 @@ void ZenoRC_cleanupRegistry() {
     }
 }
 
-// Allocate an object with automatic reference counting
-void* ZenoRC_allocObject(size_t size, const char* type_name) {
+// Allocate an object with automatic reference counting, attributing it to a call site
+void* ZenoRC_allocObjectAt(size_t size, const char* type_name, const char* file, int line) {
     // Allocate memory for the header and the object
     size_t total_size = sizeof(ZenoRC_Header) + size;
     ZenoRC_Header* header = (ZenoRC_Header*)malloc(total_size);
@@ -142,9 +735,11 @@ void* ZenoRC_allocObject(size_t size, const char* type_name) {
     
     // Initialize header
     header->ref_count = 1;
+    header->flags = ZENO_RC_OWNS_NAME;
     header->deinit = ZenoRC_getDeinit(type_name);
     header->size = size;
     header->type_name = strdup(type_name);
+    header->trace = NULL;
     
     // Get pointer to object memory (after header)
     void* object_ptr = (void*)(header + 1);
@@ -153,7 +748,10 @@ void* ZenoRC_allocObject(size_t size, const char* type_name) {
     memset(object_ptr, 0, size);
     
 #ifdef ZENO_ARC_STATS
-    update_alloc_stats(total_size);
+    ZenoRC_recordAlloc(type_name, total_size, file, line);
+#else
+    (void)file;
+    (void)line;
 #endif
     
     if (ZENO_ARC_DEBUG) {
@@ -164,20 +762,29 @@ void* ZenoRC_allocObject(size_t size, const char* type_name) {
     return object_ptr;
 }
 
+// Allocate an object with automatic reference counting
+// (parenthesized so the ZENO_ARC_STATS call-site macro does not apply)
+void* (ZenoRC_allocObject)(size_t size, const char* type_name) {
+    return ZenoRC_allocObjectAt(size, type_name, NULL, 0);
+}
+
 // Retain an object (increment its reference count)
 void ZenoRC_retainObject(void* ptr) {
     if (!ptr) return;
     
     ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
-    header->ref_count++;
+#ifdef ZENO_ARC_CYCLES
+    ZenoRC_checkTrial(header);
+#endif
+    int count = __atomic_add_fetch(&header->ref_count, 1, __ATOMIC_RELAXED);
     
 #ifdef ZENO_ARC_STATS
-    update_retain_stats();
+    ZENO_RC_STAT_ADD(retains, 1);
 #endif
     
     if (ZENO_ARC_DEBUG) {
         printf("ZenoRC: Retained %s at %p (count: %d)\n", 
-               header->type_name, ptr, header->ref_count);
+               header->type_name, ptr, count);
     }
 }
 
@@ -186,31 +793,51 @@ void ZenoRC_releaseObject(void* ptr) {
     if (!ptr) return;
     
     ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
-    header->ref_count--;
+#ifdef ZENO_ARC_CYCLES
+    ZenoRC_checkTrial(header);
+#endif
+    int count = __atomic_sub_fetch(&header->ref_count, 1, __ATOMIC_ACQ_REL);
     
 #ifdef ZENO_ARC_STATS
-    update_release_stats();
+    ZENO_RC_STAT_ADD(releases, 1);
 #endif
     
     if (ZENO_ARC_DEBUG) {
         printf("ZenoRC: Released %s at %p (count: %d)\n", 
-               header->type_name, ptr, header->ref_count);
+               header->type_name, ptr, count);
     }
     
-    if (header->ref_count == 0) {
+#ifdef ZENO_ARC_CYCLES
+    // The cycle collector owns the lifetime of objects it is freeing
+    if (ZenoRC_flags(header) & ZENO_RC_COLLECTING) return;
+#endif
+    
+    if (count == 0) {
         if (ZENO_ARC_DEBUG) {
             printf("ZenoRC: Deallocating %s at %p\n", header->type_name, ptr);
         }
         
+        // Weak references must see the object as dead before deinit runs
+        if (__atomic_load_n(&header->flags, __ATOMIC_ACQUIRE) & ZENO_RC_WEAK) {
+            ZenoRC_clearWeakRefs(ptr);
+        }
+        
         // Call custom destructor if provided
         if (header->deinit) {
             header->deinit(ptr);
         }
         
-        size_t total_size = sizeof(ZenoRC_Header) + header->size;
+#ifdef ZENO_ARC_CYCLES
+        // Still referenced from the roots buffer; the collector frees it later
+        if (ZenoRC_flags(header) & ZENO_RC_BUFFERED) {
+            ZenoRC_clearFlags(header, ZENO_RC_COLOR_MASK);
+            ZenoRC_setFlags(header, ZENO_RC_FINALIZED);
+            return;
+        }
+#endif
         
 #ifdef ZENO_ARC_STATS
-        update_dealloc_stats(total_size);
+        ZenoRC_recordFree(header->type_name, sizeof(ZenoRC_Header) + header->size);
 #endif
         
         // Free the type name
@@ -218,9 +845,15 @@ void ZenoRC_releaseObject(void* ptr) {
         
         // Free the memory
         free(header);
-    } else if (header->ref_count < 0) {
+    } else if (count > 0) {
+#ifdef ZENO_ARC_CYCLES
+        if (header->trace) {
+            ZenoRC_possibleRoot(ptr);
+        }
+#endif
+    } else {
         fprintf(stderr, "ZenoRC: Error - negative reference count for %s at %p (%d)\n", 
-                header->type_name, ptr, header->ref_count);
+                header->type_name, ptr, count);
     }
 }
 
@@ -257,9 +890,613 @@ void* ZenoRC_createArray(size_t elem_size, size_t count, const char* elem_type)
     char type_name[256];
     snprintf(type_name, sizeof(type_name), "Array<%s>", elem_type);
     
-    return ZenoRC_allocObject(total_size, type_name);
+    void* array = ZenoRC_allocObject(total_size, type_name);
+    
+    // Arrays have value semantics, copies share storage until written
+    ZenoRC_Header* header = ((ZenoRC_Header*)array) - 1;
+    ZenoRC_setFlags(header, ZENO_RC_COW);
+    
+    return array;
+}
+
+#ifdef ZENO_ARC_CYCLES
+/**
+ * Cycle collector
+ *
+ * Synchronous trial deletion after Bacon and Rajan, "Concurrent Cycle
+ * Collection in Reference Counted Systems" (2001). Objects released to a
+ * non-zero count are possible cycle roots. A trial takes a batch of roots,
+ * subtracts the references internal to the subgraph they reach (mark gray),
+ * restores everything still referenced from outside (scan black) and frees
+ * what is left (collect white). Graph walks use explicit stacks so long
+ * chains cannot overflow the C stack.
+ *
+ * Every phase of a trial stops once the slice is out of time and carries on
+ * in the next slice; the work stacks and the gray and white lists are kept
+ * in between. Until the survivors are settled, the counts of the objects
+ * the trial reached are not exact, and the mutator touching one of them
+ * undoes the trial (ZenoRC_trialBarrier). After that only garbage is left
+ * in the trial, and garbage can only be reached through a weak reference,
+ * which are all cleared before the first deinit runs.
+ */
+
+// Largest number of roots tried together in one batch
+#define ZENO_RC_CYCLE_BATCH 64
+
+// Objects handled between budget checks
+#define ZENO_RC_CYCLE_STEP 64
+
+// Default trigger: run a 1ms slice once this many roots are buffered
+#define ZENO_RC_CYCLE_THRESHOLD 10000
+#define ZENO_RC_CYCLE_SLICE_US 1000
+
+typedef struct {
+    void** items;
+    size_t count;
+    size_t capacity;
+} ZenoRC_PtrVec;
+
+// Phases of a trial, in order
+typedef enum {
+    ZENO_RC_PHASE_IDLE,           // No trial in progress
+    ZENO_RC_PHASE_MARK,           // Mark gray from each root
+    ZENO_RC_PHASE_SCAN,           // Scan from each root
+    ZENO_RC_PHASE_GATHER,         // Give the garbage's children their counts back
+    ZENO_RC_PHASE_SETTLE,         // Survivors leave the trial
+    ZENO_RC_PHASE_FINALIZE,       // Run the garbage's deinit functions
+    ZENO_RC_PHASE_FREE            // Free the garbage
+} ZenoRC_Phase;
+
+// The trial in progress
+typedef struct {
+    ZenoRC_Phase phase;
+    size_t first;                 // Its roots are roots[first, end)
+    size_t end;
+    size_t next;                  // Next root, gray or white entry for the phase
+} ZenoRC_Trial;
+
+static ZenoRC_PtrVec zeno_rc_roots = {0};      // Possible roots, oldest first
+static size_t zeno_rc_roots_head = 0;          // First unprocessed root
+static ZenoRC_PtrVec zeno_rc_stack = {0};      // Work stack for graph walks
+static ZenoRC_PtrVec zeno_rc_black_stack = {0};
+static ZenoRC_PtrVec zeno_rc_gray = {0};       // Every object the trial reached
+static ZenoRC_PtrVec zeno_rc_white = {0};      // Garbage found by the trial
+static ZenoRC_PtrVec zeno_rc_weak_white = {0}; // The part of it with weak references
+static ZenoRC_Trial zeno_rc_trial = {0};
+static size_t zeno_rc_batch = ZENO_RC_CYCLE_BATCH;  // Roots in the next batch
+static ZenoRC_CycleStats zeno_rc_cycle_stats = {0};
+static size_t zeno_rc_cycle_threshold = ZENO_RC_CYCLE_THRESHOLD;
+static uint64_t zeno_rc_cycle_slice_us = ZENO_RC_CYCLE_SLICE_US;
+static bool zeno_rc_collecting = false;
+static bool zeno_rc_cycle_claimed = false;               // Some thread owns the collector
+static _Thread_local bool zeno_rc_cycle_owner = false;  // This thread owns it
+
+static inline ZenoRC_Header* rc_header(void* ptr) {
+    return ((ZenoRC_Header*)ptr) - 1;
+}
+
+static inline unsigned int rc_color(ZenoRC_Header* header) {
+    return ZenoRC_flags(header) & ZENO_RC_COLOR_MASK;
+}
+
+// Only the collector reads colors, so the two steps need not be one
+static inline void rc_set_color(ZenoRC_Header* header, unsigned int color) {
+    ZenoRC_clearFlags(header, ZENO_RC_COLOR_MASK & ~color);
+    ZenoRC_setFlags(header, color);
+}
+
+static void ptrvec_push(ZenoRC_PtrVec* vec, void* ptr) {
+    if (vec->count == vec->capacity) {
+        size_t capacity = vec->capacity ? vec->capacity * 2 : 256;
+        void** items = (void**)realloc(vec->items, capacity * sizeof(void*));
+        if (!items) {
+            fprintf(stderr, "ZenoRC: Memory allocation failed for cycle collector\n");
+            exit(1);
+        }
+        vec->items = items;
+        vec->capacity = capacity;
+    }
+    vec->items[vec->count++] = ptr;
+}
+
+static inline void* ptrvec_pop(ZenoRC_PtrVec* vec) {
+    return vec->count ? vec->items[--vec->count] : NULL;
+}
+
+static void ptrvec_free(ZenoRC_PtrVec* vec) {
+    free(vec->items);
+    vec->items = NULL;
+    vec->count = 0;
+    vec->capacity = 0;
+}
+
+static uint64_t rc_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Time limit for the slice
+typedef struct {
+    uint64_t deadline;            // When the slice has to end
+    size_t steps;                 // Objects handled so far
+} ZenoRC_Budget;
+
+// Count one object handled; true once the slice is out of time
+static inline bool rc_out_of_time(ZenoRC_Budget* budget) {
+    return ++budget->steps % ZENO_RC_CYCLE_STEP == 0 && rc_now_ns() >= budget->deadline;
+}
+
+// Trial deletion decrements counts without atomics, so every count it can
+// touch has to belong to the thread running it
+static void rc_check_thread(void) {
+    if (zeno_rc_cycle_owner) return;
+    
+    bool claimed = false;
+    if (__atomic_compare_exchange_n(&zeno_rc_cycle_claimed, &claimed, true, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        zeno_rc_cycle_owner = true;
+        return;
+    }
+    fprintf(stderr, "ZenoRC: Error - the cycle collector supports a single mutator thread, "
+                    "but objects with a trace function were released on a second thread\n");
+    abort();
+}
+
+// Release the header memory of an object whose deinit has already run
+static void rc_free_header(ZenoRC_Header* header) {
+    zeno_rc_cycle_stats.objects_collected++;
+    zeno_rc_cycle_stats.bytes_collected += sizeof(ZenoRC_Header) + header->size;
+    
+#ifdef ZENO_ARC_STATS
+    ZenoRC_recordFree(header->type_name, sizeof(ZenoRC_Header) + header->size);
+#endif
+    
+    if (ZenoRC_flags(header) & ZENO_RC_OWNS_NAME) {
+        free((void*)header->type_name);
+    }
+    free(header);
+}
+
+static size_t rc_collect_slice(uint64_t budget_us);
+
+// Buffer an object whose count was decremented to a non-zero value
+void ZenoRC_possibleRoot(void* ptr) {
+    ZenoRC_Header* header = rc_header(ptr);
+    if (ZenoRC_flags(header) & ZENO_RC_COLLECTING) return;
+    rc_check_thread();
+    
+    if (rc_color(header) != ZENO_RC_PURPLE) {
+        rc_set_color(header, ZENO_RC_PURPLE);
+        if (!(ZenoRC_flags(header) & ZENO_RC_BUFFERED)) {
+            ZenoRC_setFlags(header, ZENO_RC_BUFFERED);
+            ptrvec_push(&zeno_rc_roots, ptr);
+        }
+    }
+    
+    if (!zeno_rc_collecting &&
+        zeno_rc_roots.count - zeno_rc_roots_head >= zeno_rc_cycle_threshold) {
+        rc_collect_slice(zeno_rc_cycle_slice_us);
+    }
+}
+
+// Mark gray: subtract every reference internal to the subgraph
+static void rc_mark_gray(void* ptr) {
+    ZenoRC_Header* header = rc_header(ptr);
+    rc_set_color(header, ZENO_RC_GRAY);
+    ZenoRC_setFlags(header, ZENO_RC_TRIAL);
+    ptrvec_push(&zeno_rc_stack, ptr);
+    ptrvec_push(&zeno_rc_gray, ptr);
+}
+
+static void visit_mark_gray(void* child) {
+    ZenoRC_Header* header = rc_header(child);
+    header->ref_count--;
+    if (rc_color(header) != ZENO_RC_GRAY) {
+        rc_mark_gray(child);
+    }
+}
+
+// Returns false, leaving the rest for the next slice, once out of time
+static bool mark_gray(ZenoRC_Budget* budget) {
+    ZenoRC_Trial* trial = &zeno_rc_trial;
+    for (;;) {
+        void* ptr = ptrvec_pop(&zeno_rc_stack);
+        if (!ptr) {
+            if (trial->next == trial->end) return true;
+            
+            void* root = zeno_rc_roots.items[trial->next++];
+            if (rc_color(rc_header(root)) != ZENO_RC_GRAY) {
+                rc_mark_gray(root);
+            }
+            continue;
+        }
+        
+        ZenoRC_Header* header = rc_header(ptr);
+        if (header->trace) {
+            header->trace(ptr, visit_mark_gray);
+        }
+        if (rc_out_of_time(budget)) return false;
+    }
+}
+
+static void visit_restore(void* child) {
+    rc_header(child)->ref_count++;
+}
+
+// Scan black: restore the references of everything still externally reachable
+static void visit_scan_black(void* child) {
+    ZenoRC_Header* header = rc_header(child);
+    header->ref_count++;
+    if (rc_color(header) != ZENO_RC_BLACK) {
+        rc_set_color(header, ZENO_RC_BLACK);
+        ptrvec_push(&zeno_rc_black_stack, child);
+    }
+}
+
+static void visit_push(void* child) {
+    ptrvec_push(&zeno_rc_stack, child);
+}
+
+// Gray objects left with a count are referenced from outside and scanned
+// black, the others turn white. Returns false once out of time.
+static bool scan(ZenoRC_Budget* budget) {
+    ZenoRC_Trial* trial = &zeno_rc_trial;
+    for (;;) {
+        // Objects colored black have their children restored before the
+        // scan goes on, as a nested scan black would
+        void* ptr = ptrvec_pop(&zeno_rc_black_stack);
+        if (ptr) {
+            ZenoRC_Header* header = rc_header(ptr);
+            if (header->trace) {
+                header->trace(ptr, visit_scan_black);
+            }
+        } else if ((ptr = ptrvec_pop(&zeno_rc_stack))) {
+            ZenoRC_Header* header = rc_header(ptr);
+            if (rc_color(header) != ZENO_RC_GRAY) continue;
+            
+            if (header->ref_count > 0) {
+                rc_set_color(header, ZENO_RC_BLACK);
+                ptrvec_push(&zeno_rc_black_stack, ptr);
+                continue;
+            }
+            rc_set_color(header, ZENO_RC_WHITE);
+            if (header->trace) {
+                header->trace(ptr, visit_push);
+            }
+        } else if (trial->next < trial->end) {
+            ptrvec_push(&zeno_rc_stack, zeno_rc_roots.items[trial->next++]);
+            continue;
+        } else {
+            return true;
+        }
+        if (rc_out_of_time(budget)) return false;
+    }
+}
+
+// Collect white: put back the counts trial deletion took from the garbage's
+// children, so deinit functions can release them normally. Releases between
+// garbage objects are ignored because they carry ZENO_RC_COLLECTING.
+static bool gather_white(ZenoRC_Budget* budget) {
+    ZenoRC_Trial* trial = &zeno_rc_trial;
+    while (trial->next < zeno_rc_gray.count) {
+        if (rc_out_of_time(budget)) return false;
+        
+        void* ptr = zeno_rc_gray.items[trial->next++];
+        ZenoRC_Header* header = rc_header(ptr);
+        if (rc_color(header) != ZENO_RC_WHITE) continue;
+        
+        ZenoRC_setFlags(header, ZENO_RC_COLLECTING);
+        if (header->trace) {
+            header->trace(ptr, visit_restore);
+        }
+        ptrvec_push(&zeno_rc_white, ptr);
+        if (ZenoRC_flags(header) & ZENO_RC_WEAK) {
+            ptrvec_push(&zeno_rc_weak_white, ptr);
+        }
+    }
+    return true;
+}
+
+// Every count is exact again; what survived leaves the trial
+static bool settle(ZenoRC_Budget* budget) {
+    ZenoRC_Trial* trial = &zeno_rc_trial;
+    while (trial->next < zeno_rc_gray.count) {
+        if (rc_out_of_time(budget)) return false;
+        
+        ZenoRC_Header* header = rc_header(zeno_rc_gray.items[trial->next++]);
+        if (!(ZenoRC_flags(header) & ZENO_RC_COLLECTING)) {
+            ZenoRC_clearFlags(header, ZENO_RC_TRIAL);
+        }
+    }
+    return true;
 }
 
+static bool finalize_white(ZenoRC_Budget* budget) {
+    ZenoRC_Trial* trial = &zeno_rc_trial;
+    while (trial->next < zeno_rc_white.count) {
+        if (rc_out_of_time(budget)) return false;
+        
+        void* ptr = zeno_rc_white.items[trial->next++];
+        ZenoRC_Header* header = rc_header(ptr);
+        if (header->deinit && !(ZenoRC_flags(header) & ZENO_RC_FINALIZED)) {
+            ZenoRC_setFlags(header, ZENO_RC_FINALIZED);
+            header->deinit(ptr);
+        }
+    }
+    return true;
+}
+
+static bool free_white(ZenoRC_Budget* budget) {
+    ZenoRC_Trial* trial = &zeno_rc_trial;
+    while (trial->next < zeno_rc_white.count) {
+        if (rc_out_of_time(budget)) return false;
+        
+        ZenoRC_Header* header = rc_header(zeno_rc_white.items[trial->next++]);
+        if (ZenoRC_flags(header) & ZENO_RC_BUFFERED) {
+            // A later batch still points at it; freed when that root is drained
+            rc_set_color(header, ZENO_RC_BLACK);
+            ZenoRC_clearFlags(header, ZENO_RC_COLLECTING | ZENO_RC_TRIAL);
+            ZenoRC_setFlags(header, ZENO_RC_FINALIZED);
+            header->ref_count = 0;
+        } else {
+            rc_free_header(header);
+        }
+    }
+    return true;
+}
+
+// Start a trial over the next batch of roots. Roots that are no longer
+// candidates are dropped and the rest packed at the end of the batch.
+static void trial_start(void) {
+    void** roots = zeno_rc_roots.items;
+    size_t end = zeno_rc_roots_head + zeno_rc_batch;
+    if (end > zeno_rc_roots.count) {
+        end = zeno_rc_roots.count;
+    }
+    
+    size_t live = end;
+    for (size_t i = end; i-- > zeno_rc_roots_head;) {
+        void* ptr = roots[i];
+        ZenoRC_Header* header = rc_header(ptr);
+        
+        if (rc_color(header) == ZENO_RC_PURPLE && header->ref_count > 0) {
+            roots[--live] = ptr;
+        } else {
+            ZenoRC_clearFlags(header, ZENO_RC_BUFFERED);
+            if (header->ref_count == 0 && (ZenoRC_flags(header) & ZENO_RC_FINALIZED)) {
+                rc_free_header(header);
+            }
+        }
+    }
+    
+    zeno_rc_roots_head = live;
+    zeno_rc_trial.phase = ZENO_RC_PHASE_MARK;
+    zeno_rc_trial.first = live;
+    zeno_rc_trial.end = end;
+    zeno_rc_trial.next = live;
+}
+
+// Advance the trial; returns true once it is complete
+static bool trial_run(ZenoRC_Budget* budget) {
+    ZenoRC_Trial* trial = &zeno_rc_trial;
+    switch (trial->phase) {
+    case ZENO_RC_PHASE_IDLE:
+        return true;
+        
+    case ZENO_RC_PHASE_MARK:
+        if (!mark_gray(budget)) return false;
+        trial->phase = ZENO_RC_PHASE_SCAN;
+        trial->next = trial->first;
+        // fall through
+        
+    case ZENO_RC_PHASE_SCAN:
+        if (!scan(budget)) return false;
+        trial->phase = ZENO_RC_PHASE_GATHER;
+        trial->next = 0;
+        // fall through
+        
+    case ZENO_RC_PHASE_GATHER:
+        if (!gather_white(budget)) return false;
+        trial->phase = ZENO_RC_PHASE_SETTLE;
+        trial->next = 0;
+        // fall through
+        
+    case ZENO_RC_PHASE_SETTLE:
+        if (!settle(budget)) return false;
+        
+        // The roots leave the buffer, and the garbage is dead to weak
+        // references before any deinit runs
+        for (size_t i = trial->first; i < trial->end; i++) {
+            ZenoRC_clearFlags(rc_header(zeno_rc_roots.items[i]), ZENO_RC_BUFFERED);
+        }
+        for (size_t i = 0; i < zeno_rc_weak_white.count; i++) {
+            ZenoRC_clearWeakRefs(zeno_rc_weak_white.items[i]);
+        }
+        zeno_rc_weak_white.count = 0;
+        trial->phase = ZENO_RC_PHASE_FINALIZE;
+        trial->next = 0;
+        // fall through
+        
+    case ZENO_RC_PHASE_FINALIZE:
+        if (!finalize_white(budget)) return false;
+        trial->phase = ZENO_RC_PHASE_FREE;
+        trial->next = 0;
+        // fall through
+        
+    case ZENO_RC_PHASE_FREE:
+        if (!free_white(budget)) return false;
+        zeno_rc_gray.count = 0;
+        zeno_rc_white.count = 0;
+        trial->phase = ZENO_RC_PHASE_IDLE;
+        return true;
+    }
+    return true;
+}
+
+// An object leaves an abandoned trial; buffered objects stay candidates
+static void rc_leave_trial(void* ptr) {
+    ZenoRC_Header* header = rc_header(ptr);
+    ZenoRC_clearFlags(header, ZENO_RC_TRIAL | ZENO_RC_COLLECTING);
+    rc_set_color(header, (ZenoRC_flags(header) & ZENO_RC_BUFFERED) ? ZENO_RC_PURPLE : ZENO_RC_BLACK);
+}
+
+// Undo a suspended trial: put back the counts it subtracted and the colors
+// and flags it changed. Its roots stay buffered. A batch is retried one
+// root at a time, and a single root goes to the back of the buffer so the
+// roots behind it are not held up.
+static void trial_undo(void) {
+    ZenoRC_Trial* trial = &zeno_rc_trial;
+    
+    // Objects still on the mark stack were colored but not traced
+    void* ptr;
+    while ((ptr = ptrvec_pop(&zeno_rc_stack))) {
+        if (trial->phase == ZENO_RC_PHASE_MARK) {
+            rc_set_color(rc_header(ptr), ZENO_RC_BLACK);
+        }
+    }
+    
+    // Objects waiting to be scanned black still have their children subtracted
+    while ((ptr = ptrvec_pop(&zeno_rc_black_stack))) {
+        rc_set_color(rc_header(ptr), ZENO_RC_GRAY);
+    }
+    
+    // Survivors already settled have exact counts and may have been freed;
+    // the garbage among them is in the white list
+    size_t from = trial->phase == ZENO_RC_PHASE_SETTLE ? trial->next : 0;
+    for (size_t i = from; i < zeno_rc_gray.count; i++) {
+        ZenoRC_Header* header = rc_header(zeno_rc_gray.items[i]);
+        unsigned int color = rc_color(header);
+        bool subtracted = color == ZENO_RC_GRAY ||
+                          (color == ZENO_RC_WHITE && !(ZenoRC_flags(header) & ZENO_RC_COLLECTING));
+        if (subtracted && header->trace) {
+            header->trace(zeno_rc_gray.items[i], visit_restore);
+        }
+    }
+    
+    for (size_t i = from; i < zeno_rc_gray.count; i++) {
+        rc_leave_trial(zeno_rc_gray.items[i]);
+    }
+    for (size_t i = 0; i < zeno_rc_white.count; i++) {
+        rc_leave_trial(zeno_rc_white.items[i]);
+    }
+    zeno_rc_gray.count = 0;
+    zeno_rc_white.count = 0;
+    zeno_rc_weak_white.count = 0;
+    
+    if (trial->end - trial->first > 1) {
+        zeno_rc_batch = 1;
+    } else if (trial->end > trial->first) {
+        ptrvec_push(&zeno_rc_roots, zeno_rc_roots.items[trial->first]);
+        zeno_rc_roots_head = trial->first + 1;
+    }
+    trial->phase = ZENO_RC_PHASE_IDLE;
+    zeno_rc_cycle_stats.trials_cancelled++;
+}
+
+// The mutator is about to use an object the suspended trial reached
+void ZenoRC_trialBarrier(void* ptr) {
+    (void)ptr;
+    rc_check_thread();
+    
+    // Once the survivors are settled only unreachable garbage is left in the
+    // trial, released by its own deinit functions
+    if (zeno_rc_trial.phase == ZENO_RC_PHASE_IDLE || zeno_rc_trial.phase >= ZENO_RC_PHASE_FINALIZE) {
+        return;
+    }
+    trial_undo();
+}
+
+static size_t rc_collect_slice(uint64_t budget_us) {
+    if (zeno_rc_collecting) {
+        return zeno_rc_roots.count - zeno_rc_roots_head;
+    }
+    
+    zeno_rc_collecting = true;
+    uint64_t start = rc_now_ns();
+    ZenoRC_Budget budget = {
+        budget_us < (UINT64_MAX - start) / 1000ull ? start + budget_us * 1000ull : UINT64_MAX, 0
+    };
+    
+    for (;;) {
+        if (zeno_rc_trial.phase == ZENO_RC_PHASE_IDLE) {
+            if (zeno_rc_roots_head == zeno_rc_roots.count) break;
+            trial_start();
+        }
+        if (!trial_run(&budget)) break;
+        
+        zeno_rc_roots_head = zeno_rc_trial.end;
+        if (zeno_rc_batch < ZENO_RC_CYCLE_BATCH) {
+            zeno_rc_batch *= 2;
+        }
+        if (rc_now_ns() >= budget.deadline) break;
+    }
+    
+    // Compact the buffer once it has been drained
+    if (zeno_rc_roots_head == zeno_rc_roots.count) {
+        zeno_rc_roots.count = 0;
+        zeno_rc_roots_head = 0;
+    }
+    
+    uint64_t pause = rc_now_ns() - start;
+    zeno_rc_cycle_stats.slices++;
+    zeno_rc_cycle_stats.total_pause_ns += pause;
+    zeno_rc_cycle_stats.last_pause_ns = pause;
+    if (pause > zeno_rc_cycle_stats.max_pause_ns) {
+        zeno_rc_cycle_stats.max_pause_ns = pause;
+    }
+    
+    zeno_rc_collecting = false;
+    return zeno_rc_roots.count - zeno_rc_roots_head;
+}
+
+static void rc_collect_all(void) {
+    if (zeno_rc_collecting) return;
+    
+    while (rc_collect_slice(UINT64_MAX / 1000ull) > 0) {
+    }
+}
+
+// Run one bounded slice of cycle collection, returns the roots still buffered
+size_t ZenoRC_collectCyclesSlice(uint64_t budget_us) {
+    rc_check_thread();
+    return rc_collect_slice(budget_us);
+}
+
+// Collect every buffered root, however long it takes
+void ZenoRC_collectCycles(void) {
+    rc_check_thread();
+    rc_collect_all();
+}
+
+// Configure when possible roots trigger an automatic slice (0 disables it)
+void ZenoRC_setCycleTrigger(size_t root_threshold, uint64_t slice_budget_us) {
+    zeno_rc_cycle_threshold = root_threshold ? root_threshold : SIZE_MAX;
+    zeno_rc_cycle_slice_us = slice_budget_us;
+}
+
+// Get cycle collector statistics
+ZenoRC_CycleStats ZenoRC_getCycleStats(void) {
+    ZenoRC_CycleStats stats = zeno_rc_cycle_stats;
+    stats.roots_buffered = zeno_rc_roots.count - zeno_rc_roots_head;
+    return stats;
+}
+
+// Print cycle collector statistics
+void ZenoRC_printCycleStats(void) {
+    ZenoRC_CycleStats stats = ZenoRC_getCycleStats();
+    printf("Zeno ARC Cycle Collector:\n");
+    printf("  Slices:             %zu\n", stats.slices);
+    printf("  Roots buffered:     %zu\n", stats.roots_buffered);
+    printf("  Trials cancelled:   %zu\n", stats.trials_cancelled);
+    printf("  Objects collected:  %zu\n", stats.objects_collected);
+    printf("  Bytes collected:    %zu bytes\n", stats.bytes_collected);
+    printf("  Total pause:        %.3f ms\n", stats.total_pause_ns / 1e6);
+    printf("  Max pause:          %.3f ms\n", stats.max_pause_ns / 1e6);
+    printf("  Last pause:         %.3f ms\n", stats.last_pause_ns / 1e6);
+}
+#endif
+
 // Initialize the ARC system
 void ZenoRC_initialize() {
     if (ZENO_ARC_DEBUG) {
@@ -272,8 +1509,11 @@ void ZenoRC_initialize() {
     ZenoRC_registerDeinit("String", NULL);
     
 #ifdef ZENO_ARC_STATS
-    // Reset statistics
-    memset(&zeno_rc_stats, 0, sizeof(ZenoRC_Stats));
+    // Optional call-site sampling, e.g. ZENO_ARC_SAMPLE_BYTES=65536
+    const char* sample_bytes = getenv("ZENO_ARC_SAMPLE_BYTES");
+    if (sample_bytes) {
+        ZenoRC_setSampleInterval((size_t)strtoull(sample_bytes, NULL, 10));
+    }
 #endif
 }
 
@@ -283,9 +1523,36 @@ void ZenoRC_shutdown() {
         printf("ZenoRC: Shutting down automatic reference counting system\n");
     }
     
+#ifdef ZENO_ARC_CYCLES
+    // Reclaim any cycles still waiting in the roots buffer. This runs on
+    // whichever thread exits, so it skips the owner check.
+    rc_collect_all();
+    ptrvec_free(&zeno_rc_roots);
+    ptrvec_free(&zeno_rc_stack);
+    ptrvec_free(&zeno_rc_black_stack);
+    ptrvec_free(&zeno_rc_white);
+    ptrvec_free(&zeno_rc_gray);
+    ptrvec_free(&zeno_rc_weak_white);
+#endif
+    
 #ifdef ZENO_ARC_STATS
     // Print final statistics
     ZenoRC_printStats();
+    
+    // Write the full, diffable report if requested
+    const char* report_path = getenv("ZENO_ARC_STATS_REPORT");
+    if (report_path) {
+        FILE* report = fopen(report_path, "w");
+        if (report) {
+            ZenoRC_writeStatsReport(report);
+            fclose(report);
+        } else {
+            fprintf(stderr, "ZenoRC: Could not write statistics report to %s\n", report_path);
+        }
+    }
+#ifdef ZENO_ARC_CYCLES
+    ZenoRC_printCycleStats();
+#endif
 #endif
     
     // Clean up type registry
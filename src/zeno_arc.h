@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
 /**
@@ -14,21 +15,175 @@
  * and custom deinitializers.
  */
 
+// Callback handed to trace functions; called once per ZenoRC child reference
+typedef void (*ZenoRC_Visitor)(void* child);
+
 // Header structure for reference counted objects
 typedef struct {
     int ref_count;                // Number of references to this object
+    unsigned int flags;           // ZENO_RC_* bookkeeping bits
     void (*deinit)(void*);        // Custom deinitializer function
     size_t size;                  // Size of the managed object
     const char* type_name;        // Type name for debugging
+    void (*trace)(void*, ZenoRC_Visitor); // Reports children to the cycle collector
 } ZenoRC_Header;
 
+// Header flag bits. The low two bits hold the cycle collector color.
+#define ZENO_RC_COLOR_MASK   0x03u
+#define ZENO_RC_BLACK        0x00u  // In use or free
+#define ZENO_RC_GRAY         0x01u  // Possible member of a cycle
+#define ZENO_RC_WHITE        0x02u  // Member of a garbage cycle
+#define ZENO_RC_PURPLE       0x03u  // Possible root of a cycle
+#define ZENO_RC_BUFFERED     0x04u  // Object is in the possible-roots buffer
+#define ZENO_RC_OWNS_NAME    0x08u  // type_name was strdup'd and must be freed
+#define ZENO_RC_FINALIZED    0x10u  // deinit already ran, only the memory is left
+#define ZENO_RC_COLLECTING   0x20u  // Object is being freed by the cycle collector
+#define ZENO_RC_COW          0x40u  // Copies share storage until the first write
+#define ZENO_RC_WEAK         0x80u  // Object has an entry in the weak reference table
+#define ZENO_RC_TRIAL        0x100u // Count is part of a suspended cycle collector trial
+
+// Flags of an object other threads can see are only changed with atomic
+// read-modify-writes: the weak reference table sets and clears ZENO_RC_WEAK
+// from any thread, and a plain `flags |= bit` elsewhere could drop it.
+static inline unsigned int ZenoRC_flags(ZenoRC_Header* header) {
+    return __atomic_load_n(&header->flags, __ATOMIC_RELAXED);
+}
+
+static inline void ZenoRC_setFlags(ZenoRC_Header* header, unsigned int bits) {
+    __atomic_fetch_or(&header->flags, bits, __ATOMIC_RELAXED);
+}
+
+static inline void ZenoRC_clearFlags(ZenoRC_Header* header, unsigned int bits) {
+    __atomic_fetch_and(&header->flags, ~bits, __ATOMIC_RELAXED);
+}
+
+#ifdef ZENO_ARC_CYCLES
+/**
+ * Optional cycle collector (Bacon-Rajan trial deletion).
+ *
+ * Objects that can take part in a cycle register a trace function with
+ * ZenoRC_setTrace. Whenever such an object is released to a non-zero count it
+ * is buffered as a possible cycle root. Buffered roots are processed in
+ * slices with a time budget, so collector pauses stay bounded. A trial that
+ * does not finish within a slice carries on in the next one, so a root that
+ * reaches a large subgraph is collected over as many slices as it takes.
+ * Objects without a trace function are treated as acyclic and never buffered.
+ *
+ * While a trial is suspended, the objects it reached carry ZENO_RC_TRIAL and
+ * their counts lack their internal references. Retaining, releasing,
+ * upgrading a weak reference to, or reading the count of such an object
+ * calls ZenoRC_trialBarrier first, which abandons the trial if it still
+ * depends on those counts.
+ *
+ * The collector needs a single mutator thread: objects with a trace function
+ * must only be retained and released on one thread, which also runs the
+ * collector. The first thread to buffer a root or run a slice owns the
+ * collector; any other thread that does either is reported and aborts.
+ */
+typedef struct {
+    size_t slices;                // Number of collection slices run
+    size_t roots_buffered;        // Possible roots currently waiting
+    size_t trials_cancelled;      // Suspended trials abandoned because the mutator used their objects
+    size_t objects_collected;     // Objects freed as cycle garbage
+    size_t bytes_collected;       // Bytes freed as cycle garbage (headers included)
+    uint64_t total_pause_ns;      // Time spent in the collector
+    uint64_t max_pause_ns;        // Longest single slice
+    uint64_t last_pause_ns;       // Most recent slice
+} ZenoRC_CycleStats;
+
+void ZenoRC_possibleRoot(void* ptr);
+void ZenoRC_trialBarrier(void* ptr);
+size_t ZenoRC_collectCyclesSlice(uint64_t budget_us);
+void ZenoRC_collectCycles(void);
+void ZenoRC_setCycleTrigger(size_t root_threshold, uint64_t slice_budget_us);
+ZenoRC_CycleStats ZenoRC_getCycleStats(void);
+void ZenoRC_printCycleStats(void);
+
+// Call before the count of an object is read or changed
+static inline void ZenoRC_checkTrial(ZenoRC_Header* header) {
+    if (ZenoRC_flags(header) & ZENO_RC_TRIAL) {
+        ZenoRC_trialBarrier(header + 1);
+    }
+}
+#endif
+
+#ifdef ZENO_ARC_STATS
+/**
+ * Optional allocation statistics and profiler.
+ *
+ * Each thread updates its own shard of counters, so the fast paths never
+ * contend; readers sum all shards. Allocations and frees are also counted
+ * per type name. With a sample interval set (ZenoRC_setSampleInterval or the
+ * ZENO_ARC_SAMPLE_BYTES environment variable), one allocation every N bytes
+ * records its call site. ZenoRC_writeStatsReport prints everything in a
+ * stable, sorted text format meant to be diffed between builds; set
+ * ZENO_ARC_STATS_REPORT to a path to write it at shutdown.
+ */
+typedef struct {
+    size_t total_allocations;     // Total number of allocations
+    size_t active_allocations;    // Current active allocations
+    size_t total_memory;          // Total memory allocated (in bytes)
+    size_t active_memory;         // Current active memory (in bytes)
+    size_t total_retains;         // Total number of retain operations
+    size_t total_releases;        // Total number of release operations
+} ZenoRC_Stats;
+
+// Counters owned by one thread; only that thread writes them
+typedef struct {
+    size_t allocations;
+    size_t deallocations;
+    size_t bytes_allocated;
+    size_t bytes_freed;
+    size_t retains;
+    size_t releases;
+} ZenoRC_StatsCounters;
+
+extern _Thread_local ZenoRC_StatsCounters* zeno_rc_stats_counters;
+ZenoRC_StatsCounters* ZenoRC_attachStatsShard(void);
+
+void ZenoRC_recordAlloc(const char* type_name, size_t size, const char* file, int line);
+void ZenoRC_recordFree(const char* type_name, size_t size);
+void ZenoRC_setSampleInterval(size_t bytes);
+ZenoRC_Stats ZenoRC_getStats(void);
+void ZenoRC_printStats(void);
+void ZenoRC_writeStatsReport(FILE* out);
+
+// Bump one of the calling thread's counters. Relaxed stores are enough:
+// the owner is the only writer and readers only need an approximate sum.
+#define ZENO_RC_STAT_ADD(field, n) do { \
+    ZenoRC_StatsCounters* counters_ = zeno_rc_stats_counters; \
+    if (!counters_) counters_ = ZenoRC_attachStatsShard(); \
+    __atomic_store_n(&counters_->field, counters_->field + (n), __ATOMIC_RELAXED); \
+} while (0)
+#endif
+
+/**
+ * Weak references.
+ *
+ * A weak reference does not keep its object alive. ZenoRC_weakUpgrade returns
+ * a retained pointer while the object lives and NULL once its count has
+ * reached zero. Weak references live in a side table keyed by object, so
+ * objects that never had one pay nothing beyond a header flag test when
+ * they are freed. All weak reference functions are thread-safe, and
+ * retain/release update the count atomically so upgrades cannot race with
+ * the final release.
+ */
+typedef struct ZenoRC_Weak ZenoRC_Weak;
+
+ZenoRC_Weak* ZenoRC_weakRef(void* ptr);
+ZenoRC_Weak* ZenoRC_weakCopy(ZenoRC_Weak* weak);
+void* ZenoRC_weakUpgrade(ZenoRC_Weak* weak);
+bool ZenoRC_weakIsAlive(ZenoRC_Weak* weak);
+void ZenoRC_weakRelease(ZenoRC_Weak* weak);
+void ZenoRC_clearWeakRefs(void* ptr);
+
 // Debug setting - set to true to enable debug messages
 #ifndef ZENO_ARC_DEBUG
 #define ZENO_ARC_DEBUG false
 #endif
 
-// Allocate reference counted memory
-static inline void* ZenoRC_alloc(size_t size, const char* type_name) {
+// Allocate reference counted memory, attributing it to a call site
+static inline void* ZenoRC_allocAt(size_t size, const char* type_name, const char* file, int line) {
     ZenoRC_Header* header = (ZenoRC_Header*)malloc(sizeof(ZenoRC_Header) + size);
     if (!header) {
         fprintf(stderr, "ZenoRC: Memory allocation failed for type %s\n", type_name);
@@ -36,12 +191,21 @@ static inline void* ZenoRC_alloc(size_t size, const char* type_name) {
     }
     
     header->ref_count = 1;
+    header->flags = 0;
     header->deinit = NULL;
     header->size = size;
     header->type_name = type_name;
+    header->trace = NULL;
     
     void* ptr = (void*)(header + 1);
     
+#ifdef ZENO_ARC_STATS
+    ZenoRC_recordAlloc(type_name, sizeof(ZenoRC_Header) + size, file, line);
+#else
+    (void)file;
+    (void)line;
+#endif
+    
     if (ZENO_ARC_DEBUG) {
         printf("ZenoRC: Allocated %s at %p (count: %d)\n", 
                type_name, ptr, header->ref_count);
@@ -51,17 +215,35 @@ static inline void* ZenoRC_alloc(size_t size, const char* type_name) {
     return ptr;
 }
 
+// Allocate reference counted memory
+static inline void* ZenoRC_alloc(size_t size, const char* type_name) {
+    return ZenoRC_allocAt(size, type_name, NULL, 0);
+}
+
+#ifdef ZENO_ARC_STATS
+// Record the caller's location so sampled allocations point at real call sites
+#define ZenoRC_alloc(size, type_name) ZenoRC_allocAt((size), (type_name), __FILE__, __LINE__)
+#endif
+
 // Retain (increment reference count)
 static inline void ZenoRC_retain(void* ptr) {
     if (!ptr) return;
     
     ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
-    header->ref_count++;
+#ifdef ZENO_ARC_CYCLES
+    ZenoRC_checkTrial(header);
+#endif
+    int count = __atomic_add_fetch(&header->ref_count, 1, __ATOMIC_RELAXED);
+    
+#ifdef ZENO_ARC_STATS
+    ZENO_RC_STAT_ADD(retains, 1);
+#endif
     
     if (ZENO_ARC_DEBUG) {
         printf("ZenoRC: Retained %s at %p (count: %d)\n", 
-               header->type_name, ptr, header->ref_count);
+               header->type_name, ptr, count);
     }
+    (void)count;
 }
 
 // Release (decrement reference count and free if zero)
@@ -69,28 +251,69 @@ static inline void ZenoRC_release(void* ptr) {
     if (!ptr) return;
     
     ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
-    header->ref_count--;
+#ifdef ZENO_ARC_CYCLES
+    ZenoRC_checkTrial(header);
+#endif
+    int count = __atomic_sub_fetch(&header->ref_count, 1, __ATOMIC_ACQ_REL);
+    
+#ifdef ZENO_ARC_STATS
+    ZENO_RC_STAT_ADD(releases, 1);
+#endif
     
     if (ZENO_ARC_DEBUG) {
         printf("ZenoRC: Released %s at %p (count: %d)\n", 
-               header->type_name, ptr, header->ref_count);
+               header->type_name, ptr, count);
     }
     
-    if (header->ref_count == 0) {
+#ifdef ZENO_ARC_CYCLES
+    // The cycle collector owns the lifetime of objects it is freeing
+    if (ZenoRC_flags(header) & ZENO_RC_COLLECTING) return;
+#endif
+    
+    if (count == 0) {
         if (ZENO_ARC_DEBUG) {
             printf("ZenoRC: Deallocating %s at %p\n", header->type_name, ptr);
         }
         
+        // Weak references must see the object as dead before deinit runs
+        if (__atomic_load_n(&header->flags, __ATOMIC_ACQUIRE) & ZENO_RC_WEAK) {
+            ZenoRC_clearWeakRefs(ptr);
+        }
+        
         // Call custom destructor if provided
         if (header->deinit) {
             header->deinit(ptr);
         }
         
+#ifdef ZENO_ARC_CYCLES
+        // Still referenced from the roots buffer; the collector frees it later
+        if (ZenoRC_flags(header) & ZENO_RC_BUFFERED) {
+            ZenoRC_clearFlags(header, ZENO_RC_COLOR_MASK);
+            ZenoRC_setFlags(header, ZENO_RC_FINALIZED);
+            return;
+        }
+#endif
+        
+#ifdef ZENO_ARC_STATS
+        ZenoRC_recordFree(header->type_name, sizeof(ZenoRC_Header) + header->size);
+#endif
+        
+        // Free the type name if this object owns it
+        if (ZenoRC_flags(header) & ZENO_RC_OWNS_NAME) {
+            free((void*)header->type_name);
+        }
+        
         // Free the memory
         free(header);
-    } else if (header->ref_count < 0) {
+    } else if (count > 0) {
+#ifdef ZENO_ARC_CYCLES
+        if (header->trace) {
+            ZenoRC_possibleRoot(ptr);
+        }
+#endif
+    } else {
         fprintf(stderr, "ZenoRC: Error - negative reference count for %s at %p (%d)\n", 
-                header->type_name, ptr, header->ref_count);
+                header->type_name, ptr, count);
     }
 }
 
@@ -106,26 +329,75 @@ static inline void ZenoRC_setDeinit(void* ptr, void (*deinit)(void*)) {
     }
 }
 
+// Set the trace function used by the cycle collector to find an object's children.
+// Without ZENO_ARC_CYCLES it is stored but never called.
+static inline void ZenoRC_setTrace(void* ptr, void (*trace)(void*, ZenoRC_Visitor)) {
+    if (!ptr) return;
+    
+    ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
+    header->trace = trace;
+}
+
 // Get reference count (for debugging)
 static inline int ZenoRC_getCount(void* ptr) {
     if (!ptr) return 0;
     
     ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
-    return header->ref_count;
+#ifdef ZENO_ARC_CYCLES
+    ZenoRC_checkTrial(header);
+#endif
+    return __atomic_load_n(&header->ref_count, __ATOMIC_ACQUIRE);
 }
 
-// Create a copy of an object (with new reference count)
-static inline void* ZenoRC_copy(void* ptr) {
+/**
+ * Copy hooks.
+ *
+ * ZenoRC_clone copies an object byte for byte, so child references end up
+ * shared between the original and the clone. An object with a deinit
+ * releases its children, and both copies would release them. Types with a
+ * deinit therefore register a copy hook that retains the children for the
+ * clone. Objects with a deinit and no copy hook for their type are not
+ * cloned.
+ */
+void ZenoRC_registerCopy(const char* type_name, void (*copy)(void* dst, const void* src));
+void (*ZenoRC_getCopy(const char* type_name))(void* dst, const void* src);
+
+// Create an independent copy of an object (with new reference count). The
+// type's copy hook, if any, retains the children the clone shares. Returns
+// NULL, with a message, if the object has a deinit but no copy hook.
+static inline void* ZenoRC_clone(void* ptr) {
     if (!ptr) return NULL;
     
     ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
+    void (*copy)(void*, const void*) = NULL;
+    if (header->deinit) {
+        copy = ZenoRC_getCopy(header->type_name);
+        if (!copy) {
+            fprintf(stderr, "ZenoRC: Error - cannot clone %s at %p: it has a deinit but no copy hook\n",
+                    header->type_name, ptr);
+            return NULL;
+        }
+    }
+    
     void* new_ptr = ZenoRC_alloc(header->size, header->type_name);
+    ZenoRC_Header* new_header = ((ZenoRC_Header*)new_ptr) - 1;
+    
+    // The clone may outlive the original, so it needs its own type name
+    if (ZenoRC_flags(header) & ZENO_RC_OWNS_NAME) {
+        new_header->type_name = strdup(header->type_name);
+        ZenoRC_setFlags(new_header, ZENO_RC_OWNS_NAME);
+    }
+    ZenoRC_setFlags(new_header, ZenoRC_flags(header) & ZENO_RC_COW);
     
-    // Copy the data
+    // Copy the data, then take references to the children it shares
     memcpy(new_ptr, ptr, header->size);
+    if (copy) {
+        copy(new_ptr, ptr);
+    }
     
     // Copy the destructor
     ZenoRC_setDeinit(new_ptr, header->deinit);
+    ZenoRC_setTrace(new_ptr, header->trace);
     
     if (ZENO_ARC_DEBUG) {
         printf("ZenoRC: Created copy of %s from %p to %p\n", 
@@ -135,6 +407,64 @@ static inline void* ZenoRC_copy(void* ptr) {
     return new_ptr;
 }
 
+// Opt an object into copy-on-write. Every holder of a copy must then write
+// through ZenoRC_mutate, since ZenoRC_copy hands out the same storage.
+static inline void ZenoRC_setCopyOnWrite(void* ptr) {
+    if (!ptr) return;
+    
+    ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
+    ZenoRC_setFlags(header, ZENO_RC_COW);
+}
+
+// Create a copy of an object with value semantics. Objects tagged
+// ZENO_RC_COW (arrays from ZenoRC_createArray, or anything passed to
+// ZenoRC_setCopyOnWrite) share the original's storage until one side writes
+// through ZenoRC_mutate. Everything else is copied immediately with
+// ZenoRC_clone, which may return NULL (see above).
+static inline void* ZenoRC_copy(void* ptr) {
+    if (!ptr) return NULL;
+    
+    ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
+    if (ZenoRC_flags(header) & ZENO_RC_COW) {
+        ZenoRC_retain(ptr);
+        return ptr;
+    }
+    
+    return ZenoRC_clone(ptr);
+}
+
+// Prepare an object for writing. If the storage is shared with other copies,
+// *ref is replaced by a private clone and the shared one is released.
+// Returns the (possibly new) writable pointer, or NULL with *ref unchanged
+// if the object cannot be cloned.
+static inline void* ZenoRC_mutate(void** ref) {
+    if (!ref || !*ref) return NULL;
+    
+    ZenoRC_Header* header = ((ZenoRC_Header*)*ref) - 1;
+#ifdef ZENO_ARC_CYCLES
+    ZenoRC_checkTrial(header);
+#endif
+    if (__atomic_load_n(&header->ref_count, __ATOMIC_ACQUIRE) > 1) {
+        void* unique = ZenoRC_clone(*ref);
+        if (!unique) return NULL;
+        ZenoRC_release(*ref);
+        *ref = unique;
+    }
+    
+    return *ref;
+}
+
+// Check whether an object can be written without affecting other copies
+static inline bool ZenoRC_isUnique(void* ptr) {
+    if (!ptr) return false;
+    
+    ZenoRC_Header* header = ((ZenoRC_Header*)ptr) - 1;
+#ifdef ZENO_ARC_CYCLES
+    ZenoRC_checkTrial(header);
+#endif
+    return __atomic_load_n(&header->ref_count, __ATOMIC_ACQUIRE) == 1;
+}
+
 // Create a string (with reference counting)
 static inline char* ZenoRC_string(const char* str) {
     if (!str) return NULL;
@@ -177,5 +507,20 @@ static inline void ZenoRC_dump(void* ptr) {
 #define ZENO_RETAIN(ptr) ZenoRC_retain(ptr)
 #define ZENO_RELEASE(ptr) ZenoRC_release(ptr)
 #define ZENO_STRING(str) ZenoRC_string(str)
+#define ZENO_MUTATE(ref) ((__typeof__(ref))ZenoRC_mutate((void**)&(ref)))
+
+// Runtime functions implemented in zeno_arc.c
+void ZenoRC_registerDeinit(const char* type_name, void (*deinit)(void*));
+void* ZenoRC_allocObject(size_t size, const char* type_name);
+void* ZenoRC_allocObjectAt(size_t size, const char* type_name, const char* file, int line);
+void ZenoRC_retainObject(void* ptr);
+void ZenoRC_releaseObject(void* ptr);
+void ZenoRC_setObjectDeinit(void* ptr, void (*deinit)(void*));
+char* ZenoRC_createString(const char* str);
+void* ZenoRC_createArray(size_t elem_size, size_t count, const char* elem_type);
+
+#ifdef ZENO_ARC_STATS
+#define ZenoRC_allocObject(size, type_name) ZenoRC_allocObjectAt((size), (type_name), __FILE__, __LINE__)
+#endif
 
 #endif // ZENO_ARC_H
\ No newline at end of file
@@ -0,0 +1,523 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <spawn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "zeno_cli.h"
+#include "parse.h"
+#include "threads.h"
+#include "codegen/codegen.h"
+
+extern char** environ;
+
+// Subdirectory of the output directory holding the generated units
+#define UNIT_DIR_NAME "units"
+
+// A source file of the project and the translation unit generated for it
+typedef struct {
+    char* path;             // Canonical path of the source file
+    char* unit;             // Unit name: <unit>.c, <unit>.h and <unit>.o
+    char* header;           // <unit>.h, as units include it
+    Arena* arena;           // Arena holding the module's AST and codegen strings
+    AST_Node* program;      // Parsed program, NULL until parsed
+    int* import_modules;    // Indices of the Zeno modules it imports
+    CodeGenImport* imports; // The same modules, as code generation sees them
+    int import_count;
+    int failed;             // Set by a task that could not finish
+} ZenoModule;
+
+// The import graph, and the batch of tasks currently on the thread pool
+typedef struct {
+    ZenoModule* modules;
+    int count;
+    int capacity;
+    ZenoManifest* manifest;
+    const char* unit_dir;
+    zn_mutex_t lock;
+    zn_cond_t done;
+    int pending;
+} BuildGraph;
+
+typedef struct {
+    BuildGraph* graph;
+    int index;
+} ModuleTask;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static void* build_alloc(size_t size) {
+    void* ptr = calloc(1, size);
+    if (!ptr) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+// Whether a unit name is taken, by a module or by a runtime object
+static int unit_name_taken(BuildGraph* graph, const char* name) {
+    if (strcmp(name, "zeno_string") == 0 || strcmp(name, "zeno_arc") == 0) {
+        return 1;
+    }
+    for (int i = 0; i < graph->count; i++) {
+        if (strcmp(graph->modules[i].unit, name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Unit name for a source: its file name without extension, made a valid
+// C identifier, with a numeric suffix if another module has the same one
+static char* make_unit_name(BuildGraph* graph, const char* path) {
+    const char* base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    size_t length = strcspn(base, ".");
+    
+    char name[NAME_MAX + 16];
+    if (length > NAME_MAX) length = NAME_MAX;
+    for (size_t i = 0; i < length; i++) {
+        char c = base[i];
+        int valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        name[i] = valid ? c : '_';
+    }
+    name[length] = '\0';
+    
+    if (unit_name_taken(graph, name)) {
+        size_t end = strlen(name);
+        for (int n = 2; ; n++) {
+            snprintf(name + end, sizeof(name) - end, "_%d", n);
+            if (!unit_name_taken(graph, name)) break;
+        }
+    }
+    return strdup(name);
+}
+
+// Index of the module for a source file, adding it if it is new
+static int add_module(BuildGraph* graph, const char* path) {
+    char canonical[PATH_MAX];
+    if (!realpath(path, canonical)) {
+        return -1;
+    }
+    
+    for (int i = 0; i < graph->count; i++) {
+        if (strcmp(graph->modules[i].path, canonical) == 0) {
+            return i;
+        }
+    }
+    
+    if (graph->count == graph->capacity) {
+        graph->capacity = graph->capacity ? graph->capacity * 2 : 16;
+        graph->modules = (ZenoModule*)realloc(graph->modules, graph->capacity * sizeof(ZenoModule));
+        if (!graph->modules) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+    }
+    
+    ZenoModule* module = &graph->modules[graph->count];
+    memset(module, 0, sizeof(ZenoModule));
+    module->path = strdup(canonical);
+    module->unit = make_unit_name(graph, canonical);
+    module->header = (char*)build_alloc(strlen(module->unit) + 3);
+    sprintf(module->header, "%s.h", module->unit);
+    return graph->count++;
+}
+
+// Run task on modules first..last-1 on the pool and wait for all of them
+static void run_module_tasks(BuildGraph* graph, zn_thread_pool_t* pool, int first, int last,
+                             zn_task_func_t task) {
+    if (first >= last) return;
+    
+    ModuleTask* tasks = (ModuleTask*)build_alloc((size_t)(last - first) * sizeof(ModuleTask));
+    graph->pending = last - first;
+    for (int i = first; i < last; i++) {
+        tasks[i - first].graph = graph;
+        tasks[i - first].index = i;
+        zn_thread_pool_add_task(pool, task, &tasks[i - first]);
+    }
+    
+    zn_mutex_lock(&graph->lock);
+    while (graph->pending > 0) {
+        zn_cond_wait(&graph->done, &graph->lock);
+    }
+    zn_mutex_unlock(&graph->lock);
+    free(tasks);
+}
+
+static void finish_task(BuildGraph* graph) {
+    zn_mutex_lock(&graph->lock);
+    if (--graph->pending == 0) {
+        zn_cond_signal(&graph->done);
+    }
+    zn_mutex_unlock(&graph->lock);
+}
+
+// Parse one module into its own arena
+static void parse_module_task(void* arg) {
+    ModuleTask* task = (ModuleTask*)arg;
+    ZenoModule* module = &task->graph->modules[task->index];
+    
+    module->arena = arena_create(0);
+    module->program = parse_path(module->path, module->arena);
+    if (!module->program) {
+        module->failed = 1;
+    }
+    
+    finish_task(task->graph);
+}
+
+// Whether an import names a Zeno module rather than a C header
+static int is_module_import(const char* name, size_t length) {
+    return (length > 3 && strncmp(name + length - 3, ".zn", 3) == 0) ||
+           (length > 5 && strncmp(name + length - 5, ".zeno", 5) == 0);
+}
+
+// Find an imported module next to the importer, then in the include directories
+static int resolve_import(BuildGraph* graph, const ZenoModule* importer, const char* name) {
+    char candidate[PATH_MAX];
+    const char* slash = strrchr(importer->path, '/');
+    int dir_length = (int)(slash - importer->path);
+    
+    snprintf(candidate, sizeof(candidate), "%.*s/%s", dir_length, importer->path, name);
+    if (access(candidate, R_OK) == 0) {
+        return add_module(graph, candidate);
+    }
+    
+    for (int i = 0; i < graph->manifest->source.include_count; i++) {
+        snprintf(candidate, sizeof(candidate), "%s/%s", graph->manifest->source.include[i], name);
+        if (access(candidate, R_OK) == 0) {
+            return add_module(graph, candidate);
+        }
+    }
+    return -1;
+}
+
+// Resolve a parsed module's imports, adding the modules not seen yet
+static int resolve_imports(BuildGraph* graph, int index) {
+    AST_Node* program = graph->modules[index].program;
+    int capacity = 0;
+    
+    for (AST_Node* decl = program->data.program.declarations->head; decl; decl = decl->next) {
+        if (decl->type == NODE_IMPORT) capacity++;
+    }
+    int* imports = (int*)build_alloc((size_t)(capacity ? capacity : 1) * sizeof(int));
+    int count = 0;
+    
+    for (AST_Node* decl = program->data.program.declarations->head; decl; decl = decl->next) {
+        if (decl->type != NODE_IMPORT) continue;
+    
+        // The filename keeps the quotes of the string literal
+        const char* literal = decl->data.import.filename;
+        char name[PATH_MAX];
+        snprintf(name, sizeof(name), "%s", literal[0] == '"' ? literal + 1 : literal);
+        size_t length = strlen(name);
+        if (length > 0 && name[length - 1] == '"') {
+            name[--length] = '\0';
+        }
+        if (!is_module_import(name, length)) continue;
+    
+        // add_module may move the module array
+        int imported = resolve_import(graph, &graph->modules[index], name);
+        if (imported < 0) {
+            fprintf(stderr, "Error: Cannot find module %s imported by %s\n", name,
+                    graph->modules[index].path);
+            free(imports);
+            return 1;
+        }
+        imports[count++] = imported;
+    }
+    
+    graph->modules[index].import_modules = imports;
+    graph->modules[index].import_count = count;
+    return 0;
+}
+
+// Generate the module's unit and the header its importers include
+static void generate_module_task(void* arg) {
+    ModuleTask* task = (ModuleTask*)arg;
+    BuildGraph* graph = task->graph;
+    ZenoModule* module = &graph->modules[task->index];
+    
+    size_t path_size = strlen(graph->unit_dir) + strlen(module->unit) + 8;
+    char* c_path = (char*)build_alloc(path_size);
+    char* h_path = (char*)build_alloc(path_size);
+    snprintf(c_path, path_size, "%s/%s.c", graph->unit_dir, module->unit);
+    snprintf(h_path, path_size, "%s/%s.h", graph->unit_dir, module->unit);
+    
+    FILE* c_file = fopen(c_path, "w");
+    FILE* h_file = fopen(h_path, "w");
+    if (!c_file || !h_file) {
+        fprintf(stderr, "Error: Could not open output file %s\n", c_file ? h_path : c_path);
+        module->failed = 1;
+    } else {
+        // Code generation allocates from the module's arena
+        ast_set_arena(module->arena);
+    
+        CodeGenContext* ctx = init_codegen(c_file);
+        ctx->imports = module->imports;
+        ctx->import_count = module->import_count;
+        generate_code(ctx, module->program);
+        cleanup_codegen(ctx);
+    
+        char guard[NAME_MAX + 32];
+        int length = snprintf(guard, sizeof(guard), "ZENO_UNIT_%s_H", module->unit);
+        for (int i = 0; i < length; i++) {
+            if (guard[i] >= 'a' && guard[i] <= 'z') guard[i] = (char)(guard[i] - 'a' + 'A');
+        }
+        ctx = init_codegen(h_file);
+        ctx->imports = module->imports;
+        ctx->import_count = module->import_count;
+        generate_module_header(ctx, module->program, guard);
+        cleanup_codegen(ctx);
+    
+        ast_set_arena(NULL);
+    }
+    
+    if (c_file) fclose(c_file);
+    if (h_file) fclose(h_file);
+    free(c_path);
+    free(h_path);
+    finish_task(graph);
+}
+
+// Run shell commands, at most jobs at a time; stops starting new ones after
+// the first failure. Returns 0 when every command succeeded.
+static int run_commands(char** commands, int count, int jobs, bool verbose) {
+    pid_t* pids = (pid_t*)build_alloc((size_t)(count ? count : 1) * sizeof(pid_t));
+    int next = 0;
+    int running = 0;
+    int failed = 0;
+    
+    while (running > 0 || (next < count && !failed)) {
+        while (running < jobs && next < count && !failed) {
+            char* argv[] = { "sh", "-c", commands[next], NULL };
+            if (verbose) {
+                printf("%s\n", commands[next]);
+            }
+            if (posix_spawn(&pids[next], "/bin/sh", NULL, NULL, argv, environ) != 0) {
+                fprintf(stderr, "Error: Could not run %s\n", commands[next]);
+                failed = 1;
+                break;
+            }
+            next++;
+            running++;
+        }
+        if (running == 0) break;
+    
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            failed = 1;
+            break;
+        }
+        running--;
+    
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            for (int i = 0; i < next; i++) {
+                if (pids[i] == pid) {
+                    fprintf(stderr, "Error: Command failed with code %d: %s\n",
+                            WIFEXITED(status) ? WEXITSTATUS(status) : -1, commands[i]);
+                }
+            }
+            failed = 1;
+        }
+    }
+    
+    free(pids);
+    return failed;
+}
+
+static char* format_command(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+static char* format_command(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    char* command = NULL;
+    if (vasprintf(&command, format, args) < 0) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    va_end(args);
+    return command;
+}
+
+static void free_graph(BuildGraph* graph) {
+    for (int i = 0; i < graph->count; i++) {
+        ZenoModule* module = &graph->modules[i];
+        free(module->path);
+        free(module->unit);
+        free(module->header);
+        free(module->import_modules);
+        free(module->imports);
+        arena_destroy(module->arena);
+    }
+    free(graph->modules);
+}
+
+// Build a project of many modules: parse the import graph reachable from
+// the main source, generate one C unit and header per module and compile
+// the units in parallel, then link them
+int build_zeno_project(ZenoOptions* options, ZenoManifest* manifest) {
+    const char* main_file = options->input_file ? options->input_file : manifest->source.main;
+    if (!main_file) {
+        fprintf(stderr, "No input file specified and no main file in manifest\n");
+        return 1;
+    }
+    if (options->use_llvm) {
+        fprintf(stderr, "Error: build supports the C backend only\n");
+        return 1;
+    }
+    
+    int jobs = options->jobs > 0 ? options->jobs : (int)zn_get_num_cores();
+    if (jobs < 1) jobs = 1;
+    
+    char unit_dir[PATH_MAX];
+    char output_path[PATH_MAX];
+    snprintf(unit_dir, sizeof(unit_dir), "%s/%s", manifest->output.dir, UNIT_DIR_NAME);
+    snprintf(output_path, sizeof(output_path), "%s/%s", manifest->output.dir,
+             options->output_file ? options->output_file : manifest->output.binary);
+    ensure_dir_exists(manifest->output.dir);
+    ensure_dir_exists(unit_dir);
+    
+    BuildGraph graph;
+    memset(&graph, 0, sizeof(graph));
+    graph.manifest = manifest;
+    graph.unit_dir = unit_dir;
+    zn_mutex_init(&graph.lock);
+    zn_cond_init(&graph.done);
+    
+    int result = 1;
+    zn_thread_pool_t* pool = zn_thread_pool_create(jobs);
+    if (!pool) {
+        fprintf(stderr, "Error: Could not create the build thread pool\n");
+        goto done;
+    }
+    
+    if (add_module(&graph, main_file) < 0) {
+        fprintf(stderr, "Error: Could not open input file %s\n", main_file);
+        goto done;
+    }
+    
+    // Discover the graph a wave at a time: parse every module found so far
+    // in parallel, then resolve their imports to find the next wave
+    double start = now_ms();
+    int parsed = 0;
+    while (parsed < graph.count) {
+        int wave_end = graph.count;
+        run_module_tasks(&graph, pool, parsed, wave_end, parse_module_task);
+        for (int i = parsed; i < wave_end; i++) {
+            if (graph.modules[i].failed) {
+                fprintf(stderr, "Error: Parsing failed for %s\n", graph.modules[i].path);
+                goto done;
+            }
+            if (resolve_imports(&graph, i) != 0) {
+                goto done;
+            }
+        }
+        parsed = wave_end;
+    }
+    
+    // Every module is parsed, so imports can now point at programs
+    for (int i = 0; i < graph.count; i++) {
+        ZenoModule* module = &graph.modules[i];
+        module->imports = (CodeGenImport*)build_alloc((size_t)(module->import_count + 1) * sizeof(CodeGenImport));
+        int import = 0;
+        for (AST_Node* decl = module->program->data.program.declarations->head; decl; decl = decl->next) {
+            if (decl->type != NODE_IMPORT) continue;
+            const char* name = decl->data.import.filename;
+            size_t length = strlen(name);
+            if (length > 0 && name[length - 1] == '"') length--;
+            if (!is_module_import(name, length)) continue;
+    
+            ZenoModule* imported = &graph.modules[module->import_modules[import]];
+            module->imports[import].filename = name;
+            module->imports[import].header = imported->header;
+            module->imports[import].program = imported->program;
+            import++;
+        }
+    }
+    double parse_done = now_ms();
+    
+    run_module_tasks(&graph, pool, 0, graph.count, generate_module_task);
+    for (int i = 0; i < graph.count; i++) {
+        if (graph.modules[i].failed) {
+            fprintf(stderr, "Error: Transpilation failed for %s\n", graph.modules[i].path);
+            goto done;
+        }
+    }
+    double generate_done = now_ms();
+    
+    // One compiler invocation per unit and per runtime source
+    const char* runtime_dir = get_runtime_dir();
+    const char* runtime_sources[] = { "zeno_string", "zeno_arc" };
+    int runtime_count = (int)(sizeof(runtime_sources) / sizeof(runtime_sources[0]));
+    int object_count = graph.count + runtime_count;
+    char** commands = (char**)build_alloc((size_t)object_count * sizeof(char*));
+    size_t objects_size = 1;
+    for (int i = 0; i < object_count; i++) {
+        const char* unit = i < graph.count ? graph.modules[i].unit : runtime_sources[i - graph.count];
+        const char* source_dir = i < graph.count ? unit_dir : runtime_dir;
+        commands[i] = format_command("%s %s -I%s -I%s -c %s/%s.c -o %s/%s.o", manifest->compiler.cc,
+                                     manifest->compiler.flags, runtime_dir, unit_dir, source_dir, unit,
+                                     unit_dir, unit);
+        objects_size += strlen(unit_dir) + strlen(unit) + 4;
+    }
+    
+    int compile_failed = run_commands(commands, object_count, jobs, options->verbose);
+    double compile_done = now_ms();
+    
+    int link_failed = 1;
+    if (!compile_failed) {
+        char* objects = (char*)build_alloc(objects_size);
+        char* end = objects;
+        for (int i = 0; i < object_count; i++) {
+            const char* unit = i < graph.count ? graph.modules[i].unit : runtime_sources[i - graph.count];
+            end += sprintf(end, " %s/%s.o", unit_dir, unit);
+        }
+        char* link = format_command("%s%s -o %s -lpthread %s", manifest->compiler.cc, objects, output_path,
+                                    manifest->compiler.flags);
+        link_failed = run_commands(&link, 1, 1, options->verbose);
+        free(link);
+        free(objects);
+    }
+    double link_done = now_ms();
+    
+    for (int i = 0; i < object_count; i++) {
+        free(commands[i]);
+    }
+    free(commands);
+    
+    if (compile_failed || link_failed) {
+        fprintf(stderr, "C compilation failed\n");
+        goto done;
+    }
+    
+    if (options->verbose) {
+        printf("Parsed %d modules in %.1f ms\n", graph.count, parse_done - start);
+        printf("Generated %d units in %.1f ms\n", graph.count, generate_done - parse_done);
+        printf("Compiled %d objects with %d jobs in %.1f ms\n", object_count, jobs, compile_done - generate_done);
+        printf("Linked %s in %.1f ms\n", output_path, link_done - compile_done);
+    }
+    result = 0;
+
+done:
+    if (pool) {
+        zn_thread_pool_destroy(pool);
+    }
+    zn_cond_destroy(&graph.done);
+    zn_mutex_destroy(&graph.lock);
+    free_graph(&graph);
+    return result;
+}
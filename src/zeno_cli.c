@@ -5,54 +5,33 @@
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include "zeno_cli.h"
+#include "parse.h"
 #include "llvm_codegen/llvm_codegen.h"
 #include "codegen/codegen.h"
 
-// External variables from Flex/Bison
-extern FILE* yyin;
-extern int yyparse();
-extern AST_Node* root;
+// Directory holding the runtime sources generated C code is built against
+#ifndef ZENO_RUNTIME_DIR
+#define ZENO_RUNTIME_DIR "src"
+#endif
 
-// Transpile a Zeno source file to C or LLVM
-int transpile_file(const char* input_path, const char* output_path, bool verbose, bool use_llvm) {
-    if (!input_path) {
-        fprintf(stderr, "Error: No input file specified\n");
-        return 1;
-    }
-    
-    if (!output_path) {
-        // Default output path: input file with .c or .bc extension
-        char default_output[1024];
-        char *ext = use_llvm ? ".bc" : ".c";
-        snprintf(default_output, sizeof(default_output), "%s%s", input_path, ext);
-        output_path = default_output;
-    }
-    
-    if (verbose) {
-        printf("Transpiling %s to %s%s\n", input_path, output_path, use_llvm ? " (using LLVM)" : "");
-    }
-    
-    // Open input file
-    yyin = fopen(input_path, "r");
-    if (!yyin) {
-        fprintf(stderr, "Error: Could not open input file %s\n", input_path);
-        return 1;
-    }
-    
-    // Parse the input file
-    int parse_result = yyparse();
-    fclose(yyin);
-    
-    if (parse_result != 0) {
-        fprintf(stderr, "Error: Parsing failed with code %d\n", parse_result);
-        return 1;
-    }
-    
-    if (!root) {
-        fprintf(stderr, "Error: No AST root node generated\n");
-        return 1;
-    }
-    
+// Get the runtime directory, allowing an environment override
+const char* get_runtime_dir(void) {
+    const char* dir = getenv("ZENO_RUNTIME_DIR");
+    return (dir && *dir) ? dir : ZENO_RUNTIME_DIR;
+}
+
+// Build the command that compiles generated C together with the runtime
+static void format_c_compile_command(char* buffer, size_t size, ZenoManifest* manifest,
+                                     const char* c_path, const char* output_path) {
+    const char* runtime_dir = get_runtime_dir();
+    snprintf(buffer, size,
+             "%s %s %s/zeno_string.c %s/zeno_arc.c -I%s -o %s -lpthread %s",
+             manifest->compiler.cc, c_path, runtime_dir, runtime_dir, runtime_dir,
+             output_path, manifest->compiler.flags);
+}
+
+// Generate C or LLVM output for a parsed program
+static int generate_output(AST_Node* program, const char* output_path, bool verbose, bool use_llvm) {
     if (use_llvm) {
         // Use LLVM backend
         LLVMGenContext* ctx = init_llvm_codegen("zeno_module", verbose);
@@ -62,7 +41,7 @@ int transpile_file(const char* input_path, const char* output_path, bool verbose
         }
         
         // Generate LLVM IR
-        llvm_generate_code(ctx, root);
+        llvm_generate_code(ctx, program);
         
         // Write LLVM output (either IR or compiled)
         int result;
@@ -94,7 +73,15 @@ int transpile_file(const char* input_path, const char* output_path, bool verbose
         }
         
         // Generate C code
-        generate_code(ctx, root);
+        generate_code(ctx, program);
+        
+        if (verbose) {
+            ArcStats* arc = &ctx->arc_stats;
+            printf("ARC: emitted %d retains/%d releases, elided %d retains/%d releases\n",
+                   arc->retains_emitted, arc->releases_emitted,
+                   arc->retains_naive - arc->retains_emitted,
+                   arc->releases_naive - arc->releases_emitted);
+        }
         
         // Clean up
         cleanup_codegen(ctx);
@@ -108,6 +95,46 @@ int transpile_file(const char* input_path, const char* output_path, bool verbose
     }
 }
 
+// Transpile a Zeno source file to C or LLVM
+int transpile_file(const char* input_path, const char* output_path, bool verbose, bool use_llvm) {
+    if (!input_path) {
+        fprintf(stderr, "Error: No input file specified\n");
+        return 1;
+    }
+    
+    char default_output[1024];
+    if (!output_path) {
+        // Default output path: input file with .c or .bc extension
+        char *ext = use_llvm ? ".bc" : ".c";
+        snprintf(default_output, sizeof(default_output), "%s%s", input_path, ext);
+        output_path = default_output;
+    }
+    
+    if (verbose) {
+        printf("Transpiling %s to %s%s\n", input_path, output_path, use_llvm ? " (using LLVM)" : "");
+    }
+    
+    // Everything the parser builds for this unit comes from one arena,
+    // released in one go once the output has been generated
+    Arena* arena = arena_create(0);
+    
+    // Parse the input file, mapped into memory when it is a regular file
+    AST_Node* root = parse_path(input_path, arena);
+    
+    int result = 1;
+    if (!root) {
+        fprintf(stderr, "Error: Parsing failed\n");
+    } else {
+        // Code generation allocates from the unit's arena too
+        ast_set_arena(arena);
+        result = generate_output(root, output_path, verbose, use_llvm);
+        ast_set_arena(NULL);
+    }
+    
+    arena_destroy(arena);
+    return result;
+}
+
 // For parsing YAML
 #define MAX_LINE_LENGTH 1024
 #define MAX_INCLUDE_DIRS 32
@@ -354,7 +381,7 @@ void free_manifest(ZenoManifest* manifest) {
 }
 
 // Ensure directory exists
-static void ensure_dir_exists(const char* dir) {
+void ensure_dir_exists(const char* dir) {
     struct stat st = {0};
     if (stat(dir, &st) == -1) {
         // Directory doesn't exist, create it
@@ -428,10 +455,9 @@ int run_zeno_file(ZenoOptions* options, ZenoManifest* manifest) {
             printf("Compiling %s to %s\n", c_output_path, output_path);
         }
         
-        char compile_cmd[2048];
-        snprintf(compile_cmd, sizeof(compile_cmd), 
-                 "%s %s -o %s %s", 
-                 manifest->compiler.cc, c_output_path, output_path, manifest->compiler.flags);
+        char compile_cmd[4096];
+        format_c_compile_command(compile_cmd, sizeof(compile_cmd), manifest,
+                                 c_output_path, output_path);
         
         result = system(compile_cmd);
         if (result != 0) {
@@ -521,10 +547,9 @@ int compile_zeno_file(ZenoOptions* options, ZenoManifest* manifest) {
             printf("Compiling %s to %s\n", c_output_path, output_path);
         }
         
-        char compile_cmd[2048];
-        snprintf(compile_cmd, sizeof(compile_cmd), 
-                 "%s %s -o %s %s", 
-                 manifest->compiler.cc, c_output_path, output_path, manifest->compiler.flags);
+        char compile_cmd[4096];
+        format_c_compile_command(compile_cmd, sizeof(compile_cmd), manifest,
+                                 c_output_path, output_path);
         
         result = system(compile_cmd);
         if (result != 0) {
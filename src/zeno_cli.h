@@ -33,7 +33,9 @@ typedef struct {
     char* output_file;
     bool run_mode;
     bool compile_mode;
+    bool build_mode;
     bool use_llvm;    // New flag for LLVM backend
+    int jobs;         // Parallel jobs for build (0 = number of cores)
 } ZenoOptions;
 
 // Function declarations
@@ -42,6 +44,11 @@ void free_manifest(ZenoManifest* manifest);
 int run_zeno_file(ZenoOptions* options, ZenoManifest* manifest);
 int compile_zeno_file(ZenoOptions* options, ZenoManifest* manifest);
 int init_zeno_project(const char* dir_path, bool verbose);
+const char* get_runtime_dir(void);
+void ensure_dir_exists(const char* dir);
+
+// Build a multi-module project (defined in zeno_build.c)
+int build_zeno_project(ZenoOptions* options, ZenoManifest* manifest);
 
 // Transpile function (defined in main.c)
 int transpile_file(const char* input_path, const char* output_path, bool verbose, bool use_llvm);
@@ -0,0 +1,244 @@
+#include "zeno_string.h"
+#include "zeno_arc.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * Zeno Strings - Implementation
+ *
+ * Short strings live inside the zn_string_t value. Long strings are copied
+ * once into a ZenoRC buffer that carries a trailing NUL, so zn_string_cstr
+ * never allocates. The intern table stores each distinct string once in a
+ * bump-allocated block together with its hash and length.
+ */
+
+// Header stored in front of every interned string's characters
+typedef struct {
+    uint32_t hash;
+    uint32_t length;
+    char chars[];
+} ZnInternEntry;
+
+#define ZN_INTERN_INITIAL_CAPACITY 1024   // Slots, always a power of two
+#define ZN_INTERN_BLOCK_SIZE       65536  // Bytes per bump allocator block
+
+typedef struct ZnInternBlock {
+    struct ZnInternBlock* next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} ZnInternBlock;
+
+static struct {
+    pthread_mutex_t lock;
+    ZnInternEntry** slots;
+    size_t capacity;
+    size_t count;
+    ZnInternBlock* blocks;
+} zn_intern_table = { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, NULL };
+
+// FNV-1a, 32-bit
+static uint32_t hash_bytes(const char* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline ZnInternEntry* intern_entry(const zn_string_t* str) {
+    return (ZnInternEntry*)(str->large.data - offsetof(ZnInternEntry, chars));
+}
+
+static zn_string_t make_small(const char* data, size_t length) {
+    zn_string_t result = ZN_STRING_EMPTY;
+    memcpy(result.small.chars, data, length);
+    result.small.remaining = (uint8_t)(ZN_STRING_INLINE_CAPACITY - length);
+    return result;
+}
+
+static zn_string_t make_large(const char* data, size_t length, uint8_t tag) {
+    zn_string_t result;
+    memset(&result, 0, sizeof(result));
+    result.large.data = data;
+    result.large.length = (uint32_t)length;
+    result.large.tag = tag;
+    return result;
+}
+
+zn_string_t zn_string_from_buffer(const char* data, size_t length) {
+    if (length <= ZN_STRING_INLINE_CAPACITY) {
+        return make_small(data, length);
+    }
+
+    char* buffer = ZenoRC_alloc(length + 1, "String");
+    if (!buffer) {
+        return ZN_STRING_EMPTY;
+    }
+    memcpy(buffer, data, length);
+    buffer[length] = '\0';
+    return make_large(buffer, length, ZN_STRING_TAG_HEAP);
+}
+
+zn_string_t zn_string_from_cstr(const char* cstr) {
+    return zn_string_from_buffer(cstr, strlen(cstr));
+}
+
+zn_string_t zn_string_concat(zn_string_t left, zn_string_t right) {
+    size_t left_length = zn_string_length(&left);
+    size_t right_length = zn_string_length(&right);
+    size_t length = left_length + right_length;
+
+    if (length <= ZN_STRING_INLINE_CAPACITY) {
+        zn_string_t result = make_small(zn_string_cstr(&left), left_length);
+        memcpy(result.small.chars + left_length, zn_string_cstr(&right), right_length);
+        result.small.remaining = (uint8_t)(ZN_STRING_INLINE_CAPACITY - length);
+        return result;
+    }
+
+    char* buffer = ZenoRC_alloc(length + 1, "String");
+    if (!buffer) {
+        return ZN_STRING_EMPTY;
+    }
+    memcpy(buffer, zn_string_cstr(&left), left_length);
+    memcpy(buffer + left_length, zn_string_cstr(&right), right_length);
+    buffer[length] = '\0';
+    return make_large(buffer, length, ZN_STRING_TAG_HEAP);
+}
+
+void zn_string_retain(const zn_string_t* str) {
+    if (!zn_string_is_small(str) && str->large.tag == ZN_STRING_TAG_HEAP) {
+        ZenoRC_retain((void*)str->large.data);
+    }
+}
+
+void zn_string_release(zn_string_t* str) {
+    if (!zn_string_is_small(str) && str->large.tag == ZN_STRING_TAG_HEAP) {
+        ZenoRC_release((void*)str->large.data);
+    }
+    *str = ZN_STRING_EMPTY;
+}
+
+uint32_t zn_string_hash(const zn_string_t* str) {
+    if (zn_string_is_interned(str)) {
+        return intern_entry(str)->hash;
+    }
+    return hash_bytes(zn_string_cstr(str), zn_string_length(str));
+}
+
+// Carve an entry out of the current block, starting a new block when full
+static ZnInternEntry* intern_allocate(size_t length) {
+    size_t size = (sizeof(ZnInternEntry) + length + 1 + 7) & ~(size_t)7;
+    ZnInternBlock* block = zn_intern_table.blocks;
+
+    if (!block || block->capacity - block->used < size) {
+        size_t capacity = size > ZN_INTERN_BLOCK_SIZE ? size : ZN_INTERN_BLOCK_SIZE;
+        block = malloc(sizeof(ZnInternBlock) + capacity);
+        if (!block) {
+            return NULL;
+        }
+        block->next = zn_intern_table.blocks;
+        block->used = 0;
+        block->capacity = capacity;
+        zn_intern_table.blocks = block;
+    }
+
+    ZnInternEntry* entry = (ZnInternEntry*)(block->data + block->used);
+    block->used += size;
+    return entry;
+}
+
+static bool intern_grow(void) {
+    size_t capacity = zn_intern_table.capacity ? zn_intern_table.capacity * 2
+                                               : ZN_INTERN_INITIAL_CAPACITY;
+    ZnInternEntry** slots = calloc(capacity, sizeof(ZnInternEntry*));
+    if (!slots) {
+        return false;
+    }
+
+    for (size_t i = 0; i < zn_intern_table.capacity; i++) {
+        ZnInternEntry* entry = zn_intern_table.slots[i];
+        if (!entry) {
+            continue;
+        }
+        size_t index = entry->hash & (capacity - 1);
+        while (slots[index]) {
+            index = (index + 1) & (capacity - 1);
+        }
+        slots[index] = entry;
+    }
+
+    free(zn_intern_table.slots);
+    zn_intern_table.slots = slots;
+    zn_intern_table.capacity = capacity;
+    return true;
+}
+
+zn_string_t zn_string_intern_buffer(const char* data, size_t length) {
+    uint32_t hash = hash_bytes(data, length);
+    ZnInternEntry* found = NULL;
+
+    pthread_mutex_lock(&zn_intern_table.lock);
+
+    // Keep the load factor below 3/4
+    if ((zn_intern_table.count + 1) * 4 > zn_intern_table.capacity * 3 && !intern_grow()) {
+        pthread_mutex_unlock(&zn_intern_table.lock);
+        return zn_string_from_buffer(data, length);
+    }
+
+    size_t mask = zn_intern_table.capacity - 1;
+    size_t index = hash & mask;
+    while (zn_intern_table.slots[index]) {
+        ZnInternEntry* entry = zn_intern_table.slots[index];
+        if (entry->hash == hash && entry->length == length &&
+            memcmp(entry->chars, data, length) == 0) {
+            found = entry;
+            break;
+        }
+        index = (index + 1) & mask;
+    }
+
+    if (!found) {
+        found = intern_allocate(length);
+        if (found) {
+            found->hash = hash;
+            found->length = (uint32_t)length;
+            memcpy(found->chars, data, length);
+            found->chars[length] = '\0';
+            zn_intern_table.slots[index] = found;
+            zn_intern_table.count++;
+        }
+    }
+
+    pthread_mutex_unlock(&zn_intern_table.lock);
+
+    if (!found) {
+        return zn_string_from_buffer(data, length);
+    }
+    return make_large(found->chars, length, ZN_STRING_TAG_INTERNED);
+}
+
+zn_string_t zn_string_intern(const zn_string_t* str) {
+    if (zn_string_is_interned(str)) {
+        return *str;
+    }
+    return zn_string_intern_buffer(zn_string_cstr(str), zn_string_length(str));
+}
+
+const char* zn_string_intern_cstr(const char* cstr) {
+    zn_string_t interned = zn_string_intern_buffer(cstr, strlen(cstr));
+    if (!zn_string_is_interned(&interned)) {
+        // Out of memory: the fallback copy would not outlive this call
+        zn_string_release(&interned);
+        return NULL;
+    }
+    return interned.large.data;
+}
+
+size_t zn_string_intern_count(void) {
+    pthread_mutex_lock(&zn_intern_table.lock);
+    size_t count = zn_intern_table.count;
+    pthread_mutex_unlock(&zn_intern_table.lock);
+    return count;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file zeno_string.h
+ * @brief Immutable runtime strings with small-string optimization and interning
+ *
+ * A zn_string_t is a 16 byte value. Strings of up to 15 bytes are stored
+ * inline and never allocate. Longer strings point at a static literal, a
+ * ZenoRC heap buffer or an entry in the global intern table. The length is
+ * always cached, so no operation needs strlen. Interned strings are unique
+ * per content, which turns equality into a pointer compare.
+ */
+
+#ifndef ZENO_STRING_H
+#define ZENO_STRING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Longest string stored inline */
+#define ZN_STRING_INLINE_CAPACITY 15
+
+/* Storage tags for large strings; always above ZN_STRING_INLINE_CAPACITY */
+#define ZN_STRING_TAG_STATIC   0x80u  /* Points at a literal, never freed */
+#define ZN_STRING_TAG_HEAP     0x81u  /* ZenoRC buffer, retained and released */
+#define ZN_STRING_TAG_INTERNED 0x82u  /* Intern table entry, lives forever */
+
+/**
+ * @brief Runtime string value
+ *
+ * The last byte tells the two layouts apart. For inline strings it holds
+ * the unused capacity, which is zero (and so doubles as the terminator) when
+ * all 15 bytes are used. For large strings it holds a ZN_STRING_TAG_* value.
+ */
+typedef union {
+    struct {
+        char chars[ZN_STRING_INLINE_CAPACITY];
+        uint8_t remaining;
+    } small;
+    struct {
+        const char* data;
+        uint32_t length;
+        uint8_t reserved[3];
+        uint8_t tag;
+    } large;
+} zn_string_t;
+
+/**
+ * @brief Build an inline string from a literal of at most 15 bytes
+ */
+#define ZN_STRING_SMALL_LITERAL(lit) \
+    ((zn_string_t){ .small = { lit, ZN_STRING_INLINE_CAPACITY - (sizeof(lit) - 1) } })
+
+/**
+ * @brief Build a string that points at a literal longer than 15 bytes
+ */
+#define ZN_STRING_STATIC_LITERAL(lit) \
+    ((zn_string_t){ .large = { lit, sizeof(lit) - 1, {0}, ZN_STRING_TAG_STATIC } })
+
+/**
+ * @brief The empty string (a zero-filled zn_string_t is not empty)
+ */
+#define ZN_STRING_EMPTY ZN_STRING_SMALL_LITERAL("")
+
+/**
+ * @brief Get a C string from any zn_string_t expression
+ *
+ * The temporary lives until the end of the enclosing block.
+ */
+#define ZN_CSTR(expr) zn_string_cstr((const zn_string_t[]){ (expr) })
+
+/**
+ * @brief Check whether a string is stored inline
+ */
+static inline bool zn_string_is_small(const zn_string_t* str) {
+    return str->small.remaining <= ZN_STRING_INLINE_CAPACITY;
+}
+
+/**
+ * @brief Get the cached length of a string in bytes
+ */
+static inline size_t zn_string_length(const zn_string_t* str) {
+    if (zn_string_is_small(str)) {
+        return ZN_STRING_INLINE_CAPACITY - str->small.remaining;
+    }
+    return str->large.length;
+}
+
+/**
+ * @brief Get a NUL-terminated view of a string
+ *
+ * For inline strings the pointer refers into *str itself.
+ */
+static inline const char* zn_string_cstr(const zn_string_t* str) {
+    return zn_string_is_small(str) ? str->small.chars : str->large.data;
+}
+
+/**
+ * @brief Check whether a string lives in the intern table
+ */
+static inline bool zn_string_is_interned(const zn_string_t* str) {
+    return !zn_string_is_small(str) && str->large.tag == ZN_STRING_TAG_INTERNED;
+}
+
+/**
+ * @brief Create a string by copying a buffer
+ * @param data Characters to copy (need not be NUL-terminated)
+ * @param length Number of bytes to copy
+ * @return Inline string when it fits, heap string otherwise
+ */
+zn_string_t zn_string_from_buffer(const char* data, size_t length);
+
+/**
+ * @brief Create a string by copying a C string
+ */
+zn_string_t zn_string_from_cstr(const char* cstr);
+
+/**
+ * @brief Concatenate two strings into a new string
+ */
+zn_string_t zn_string_concat(zn_string_t left, zn_string_t right);
+
+/**
+ * @brief Take another reference to a string (no-op unless heap allocated)
+ */
+void zn_string_retain(const zn_string_t* str);
+
+/**
+ * @brief Drop a reference to a string and reset it to empty
+ */
+void zn_string_release(zn_string_t* str);
+
+/**
+ * @brief Compare two strings for equality
+ *
+ * Inline strings compare by two word compares, and strings of different
+ * lengths or two interned strings without reading their characters. Only
+ * large strings of the same length reach memcmp. Inline so that generated
+ * comparisons do not pay for a call and for copying both operands.
+ */
+static inline bool zn_string_equals(const zn_string_t* left, const zn_string_t* right) {
+    // Inline strings are zero padded, so the whole value can be compared
+    if (zn_string_is_small(left) && zn_string_is_small(right)) {
+        return memcmp(left, right, sizeof(zn_string_t)) == 0;
+    }
+
+    size_t length = zn_string_length(left);
+    if (length != zn_string_length(right)) {
+        return false;
+    }
+    const char* left_data = zn_string_cstr(left);
+    const char* right_data = zn_string_cstr(right);
+    if (left_data == right_data) {
+        return true;
+    }
+
+    // Interned strings are unique per content
+    if (zn_string_is_interned(left) && zn_string_is_interned(right)) {
+        return false;
+    }
+    return memcmp(left_data, right_data, length) == 0;
+}
+
+/**
+ * @brief Hash a string (cached for interned strings)
+ */
+uint32_t zn_string_hash(const zn_string_t* str);
+
+/**
+ * @brief Return the canonical interned copy of a string
+ *
+ * Two interned strings are equal exactly when their data pointers are equal.
+ * Interned strings are never freed. The table is safe to use from multiple
+ * threads.
+ */
+zn_string_t zn_string_intern(const zn_string_t* str);
+
+/**
+ * @brief Intern a buffer directly
+ */
+zn_string_t zn_string_intern_buffer(const char* data, size_t length);
+
+/**
+ * @brief Intern a C string and return the canonical character pointer
+ *
+ * Used for map keys, which can then be compared by pointer.
+ */
+const char* zn_string_intern_cstr(const char* cstr);
+
+/**
+ * @brief Number of distinct strings in the intern table
+ */
+size_t zn_string_intern_count(void);
+
+#endif /* ZENO_STRING_H */